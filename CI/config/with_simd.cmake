@@ -0,0 +1,3 @@
+# from default, test the AVX2/FMA kernels of numerics
+include(CI/config/default.cmake)
+set_option(SIMD_ARCH avx2)
@@ -115,6 +115,9 @@ siconos_with_mumps = siconos_default.copy()(
     ci_config='with_mumps',
     add_pkgs=['mumps'])
 
+siconos_with_simd = siconos_default.copy()(
+    ci_config='with_simd')
+
 
 siconos_default_examples = siconos_default.copy()(
     ci_config='examples',
@@ -145,4 +148,5 @@ known_tasks = {'siconos---vm0':
                (siconos_debian_latest,
                 siconos_openblas_lapacke,
                 siconos_serialization,
-                siconos_with_mumps)}
+                siconos_with_mumps,
+                siconos_with_simd)}
@@ -72,6 +72,25 @@ elseif(USE_SANITIZER MATCHES "cfi")
   APPEND_C_FLAGS("-fsanitize=cfi -flto -fno-omit-frame-pointer -B ${CLANG_LD_HACK}")
 endif()
 
+# === SIMD kernels ===
+# Without these flags, the vectorized kernels fall back to their scalar loops.
+if(SIMD_ARCH STREQUAL "avx2")
+  set(_SIMD_FLAGS "-mavx2 -mfma")
+elseif(SIMD_ARCH STREQUAL "avx512")
+  set(_SIMD_FLAGS "-mavx512f -mavx2 -mfma")
+elseif(SIMD_ARCH STREQUAL "native")
+  set(_SIMD_FLAGS "-march=native")
+elseif(SIMD_ARCH AND NOT SIMD_ARCH STREQUAL "none")
+  message(FATAL_ERROR "Unknown SIMD_ARCH ${SIMD_ARCH}: use none, avx2, avx512 or native")
+endif()
+if(_SIMD_FLAGS)
+  add_c_options("${_SIMD_FLAGS}")
+  string(REGEX REPLACE " " "" _SIMD_FLAGS_SANE "${_SIMD_FLAGS}")
+  if(NOT C_HAVE_${_SIMD_FLAGS_SANE})
+    message(FATAL_ERROR "The C compiler does not support ${_SIMD_FLAGS} (SIMD_ARCH=${SIMD_ARCH})")
+  endif()
+endif()
+
 # === Others options ===
 if(C_VERSION STRLESS "201112L")
   set(C_STD_VERSION "c99")
@@ -30,6 +30,10 @@ option(WITH_BULLET "compilation with Bullet Bindings. Default = OFF" OFF)
 option(WITH_OCC "compilation with OpenCascade Bindings. Default = OFF" OFF)
 option(WITH_MUMPS "Compilation with the MUMPS solver. Default = OFF" OFF)
 option(WITH_UMFPACK "Compilation with the UMFPACK solver. Default = OFF" OFF)
+option(WITH_OPENMP "Use OpenMP in the parallel numerics solvers, in the assembly of the one step nonsmooth problems and in the SpaceFilter broadphase. Default = OFF" OFF)
+option(WITH_TIMERS "Time the phases of the simulations, see Simulation::profiler(). Default = OFF" OFF)
+set(SIMD_ARCH "none" CACHE STRING "Instruction set of the vectorized numerics kernels (projectionOnConeBatch, projectionOnCylinderBatch, fc3d_nsgs plan, batched Alart-Curnier): none, avx2 (with fma), avx512 or native. Default = none")
+set_property(CACHE SIMD_ARCH PROPERTY STRINGS none avx2 avx512 native)
 option(WITH_FCLIB "link with fclib when this mode is enable. Default = OFF" OFF)
 option(WITH_FREECAD "Use FreeCAD. Default = OFF" OFF)
 option(WITH_MECHANISMS "Generation of bindings for Mechanisms toolbox (required OCE). Default = OFF" OFF)
@@ -58,6 +58,15 @@ if(WITH_UMFPACK)
   compile_with(Umfpack REQUIRED)
 endif()
 
+# --- OpenMP ---
+if(WITH_OPENMP)
+  find_package(OpenMP REQUIRED)
+  APPEND_C_FLAGS(${OpenMP_C_FLAGS})
+  if(WITH_CXX)
+    APPEND_CXX_FLAGS(${OpenMP_CXX_FLAGS})
+  endif()
+endif()
+
 # --- Fclib ---
 IF(WITH_FCLIB)
   COMPILE_WITH(FCLIB REQUIRED)   
@@ -105,6 +105,7 @@ int main(int argc, char* argv[])
   // Numerics and Solver Options
 
   NumericsOptions numerics_options;
+  setDefaultNumericsOptions(&numerics_options);
   numerics_options.verboseMode = 1; // turn verbose mode to off by default
 
 
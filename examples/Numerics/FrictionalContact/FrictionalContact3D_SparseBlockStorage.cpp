@@ -84,7 +84,7 @@ int main(int argc, char* argv[])
   MM->size1 = 3 * NC;
   NumericsProblem.M = MM;
 
-  SparseBlockStructuredMatrix *MBlockMatrix = (SparseBlockStructuredMatrix*)malloc(sizeof(*MBlockMatrix));
+  SparseBlockStructuredMatrix *MBlockMatrix = newSBM();
   MM->matrix1 = MBlockMatrix;
   MBlockMatrix->nbblocks = 3;
   double * block[3] = {M11, M22, M33};
@@ -115,6 +115,7 @@ int main(int argc, char* argv[])
   // Numerics and Solver Options
 
   NumericsOptions numerics_options;
+  setDefaultNumericsOptions(&numerics_options);
   numerics_options.verboseMode = 2; // turn verbose mode to off by default
 
 
@@ -179,7 +179,7 @@ int main(int argc, char* argv[])
   HH->size0 = Ndof;
   HH->size1 = 3 * NC;
 
-  HH->matrix1 = (SparseBlockStructuredMatrix*)malloc(sizeof(SparseBlockStructuredMatrix));
+  HH->matrix1 = newSBM();
   SparseBlockStructuredMatrix *HBlockMatrix = HH->matrix1;
   HBlockMatrix->nbblocks = 2;
   double * hblock[3] = {H00, H20};
@@ -210,6 +210,7 @@ int main(int argc, char* argv[])
   // Numerics and Solver Options
 
   NumericsOptions numerics_options;
+  setDefaultNumericsOptions(&numerics_options);
   numerics_options.verboseMode = 4; // turn verbose mode to off by default
 
 
@@ -182,7 +182,7 @@ int main(int argc, char* argv[])
   HH->size0 = Ndof;
   HH->size1 = 3 * NC;
 
-  HH->matrix1 = (SparseBlockStructuredMatrix*)malloc(sizeof(SparseBlockStructuredMatrix));
+  HH->matrix1 = newSBM();
   HH->matrix0 = NULL;
   SparseBlockStructuredMatrix *HBlockMatrix = HH->matrix1;
   HBlockMatrix->nbblocks = 4;
@@ -217,6 +217,7 @@ int main(int argc, char* argv[])
   // Numerics and Solver Options
 
   NumericsOptions numerics_options;
+  setDefaultNumericsOptions(&numerics_options);
   numerics_options.verboseMode = 1; // turn verbose mode to off by default
 
 
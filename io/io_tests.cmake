@@ -20,6 +20,10 @@ if(WITH_${COMPONENT}_TESTING)
     NEW_TEST(ioTests BasicTest.cpp KernelTest.cpp)
   ENDIF()
 
+  IF(HAVE_SICONOS_MECHANICS)
+    NEW_TEST(ioMechanicsTests MechanicsIOTest.cpp)
+  ENDIF()
+
   END_TEST(test)
 
 endif()
@@ -85,6 +85,7 @@ SICONOS_IO_REGISTER_WITH_BASES(DynamicalSystemsGraph,(_DynamicalSystemsGraph),
   (Bd)
   (L)
   (Ld)
+  (WStamp)
   (dummy)
   (e)
   (groupId)
@@ -592,7 +593,9 @@ SICONOS_IO_REGISTER_WITH_BASES(MoreauJeanGOSI,(OneStepIntegrator),
 SICONOS_IO_REGISTER_WITH_BASES(MoreauJeanOSI,(OneStepIntegrator),
   (_explicitNewtonEulerDSOperators)
   (_gamma)
+  (_sparseW)
   (_theta)
+  (_threadsNumber)
   (_useGamma)
   (_useGammaForRelation))
 SICONOS_IO_REGISTER_WITH_BASES(EulerMoreauOSI,(OneStepIntegrator),
@@ -24,7 +24,7 @@
 #include "Register.hpp"
 
 
-SICONOS_IO_REGISTER(NumericsOptions, (verboseMode));
+SICONOS_IO_REGISTER(NumericsOptions, (verboseMode)(threadsNumber));
 
 
 template <class Archive>
@@ -95,6 +95,8 @@ void siconos_io(Archive& ar, SparseBlockStructuredMatrix& v, unsigned int versio
   if (Archive::is_loading::value)
   {
     v.block = (double **) malloc(v.nbblocks * sizeof(double *));
+    v.blockstorage = NULL;
+    v.fixedblocksize = 0;
     v.blocksize1 = (unsigned int *) malloc (v.blocknumber1* sizeof(unsigned int));
     v.blocksize0 = (unsigned int *) malloc (v.blocknumber0* sizeof(unsigned int));
     SERIALIZE_C_ARRAY(v.blocknumber1, v, blocksize1, ar);
@@ -0,0 +1,356 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "SiconosConfig.h"
+
+#ifdef WITH_HDF5
+
+#include "MechanicsHdf5Writer.hpp"
+
+#include <Model.hpp>
+#include <Simulation.hpp>
+#include <RuntimeException.hpp>
+
+#include <hdf5.h>
+#include <pthread.h>
+
+//#define DEBUG_MESSAGES 1
+#include <debug.h>
+
+/* the datasets written by the writer */
+enum { DYNAMIC = 0, VELOCITIES = 1, CF = 2, NB_DATASETS = 3 };
+
+static const char* datasetNames[NB_DATASETS] =
+  { "dynamic", "velocities", "cf" };
+
+static const unsigned int datasetWidths[NB_DATASETS] = { 9, 8, 15 };
+
+struct MechanicsHdf5Writer::Impl
+{
+  std::string filename;
+  hid_t file;
+  hid_t data;
+  hid_t datasets[NB_DATASETS];
+  hsize_t nbRows[NB_DATASETS];
+
+  /* rows appended by the simulation */
+  std::vector<double> front[NB_DATASETS];
+  /* rows being written */
+  std::vector<double> back[NB_DATASETS];
+
+  bool background;
+  bool opened;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  bool pending;
+  bool stop;
+  bool failed;
+
+  Impl() : file(-1), data(-1), background(false), opened(false),
+           pending(false), stop(false), failed(false)
+  {
+    for(unsigned int i = 0; i < NB_DATASETS; ++i)
+    {
+      datasets[i] = -1;
+      nbRows[i] = 0;
+    }
+  }
+
+  void open(unsigned int chunkRows, unsigned int compression);
+  bool write(std::vector<double>* buffers);
+  void closeHandles();
+
+  static void* run(void* arg);
+};
+
+void MechanicsHdf5Writer::Impl::open(unsigned int chunkRows,
+                                     unsigned int compression)
+{
+  H5E_BEGIN_TRY
+  {
+    if (H5Fis_hdf5(filename.c_str()) > 0)
+      file = H5Fopen(filename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+    else
+      file = H5Fcreate(filename.c_str(), H5F_ACC_TRUNC,
+                       H5P_DEFAULT, H5P_DEFAULT);
+  }
+  H5E_END_TRY;
+  if (file < 0)
+    RuntimeException::selfThrow("MechanicsHdf5Writer: cannot open "
+                                + filename);
+
+  if (H5Lexists(file, "data", H5P_DEFAULT) > 0)
+    data = H5Gopen2(file, "data", H5P_DEFAULT);
+  else
+    data = H5Gcreate2(file, "data", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  if (data < 0)
+    RuntimeException::selfThrow("MechanicsHdf5Writer: cannot open group data in "
+                                + filename);
+
+  for(unsigned int i = 0; i < NB_DATASETS; ++i)
+  {
+    hsize_t dims[2] = { 0, datasetWidths[i] };
+    if (H5Lexists(data, datasetNames[i], H5P_DEFAULT) > 0)
+    {
+      datasets[i] = H5Dopen2(data, datasetNames[i], H5P_DEFAULT);
+      hid_t space = H5Dget_space(datasets[i]);
+      if (H5Sget_simple_extent_ndims(space) != 2)
+      {
+        H5Sclose(space);
+        RuntimeException::selfThrow("MechanicsHdf5Writer: unexpected rank for dataset "
+                                    + std::string(datasetNames[i]));
+      }
+      H5Sget_simple_extent_dims(space, dims, NULL);
+      H5Sclose(space);
+      if (dims[1] != datasetWidths[i])
+        RuntimeException::selfThrow("MechanicsHdf5Writer: unexpected number of columns for dataset "
+                                    + std::string(datasetNames[i]));
+    }
+    else
+    {
+      hsize_t maxdims[2] = { H5S_UNLIMITED, datasetWidths[i] };
+      hsize_t chunk[2] = { chunkRows, datasetWidths[i] };
+      hid_t space = H5Screate_simple(2, dims, maxdims);
+      hid_t plist = H5Pcreate(H5P_DATASET_CREATE);
+      H5Pset_chunk(plist, 2, chunk);
+      if (compression > 0 && H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0)
+      {
+        H5Pset_shuffle(plist);
+        H5Pset_deflate(plist, compression);
+      }
+      datasets[i] = H5Dcreate2(data, datasetNames[i], H5T_NATIVE_DOUBLE,
+                               space, H5P_DEFAULT, plist, H5P_DEFAULT);
+      H5Pclose(plist);
+      H5Sclose(space);
+    }
+    if (datasets[i] < 0)
+      RuntimeException::selfThrow("MechanicsHdf5Writer: cannot open dataset "
+                                  + std::string(datasetNames[i]));
+    nbRows[i] = dims[0];
+  }
+}
+
+/* append the rows of the buffers to the datasets. Called from the
+ * background thread if there is one. */
+bool MechanicsHdf5Writer::Impl::write(std::vector<double>* buffers)
+{
+  bool ok = true;
+  for(unsigned int i = 0; i < NB_DATASETS; ++i)
+  {
+    std::vector<double>& rows = buffers[i];
+    if (rows.empty()) continue;
+
+    hsize_t count[2] = { rows.size() / datasetWidths[i], datasetWidths[i] };
+    hsize_t start[2] = { nbRows[i], 0 };
+    hsize_t dims[2] = { nbRows[i] + count[0], datasetWidths[i] };
+
+    DEBUG_PRINTF("write %llu rows in %s\n", count[0], datasetNames[i]);
+
+    if (H5Dset_extent(datasets[i], dims) < 0)
+    {
+      ok = false;
+    }
+    else
+    {
+      hid_t filespace = H5Dget_space(datasets[i]);
+      hid_t memspace = H5Screate_simple(2, count, NULL);
+      H5Sselect_hyperslab(filespace, H5S_SELECT_SET, start, NULL, count, NULL);
+      if (H5Dwrite(datasets[i], H5T_NATIVE_DOUBLE, memspace, filespace,
+                   H5P_DEFAULT, &rows[0]) < 0)
+        ok = false;
+      else
+        nbRows[i] = dims[0];
+      H5Sclose(memspace);
+      H5Sclose(filespace);
+    }
+    /* the capacity is kept for the next steps */
+    rows.clear();
+  }
+  if (H5Fflush(file, H5F_SCOPE_LOCAL) < 0)
+    ok = false;
+  return ok;
+}
+
+void MechanicsHdf5Writer::Impl::closeHandles()
+{
+  for(unsigned int i = 0; i < NB_DATASETS; ++i)
+  {
+    if (datasets[i] >= 0) H5Dclose(datasets[i]);
+    datasets[i] = -1;
+  }
+  if (data >= 0) H5Gclose(data);
+  if (file >= 0) H5Fclose(file);
+  data = -1;
+  file = -1;
+}
+
+void* MechanicsHdf5Writer::Impl::run(void* arg)
+{
+  Impl& impl = *static_cast<Impl*>(arg);
+  pthread_mutex_lock(&impl.mutex);
+  while (true)
+  {
+    while (!impl.pending && !impl.stop)
+      pthread_cond_wait(&impl.cond, &impl.mutex);
+    if (!impl.pending)
+      break;
+    pthread_mutex_unlock(&impl.mutex);
+
+    bool ok = impl.write(impl.back);
+
+    pthread_mutex_lock(&impl.mutex);
+    impl.failed = impl.failed || !ok;
+    impl.pending = false;
+    pthread_cond_broadcast(&impl.cond);
+  }
+  pthread_mutex_unlock(&impl.mutex);
+  return NULL;
+}
+
+MechanicsHdf5Writer::MechanicsHdf5Writer(const std::string& filename,
+                                         bool background,
+                                         unsigned int chunkRows,
+                                         unsigned int compression) :
+  _impl(new Impl())
+{
+  _impl->filename = filename;
+  try
+  {
+    _impl->open(chunkRows > 0 ? chunkRows : 1, compression);
+  }
+  catch (...)
+  {
+    _impl->closeHandles();
+    delete _impl;
+    throw;
+  }
+  _impl->opened = true;
+
+  hbool_t threadsafe = 0;
+  H5is_library_threadsafe(&threadsafe);
+  if (background && threadsafe)
+  {
+    pthread_mutex_init(&_impl->mutex, NULL);
+    pthread_cond_init(&_impl->cond, NULL);
+    _impl->background =
+      (pthread_create(&_impl->thread, NULL, &Impl::run, _impl) == 0);
+    if (!_impl->background)
+    {
+      pthread_cond_destroy(&_impl->cond);
+      pthread_mutex_destroy(&_impl->mutex);
+    }
+  }
+  DEBUG_PRINTF("MechanicsHdf5Writer: background = %d\n", _impl->background);
+}
+
+MechanicsHdf5Writer::~MechanicsHdf5Writer()
+{
+  try
+  {
+    close();
+  }
+  catch (...)
+  {
+  }
+  delete _impl;
+}
+
+void MechanicsHdf5Writer::outputDynamicObjects(const Model& model)
+{
+  _io.appendPositions(model, model.simulation()->nextTime(),
+                      _impl->front[DYNAMIC]);
+}
+
+void MechanicsHdf5Writer::outputVelocities(const Model& model)
+{
+  _io.appendVelocities(model, model.simulation()->nextTime(),
+                       _impl->front[VELOCITIES]);
+}
+
+void MechanicsHdf5Writer::outputContactForces(const Model& model)
+{
+  _io.appendContactPoints(model, model.simulation()->nextTime(),
+                          _impl->front[CF]);
+}
+
+void MechanicsHdf5Writer::flush()
+{
+  if (!_impl->opened)
+    RuntimeException::selfThrow("MechanicsHdf5Writer::flush: "
+                                + _impl->filename + " is closed");
+  bool failed;
+  if (_impl->background)
+  {
+    pthread_mutex_lock(&_impl->mutex);
+    while (_impl->pending)
+      pthread_cond_wait(&_impl->cond, &_impl->mutex);
+    for(unsigned int i = 0; i < NB_DATASETS; ++i)
+      _impl->front[i].swap(_impl->back[i]);
+    _impl->pending = true;
+    failed = _impl->failed;
+    pthread_cond_broadcast(&_impl->cond);
+    pthread_mutex_unlock(&_impl->mutex);
+  }
+  else
+  {
+    failed = !_impl->write(_impl->front);
+  }
+  if (failed)
+    RuntimeException::selfThrow("MechanicsHdf5Writer: write error in "
+                                + _impl->filename);
+}
+
+void MechanicsHdf5Writer::close()
+{
+  if (!_impl->opened)
+    return;
+  bool failed = false;
+  try
+  {
+    flush();
+  }
+  catch (...)
+  {
+    failed = true;
+  }
+  if (_impl->background)
+  {
+    pthread_mutex_lock(&_impl->mutex);
+    _impl->stop = true;
+    pthread_cond_broadcast(&_impl->cond);
+    pthread_mutex_unlock(&_impl->mutex);
+    pthread_join(_impl->thread, NULL);
+    failed = failed || _impl->failed;
+    pthread_cond_destroy(&_impl->cond);
+    pthread_mutex_destroy(&_impl->mutex);
+    _impl->background = false;
+  }
+  _impl->closeHandles();
+  _impl->opened = false;
+  if (failed)
+    RuntimeException::selfThrow("MechanicsHdf5Writer: write error in "
+                                + _impl->filename);
+}
+
+bool MechanicsHdf5Writer::background() const
+{
+  return _impl->background;
+}
+
+#endif
@@ -0,0 +1,111 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#ifndef MechanicsHdf5Writer_hpp
+#define MechanicsHdf5Writer_hpp
+
+#include <SiconosConfig.h>
+
+#ifdef WITH_HDF5
+
+#include <MechanicsIO.hpp>
+
+#include <string>
+#include <vector>
+
+/** Output of a mechanical simulation in an HDF5 file.
+ *
+ * The rows are appended to the datasets data/dynamic (9 columns),
+ * data/velocities (8 columns) and data/cf (15 columns), with the same
+ * layout as the one used by siconos.io.mechanics_io.Hdf5. The datasets
+ * are chunked and compressed. The rows are collected with the
+ * MechanicsIO visitors into a front buffer. flush() hands this buffer
+ * over to a background thread that writes it while the simulation
+ * goes on.
+ *
+ * The HDF5 library is called from the background thread only if it
+ * has been built thread-safe, as other HDF5 calls (from h5py for
+ * instance) may happen in the main thread. Otherwise the buffer is
+ * written by flush() itself.
+ */
+class MechanicsHdf5Writer
+{
+private:
+  struct Impl;
+  Impl* _impl;
+
+  MechanicsIO _io;
+
+  /* copy is forbidden */
+  MechanicsHdf5Writer(const MechanicsHdf5Writer&);
+  MechanicsHdf5Writer& operator=(const MechanicsHdf5Writer&);
+
+public:
+
+  /** constructor. The file is created if it does not exist, and
+   * the rows are appended to its existing datasets otherwise.
+   * \param filename the HDF5 file name
+   * \param background write the data from a background thread
+   * \param chunkRows number of rows of a dataset chunk
+   * \param compression deflate level, 0 for no compression
+   */
+  MechanicsHdf5Writer(const std::string& filename,
+                      bool background = true,
+                      unsigned int chunkRows = 4096,
+                      unsigned int compression = 4);
+
+  /** destructor, the remaining rows are written and the file is closed.
+   */
+  ~MechanicsHdf5Writer();
+
+  /** append translations and orientations of the dynamical systems,
+   * at the next time of the simulation
+   * \param model the model
+   */
+  void outputDynamicObjects(const Model& model);
+
+  /** append velocities of the dynamical systems, at the next time of
+   * the simulation
+   * \param model the model
+   */
+  void outputVelocities(const Model& model);
+
+  /** append contact points, normals and forces, at the next time of
+   * the simulation
+   * \param model the model
+   */
+  void outputContactForces(const Model& model);
+
+  /** hand the rows appended since the last call over to the writer.
+   * Waits only if the previous rows are still being written.
+   */
+  void flush();
+
+  /** write the remaining rows and close the file. Called by the
+   * destructor.
+   */
+  void close();
+
+  /** \return true if the rows are written from a background thread
+   */
+  bool background() const;
+};
+
+#endif
+
+#endif
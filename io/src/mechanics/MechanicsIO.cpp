@@ -138,6 +138,50 @@ struct GetVelocity : public SiconosVisitor
   }
 };
 
+/* fill a row of the given width with id followed by the components
+ * of v, completed with zeros */
+static void fillRow(double* row, unsigned int width,
+                    double id, const SiconosVector& v)
+{
+  row[0] = id;
+  unsigned int n = v.size() < width - 1 ? v.size() : width - 1;
+  unsigned int i;
+  for(i = 0; i < n; ++i)
+  {
+    row[1+i] = v(i);
+  }
+  for(i = n + 1; i < width; ++i)
+  {
+    row[i] = 0.;
+  }
+}
+
+struct AppendPosition : public SiconosVisitor
+{
+
+  double* row;
+  unsigned int width;
+
+  template<typename T>
+  void operator()(const T& ds)
+  {
+    fillRow(row, width, ds.number() + 1, *ds.q());
+  }
+};
+
+struct AppendVelocity : public SiconosVisitor
+{
+
+  double* row;
+  unsigned int width;
+
+  template<typename T>
+  void operator()(const T& ds)
+  {
+    fillRow(row, width, ds.number() + 1, *ds.velocity());
+  }
+};
+
 struct ForMu : public Question<double>
 {
     ANSWER(NewtonImpactFrictionNSL, mu());
@@ -147,76 +191,96 @@ struct ForMu : public Question<double>
 /* template partial specilization is not possible inside struct, so we
  * need an helper function */
 template<typename T>
-void contactPointProcess(SiconosVector& answer,
+bool contactPointProcess(double* answer,
                          const Interaction& inter,
                          const T& rel)
 {
 
-  answer.resize(14);
   const SiconosVector& posa = *rel.pc1();
   const SiconosVector& posb = *rel.pc2();
   const SiconosVector& nc = *rel.nc();
   const SimpleMatrix& jachqT = *rel.jachqT();
+  const SiconosVector& lambda = *inter.lambda(1);
   double id = inter.number();
   double mu = ask<ForMu>(*inter.nslaw());
-  SiconosVector cf(jachqT.size(1));
-  prod(*inter.lambda(1), jachqT, cf, true);
-  answer.setValue(0, mu);
+
+  /* cf = jachqT^T lambda, only the first 3 components are needed */
+  double cf[3] = { 0., 0., 0. };
+  for(unsigned int i = 0; i < lambda.size(); ++i)
+  {
+    for(unsigned int j = 0; j < 3; ++j)
+    {
+      cf[j] += lambda(i) * jachqT(i, j);
+    }
+  }
 
   DEBUG_PRINTF("posa(0)=%g\n", posa(0));
   DEBUG_PRINTF("posa(1)=%g\n", posa(1));
   DEBUG_PRINTF("posa(2)=%g\n", posa(2));
 
-
-  answer.setValue(1, posa(0));
-  answer.setValue(2, posa(1));
-  answer.setValue(3, posa(2));
-  answer.setValue(4, posb(0));
-  answer.setValue(5, posb(1));
-  answer.setValue(6, posb(2));
-  answer.setValue(7, nc(0));
-  answer.setValue(8, nc(1));
-  answer.setValue(9, nc(2));
-  answer.setValue(10, cf(0));
-  answer.setValue(11, cf(1));
-  answer.setValue(12, cf(2));
-  answer.setValue(13, id);
+  answer[0] = mu;
+  answer[1] = posa(0);
+  answer[2] = posa(1);
+  answer[3] = posa(2);
+  answer[4] = posb(0);
+  answer[5] = posb(1);
+  answer[6] = posb(2);
+  answer[7] = nc(0);
+  answer[8] = nc(1);
+  answer[9] = nc(2);
+  answer[10] = cf[0];
+  answer[11] = cf[1];
+  answer[12] = cf[2];
+  answer[13] = id;
+  return true;
 };
 
 template<>
-void contactPointProcess<PivotJointR>(SiconosVector& answer,
+bool contactPointProcess<PivotJointR>(double* answer,
                                       const Interaction& inter,
                                       const PivotJointR& rel)
 {
+  return false;
 };
 
 template<>
-void contactPointProcess<KneeJointR>(SiconosVector& answer,
+bool contactPointProcess<KneeJointR>(double* answer,
                                      const Interaction& inter,
                                      const KneeJointR& rel)
 {
+  return false;
 };
 
 template<>
-void contactPointProcess<PrismaticJointR>(SiconosVector& answer,
+bool contactPointProcess<PrismaticJointR>(double* answer,
                                           const Interaction& inter,
                                           const PrismaticJointR& rel)
 {
+  return false;
 };
 
 struct ContactPointVisitor : public SiconosVisitor
 {
   SP::Interaction inter;
-  SiconosVector answer;
+  double* answer;
+  bool valid;
 
   template<typename T>
   void operator()(const T& rel)
   {
-    contactPointProcess<T>(answer, *inter, rel);
+    valid = contactPointProcess<T>(answer, *inter, rel);
   }
 
 };
 
+typedef Visitor < Classes <
+                    NewtonEulerFrom1DLocalFrameR,
+                    NewtonEulerFrom3DLocalFrameR,
+                    PrismaticJointR,
+                    KneeJointR,
+                    PivotJointR>,
+                  ContactPointVisitor>::Make ContactPointInspector;
+
 template<typename T, typename G>
 SP::SimpleMatrix MechanicsIO::visitAllVerticesForVector(const G& graph) const
 {
@@ -283,25 +347,100 @@ SP::SimpleMatrix MechanicsIO::contactPoints(const Model& model) const
     InteractionsGraph& graph =
       *model.nonSmoothDynamicalSystem()->topology()->indexSet(1);
     unsigned int current_row;
+    double data[14];
     result->resize(graph.vertices_number(), 14);
     for(current_row=0, std11::tie(vi,viend) = graph.vertices();
         vi!=viend; ++vi, ++current_row)
     {
       DEBUG_PRINTF("process interaction : %p\n", &*graph.bundle(*vi));
 
-      typedef Visitor < Classes <
-                          NewtonEulerFrom1DLocalFrameR,
-                          NewtonEulerFrom3DLocalFrameR,
-                          PrismaticJointR,
-                          KneeJointR,
-                          PivotJointR>,
-                        ContactPointVisitor>::Make ContactPointInspector;
       ContactPointInspector inspector;
       inspector.inter = graph.bundle(*vi);
+      inspector.answer = data;
+      inspector.valid = false;
       graph.bundle(*vi)->relation()->accept(inspector);
-      const SiconosVector& data = inspector.answer;
-      if (data.size() == 14) result->setRow(current_row, data);
+      if (inspector.valid)
+      {
+        for(unsigned int j = 0; j < 14; ++j)
+        {
+          result->setValue(current_row, j, data[j]);
+        }
+      }
     }
   }
   return result;
 }
+
+template<typename T, typename G>
+unsigned int MechanicsIO::visitAllVerticesForRows(const G& graph,
+                                                  double time,
+                                                  std::vector<double>& rows,
+                                                  unsigned int width) const
+{
+  size_t current = rows.size();
+  unsigned int n = graph.vertices_number();
+  rows.resize(current + n * width);
+  T getter;
+  getter.width = width - 1;
+  typename G::VIterator vi, viend;
+  for(std11::tie(vi,viend)=graph.vertices(); vi!=viend; ++vi)
+  {
+    rows[current] = time;
+    getter.row = &rows[current + 1];
+    graph.bundle(*vi)->accept(getter);
+    current += width;
+  }
+  return n;
+}
+
+unsigned int MechanicsIO::appendPositions(const Model& model, double time,
+                                          std::vector<double>& rows) const
+{
+  typedef
+    Visitor < Classes < LagrangianDS, NewtonEulerDS >,
+              AppendPosition >::Make Getter;
+
+  return visitAllVerticesForRows<Getter>
+    (*model.nonSmoothDynamicalSystem()->topology()->dSG(0), time, rows, 9);
+}
+
+unsigned int MechanicsIO::appendVelocities(const Model& model, double time,
+                                           std::vector<double>& rows) const
+{
+  typedef
+    Visitor < Classes < LagrangianDS, NewtonEulerDS >,
+              AppendVelocity >::Make Getter;
+
+  return visitAllVerticesForRows<Getter>
+    (*model.nonSmoothDynamicalSystem()->topology()->dSG(0), time, rows, 8);
+}
+
+unsigned int MechanicsIO::appendContactPoints(const Model& model, double time,
+                                              std::vector<double>& rows) const
+{
+  unsigned int n = 0;
+  if (model.nonSmoothDynamicalSystem()->topology()->numberOfIndexSet() > 1)
+  {
+    InteractionsGraph& graph =
+      *model.nonSmoothDynamicalSystem()->topology()->indexSet(1);
+    size_t current = rows.size();
+    rows.resize(current + graph.vertices_number() * 15);
+    InteractionsGraph::VIterator vi, viend;
+    ContactPointInspector inspector;
+    for(std11::tie(vi,viend) = graph.vertices(); vi!=viend; ++vi)
+    {
+      rows[current] = time;
+      inspector.inter = graph.bundle(*vi);
+      inspector.answer = &rows[current + 1];
+      inspector.valid = false;
+      graph.bundle(*vi)->relation()->accept(inspector);
+      if (inspector.valid)
+      {
+        current += 15;
+        ++n;
+      }
+    }
+    rows.resize(current);
+  }
+  return n;
+}
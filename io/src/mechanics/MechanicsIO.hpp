@@ -23,6 +23,8 @@
 #include <SiconosPointers.hpp>
 #include <SiconosFwd.hpp>
 
+#include <vector>
+
 class MechanicsIO
 {
 protected:
@@ -33,6 +35,11 @@ protected:
   template<typename T, typename G>
   SP::SiconosVector visitAllVerticesForDouble(const G& graph) const;
 
+  template<typename T, typename G>
+  unsigned int visitAllVerticesForRows(const G& graph, double time,
+                                       std::vector<double>& rows,
+                                       unsigned int width) const;
+
 public:
   /** default constructor
    */
@@ -61,6 +68,38 @@ public:
       \return a matrix where the columns are mu x y z, nx, ny, nz, rx, ry, rz, vx, vy, vz, ox, oy, oz, id
   */
   SP::SimpleMatrix contactPoints(const Model& model) const;
+
+  /** append all positions to a row major buffer, without any
+   * intermediate matrix. Each row has 9 columns:
+   * time, id, x, y, z, qw, qx, qy, qz
+   * \param model the model
+   * \param time the value of the first column
+   * \param rows the buffer, rows are added at its end
+   * \return the number of appended rows
+   */
+  unsigned int appendPositions(const Model& model, double time,
+                               std::vector<double>& rows) const;
+
+  /** append all velocities to a row major buffer. Each row has 8
+   * columns: time, id, xdot, ydot, zdot, ox, oy, oz
+   * \param model the model
+   * \param time the value of the first column
+   * \param rows the buffer, rows are added at its end
+   * \return the number of appended rows
+   */
+  unsigned int appendVelocities(const Model& model, double time,
+                                std::vector<double>& rows) const;
+
+  /** append all contact points to a row major buffer. Each row has 15
+   * columns: time followed by the columns of contactPoints(). Joints
+   * are skipped.
+   * \param model the model
+   * \param time the value of the first column
+   * \param rows the buffer, rows are added at its end
+   * \return the number of appended rows
+   */
+  unsigned int appendContactPoints(const Model& model, double time,
+                                   std::vector<double>& rows) const;
 };
 
 
@@ -0,0 +1,254 @@
+#include "SiconosConfig.h"
+
+#include "MechanicsIOTest.hpp"
+#include "MechanicsIO.hpp"
+#ifdef WITH_HDF5
+#include "MechanicsHdf5Writer.hpp"
+#include <hdf5.h>
+#endif
+
+#include "SiconosKernel.hpp"
+#include "Disk.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MechanicsIOTest);
+
+/* contact of a sphere of radius r with the plane z = 0 */
+class SphereGroundR : public NewtonEulerFrom3DLocalFrameR
+{
+  double _r;
+
+public:
+
+  SphereGroundR(double r): NewtonEulerFrom3DLocalFrameR(), _r(r) {};
+
+  void computeh(double time, BlockVector& q0, SiconosVector& y)
+  {
+    y.setValue(0, q0(2) - _r);
+    _Pc1->setValue(0, q0(0));
+    _Pc1->setValue(1, q0(1));
+    _Pc1->setValue(2, q0(2) - _r);
+    _Pc2->setValue(0, q0(0));
+    _Pc2->setValue(1, q0(1));
+    _Pc2->setValue(2, 0.);
+    _Nc->setValue(0, 0.);
+    _Nc->setValue(1, 0.);
+    _Nc->setValue(2, 1.);
+  }
+};
+
+void MechanicsIOTest::setUp()
+{
+  double r = 0.1;
+
+  model.reset(new Model(0, 1));
+
+  SP::SiconosVector q0(new SiconosVector(7));
+  SP::SiconosVector v0(new SiconosVector(6));
+  SP::SimpleMatrix inertia(new SimpleMatrix(3, 3));
+  inertia->eye();
+  *inertia *= 2. / 5 * r * r;
+  (*q0)(0) = 0.5;
+  (*q0)(2) = r + 0.01;
+  (*q0)(3) = 1.;
+  (*v0)(0) = 0.2;
+  (*v0)(2) = -1.;
+  SP::NewtonEulerDS s(new NewtonEulerDS(q0, v0, 1., inertia));
+  SP::SiconosVector weight(new SiconosVector(3));
+  (*weight)(2) = -9.81;
+  s->setFExtPtr(weight);
+  sphere = s;
+
+  SP::SiconosVector q(new SiconosVector(3));
+  SP::SiconosVector v(new SiconosVector(3));
+  (*q)(0) = 2.;
+  (*q)(1) = 1.;
+  (*v)(2) = 0.5;
+  disk.reset(new Disk(0.2, 1., q, v));
+
+  SP::NonSmoothDynamicalSystem nsds = model->nonSmoothDynamicalSystem();
+  nsds->insertDynamicalSystem(sphere);
+  nsds->insertDynamicalSystem(disk);
+
+  SP::NonSmoothLaw nslaw(new NewtonImpactFrictionNSL(0., 0., 0.3, 3));
+  SP::Interaction inter(new Interaction(3, nslaw,
+                                        SP::Relation(new SphereGroundR(r))));
+  nsds->link(inter, sphere);
+
+  SP::TimeDiscretisation td(new TimeDiscretisation(0., 5e-3));
+  simulation.reset(new TimeStepping(td,
+                                    SP::OneStepIntegrator(new MoreauJeanOSI(0.5)),
+                                    SP::OneStepNSProblem(new FrictionContact(3))));
+  model->setSimulation(simulation);
+  model->initialize();
+}
+
+void MechanicsIOTest::tearDown()
+{
+  simulation.reset();
+  model.reset();
+  sphere.reset();
+  disk.reset();
+}
+
+void MechanicsIOTest::runUntilContact()
+{
+  for (unsigned int k = 0; k < 10; ++k)
+  {
+    simulation->computeOneStep();
+    simulation->nextStep();
+  }
+  CPPUNIT_ASSERT(model->nonSmoothDynamicalSystem()->topology()->indexSet(1)->size() == 1);
+}
+
+void MechanicsIOTest::checkRows(const std::vector<double>& rows,
+                                const std::vector<double>& expected)
+{
+  CPPUNIT_ASSERT_EQUAL(expected.size(), rows.size());
+  for (unsigned int i = 0; i < rows.size(); ++i)
+  {
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], rows[i],
+                                 1e-14 * (1. + std::fabs(expected[i])));
+  }
+}
+
+/* the rows of appendPositions and appendVelocities: time, id, then
+ * the coordinates, completed with zeros for the disk */
+void MechanicsIOTest::t0()
+{
+  runUntilContact();
+
+  MechanicsIO io;
+  std::vector<double> positions, velocities;
+  positions.push_back(-1.);
+  CPPUNIT_ASSERT_EQUAL(2u, io.appendPositions(*model, 0.5, positions));
+  CPPUNIT_ASSERT_EQUAL(2u, io.appendPositions(*model, 0.75, positions));
+  CPPUNIT_ASSERT_EQUAL(2u, io.appendVelocities(*model, 0.5, velocities));
+
+  std::vector<double> expectedPositions(1, -1.), expectedVelocities;
+  double times[2] = { 0.5, 0.75 };
+  SP::DynamicalSystemsGraph dsg = model->nonSmoothDynamicalSystem()->topology()->dSG(0);
+  for (unsigned int t = 0; t < 2; ++t)
+  {
+    DynamicalSystemsGraph::VIterator vi, viend;
+    for (std11::tie(vi, viend) = dsg->vertices(); vi != viend; ++vi)
+    {
+      SP::DynamicalSystem ds = dsg->bundle(*vi);
+      const SiconosVector& q = (ds == sphere) ?
+        *std11::static_pointer_cast<NewtonEulerDS>(ds)->q() :
+        *std11::static_pointer_cast<LagrangianDS>(ds)->q();
+      const SiconosVector& v = (ds == sphere) ?
+        *std11::static_pointer_cast<NewtonEulerDS>(ds)->velocity() :
+        *std11::static_pointer_cast<LagrangianDS>(ds)->velocity();
+      expectedPositions.push_back(times[t]);
+      expectedPositions.push_back(ds->number() + 1);
+      for (unsigned int j = 0; j < 7; ++j)
+        expectedPositions.push_back(j < q.size() ? q(j) : 0.);
+      if (t == 0)
+      {
+        expectedVelocities.push_back(times[t]);
+        expectedVelocities.push_back(ds->number() + 1);
+        for (unsigned int j = 0; j < 6; ++j)
+          expectedVelocities.push_back(j < v.size() ? v(j) : 0.);
+      }
+    }
+  }
+  checkRows(positions, expectedPositions);
+  checkRows(velocities, expectedVelocities);
+}
+
+/* the relation of the contact is visited as a NewtonEulerR, which is
+ * not a contact relation for MechanicsIO: the interaction is skipped
+ * and leaves no row in the buffer */
+void MechanicsIOTest::t1()
+{
+  runUntilContact();
+
+  MechanicsIO io;
+  std::vector<double> rows(1, -1.);
+  CPPUNIT_ASSERT_EQUAL(0u, io.appendContactPoints(*model, 0.5, rows));
+  checkRows(rows, std::vector<double>(1, -1.));
+}
+
+#ifdef WITH_HDF5
+
+/* read the whole dataset data/name, with the given width */
+static std::vector<double> readDataset(const std::string& filename,
+                                       const char* name,
+                                       unsigned int width)
+{
+  hid_t file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  CPPUNIT_ASSERT(file >= 0);
+  hid_t dataset = H5Dopen2(file, (std::string("data/") + name).c_str(), H5P_DEFAULT);
+  CPPUNIT_ASSERT(dataset >= 0);
+  hid_t space = H5Dget_space(dataset);
+  hsize_t dims[2];
+  CPPUNIT_ASSERT_EQUAL(2, H5Sget_simple_extent_dims(space, dims, NULL));
+  CPPUNIT_ASSERT_EQUAL((hsize_t) width, dims[1]);
+  std::vector<double> rows(dims[0] * dims[1]);
+  if (!rows.empty())
+    CPPUNIT_ASSERT(H5Dread(dataset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL,
+                           H5P_DEFAULT, &rows[0]) >= 0);
+  H5Sclose(space);
+  H5Dclose(dataset);
+  H5Fclose(file);
+  return rows;
+}
+
+void MechanicsIOTest::writeAndRead(const std::string& filename,
+                                   bool background,
+                                   unsigned int nbSteps)
+{
+  std::vector<double> expected[3];
+  expected[0] = readDataset(filename, "dynamic", 9);
+  expected[1] = readDataset(filename, "velocities", 8);
+  expected[2] = readDataset(filename, "cf", 15);
+
+  {
+    // small chunks, the datasets are extended several times
+    MechanicsHdf5Writer writer(filename, background, 3);
+    MechanicsIO io;
+    for (unsigned int k = 0; k < nbSteps; ++k)
+    {
+      simulation->computeOneStep();
+      writer.outputDynamicObjects(*model);
+      writer.outputVelocities(*model);
+      writer.outputContactForces(*model);
+      io.appendPositions(*model, simulation->nextTime(), expected[0]);
+      io.appendVelocities(*model, simulation->nextTime(), expected[1]);
+      io.appendContactPoints(*model, simulation->nextTime(), expected[2]);
+      writer.flush();
+      simulation->nextStep();
+    }
+    // the remaining rows are written by the destructor
+  }
+
+  checkRows(readDataset(filename, "dynamic", 9), expected[0]);
+  checkRows(readDataset(filename, "velocities", 8), expected[1]);
+  checkRows(readDataset(filename, "cf", 15), expected[2]);
+}
+
+/* a new file, written by flush() */
+void MechanicsIOTest::t2()
+{
+  std::string filename = "MechanicsIOt2.hdf5";
+  std::remove(filename.c_str());
+  { MechanicsHdf5Writer writer(filename, false); }
+  writeAndRead(filename, false, 20);
+}
+
+/* the rows are appended to the datasets of an existing file, from the
+ * background thread if the HDF5 library is thread-safe */
+void MechanicsIOTest::t3()
+{
+  std::string filename = "MechanicsIOt3.hdf5";
+  std::remove(filename.c_str());
+  { MechanicsHdf5Writer writer(filename, true); }
+  writeAndRead(filename, true, 7);
+  writeAndRead(filename, true, 13);
+  CPPUNIT_ASSERT_EQUAL((size_t) 40 * 9, readDataset(filename, "dynamic", 9).size());
+}
+
+#endif
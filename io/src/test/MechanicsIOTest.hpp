@@ -0,0 +1,55 @@
+#ifndef MECHANICS_IO_TEST_HPP
+#define MECHANICS_IO_TEST_HPP
+
+#include "SiconosConfig.h"
+#include <cppunit/extensions/HelperMacros.h>
+#include <SiconosFwd.hpp>
+#include <string>
+#include <vector>
+
+class MechanicsIOTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE(MechanicsIOTest);
+
+  CPPUNIT_TEST(t0);
+  CPPUNIT_TEST(t1);
+
+#ifdef WITH_HDF5
+  CPPUNIT_TEST(t2);
+  CPPUNIT_TEST(t3);
+#endif
+
+  CPPUNIT_TEST_SUITE_END();
+
+  /* a sphere falling on the plane z = 0, and a disk without contact */
+  SP::Model model;
+  SP::TimeStepping simulation;
+  SP::DynamicalSystem sphere;
+  SP::DynamicalSystem disk;
+
+  /* run the simulation until the sphere is in contact */
+  void runUntilContact();
+
+  /* check the rows against the expected ones */
+  void checkRows(const std::vector<double>& rows,
+                 const std::vector<double>& expected);
+
+  void t0();
+  void t1();
+
+#ifdef WITH_HDF5
+  void t2();
+  void t3();
+
+  /* run nbSteps steps with a MechanicsHdf5Writer on filename and
+   * check the datasets of the file */
+  void writeAndRead(const std::string& filename, bool background,
+                    unsigned int nbSteps);
+#endif
+
+public:
+  void setUp();
+  void tearDown();
+};
+
+#endif
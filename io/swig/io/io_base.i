@@ -26,4 +26,11 @@
 %{
 #include <MechanicsIO.hpp>
 %}
+
+#ifdef WITH_HDF5
+%include <MechanicsHdf5Writer.hpp>
+%{
+#include <MechanicsHdf5Writer.hpp>
+%}
+#endif
 #endif
@@ -62,6 +62,11 @@ from siconos.kernel import \
 import siconos.kernel as Kernel
 from siconos.io.io_base import MechanicsIO
 
+try:
+    from siconos.io.io_base import MechanicsHdf5Writer
+except ImportError:
+    MechanicsHdf5Writer = None
+
 import siconos.numerics as Numerics
 
 from scipy import constants
@@ -448,11 +453,17 @@ class Hdf5():
          px, py, pz : components of the translation (float)
          ow, ox, oy oz : components of an unit quaternion (float)
 
+       With native_output=True, the dynamic, velocities and cf datasets
+       are written by a MechanicsHdf5Writer in a companion file
+       (<io_filename>_output.hdf5), and are reached from io_filename
+       through external links.
+
     """
 
     def __init__(self, io_filename=None, mode='w',
                  broadphase=None, osi=None, shape_filename=None,
-                 set_external_forces=None, gravity_scale=None, collision_margin=None):
+                 set_external_forces=None, gravity_scale=None, collision_margin=None,
+                 native_output=False):
 
         if io_filename is None:
             self._io_filename = '{0}.hdf5'.format(
@@ -488,6 +499,9 @@ class Hdf5():
         self._collision_margin = collision_margin
         self._output_frequency = 1
         self._keep = []
+        self._native_output = native_output
+        self._native_filename = None
+        self._writer = None
 
         #print('collision_margin in __init__', collision_margin)
         #print('self._collision_margin in __init__', self._collision_margin)
@@ -506,9 +520,15 @@ class Hdf5():
         self._ref = group(self._data, 'ref')
         self._joints = group(self._data, 'joints')
         self._static_data = data(self._data, 'static', 9)
-        self._velocities_data = data(self._data, 'velocities', 8)
-        self._dynamic_data = data(self._data, 'dynamic', 9)
-        self._cf_data = data(self._data, 'cf', 15)
+        if self._native_output and self.setup_native_output():
+            self._velocities_data = self.native_data('velocities')
+            self._dynamic_data = self.native_data('dynamic')
+            self._cf_data = self.native_data('cf')
+        else:
+            self._native_output = False
+            self._velocities_data = data(self._data, 'velocities', 8)
+            self._dynamic_data = data(self._data, 'dynamic', 9)
+            self._cf_data = data(self._data, 'cf', 15)
         self._solv_data = data(self._data, 'solv', 4)
         self._input = group(self._data, 'input')
         self._nslaws = group(self._data, 'nslaws')
@@ -527,8 +547,60 @@ class Hdf5():
         return self
 
     def __exit__(self, type_, value, traceback):
+        if self._writer is not None:
+            self._writer.close()
+            self._writer = None
         self._out.close()
 
+    def setup_native_output(self):
+        """
+        Link the dynamic, velocities and cf datasets to the companion
+        file written by MechanicsHdf5Writer. Returns False if the
+        native writer is not available or if the datasets are already
+        stored in the main file.
+        """
+        if MechanicsHdf5Writer is None:
+            print('MechanicsHdf5Writer not available, native_output ignored')
+            return False
+
+        names = ['dynamic', 'velocities', 'cf']
+        links = [self._data.get(name, getlink=True) for name in names]
+        if any(link is not None and not isinstance(link, h5py.ExternalLink)
+               for link in links):
+            print('datasets already in {0}, native_output ignored'.format(
+                self._io_filename))
+            return False
+
+        self._native_filename = '{0}_output.hdf5'.format(
+            os.path.splitext(self._io_filename)[0])
+        for name, link in zip(names, links):
+            if link is None:
+                self._data[name] = h5py.ExternalLink(
+                    os.path.basename(self._native_filename), '/data/' + name)
+        return True
+
+    def native_data(self, name):
+        """
+        The dataset written by MechanicsHdf5Writer, None if it has not
+        been written yet.
+        """
+        try:
+            return self._data[name]
+        except KeyError:
+            return None
+
+    def writer(self):
+        """
+        The MechanicsHdf5Writer, created at the first output so that the
+        companion file may still be read before.
+        """
+        if self._writer is None:
+            self._dynamic_data = None
+            self._velocities_data = None
+            self._cf_data = None
+            self._writer = MechanicsHdf5Writer(self._native_filename)
+        return self._writer
+
     def apply_gravity(self, body):
         g = constants.g / self._gravity_scale
         weight = [0, 0, - body.scalarMass() * g]
@@ -884,6 +956,9 @@ class Hdf5():
         """
         Outputs translations and orientations of dynamic objects
         """
+        if self._native_output:
+            self.writer().outputDynamicObjects(self._broadphase.model())
+            return
 
         current_line = self._dynamic_data.shape[0]
 
@@ -904,6 +979,9 @@ class Hdf5():
         """
         Output velocities of dynamic objects
         """
+        if self._native_output:
+            self.writer().outputVelocities(self._broadphase.model())
+            return
 
         current_line = self._dynamic_data.shape[0]
 
@@ -924,6 +1002,10 @@ class Hdf5():
         """
         Outputs contact forces
         """
+        if self._native_output:
+            self.writer().outputContactForces(self._broadphase.model())
+            return
+
         if self._broadphase.model().nonSmoothDynamicalSystem().\
                 topology().indexSetsSize() > 1:
             time = self._broadphase.model().simulation().nextTime()
@@ -1435,6 +1517,9 @@ class Hdf5():
 
                 log(self.outputSolverInfos, with_timer)()
 
+                if self._writer is not None:
+                    log(self._writer.flush, with_timer)()
+
                 log(self._out.flush)()
 
             print('number of contact',self._broadphase.model().simulation().oneStepNSProblem(0).getSizeOutput()/3)
@@ -84,7 +84,7 @@ if(WITH_${COMPONENT}_TESTING)
   # Simulation tests
   BEGIN_TEST(src/simulationTools/test)
 
-  NEW_TEST(testSimulationTools ZOHTest.cpp OSNSPTest.cpp)
+  NEW_TEST(testSimulationTools ZOHTest.cpp OSNSPTest.cpp ActiveSetCacheTest.cpp ParallelLoopTest.cpp InteractionBlocksTest.cpp LsodarOSITest.cpp TopologyTest.cpp InteractionRecycleTest.cpp)
 
 
   END_TEST()
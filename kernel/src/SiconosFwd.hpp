@@ -54,6 +54,8 @@ DEFINE_SPTR(Simulation)
 DEFINE_SPTR(EventDriven)
 DEFINE_SPTR(TimeStepping)
 DEFINE_SPTR(EventsManager)
+DEFINE_SPTR(Profiler)
+DEFINE_SPTR(ActiveSetCache)
 
 DEFINE_SPTR(RelayNSL)
 DEFINE_SPTR(MixedComplementarityConditionNSL)
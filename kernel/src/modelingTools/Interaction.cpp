@@ -63,6 +63,36 @@ Interaction::Interaction(SP::NonSmoothLaw NSL,
   _sizeOfDS(0), _has2Bodies(false), _y(2),  _nslaw(NSL), _relation(rel)
 {}
 
+void Interaction::recycle(SP::NonSmoothLaw NSL,
+                          SP::Relation rel,
+                          unsigned int number)
+{
+  _initialized = false;
+  _number = number;
+  _interactionSize = NSL->size();
+  _sizeOfDS = 0;
+  _has2Bodies = false;
+  _nslaw = NSL;
+  _relation = rel;
+}
+
+/* a vector of a recycled interaction is reused if it has the right size */
+static void allocateVector(SP::SiconosVector& v, unsigned int size)
+{
+  if (v && v->size() == size)
+    v->zero();
+  else
+    v.reset(new SiconosVector(size));
+}
+
+static void allocateMemory(SP::SiconosMemory& m, unsigned int steps, unsigned int size)
+{
+  if (m && m->getMemorySize() == steps && m->vectorMemory()->size() == steps
+      && m->vectorMemory()->front() && m->vectorMemory()->front()->size() == size)
+    m->reset();
+  else
+    m.reset(new SiconosMemory(steps, size));
+}
 
 void Interaction::setDSLinkAndWorkspace(InteractionProperties& interProp,
                              DynamicalSystem& ds1, VectorOfVectors& workV1,
@@ -204,26 +234,23 @@ void Interaction::initializeMemory(bool computeResidu)
   // get the dimension of the non smooth law, ie the size of an Interaction blocks (one per relation)
   unsigned int nslawSize = nslaw()->size();
   // XXX hm hm -- xhub
+  // the vectors of a recycled interaction are reused, and zeroed
   if (computeResidu)
   {
-    _h_alpha.reset(new SiconosVector(nslawSize));
-    _residuY.reset(new SiconosVector(nslawSize));
+    allocateVector(_h_alpha, nslawSize);
+    allocateVector(_residuY, nslawSize);
   }
-  _yForNSsolver.reset(new SiconosVector(nslawSize));
+  allocateVector(_yForNSsolver, nslawSize);
 
   for (unsigned int i = _lowerLevelForOutput ;
        i < _upperLevelForOutput + 1 ;
        i++)
   {
-    _y[i].reset(new SiconosVector(nslawSize));
-    _yOld[i].reset(new SiconosVector(nslawSize));
-    _y_k[i].reset(new SiconosVector(nslawSize));
+    allocateVector(_y[i], nslawSize);
+    allocateVector(_yOld[i], nslawSize);
+    allocateVector(_y_k[i], nslawSize);
     assert(_steps > 0);
-    _yMemory[i].reset(new SiconosMemory(_steps, nslawSize));
-
-    _y[i]->zero();
-    _yOld[i]->zero();
-    _y_k[i]->zero();
+    allocateMemory(_yMemory[i], _steps, nslawSize);
   }
 
 
@@ -232,10 +259,9 @@ void Interaction::initializeMemory(bool computeResidu)
        i++)
   {
     DEBUG_PRINTF("Interaction::initializeMemory(). _lambda[%i].reset()\n",i)
-    _lambda[i].reset(new SiconosVector(nslawSize));
-    _lambdaOld[i].reset(new SiconosVector(nslawSize));
-    _lambdaOld[i]->zero();
-    _lambdaMemory[i].reset(new SiconosMemory(_steps, nslawSize));
+    allocateVector(_lambda[i], nslawSize);
+    allocateVector(_lambdaOld[i], nslawSize);
+    allocateMemory(_lambdaMemory[i], _steps, nslawSize);
   }
 }
 void Interaction::resetAllLambda()
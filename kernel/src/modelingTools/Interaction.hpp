@@ -205,6 +205,17 @@ public:
    */
   ~Interaction() {};
 
+  /** prepare an Interaction removed from the topology to be inserted
+   *  again as a new one, with another NonSmoothLaw and Relation. The
+   *  vectors and memories of y and lambda are kept, and reused by
+   *  initialize() when their sizes still match.
+   *  \param NSL pointer to the NonSmoothLaw, the interaction size is
+   *         infered from the size of the NonSmoothLaw
+   *  \param rel a pointer to the Relation
+   *  \param number the number of this Interaction
+   */
+  void recycle(SP::NonSmoothLaw NSL, SP::Relation rel, unsigned int number);
+
   /** set the links to the DynamicalSystem(s) and allocate the workspace
    *  \param interProp the InteractionProperties of this Interaction
       \param ds1 first ds linked to this Interaction (i.e IG->vertex.source)
@@ -278,7 +289,7 @@ public:
   /** Get the lower level for output y.
       \return an unsigned int.
    */
-  inline unsigned int lowerLevelForOutput()
+  inline unsigned int lowerLevelForOutput() const
   {
     return _lowerLevelForOutput;
   };
@@ -286,7 +297,7 @@ public:
   /** Get the upper level for output y.
       \return an unsigned int.
    */
-  inline unsigned int  upperLevelForOutput()
+  inline unsigned int  upperLevelForOutput() const
   {
     return _upperLevelForOutput;
   };
@@ -311,7 +322,7 @@ public:
   /** Get the lower level for input Lambda.
       \return an unsigned int.
    */
-  inline unsigned int lowerLevelForInput()
+  inline unsigned int lowerLevelForInput() const
   {
     return _lowerLevelForInput ;
   };
@@ -319,7 +330,7 @@ public:
   /** Get the upper level for input Lambda.
       \return an unsigned int.
    */
-  inline unsigned int upperLevelForInput()
+  inline unsigned int upperLevelForInput() const
   {
     return _upperLevelForInput;
   };
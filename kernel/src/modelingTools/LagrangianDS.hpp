@@ -715,6 +715,14 @@ public:
 
   // --- PLUGINS RELATED FUNCTIONS ---
 
+  /** Get _pluginMass
+   * \return a SP::PluggedObject
+   */
+  inline SP::PluggedObject getPluginMass() const
+  {
+    return _pluginMass;
+  };
+
   /** allow to set a specified function to compute the mass
    *  \param pluginPath std::string : the complete path to the plugin
    *  \param functionName std::string : the name of the function to use in this plugin
@@ -167,20 +167,30 @@ void NewtonEulerFrom1DLocalFrameR::NIcomputeJachqTFromContacts(SP::SiconosVector
 
 void NewtonEulerFrom1DLocalFrameR::initComponents(Interaction& inter, VectorOfBlockVectors& DSlink, VectorOfVectors& workV, VectorOfSMatrices& workM)
 {
+  // _jachq is allocated by NewtonEulerR::initComponents, with one row
+  // per component of y. The matrices of a relation recycled by a new
+  // interaction are kept, unless the sizes have changed.
+  unsigned int qSize = 7 * (inter.getSizeOfDS() / 6);
+  if (_jachq && (_jachq->size(0) != inter.getSizeOfY() || _jachq->size(1) != qSize))
+    _jachq.reset();
   NewtonEulerR::initComponents(inter, DSlink, workV, workM);
   //proj_with_q  _jachqProj.reset(new SimpleMatrix(_jachq->size(0),_jachq->size(1)));
-  unsigned int qSize = 7 * (inter.getSizeOfDS() / 6);
-  _jachq.reset(new SimpleMatrix(1, qSize));
 
 
 
   /* VA 12/04/2016 All of what follows should be put in WorkM*/
-  _Mabs_C.reset(new SimpleMatrix(1, 3));
-  _MObjToAbs.reset(new SimpleMatrix(3, 3));
-  _AUX1.reset(new SimpleMatrix(3, 3));
-  _AUX2.reset(new SimpleMatrix(1, 3));
-  _NPG1.reset(new SimpleMatrix(3, 3));
-  _NPG2.reset(new SimpleMatrix(3, 3));
+  if (!_Mabs_C)
+    _Mabs_C.reset(new SimpleMatrix(1, 3));
+  if (!_MObjToAbs)
+    _MObjToAbs.reset(new SimpleMatrix(3, 3));
+  if (!_AUX1)
+    _AUX1.reset(new SimpleMatrix(3, 3));
+  if (!_AUX2)
+    _AUX2.reset(new SimpleMatrix(1, 3));
+  if (!_NPG1)
+    _NPG1.reset(new SimpleMatrix(3, 3));
+  if (!_NPG2)
+    _NPG2.reset(new SimpleMatrix(3, 3));
   //  _isContact=1;
 }
 
@@ -35,13 +35,14 @@ See devNotes.pdf for details. A detailed documentation is available in DevNotes.
 void NewtonEulerFrom3DLocalFrameR::initComponents(Interaction& inter, VectorOfBlockVectors& DSlink, VectorOfVectors& workV, VectorOfSMatrices& workM)
 {
   NewtonEulerFrom1DLocalFrameR::initComponents(inter, DSlink, workV, workM);
-  unsigned int qSize = 7 * (inter.getSizeOfDS() / 6);
   /*keep only the distance.*/
-  _jachq.reset(new SimpleMatrix(3, qSize));
+  if (_jachq->size(0) != 3)
+    _jachq.reset(new SimpleMatrix(3, 7 * (inter.getSizeOfDS() / 6)));
 
-
-  _Mabs_C.reset(new SimpleMatrix(3, 3));
-  _AUX2.reset(new SimpleMatrix(3, 3));
+  if (_Mabs_C->size(0) != 3)
+    _Mabs_C.reset(new SimpleMatrix(3, 3));
+  if (_AUX2->size(0) != 3)
+    _AUX2.reset(new SimpleMatrix(3, 3));
   //  _isContact=1;
 }
 void NewtonEulerFrom3DLocalFrameR::FC3DcomputeJachqTFromContacts(SP::SiconosVector q1)
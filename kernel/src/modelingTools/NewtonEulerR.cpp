@@ -65,7 +65,7 @@ void NewtonEulerR::initComponents(Interaction& inter, VectorOfBlockVectors& DSli
 
   DEBUG_EXPR(_jachq->display());
 
-  if (! _jachqT)
+  if (! _jachqT || _jachqT->size(0) != ySize || _jachqT->size(1) != xSize)
     _jachqT.reset(new SimpleMatrix(ySize, xSize));
 
   //_jachqT.reset(new SimpleMatrix(ySize, xSize));
@@ -100,7 +100,9 @@ void NewtonEulerR::initialize(Interaction& inter, VectorOfBlockVectors& DSlink,
  // Memory allocation for G[i], if required (depends on the chosen constructor).
   initComponents(inter, DSlink, workV, workM);
 
-  _contactForce.reset(new SiconosVector(DSlink[NewtonEulerR::p1]->size()));
+  // kept when the relation is recycled by a new interaction
+  if (!_contactForce || _contactForce->size() != DSlink[NewtonEulerR::p1]->size())
+    _contactForce.reset(new SiconosVector(DSlink[NewtonEulerR::p1]->size()));
   _contactForce->zero();
 }
 
@@ -0,0 +1,218 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "ActiveSetCache.hpp"
+#include "SimpleMatrix.hpp"
+#include "SiconosVector.hpp"
+#include "SiconosMatrixException.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+// #define DEBUG_MESSAGES
+#include "debug.h"
+
+/* false for nan and inf */
+static bool isFinite(double v)
+{
+  return std::abs(v) <= std::numeric_limits<double>::max();
+}
+
+ActiveSetCache::ActiveSetCache(unsigned int maxSize, double tolerance):
+  _maxSize(maxSize), _tolerance(tolerance),
+  _hits(0), _misses(0), _evictions(0), _invalidations(0)
+{
+}
+
+void ActiveSetCache::checkMatrix(const SiconosMatrix& M)
+{
+  unsigned int n = M.size(0);
+  bool same = _M && _M->size(0) == n && _M->size(1) == M.size(1);
+  if (same)
+  {
+    const double* a = _M->getArray();
+    const double* b = M.getArray();
+    same = std::equal(a, a + n * M.size(1), b);
+  }
+  if (!same)
+  {
+    DEBUG_PRINT("ActiveSetCache::checkMatrix: M has changed\n");
+    if (!_modes.empty())
+      _invalidations++;
+    _modes.clear();
+    if (_M && _M->size(0) == n && _M->size(1) == M.size(1))
+      *_M = M;
+    else
+      _M.reset(new SimpleMatrix(M));
+  }
+}
+
+bool ActiveSetCache::solveMode(Mode& mode, const SiconosMatrix& M,
+                               const SiconosVector& q,
+                               const std::vector<bool>& isComp)
+{
+  unsigned int n = q.size();
+  unsigned int k = mode.free.size();
+  double threshold = _tolerance * (1. + q.normInf());
+
+  if (!_zWork || _zWork->size() != n)
+  {
+    _zWork.reset(new SiconosVector(n));
+    _wWork.reset(new SiconosVector(n));
+  }
+  _zWork->zero();
+
+  if (k > 0)
+  {
+    if (!_x || _x->size() != k)
+      _x.reset(new SiconosVector(k));
+    for (unsigned int i = 0; i < k; ++i)
+      _x->setValue(i, -q.getValue(mode.free[i]));
+    mode.LU->PLUForwardBackwardInPlace(*_x);
+    for (unsigned int i = 0; i < k; ++i)
+    {
+      unsigned int row = mode.free[i];
+      double zi = _x->getValue(i);
+      if (!isFinite(zi) || (isComp[row] && zi < -threshold))
+        return false;
+      _zWork->setValue(row, zi);
+    }
+  }
+
+  // w = q + M z, it vanishes on the free rows by construction
+  *_wWork = q;
+  prod(M, *_zWork, *_wWork, false);
+  for (unsigned int i = 0; i < k; ++i)
+    _wWork->setValue(mode.free[i], 0.);
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    double wi = _wWork->getValue(i);
+    if (!isFinite(wi) || (!mode.activeSet[i] && wi < -threshold))
+      return false;
+  }
+  return true;
+}
+
+bool ActiveSetCache::solve(const SiconosMatrix& M, const SiconosVector& q,
+                           const std::vector<bool>& isComp,
+                           SiconosVector& z, SiconosVector& w)
+{
+  checkMatrix(M);
+  for (std::list<Mode>::iterator it = _modes.begin(); it != _modes.end(); ++it)
+  {
+    if (solveMode(*it, M, q, isComp))
+    {
+      DEBUG_PRINTF("ActiveSetCache::solve: hit, %lu free unknowns\n", it->free.size());
+      // the mode becomes the most recently used one
+      _modes.splice(_modes.begin(), _modes, it);
+      z = *_zWork;
+      w = *_wWork;
+      _hits++;
+      return true;
+    }
+  }
+  _misses++;
+  return false;
+}
+
+void ActiveSetCache::insert(const SiconosMatrix& M, const std::vector<bool>& isComp,
+                            const SiconosVector& z, const SiconosVector& w)
+{
+  if (_maxSize == 0)
+    return;
+  checkMatrix(M);
+
+  unsigned int n = z.size();
+  ActiveSet activeSet(n);
+  for (unsigned int i = 0; i < n; ++i)
+    activeSet[i] = !isComp[i] || z.getValue(i) > w.getValue(i);
+
+  for (std::list<Mode>::iterator it = _modes.begin(); it != _modes.end(); ++it)
+  {
+    if (it->activeSet == activeSet)
+    {
+      _modes.splice(_modes.begin(), _modes, it);
+      return;
+    }
+  }
+
+  Mode mode;
+  mode.activeSet = activeSet;
+  for (unsigned int i = 0; i < n; ++i)
+    if (activeSet[i])
+      mode.free.push_back(i);
+  unsigned int k = mode.free.size();
+  if (k > 0)
+  {
+    mode.LU.reset(new SimpleMatrix(k, k));
+    for (unsigned int j = 0; j < k; ++j)
+      for (unsigned int i = 0; i < k; ++i)
+        mode.LU->setValue(i, j, M.getValue(mode.free[i], mode.free[j]));
+    try
+    {
+      mode.LU->PLUFactorizationInPlace();
+    }
+    catch (SiconosMatrixException&)
+    {
+      DEBUG_PRINT("ActiveSetCache::insert: singular reduced matrix\n");
+      return;
+    }
+  }
+
+  _modes.push_front(mode);
+  if (_modes.size() > _maxSize)
+  {
+    _modes.pop_back();
+    _evictions++;
+  }
+}
+
+void ActiveSetCache::clear()
+{
+  _modes.clear();
+  _M.reset();
+}
+
+void ActiveSetCache::resetStatistics()
+{
+  _hits = 0;
+  _misses = 0;
+  _evictions = 0;
+  _invalidations = 0;
+}
+
+void ActiveSetCache::setMaxSize(unsigned int maxSize)
+{
+  _maxSize = maxSize;
+  while (_modes.size() > _maxSize)
+  {
+    _modes.pop_back();
+    _evictions++;
+  }
+}
+
+void ActiveSetCache::display() const
+{
+  std::cout << "======= ActiveSetCache: " << _modes.size() << " modes (max "
+            << _maxSize << ")" << std::endl;
+  std::cout << "hits: " << _hits << ", misses: " << _misses
+            << ", evictions: " << _evictions
+            << ", invalidations: " << _invalidations << std::endl;
+}
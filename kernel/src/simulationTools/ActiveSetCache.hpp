@@ -0,0 +1,220 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/*! \file ActiveSetCache.hpp
+  \brief Memoization of the active sets of a linear complementarity problem
+*/
+
+#ifndef ACTIVESETCACHE_HPP
+#define ACTIVESETCACHE_HPP
+
+#include "SiconosPointers.hpp"
+#include "SiconosFwd.hpp"
+
+#include <list>
+#include <vector>
+
+/** Memoization of the active sets (or modes) of a problem
+ *  \f$ w = q + M z\f$, \f$ 0 \leq z \perp w \geq 0 \f$, where some
+ *  components may be equalities (MLCP).
+ *
+ * The active set of a solution is the set of the free unknowns: the
+ * equality unknowns and the complementarity unknowns with
+ * \f$ z_i > w_i \f$. Given an active set F, the solution is the one of
+ * the reduced system \f$ M_{FF} z_F = - q_F \f$, \f$ z_i = 0 \f$ for
+ * i not in F, if it is feasible, that is if \f$ z_F \geq 0 \f$ and
+ * \f$ w_i = (q + M z)_i \geq 0 \f$ for i not in F.
+ *
+ * The cache keeps the LU factors of \f$ M_{FF} \f$ for the last active
+ * sets found by the numerics solver, the most recently used first, up
+ * to maxSize() of them. solve() tries them in this order: when the
+ * problem comes back to a known active set, as the switched circuits
+ * do, the solution costs a triangular solve and a feasibility check
+ * instead of a call to the numerics solver.
+ *
+ * The factors are only valid for a given M: the cache keeps a copy of
+ * M and is emptied when the matrix of the problem differs.
+ *
+ * Only dense matrices (storage 0 of OSNSMatrix) are handled.
+ */
+class ActiveSetCache
+{
+private:
+
+  /** for each unknown, true if it is free */
+  typedef std::vector<bool> ActiveSet;
+
+  /** a cached active set */
+  struct Mode
+  {
+    ActiveSet activeSet;
+    /** indices of the free unknowns */
+    std::vector<unsigned int> free;
+    /** LU factors of the reduced matrix */
+    SP::SimpleMatrix LU;
+  };
+
+  /** the cached modes, the most recently used first */
+  std::list<Mode> _modes;
+
+  /** the maximum number of modes */
+  unsigned int _maxSize;
+
+  /** relative tolerance of the feasibility check */
+  double _tolerance;
+
+  /** copy of the matrix the factors are computed from */
+  SP::SimpleMatrix _M;
+
+  /** work vectors */
+  SP::SiconosVector _x;
+  SP::SiconosVector _zWork;
+  SP::SiconosVector _wWork;
+
+  /** statistics */
+  unsigned long _hits;
+  unsigned long _misses;
+  unsigned long _evictions;
+  unsigned long _invalidations;
+
+  /** empty the cache if M is not the matrix of the modes
+   *  \param M the matrix of the problem
+   */
+  void checkMatrix(const SiconosMatrix& M);
+
+  /** solve the reduced system of a mode, results in _zWork, _wWork
+   *  \param mode the mode
+   *  \param M the matrix of the problem
+   *  \param q the vector of the problem
+   *  \param isComp for each unknown, true if it is a complementarity one
+   *  \return true if the solution is feasible
+   */
+  bool solveMode(Mode& mode, const SiconosMatrix& M, const SiconosVector& q,
+                 const std::vector<bool>& isComp);
+
+  /** Private copy constructor => no copy nor pass by value */
+  ActiveSetCache(const ActiveSetCache&);
+
+  /** Private assignment -> forbidden
+   * \return ActiveSetCache&
+   */
+  ActiveSetCache& operator=(const ActiveSetCache&);
+
+public:
+
+  /** constructor
+   *  \param maxSize the maximum number of cached modes
+   *  \param tolerance relative tolerance of the feasibility check
+   */
+  ActiveSetCache(unsigned int maxSize = 16, double tolerance = 1e-10);
+
+  /** destructor
+   */
+  ~ActiveSetCache() {};
+
+  /** try the cached modes, the most recently used first
+   *  \param M the matrix of the problem, dense
+   *  \param q the vector of the problem
+   *  \param isComp for each unknown, true if it is a complementarity one
+   *  \param[out] z the solution, unchanged if no mode fits
+   *  \param[out] w q + M z, unchanged if no mode fits
+   *  \return true if a cached mode gives a feasible solution (a hit)
+   */
+  bool solve(const SiconosMatrix& M, const SiconosVector& q,
+             const std::vector<bool>& isComp,
+             SiconosVector& z, SiconosVector& w);
+
+  /** add the mode of a solution computed by a solver, as the most
+   *  recently used one. The least recently used mode is dropped if the
+   *  cache is full. Nothing is added if the reduced matrix is singular.
+   *  \param M the matrix of the problem, dense
+   *  \param isComp for each unknown, true if it is a complementarity one
+   *  \param z the solution
+   *  \param w q + M z
+   */
+  void insert(const SiconosMatrix& M, const std::vector<bool>& isComp,
+              const SiconosVector& z, const SiconosVector& w);
+
+  /** remove all the modes, the statistics are kept */
+  void clear();
+
+  /** set the statistics to zero */
+  void resetStatistics();
+
+  /** \return the number of cached modes */
+  inline unsigned int size() const
+  {
+    return _modes.size();
+  }
+
+  /** \return the maximum number of cached modes */
+  inline unsigned int maxSize() const
+  {
+    return _maxSize;
+  }
+
+  /** set the maximum number of cached modes, the least recently used
+   *  ones are dropped if needed
+   *  \param maxSize the new maximum
+   */
+  void setMaxSize(unsigned int maxSize);
+
+  /** \return the relative tolerance of the feasibility check */
+  inline double tolerance() const
+  {
+    return _tolerance;
+  }
+
+  /** set the relative tolerance of the feasibility check: z_F and w
+   *  outside F must be greater than -tolerance * (1 + |q|_inf)
+   *  \param tolerance the new tolerance
+   */
+  inline void setTolerance(double tolerance)
+  {
+    _tolerance = tolerance;
+  }
+
+  /** \return the number of calls of solve() that found a mode */
+  inline unsigned long hits() const
+  {
+    return _hits;
+  }
+
+  /** \return the number of calls of solve() that did not find a mode */
+  inline unsigned long misses() const
+  {
+    return _misses;
+  }
+
+  /** \return the number of modes dropped because the cache was full */
+  inline unsigned long evictions() const
+  {
+    return _evictions;
+  }
+
+  /** \return the number of times the cache was emptied because M changed */
+  inline unsigned long invalidations() const
+  {
+    return _invalidations;
+  }
+
+  /** print the statistics to the screen */
+  void display() const;
+};
+
+#endif // ACTIVESETCACHE_HPP
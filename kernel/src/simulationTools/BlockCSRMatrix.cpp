@@ -28,6 +28,8 @@
 
 #include "Tools.hpp"
 
+#include <algorithm>
+
 // Default constructor: empty matrix
 BlockCSRMatrix::BlockCSRMatrix():
   _nr(0), 
@@ -36,7 +38,8 @@ BlockCSRMatrix::BlockCSRMatrix():
   _diagsize0(new IndexInt()),
   _diagsize1(new IndexInt()),
   rowPos(new IndexInt()),
-  colPos(new IndexInt())
+  colPos(new IndexInt()),
+  _indexSetStamp(0), _nbReusedBlocks(0)
 {}
 
 // Constructor with dimensions
@@ -49,11 +52,12 @@ BlockCSRMatrix::BlockCSRMatrix(unsigned int nRow):
   // (according to given nr) space in memory.  Thus a future resize
   // will not require memory allocation or copy.
   _blockCSR(new CompressedRowMat(_nr, _nr)),
-  _sparseBlockStructuredMatrix(new SparseBlockStructuredMatrix),
+  _sparseBlockStructuredMatrix(new SparseBlockStructuredMatrix()),
   _diagsize0(new IndexInt(_nr)),
   _diagsize1(new IndexInt(_nr)),
   rowPos(new IndexInt(_nr)),
-  colPos(new IndexInt(_nr))
+  colPos(new IndexInt(_nr)),
+  _indexSetStamp(0), _nbReusedBlocks(0)
 {}
 
 // Basic constructor
@@ -64,7 +68,8 @@ BlockCSRMatrix::BlockCSRMatrix(SP::InteractionsGraph indexSet):
   _diagsize0(new IndexInt(_nr)),
   _diagsize1(new IndexInt(_nr)),
   rowPos(new IndexInt(_nr)),
-  colPos(new IndexInt(_nr))
+  colPos(new IndexInt(_nr)),
+  _indexSetStamp(0), _nbReusedBlocks(0)
 {
   fill(indexSet);
 }
@@ -72,6 +77,17 @@ BlockCSRMatrix::BlockCSRMatrix(SP::InteractionsGraph indexSet):
 BlockCSRMatrix::~BlockCSRMatrix()
 {}
 
+/* set a block pointer in a ublas matrix with a known sparsity
+   pattern, returns true if the block was already in place */
+static bool setBlockInPlace(CompressedRowMat& m, unsigned int row, unsigned int col, double* block)
+{
+  double** entry = m.find_element(row, col);
+  if (entry && *entry == block)
+    return true;
+  m(row, col) = block;
+  return false;
+}
+
 // Fill the SparseMat
 void BlockCSRMatrix::fill(SP::InteractionsGraph indexSet)
 {
@@ -81,11 +97,16 @@ void BlockCSRMatrix::fill(SP::InteractionsGraph indexSet)
 
   assert(indexSet);
 
+  // the sparsity pattern is unchanged if no vertex or edge has been
+  // added or removed since the last call
+  bool samePattern = (indexSet == _indexSet &&
+                      indexSet->stamp() == _indexSetStamp &&
+                      indexSet->size() == _nr);
+
   // Number of blocks in a row = number of active constraints.
   _nr = indexSet->size();
-
-  // (re)allocate memory for ublas matrix
-  _blockCSR->resize(_nr, _nr, false);
+  _indexSet = indexSet;
+  _indexSetStamp = indexSet->stamp();
 
   _diagsize0->resize(_nr);
   _diagsize1->resize(_nr);
@@ -93,6 +114,9 @@ void BlockCSRMatrix::fill(SP::InteractionsGraph indexSet)
   // === Loop through "active" Interactions (ie present in
   // indexSets[level]) ===
 
+  unsigned int nbChangedBlocks = 0;
+  _entries.clear();
+  BlockEntry entry;
 
   int sizeV = 0;
 
@@ -110,8 +134,13 @@ void BlockCSRMatrix::fill(SP::InteractionsGraph indexSet)
     assert((*_diagsize0)[indexSet->index(*vi)] > 0);
     assert((*_diagsize1)[indexSet->index(*vi)] > 0);
 
-    (*_blockCSR)(indexSet->index(*vi), indexSet->index(*vi)) =
-      indexSet->properties(*vi).block->getArray();
+    entry.row = indexSet->index(*vi);
+    entry.col = entry.row;
+    entry.block = indexSet->properties(*vi).block->getArray();
+    if (samePattern)
+      nbChangedBlocks += !setBlockInPlace(*_blockCSR, entry.row, entry.col, entry.block);
+    else
+      _entries.push_back(entry);
   }
 
   InteractionsGraph::EIterator ei, eiend;
@@ -137,11 +166,47 @@ void BlockCSRMatrix::fill(SP::InteractionsGraph indexSet)
 
     assert(pos != col);
 
-    (*_blockCSR)(std::min(pos, col), std::max(pos, col)) =
-      indexSet->properties(*ei).upper_block->getArray();
+    BlockEntry upper, lower;
+    upper.row = std::min(pos, col);
+    upper.col = std::max(pos, col);
+    upper.block = indexSet->properties(*ei).upper_block->getArray();
+    lower.row = upper.col;
+    lower.col = upper.row;
+    lower.block = indexSet->properties(*ei).lower_block->getArray();
 
-    (*_blockCSR)(std::max(pos, col), std::min(pos, col)) =
-      indexSet->properties(*ei).lower_block->getArray();
+    if (samePattern)
+    {
+      nbChangedBlocks += !setBlockInPlace(*_blockCSR, upper.row, upper.col, upper.block);
+      nbChangedBlocks += !setBlockInPlace(*_blockCSR, lower.row, lower.col, lower.block);
+    }
+    else
+    {
+      _entries.push_back(upper);
+      _entries.push_back(lower);
+    }
+  }
+
+  if (samePattern)
+  {
+    _nbReusedBlocks = _blockCSR->nnz() - nbChangedBlocks;
+  }
+  else
+  {
+    // on the adjoint graph, two edges may link the same interactions:
+    // the duplicated positions hold the same blocks
+    std::sort(_entries.begin(), _entries.end());
+    _entries.erase(std::unique(_entries.begin(), _entries.end()), _entries.end());
+
+    // (re)allocate memory for ublas matrix, the blocks are inserted
+    // in row major order
+    _blockCSR->resize(_nr, _nr, false);
+    _blockCSR->reserve(_entries.size(), false);
+    for (std::vector<BlockEntry>::iterator it = _entries.begin();
+         it != _entries.end(); ++it)
+    {
+      _blockCSR->push_back(it->row, it->col, it->block);
+    }
+    _nbReusedBlocks = 0;
   }
 }
 
@@ -149,6 +214,9 @@ void BlockCSRMatrix::fillM(SP::InteractionsGraph indexSet)
 {
   assert(indexSet);
 
+  // the pattern does not come from the interaction blocks
+  _indexSet.reset();
+
   /* on adjoint graph a dynamical system may be on several edges */
   std::map<SP::DynamicalSystem, bool> involvedDS;
   InteractionsGraph::EIterator ei, eiend;
@@ -193,6 +261,8 @@ void BlockCSRMatrix::fillH(SP::InteractionsGraph indexSet)
 {
   assert(indexSet);
 
+  _indexSet.reset();
+
   /* on adjoint graph a dynamical system may be on several edges */
   std::map<SP::DynamicalSystem, unsigned int> involvedDS;
   InteractionsGraph::EIterator ei, eiend;
@@ -304,6 +374,21 @@ void BlockCSRMatrix::convert()
     _sparseBlockStructuredMatrix->block =  &((*_blockCSR).value_data()[0]);
   };
 
+  // blocks are owned by the interactions: no contiguous storage, but
+  // the fixed size fast paths of numerics apply when all the diagonal
+  // blocks have the same square size
+  _sparseBlockStructuredMatrix->blockstorage = NULL;
+  _sparseBlockStructuredMatrix->fixedblocksize = 0;
+  if (_nr > 0)
+  {
+    unsigned int size = (*_diagsize0)[0];
+    bool sameSize = true;
+    for (unsigned int i = 0; sameSize && i < _nr; ++i)
+      sameSize = ((*_diagsize0)[i] == (i + 1) * size && (*_diagsize1)[i] == (i + 1) * size);
+    if (sameSize)
+      _sparseBlockStructuredMatrix->fixedblocksize = size;
+  }
+
   //   // Loop through the non-null blocks
   //   for (SpMatIt1 i1 = _blockCSR->begin1(); i1 != _blockCSR->end1(); ++i1)
   //     {
@@ -128,6 +128,37 @@ private:
   /** List of non null blocks positions (in col) */
   SP::IndexInt colPos;
 
+  /** position and data of a non null block, used to fill _blockCSR
+      in row major order */
+  struct BlockEntry
+  {
+    unsigned int row;
+    unsigned int col;
+    double* block;
+    bool operator<(const BlockEntry& e) const
+    {
+      return row < e.row || (row == e.row && col < e.col);
+    };
+    bool operator==(const BlockEntry& e) const
+    {
+      return row == e.row && col == e.col;
+    };
+  };
+
+  /** work vector of the non null blocks, kept between two calls of fill */
+  std::vector<BlockEntry> _entries;
+
+  /** the index set used in the last call of fill and its stamp: if
+      the index set has not been modified since, the sparsity pattern
+      of _blockCSR is kept and only the block pointers are checked.
+      The index set is held, so that a new one cannot be allocated at
+      the same address with the same stamp. */
+  SP::InteractionsGraph _indexSet;
+  int _indexSetStamp;
+
+  /** number of non null blocks left unchanged by the last call of fill */
+  unsigned int _nbReusedBlocks;
+
   /** Private copy constructor => no copy nor pass by value */
   BlockCSRMatrix(const BlockCSRMatrix&);
 
@@ -169,6 +200,15 @@ public:
    */
   unsigned int getNbNonNullBlocks() const;
 
+  /** get the number of non-null blocks that were already in place
+   *  before the last call of fill(SP::InteractionsGraph)
+   * \return unsigned int
+   */
+  inline unsigned int getNbReusedBlocks() const
+  {
+    return _nbReusedBlocks;
+  };
+
   /** get the numerics-readable structure
    * \return SP::SparseBlockStructuredMatrix
    */
@@ -205,7 +245,9 @@ public:
     else return colPos;
   };
 
-  /** fill the current class using an index set
+  /** fill the current class using an index set. If the index set
+   *  has not been modified since the last call, the sparsity pattern
+   *  is kept and only the changed block pointers are set in place.
    *  \param indexSet set of the active constraints
    */
   void fill(SP::InteractionsGraph indexSet);
@@ -150,6 +150,9 @@ void EulerMoreauOSI::initW(double t, SP::DynamicalSystem ds, DynamicalSystemsGra
   }
   else RuntimeException::selfThrow("EulerMoreauOSI::initW - not yet implemented for Dynamical system type :" + dsType);
 
+  // a new W, see MoreauJeanOSI::initW
+  ++_dynamicalSystemsGraph->WStamp[dsv];
+
   // Remark: W is not LU-factorized nor inversed here.
   // Function PLUForwardBackward will do that if required.
 
@@ -222,13 +225,17 @@ void EulerMoreauOSI::computeW(double t, DynamicalSystem& ds, DynamicalSystemsGra
     d.computeJacobianfx(t);
     // Add -h*_theta*jacobianfx to W
     scal(-h * _theta, *d.jacobianfx(), W, false);
+    ++_dynamicalSystemsGraph->WStamp[dsv];
   }
   // 2 - First order linear systems
   else if (dsType == Type::FirstOrderLinearDS || dsType == Type::FirstOrderLinearTIDS)
   {
     FirstOrderLinearDS& d = static_cast<FirstOrderLinearDS&> (ds);
     if (dsType == Type::FirstOrderLinearDS)
+    {
       d.computeA(t);
+      ++_dynamicalSystemsGraph->WStamp[dsv];
+    }
 
     if (d.M())
       W = *d.M();
@@ -440,39 +440,8 @@ void EventDriven::computeJacobianfx(OneStepIntegrator& osi,
   lsodar.computeJacobianRhs(t, *_DSG0);
 
   // Save jacobianX values from dynamical system into current jacob
-  // (in-out parameter)
-
-  unsigned int i = 0;
-  unsigned pos = 0;
-  DynamicalSystemsGraph::VIterator dsi, dsend;
-  SP::DynamicalSystemsGraph osiDSGraph = lsodar.dynamicalSystemsGraph();
-  for (std11::tie(dsi, dsend) = osiDSGraph->vertices(); dsi != dsend; ++dsi)
-  {
-    if (!(lsodar.checkOSI(dsi))) continue;
-
-    DynamicalSystem& ds = *(osiDSGraph->bundle(*dsi));
-    Type::Siconos dsType = Type::value(ds);
-    if (dsType == Type::LagrangianDS || dsType == Type::LagrangianLinearTIDS)
-    {
-      LagrangianDS& lds = static_cast<LagrangianDS&>(ds);
-      BlockMatrix& jacotmp = *lds.jacobianRhsx();
-      for (unsigned int j = 0; j < lds.n(); ++j)
-      {
-        for (unsigned int k = 0; k < lds.dimension(); ++k)
-          jacob[i++] = jacotmp(k, j);
-      }
-    }
-    else if(dsType == Type::FirstOrderNonLinearDS || dsType == Type::FirstOrderLinearDS
-        || dsType == Type::FirstOrderLinearTIDS)
-    {
-      SimpleMatrix& jacotmp = static_cast<SimpleMatrix&>(*(ds.jacobianRhsx())); // Pointer link !
-      pos += jacotmp.copyData(&jacob[pos]);
-    }
-    else
-    {
-      RuntimeException::selfThrow("EventDriven::computeJacobianfx, type of DynamicalSystem not yet supported.");
-    }
-  }
+  // (in-out parameter), a full sizeOfX by sizeOfX matrix
+  lsodar.fillJacobian(jacob, 0, *sizeOfX);
 }
 
 unsigned int EventDriven::computeSizeOfg()
@@ -157,7 +157,12 @@ int FrictionContact::compute(double time)
   if (_sizeOutput != 0)
   {
     // Call Numerics Driver for FrictionContact
-    info = solve();
+    {
+      SICONOS_PROFILE(profiler(), "FrictionContact::solve");
+      info = solve();
+    }
+    SICONOS_PROFILE_COUNT(profiler(), "FrictionContact::iterations", numericsIterations());
+    SICONOS_PROFILE_COUNT(profiler(), "FrictionContact::failures", info != 0);
     postCompute();
   }
 
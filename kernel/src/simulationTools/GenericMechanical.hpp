@@ -82,6 +82,16 @@ public:
    */
   int compute(double time);
 
+  /** the diagonal blocks gather the description of the problem and
+   *  are computed sequentially
+   *  \param nthreads the number of threads
+   *  \return false
+   */
+  virtual bool initializeParallelInteractionBlocks(unsigned int nthreads)
+  {
+    return false;
+  }
+
   /** compute extra-diagonal interactionBlock-matrix
     *  \param ed an edge descriptor
     */
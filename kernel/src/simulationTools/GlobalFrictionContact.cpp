@@ -355,12 +355,17 @@ int GlobalFrictionContact::compute(double time)
     numerics_problem.numberOfContacts = _sizeOutput / _contactProblemDim;
     numerics_problem.mu = &(_mu->at(0));
     numerics_problem.dimension = 3;
-    info = (*_gfc_driver)(&numerics_problem,
-                           _z->getArray(),
-                           _w->getArray(),
-                           _globalVelocities->getArray(),
-                           &*_numerics_solver_options,
-                           &*_numerics_options);
+    {
+      SICONOS_PROFILE(profiler(), "GlobalFrictionContact::solve");
+      info = (*_gfc_driver)(&numerics_problem,
+                            _z->getArray(),
+                            _w->getArray(),
+                            _globalVelocities->getArray(),
+                            &*_numerics_solver_options,
+                            &*_numerics_options);
+    }
+    SICONOS_PROFILE_COUNT(profiler(), "GlobalFrictionContact::iterations", numericsIterations());
+    SICONOS_PROFILE_COUNT(profiler(), "GlobalFrictionContact::failures", info != 0);
     postCompute();
 
   }
@@ -234,16 +234,14 @@ void Hem5OSI::updateData()
 
 void Hem5OSI::fillqWork(integer* NQ, doublereal* q)
 {
-  unsigned int sizeQ = (unsigned int)(*NQ);
-  for (unsigned int i = 0; i < sizeQ ; ++i)
-    (*_qWork)(i) = q[i];
+  assert((unsigned int)(*NQ) == _qWork->size() && "Hem5OSI::fillqWork qWork and NQ have different sizes");
+  fillState(q, *_qWork);
 }
 
 void Hem5OSI::fillvWork(integer* NV, doublereal* v)
 {
-  unsigned int sizeV = (unsigned int)(*NV);
-  for (unsigned int i = 0; i < sizeV ; ++i)
-    (*_vWork)(i) = v[i];
+  assert((unsigned int)(*NV) == _vWork->size() && "Hem5OSI::fillvWork vWork and NV have different sizes");
+  fillState(v, *_vWork);
 }
 
 void Hem5OSI::computeRhs(double t)
@@ -340,8 +338,6 @@ void Hem5OSI::fprob(integer* IFCN,
           Type::value(*ds) == Type::LagrangianLinearTIDS)
       {
         LagrangianDS& lds = *std11::static_pointer_cast<LagrangianDS>(ds);
-        fillqWork(NQ,q);
-        fillvWork(NV,v);
         lds.computeForces((double)*time);
       }
       else if (Type::value(*ds) == Type::NewtonEulerDS)
@@ -656,10 +652,13 @@ void Hem5OSI::integrate(double& tinit, double& tend, double& tout, int& idid)
   rtol[0] = HEM5_RTOL_DEFAULT ; // rtol
   atol[0] = HEM5_ATOL_DEFAULT ;  // atol
 
-  *_qtmp = *_qWork; // Copy into a continuous memory chuck
-  *_vtmp = *_vWork; // Copy into a continuous memory chuck
+  // HEM5 calls FPROB with its stage values, so that it can not work on
+  // the state of the dynamical systems: q, v and a are copied into
+  // continuous memory chunks
+  *_qtmp = *_qWork;
+  *_vtmp = *_vWork;
   //*_utmp = *_uWork; // Copy into a continuous memory chuck
-  *_atmp = *_aWork; // Copy into a continuous memory chuck
+  *_atmp = *_aWork;
 
   DEBUG_EXPR(_qtmp->display(););
   DEBUG_EXPR(_vtmp->display(););
@@ -62,21 +62,33 @@ int LCP::compute(double time)
     _numerics_problem->q = _q->getArray();
     _numerics_problem->size = _sizeOutput;
 
-    //const char * name = &*_numerics_solver_options->solverName;
-    if (_numerics_solver_options->solverId == SICONOS_LCP_ENUM)
+    // A known active set gives the solution without the solver
+    if (!solveWithActiveSetCache())
     {
-      lcp_enum_init(&*_numerics_problem, &*_numerics_solver_options, 1);
+      //const char * name = &*_numerics_solver_options->solverName;
+      if (_numerics_solver_options->solverId == SICONOS_LCP_ENUM)
+      {
+        lcp_enum_init(&*_numerics_problem, &*_numerics_solver_options, 1);
 
 
-    }
-    info = linearComplementarity_driver(&*_numerics_problem, _z->getArray() , _w->getArray() ,
-                                        &*_numerics_solver_options, &*_numerics_options);
+      }
+      {
+        SICONOS_PROFILE(profiler(), "LCP::solve");
+        info = linearComplementarity_driver(&*_numerics_problem, _z->getArray() , _w->getArray() ,
+                                            &*_numerics_solver_options, &*_numerics_options);
+      }
+      SICONOS_PROFILE_COUNT(profiler(), "LCP::iterations", numericsIterations());
+      SICONOS_PROFILE_COUNT(profiler(), "LCP::failures", info != 0);
+
+      if (_numerics_solver_options->solverId == SICONOS_LCP_ENUM)
+      {
+        lcp_enum_reset(&*_numerics_problem, &*_numerics_solver_options, 1);
 
-    if (_numerics_solver_options->solverId == SICONOS_LCP_ENUM)
-    {
-      lcp_enum_reset(&*_numerics_problem, &*_numerics_solver_options, 1);
 
+      }
 
+      if (!info)
+        updateActiveSetCache();
     }
 
     // --- Recovering of the desired variables from LCP output ---
@@ -37,20 +37,27 @@
 #include "LagrangianLinearTIDS.hpp"
 #include "NewtonEulerDS.hpp"
 #include "OSNSMatrix.hpp"
+#include "ActiveSetCache.hpp"
 
 #include "Tools.hpp"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace RELATION;
 // #define DEBUG_STDOUT
 // #define DEBUG_MESSAGES
 #include "debug.h"
 
-LinearOSNS::LinearOSNS(): OneStepNSProblem(), _MStorageType(0), _keepLambdaAndYState(true)
+LinearOSNS::LinearOSNS(): OneStepNSProblem(), _MStorageType(0), _keepLambdaAndYState(true),
+  _leftInteractionBlock(1), _rightInteractionBlock(1)
 {}
 
 // Constructor from a set of data
 LinearOSNS::LinearOSNS(const int numericsSolverId):
-  OneStepNSProblem(numericsSolverId), _MStorageType(0), _keepLambdaAndYState(true)
+  OneStepNSProblem(numericsSolverId), _MStorageType(0), _keepLambdaAndYState(true),
+  _leftInteractionBlock(1), _rightInteractionBlock(1)
 {}
 
 // Setters
@@ -150,6 +157,50 @@ void LinearOSNS::initialize(SP::Simulation sim)
 
 }
 
+/* resize a work matrix: memory is allocated at first use or when
+   the dimensions change, the content is not preserved */
+static void resizeWorkMatrix(SP::SiconosMatrix& m, unsigned int row, unsigned int col)
+{
+  if (!m)
+    m.reset(new SimpleMatrix(row, col));
+  else if (m->size(0) != row || m->size(1) != col)
+    m->resize(row, col, 0, 0, false);
+}
+
+bool LinearOSNS::initializeParallelInteractionBlocks(unsigned int nthreads)
+{
+  SP::InteractionsGraph indexSet = simulation()->indexSet(indexSetLevel());
+
+  InteractionsGraph::VIterator vi, viend;
+  for (std11::tie(vi, viend) = indexSet->vertices();
+       vi != viend; ++vi)
+  {
+    SP::OneStepIntegrator Osi = indexSet->properties(*vi).osi;
+    OSI::TYPES osiType = Osi->getType();
+    if (osiType != OSI::MOREAUJEANOSI &&
+        osiType != OSI::MOREAUDIRECTPROJECTIONOSI &&
+        osiType != OSI::SCHATZMANPAOLIOSI &&
+        osiType != OSI::EULERMOREAUOSI)
+      return false;
+
+    // the W matrices are shared by the blocks of a dynamical system:
+    // they must not be factorized concurrently
+    SP::SimpleMatrix W = getOSIMatrix(Osi, indexSet->properties(*vi).source);
+    if (!W->isPLUFactorized())
+      W->PLUFactorizationInPlace();
+    W = getOSIMatrix(Osi, indexSet->properties(*vi).target);
+    if (!W->isPLUFactorized())
+      W->PLUFactorizationInPlace();
+  }
+
+  if (_leftInteractionBlock.size() < nthreads)
+  {
+    _leftInteractionBlock.resize(nthreads);
+    _rightInteractionBlock.resize(nthreads);
+  }
+  return true;
+}
+
 void LinearOSNS::computeDiagonalInteractionBlock(const InteractionsGraph::VDescriptor& vd)
 {
   DEBUG_PRINT("LinearOSNS::computeDiagonalInteractionBlock(const InteractionsGraph::VDescriptor& vd)\n");
@@ -165,6 +216,12 @@ void LinearOSNS::computeDiagonalInteractionBlock(const InteractionsGraph::VDescr
 
   // Get dimension of the NonSmoothLaw (ie dim of the interactionBlock)
   SP::InteractionsGraph indexSet = simulation()->indexSet(indexSetLevel());
+
+  // the block is kept from the previous step, see
+  // OneStepNSProblem::updateInteractionBlocks
+  if (_reusedInteractionBlocks.count(indexSet->properties(vd).block))
+    return;
+
   SP::Interaction inter = indexSet->bundle(vd);
   // Get osi property from interaction
   // We assume that all ds in vertex_inter have the same osi.
@@ -217,7 +274,12 @@ void LinearOSNS::computeDiagonalInteractionBlock(const InteractionsGraph::VDescr
   // Block to be set in OSNS Matrix, corresponding to
   // the current interaction
   SP::SiconosMatrix currentInteractionBlock = indexSet->properties(vd).block;
-  SP::SiconosMatrix leftInteractionBlock, rightInteractionBlock;
+  unsigned int thread = 0;
+#ifdef _OPENMP
+  thread = omp_get_thread_num();
+#endif
+  SP::SiconosMatrix& leftInteractionBlock = _leftInteractionBlock[thread];
+  SP::SiconosMatrix& rightInteractionBlock = _rightInteractionBlock[thread];
 
   RELATION::TYPES relationType;
   double h = simulation()->currentTimeStep();
@@ -244,14 +306,14 @@ void LinearOSNS::computeDiagonalInteractionBlock(const InteractionsGraph::VDescr
     unsigned int sizeDS = ds->dimension();
     // get _interactionBlocks corresponding to the current DS
     // These _interactionBlocks depends on the relation type.
-    leftInteractionBlock.reset(new SimpleMatrix(nslawSize, sizeDS));
+    resizeWorkMatrix(leftInteractionBlock, nslawSize, sizeDS);
     inter->getLeftInteractionBlockForDS(pos, leftInteractionBlock, workMInter);
     DEBUG_EXPR(leftInteractionBlock->display(););
     // Computing depends on relation type -> move this in Interaction method?
     if (relationType == FirstOrder)
     {
 
-      rightInteractionBlock.reset(new SimpleMatrix(sizeDS, nslawSize));
+      resizeWorkMatrix(rightInteractionBlock, sizeDS, nslawSize);
 
       inter->getRightInteractionBlockForDS(pos, rightInteractionBlock, workMInter);
 
@@ -320,8 +382,9 @@ void LinearOSNS::computeDiagonalInteractionBlock(const InteractionsGraph::VDescr
 
       // (inter1 == inter2)
       DEBUG_EXPR(leftInteractionBlock->display(););
-      SP::SiconosMatrix work(new SimpleMatrix(*leftInteractionBlock));
-      work->trans();
+      resizeWorkMatrix(rightInteractionBlock, sizeDS, nslawSize);
+      SP::SiconosMatrix work = rightInteractionBlock;
+      work->trans(*leftInteractionBlock);
       SP::SiconosMatrix centralInteractionBlock = getOSIMatrix(Osi, ds);
       DEBUG_EXPR(centralInteractionBlock->display(););
       DEBUG_EXPR_WE(std::cout <<  std::boolalpha << " centralInteractionBlock->isPLUFactorized() = "<< centralInteractionBlock->isPLUFactorized() << std::endl;);
@@ -413,7 +476,12 @@ void LinearOSNS::computeInteractionBlock(const InteractionsGraph::EDescriptor& e
     currentInteractionBlock = indexSet->properties(ed).lower_block;
   }
 
-  SP::SiconosMatrix leftInteractionBlock, rightInteractionBlock;
+  unsigned int thread = 0;
+#ifdef _OPENMP
+  thread = omp_get_thread_num();
+#endif
+  SP::SiconosMatrix& leftInteractionBlock = _leftInteractionBlock[thread];
+  SP::SiconosMatrix& rightInteractionBlock = _rightInteractionBlock[thread];
 
   RELATION::TYPES relationType1, relationType2;
   double h = simulation()->currentTimeStep();
@@ -438,14 +506,14 @@ void LinearOSNS::computeInteractionBlock(const InteractionsGraph::EDescriptor& e
 
   // get _interactionBlocks corresponding to the current DS
   // These _interactionBlocks depends on the relation type.
-  leftInteractionBlock.reset(new SimpleMatrix(nslawSize1, sizeDS));
+  resizeWorkMatrix(leftInteractionBlock, nslawSize1, sizeDS);
   inter1->getLeftInteractionBlockForDS(pos1, leftInteractionBlock, workMInter1);
 
   // Computing depends on relation type -> move this in Interaction method?
   if (relationType1 == FirstOrder && relationType2 == FirstOrder)
   {
 
-    rightInteractionBlock.reset(new SimpleMatrix(sizeDS, nslawSize2));
+    resizeWorkMatrix(rightInteractionBlock, sizeDS, nslawSize2);
 
     inter2->getRightInteractionBlockForDS(pos2, rightInteractionBlock, workMInter2);
     // centralInteractionBlock contains a lu-factorized matrix and we solve
@@ -512,7 +580,7 @@ void LinearOSNS::computeInteractionBlock(const InteractionsGraph::EDescriptor& e
     }
 
     // inter1 != inter2
-    rightInteractionBlock.reset(new SimpleMatrix(nslawSize2, sizeDS));
+    resizeWorkMatrix(rightInteractionBlock, nslawSize2, sizeDS);
     inter2->getLeftInteractionBlockForDS(pos2, rightInteractionBlock, workMInter2);
 
     // Warning: we use getLeft for Right interactionBlock
@@ -592,6 +660,7 @@ void LinearOSNS::computeq(double time)
 
 bool LinearOSNS::preCompute(double time)
 {
+  SICONOS_PROFILE(profiler(), "LinearOSNS::preCompute");
   // This function is used to prepare data for the
   // LinearComplementarityProblem
 
@@ -687,8 +756,36 @@ bool LinearOSNS::preCompute(double time)
 
 }
 
+void LinearOSNS::complementarityUnknowns(std::vector<bool>& isComp) const
+{
+  isComp.assign(_sizeOutput, true);
+}
+
+bool LinearOSNS::solveWithActiveSetCache()
+{
+  if (!_activeSetCache || _MStorageType != 0)
+    return false;
+  SICONOS_PROFILE(profiler(), "LinearOSNS::activeSetCache");
+  std::vector<bool> isComp;
+  complementarityUnknowns(isComp);
+  bool hit = _activeSetCache->solve(*_M->defaultMatrix(), *_q, isComp, *_z, *_w);
+  SICONOS_PROFILE_COUNT(profiler(), "LinearOSNS::activeSetHits", hit);
+  return hit;
+}
+
+void LinearOSNS::updateActiveSetCache()
+{
+  if (!_activeSetCache || _MStorageType != 0)
+    return;
+  SICONOS_PROFILE(profiler(), "LinearOSNS::activeSetCache");
+  std::vector<bool> isComp;
+  complementarityUnknowns(isComp);
+  _activeSetCache->insert(*_M->defaultMatrix(), isComp, *_z, *_w);
+}
+
 void LinearOSNS::postCompute()
 {
+  SICONOS_PROFILE(profiler(), "LinearOSNS::postCompute");
   // This function is used to set y/lambda values using output from
   // lcp_driver (w,z).  Only Interactions (ie Interactions) of
   // indexSet(leveMin) are concerned.
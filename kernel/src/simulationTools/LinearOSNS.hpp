@@ -75,6 +75,16 @@ protected:
       size */
   bool _keepLambdaAndYState;
 
+  /** work matrices for the left and right parts of the interaction
+      blocks, one per thread, allocated at first use and resized only
+      when needed */
+  std::vector<SP::SiconosMatrix> _leftInteractionBlock;
+  std::vector<SP::SiconosMatrix> _rightInteractionBlock;
+
+  /** the active sets of the previous solutions, null if not used, see
+      setActiveSetCache() */
+  SP::ActiveSetCache _activeSetCache;
+
   /** nslaw effects : visitors experimentation
    */
   struct _TimeSteppingNSLEffect;
@@ -88,6 +98,21 @@ protected:
    */
   LinearOSNS() ;
 
+  /** for each unknown, tell if it is subject to a complementarity
+   *  condition (the default) or to an equality
+   *  \param[out] isComp the vector of size _sizeOutput to be filled
+   */
+  virtual void complementarityUnknowns(std::vector<bool>& isComp) const;
+
+  /** solve the problem with the active set cache, if any
+   *  \return true if a cached active set gives the solution, _z and _w
+   *  are then set
+   */
+  bool solveWithActiveSetCache();
+
+  /** add the active set of the solution _z, _w to the cache, if any */
+  void updateActiveSetCache();
+
 public:
 
   /** constructor from data
@@ -234,6 +259,15 @@ public:
   */
   virtual void initialize(SP::Simulation sim);
 
+  /** prepare the computation of the interaction blocks by several
+   *  threads: one pair of work matrices per thread, and the iteration
+   *  matrices of the integrators factorized beforehand
+   *  \param nthreads the number of threads
+   *  \return false if an integrator does not provide its iteration
+   *  matrix in place, the blocks are then computed sequentially
+   */
+  virtual bool initializeParallelInteractionBlocks(unsigned int nthreads);
+
   /** compute extra-diagonal interactionBlock-matrix
    *  \param ed an edge descriptor
    */
@@ -285,6 +319,25 @@ public:
     _keepLambdaAndYState = val ;
   }
 
+  /** set the cache of active sets used by compute(). Before calling
+   *  the numerics solver, the cached active sets are tried, and the
+   *  active set of a solution found by the solver is added to the
+   *  cache. It is only used with the dense storage of M.
+   *  \param cache the cache, null to stop using it
+   */
+  inline void setActiveSetCache(SP::ActiveSetCache cache)
+  {
+    _activeSetCache = cache;
+  }
+
+  /** get the cache of active sets
+   *  \return a SP::ActiveSetCache, null if not used
+   */
+  inline SP::ActiveSetCache activeSetCache() const
+  {
+    return _activeSetCache;
+  }
+
   /** visitors hook
    */
   ACCEPT_STD_VISITORS();
@@ -20,6 +20,7 @@
 #include "EventDriven.hpp"
 #include "LagrangianLinearTIDS.hpp"
 #include "BlockVector.hpp"
+#include "BlockMatrix.hpp"
 #include "NonSmoothDynamicalSystem.hpp"
 #include "Model.hpp"
 #include "Topology.hpp"
@@ -33,6 +34,10 @@
 #include "OneStepNSProblem.hpp"
 
 #include <odepack.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
 
 using namespace RELATION;
 
@@ -70,7 +75,7 @@ extern "C" void LsodarOSI_jacobianf_wrapper(integer* sizeOfX, doublereal* time,
 }
 
 LsodarOSI::LsodarOSI():
-  OneStepIntegrator(OSI::LSODAROSI)
+  OneStepIntegrator(OSI::LSODAROSI), _jacobianType(full_differences)
 {
   _intData.resize(9);
   for (int i = 0; i < 9; i++) _intData[i] = 0;
@@ -101,6 +106,13 @@ void LsodarOSI::setTol(integer newItol, SA::doublereal newRtol, SA::doublereal n
   atol = newAtol;
 }
 
+void LsodarOSI::setJacobianType(unsigned int type)
+{
+  if (type >= numberOfJacobianTypes)
+    RuntimeException::selfThrow("LsodarOSI::setJacobianType, unknown type of Jacobian.");
+  _jacobianType = type;
+}
+
 void LsodarOSI::setMinMaxStepSizes(doublereal minStep, doublereal maxStep)
 {
   _intData[5] = 1; // set IOPT = 1
@@ -161,7 +173,7 @@ void LsodarOSI::updateData()
 void LsodarOSI::fillXWork(integer* sizeOfX, doublereal* x)
 {
   assert((unsigned int)(*sizeOfX) == _xWork->size() && "LsodarOSI::fillXWork xWork and sizeOfX have different sizes");
-  (*_xWork) = x;
+  fillState(x, *_xWork);
 }
 
 void LsodarOSI::computeRhs(double t, DynamicalSystemsGraph& DSG0)
@@ -210,7 +222,200 @@ void LsodarOSI::g(integer* nEq, doublereal*  time, doublereal* x, integer* ng, d
 
 void LsodarOSI::jacobianfx(integer* sizeOfX, doublereal* time, doublereal* x, integer* ml, integer* mu,  doublereal* jacob, integer* nrowpd)
 {
-  std11::static_pointer_cast<EventDriven>(_simulation)->computeJacobianfx(*this, sizeOfX, time, x, jacob);
+  if (_jacobianType == banded_colored_differences)
+    computeJacobianByColoredDifferences(sizeOfX, time, x, *ml, *mu, jacob, *nrowpd);
+  else if (_jacobianType == banded_analytic)
+  {
+    // f has been called with the same x, see the documentation of DLSODAR
+    computeJacobianRhs(*time, *_dynamicalSystemsGraph);
+    fillJacobian(jacob, *mu, *nrowpd);
+  }
+  else
+    std11::static_pointer_cast<EventDriven>(_simulation)->computeJacobianfx(*this, sizeOfX, time, x, jacob);
+}
+
+void LsodarOSI::fillJacobian(doublereal* jacob, integer mu, integer nrowpd)
+{
+  bool banded = (_intData[8] == 4 || _intData[8] == 5);
+  unsigned int pos = 0;
+  DynamicalSystemsGraph::VIterator dsi, dsend;
+  for (std11::tie(dsi, dsend) = _dynamicalSystemsGraph->vertices(); dsi != dsend; ++dsi)
+  {
+    if (!checkOSI(dsi)) continue;
+    DynamicalSystem& ds = *_dynamicalSystemsGraph->bundle(*dsi);
+    Type::Siconos dsType = Type::value(ds);
+    SP::SiconosMatrix jacotmp;
+    // the state of a LagrangianDS is (q, velocity), its Jacobian a BlockMatrix
+    if (dsType == Type::LagrangianDS || dsType == Type::LagrangianLinearTIDS)
+      jacotmp = static_cast<LagrangianDS&>(ds).jacobianRhsx();
+    else if (dsType == Type::FirstOrderNonLinearDS || dsType == Type::FirstOrderLinearDS
+             || dsType == Type::FirstOrderLinearTIDS)
+      jacotmp = ds.jacobianRhsx();
+    else
+      RuntimeException::selfThrow("LsodarOSI::fillJacobian, type of DynamicalSystem not yet supported.");
+
+    unsigned int n = ds.n();
+    for (unsigned int j = 0; j < n; ++j)
+    {
+      for (unsigned int k = 0; k < n; ++k)
+      {
+        if (banded)
+          jacob[((integer)k - (integer)j + mu) + (pos + j) * nrowpd] = jacotmp->getValue(k, j);
+        else
+          jacob[(pos + k) + (pos + j) * nrowpd] = jacotmp->getValue(k, j);
+      }
+    }
+    pos += n;
+  }
+}
+
+void LsodarOSI::computeJacobianStructure(integer& ml, integer& mu)
+{
+  // the dynamical systems of the OSI, in the order of _xWork
+  std::map<DynamicalSystem*, unsigned int> blockNumber;
+  std::vector<DynamicalSystemsGraph::VDescriptor> blockVertex;
+  _blockPosition.clear();
+  _blockSize.clear();
+  unsigned int pos = 0;
+  DynamicalSystemsGraph::VIterator dsi, dsend;
+  for (std11::tie(dsi, dsend) = _dynamicalSystemsGraph->vertices(); dsi != dsend; ++dsi)
+  {
+    if (!checkOSI(dsi)) continue;
+    SP::DynamicalSystem ds = _dynamicalSystemsGraph->bundle(*dsi);
+    blockNumber[ds.get()] = _blockPosition.size();
+    blockVertex.push_back(*dsi);
+    _blockPosition.push_back(pos);
+    _blockSize.push_back(ds->n());
+    pos += ds->n();
+  }
+  unsigned int nBlocks = _blockPosition.size();
+
+  // two dynamical systems are coupled if an interaction links them
+  _blockCoupling.assign(nBlocks, std::vector<unsigned int>());
+  for (unsigned int b = 0; b < nBlocks; ++b)
+  {
+    _blockCoupling[b].push_back(b);
+    DynamicalSystemsGraph::AVIterator avi, aviend;
+    for (std11::tie(avi, aviend) = _dynamicalSystemsGraph->adjacent_vertices(blockVertex[b]);
+         avi != aviend; ++avi)
+    {
+      std::map<DynamicalSystem*, unsigned int>::iterator it =
+        blockNumber.find(_dynamicalSystemsGraph->bundle(*avi).get());
+      if (it != blockNumber.end())
+        _blockCoupling[b].push_back(it->second);
+    }
+    std::sort(_blockCoupling[b].begin(), _blockCoupling[b].end());
+    _blockCoupling[b].erase(std::unique(_blockCoupling[b].begin(), _blockCoupling[b].end()),
+                            _blockCoupling[b].end());
+  }
+
+  // half-bandwidths: the block (b, c) is in the band. The Jacobians of
+  // the dynamical systems do not contain the coupling through the
+  // interactions: with banded_analytic, only the diagonal blocks are
+  // filled, hence in the band.
+  ml = 0;
+  mu = 0;
+  for (unsigned int b = 0; b < nBlocks; ++b)
+  {
+    for (unsigned int i = 0; i < _blockCoupling[b].size(); ++i)
+    {
+      unsigned int c = _blockCoupling[b][i];
+      if (_jacobianType == banded_analytic && c != b)
+        continue;
+      ml = std::max(ml, (integer)(_blockPosition[b] + _blockSize[b]) - 1 - (integer)_blockPosition[c]);
+      mu = std::max(mu, (integer)(_blockPosition[c] + _blockSize[c]) - 1 - (integer)_blockPosition[b]);
+    }
+  }
+
+  _colors.clear();
+  _columnBlock.clear();
+  if (_jacobianType != banded_colored_differences)
+    return;
+
+  // Two columns can be perturbed together if they do not share a row,
+  // that is if their dynamical systems are neither the same, nor
+  // coupled, nor coupled to a common one. The dynamical systems are
+  // grouped with a greedy distance-2 coloring of the coupling graph,
+  // then the i-th columns of the systems of a group get the same color.
+  std::vector<int> group(nBlocks, -1);
+  std::vector<unsigned int> groupWidth;
+  for (unsigned int b = 0; b < nBlocks; ++b)
+  {
+    std::set<int> forbidden;
+    for (unsigned int i = 0; i < _blockCoupling[b].size(); ++i)
+    {
+      unsigned int c = _blockCoupling[b][i];
+      for (unsigned int k = 0; k < _blockCoupling[c].size(); ++k)
+        forbidden.insert(group[_blockCoupling[c][k]]);
+    }
+    int g = 0;
+    while (forbidden.count(g))
+      g++;
+    group[b] = g;
+    if ((unsigned int)g >= groupWidth.size())
+      groupWidth.resize(g + 1, 0);
+    groupWidth[g] = std::max(groupWidth[g], _blockSize[b]);
+  }
+  std::vector<unsigned int> groupFirstColor(groupWidth.size(), 0);
+  unsigned int nColors = 0;
+  for (unsigned int g = 0; g < groupWidth.size(); ++g)
+  {
+    groupFirstColor[g] = nColors;
+    nColors += groupWidth[g];
+  }
+  _colors.resize(nColors);
+  _columnBlock.resize(pos);
+  for (unsigned int b = 0; b < nBlocks; ++b)
+  {
+    for (unsigned int j = 0; j < _blockSize[b]; ++j)
+    {
+      _colors[groupFirstColor[group[b]] + j].push_back(_blockPosition[b] + j);
+      _columnBlock[_blockPosition[b] + j] = b;
+    }
+  }
+  DEBUG_PRINTF("LsodarOSI::computeJacobianStructure: %i columns, ml = %i, mu = %i, %i colors\n",
+               pos, ml, mu, nColors);
+}
+
+void LsodarOSI::computeJacobianByColoredDifferences(integer* sizeOfX, doublereal* time, doublereal* x,
+                                                    integer ml, integer mu, doublereal* jacob, integer nrowpd)
+{
+  unsigned int neq = *sizeOfX;
+  _f0.resize(neq);
+  _f1.resize(neq);
+  f(sizeOfX, time, x, &_f0[0]);
+
+  double sqrtPrec = std::sqrt(MACHINE_PREC);
+  std::vector<doublereal> h;
+  for (unsigned int c = 0; c < _colors.size(); ++c)
+  {
+    const std::vector<unsigned int>& columns = _colors[c];
+    h.resize(columns.size());
+    for (unsigned int k = 0; k < columns.size(); ++k)
+    {
+      unsigned int j = columns[k];
+      doublereal xj = x[j];
+      x[j] = xj + sqrtPrec * std::max(std::fabs(xj), 1.0);
+      h[k] = x[j] - xj; // exactly representable
+    }
+    f(sizeOfX, time, x, &_f1[0]);
+    for (unsigned int k = 0; k < columns.size(); ++k)
+    {
+      unsigned int j = columns[k];
+      x[j] -= h[k];
+      // the rows of column j are those of the systems coupled to its own
+      const std::vector<unsigned int>& coupling = _blockCoupling[_columnBlock[j]];
+      for (unsigned int b = 0; b < coupling.size(); ++b)
+      {
+        unsigned int first = _blockPosition[coupling[b]];
+        unsigned int last = first + _blockSize[coupling[b]];
+        for (unsigned int i = first; i < last; ++i)
+          jacob[((integer)i - (integer)j + mu) + j * nrowpd] = (_f1[i] - _f0[i]) / h[k];
+      }
+    }
+  }
+  // the state of the dynamical systems is the one of x
+  fillXWork(sizeOfX, x);
 }
 
 void LsodarOSI::initialize(Model& m)
@@ -240,7 +445,7 @@ void LsodarOSI::initialize(Model& m)
 
   // 1 - Neq; x vector size.
   _intData[0] = _xWork->size();
-  _xtmp.reset(new SiconosVector(_xWork->size()));
+  _xtmp = contiguousState(_xtmp, *_xWork);
 
   // 2 - Ng, number of constraints:
   _intData[1] = std11::static_pointer_cast<EventDriven>(_simulation)->computeSizeOfg();
@@ -264,18 +469,29 @@ void LsodarOSI::initialize(Model& m)
   //                 <0: error. See table below, in integrate function output message.
 
 
-  // 5 - lrw, size of rwork
-  _intData[6] = 22 + _intData[0] * std::max(16, (int)_intData[0] + 9) + 3 * _intData[1];
-
-  // 6 - liw, size of iwork
-  _intData[7] = 20 + _intData[0];
-
   // 7 - JT, Jacobian type indicator
-  _intData[8] = 2;   // jt, Jacobian type indicator.
   //           1 means a user-supplied full (NEQ by NEQ) Jacobian.
   //           2 means an internally generated (difference quotient) full Jacobian (using NEQ extra calls to f per df/dx value).
   //           4 means a user-supplied banded Jacobian.
   //           5 means an internally generated banded Jacobian (using ML+MU+1 extra calls to f per df/dx evaluation).
+  // The banded Jacobians are computed by LsodarOSI::jacobianfx.
+  integer ml = 0, mu = 0;
+  computeJacobianStructure(ml, mu);
+  if (_jacobianType == full_analytic)
+    _intData[8] = 1;
+  else if (_jacobianType == banded_analytic || _jacobianType == banded_colored_differences)
+    _intData[8] = 4;
+  else
+    _intData[8] = 2;
+
+  // 5 - lrw, size of rwork
+  if (_intData[8] == 4)
+    _intData[6] = 22 + _intData[0] * std::max(16, (int)(2 * ml + mu) + 10) + 3 * _intData[1];
+  else
+    _intData[6] = 22 + _intData[0] * std::max(16, (int)_intData[0] + 9) + 3 * _intData[1];
+
+  // 6 - liw, size of iwork
+  _intData[7] = 20 + _intData[0];
 
   // memory allocation for doublereal*, according to _intData values ...
   updateData();
@@ -283,6 +499,9 @@ void LsodarOSI::initialize(Model& m)
   // set the optional input flags of LSODAROSI to 0
   // LSODAROSI will take the default values
 
+  // Set the half-bandwidths of a banded Jacobian
+  iwork[0] = ml;
+  iwork[1] = mu;
   // Set the flag to generate extra printing at method switches.
   iwork[4] = 0;
   // Set the maximal number of steps for one call
@@ -338,7 +557,9 @@ void LsodarOSI::integrate(double& tinit, double& tend, double& tout, int& istate
 
   // === LSODAR CALL ===
 
-  *_xtmp = *_xWork;
+  // LSODAR works on the state of the dynamical system if it is
+  // contiguous, else on a copy
+  _xtmp = contiguousState(_xtmp, *_xWork);
   if (istate == 3)
   {
     istate = 1; // restart TEMPORARY
@@ -384,7 +605,7 @@ void LsodarOSI::integrate(double& tinit, double& tend, double& tout, int& istate
     RuntimeException::selfThrow("LsodarOSI, integration failed");
   }
 
-  *_xWork = *_xtmp;
+  restoreState(*_xtmp, *_xWork);
   istate = _intData[4];
   tout  = tinit_DR; // real ouput time
   tend  = tend_DR; // necessary for next start of DLSODAR
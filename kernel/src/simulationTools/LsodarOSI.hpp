@@ -40,10 +40,21 @@
  *  Except: \n
  *  - jt: Jacobian type indicator (1 means a user-supplied full Jacobian, 2 means an internally generated full Jacobian). \n
  *    Default = 2.
+ *  - the Jacobian type, see setJacobianType(): with a banded Jacobian, the band is
+ *    given by the coupling of the dynamical systems through the interactions
+ *    (the edges of the DynamicalSystemsGraph) or, for an analytic Jacobian, by
+ *    the dynamical systems alone, and the Jacobian may be computed
+ *    by finite differences, the columns that do not share a row being perturbed
+ *    together. \n
  *  - itol, rtol and atol \n
  *    ITOL   = an indicator for the type of error control. \n
  *    RTOL   = a relative error tolerance parameter, either a scalar or array of length NEQ. \n
  *    ATOL   = an absolute error tolerance parameter, either a scalar or an array of length NEQ.  Input only.
+ *
+ * LSODAR works directly on the state of the dynamical system only when there is
+ * a single one. With several dynamical systems, their states are copied into a
+ * contiguous vector before each call and back after it, since a SiconosVector
+ * can not be a view on a part of a larger array.
  */
 class LsodarOSI : public OneStepIntegrator
 {
@@ -70,7 +81,50 @@ private:
   /** temporary vector to save x values */
   SP::BlockVector _xWork;
 
+  /** the contiguous state given to LSODAR, the state of the dynamical
+   * system itself if there is only one vector in _xWork */
   SP::SiconosVector _xtmp;
+
+  /** the Jacobian type, see ListOfJacobianTypes */
+  unsigned int _jacobianType;
+
+  /** for each dynamical system, the position and the size of its state in _xWork */
+  std::vector<unsigned int> _blockPosition;
+  std::vector<unsigned int> _blockSize;
+
+  /** for each dynamical system, the dynamical systems coupled to it
+   * (itself included), sorted */
+  std::vector<std::vector<unsigned int> > _blockCoupling;
+
+  /** the columns perturbed together by the finite differences */
+  std::vector<std::vector<unsigned int> > _colors;
+
+  /** for each column, its dynamical system */
+  std::vector<unsigned int> _columnBlock;
+
+  /** work vectors of the finite differences */
+  std::vector<doublereal> _f0;
+  std::vector<doublereal> _f1;
+
+  /** compute _blockPosition, _blockSize, _blockCoupling, the colors
+   * of the columns and the half-bandwidths of the Jacobian
+   * \param[out] ml lower half-bandwidth
+   * \param[out] mu upper half-bandwidth
+   */
+  void computeJacobianStructure(integer& ml, integer& mu);
+
+  /** compute the Jacobian by finite differences, the columns of one
+   * color being perturbed together
+   * \param sizeOfX size of x
+   * \param time current time
+   * \param x current state, restored on output
+   * \param ml lower half-bandwidth
+   * \param mu upper half-bandwidth
+   * \param jacob the Jacobian, in band storage
+   * \param nrowpd leading dimension of jacob
+   */
+  void computeJacobianByColoredDifferences(integer* sizeOfX, doublereal* time, doublereal* x,
+                                           integer ml, integer mu, doublereal* jacob, integer nrowpd);
   /** nslaw effects
    */
   struct _NSLEffectOnFreeOutput;
@@ -82,6 +136,29 @@ public:
   /** Number of RHS evaluations for the problem so far. */
   static int count_NFE;
 
+  /** Jacobian of the vector field given to LSODAR
+   * - full_differences: full, generated by LSODAR with difference quotients (jt = 2, the default),
+   * - full_analytic: full, from the Jacobians of the dynamical systems (jt = 1),
+   * - banded_analytic: banded, from the Jacobians of the dynamical systems (jt = 4),
+   * - banded_colored_differences: banded, by finite differences, the columns that
+   *   do not share a row being perturbed together (jt = 4).
+   *
+   * The analytic Jacobians contain only the diagonal blocks of the
+   * dynamical systems, without the coupling through the interactions:
+   * with banded_analytic, the band is reduced to these blocks. With
+   * banded_colored_differences, the band contains the blocks of the
+   * systems linked by an interaction; the coupling of the systems in
+   * contact through the LCP at the acceleration level is longer ranged
+   * and is cut to this band. LSODAR only uses the Jacobian in the
+   * corrector iterations, so these approximations may slow down the
+   * convergence but do not change the error control.
+   */
+  enum ListOfJacobianTypes {full_differences,
+                            full_analytic,
+                            banded_analytic,
+                            banded_colored_differences,
+                            numberOfJacobianTypes };
+
   /** Default constructor */
   LsodarOSI();
 
@@ -180,6 +257,31 @@ public:
     _intData[8] = newJT;
   };
 
+  /** set the type of the Jacobian of the vector field. It must be
+   *  called before the initialization of the simulation, which
+   *  computes the band and the work memory of LSODAR.
+   *  \param type LsodarOSI::full_differences, LsodarOSI::full_analytic,
+   *  LsodarOSI::banded_analytic or LsodarOSI::banded_colored_differences
+   */
+  void setJacobianType(unsigned int type);
+
+  /** get the type of the Jacobian of the vector field
+   *  \return an unsigned int, see ListOfJacobianTypes
+   */
+  inline unsigned int jacobianType() const
+  {
+    return _jacobianType;
+  }
+
+  /** get the number of groups of columns of the finite differences,
+   *  ie the number of extra calls to f per Jacobian evaluation (plus one)
+   *  \return an unsigned int, 0 if the Jacobian type is not banded_colored_differences
+   */
+  inline unsigned int numberOfColors() const
+  {
+    return _colors.size();
+  }
+
   /** set itol, rtol and atol (tolerance parameters for lsodar)
    *  \param newItol itol value
    *  \param newRtol rtol value
@@ -215,7 +317,8 @@ public:
    */
   void updateData();
 
-  /** fill xWork with a doublereal
+  /** fill xWork with a doublereal, nothing is copied if array is the
+   *  memory of the dynamical system (see OneStepIntegrator::contiguousState)
    *  \param size size of x array
    *  \param array x array of double
    */
@@ -239,6 +342,16 @@ public:
 
   void jacobianfx(integer*, doublereal*, doublereal*, integer*, integer*,  doublereal*, integer*);
 
+  /** copy the Jacobians of the vector field of the dynamical systems,
+   *  computed by computeJacobianRhs, in the diagonal blocks of the
+   *  Jacobian of LSODAR, full or banded according to the jt parameter.
+   *  The other entries are left to zero.
+   *  \param jacob the Jacobian
+   *  \param mu upper half-bandwidth, for a banded Jacobian
+   *  \param nrowpd leading dimension of jacob
+   */
+  void fillJacobian(doublereal* jacob, integer mu, integer nrowpd);
+
   /** initialization of the integrator
    */
   void initialize(Model& m);
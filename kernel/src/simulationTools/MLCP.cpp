@@ -175,15 +175,25 @@ int MLCP::compute(double time)
     //mlcpDefaultSolver *pSolver = new mlcpDefaultSolver(m,n);
     DEBUG_EXPR(display(););
 
-    try
+    // A known active set gives the solution without the solver
+    if (!solveWithActiveSetCache())
     {
-      info = mlcp_driver(&_numerics_problem, _z->getArray(), _w->getArray(),
-                         &*_numerics_solver_options, &*_numerics_options);
-    }
-    catch (...)
-    {
-      std::cout << "exception catched" <<std::endl;
-      info = 1;
+      try
+      {
+        SICONOS_PROFILE(profiler(), "MLCP::solve");
+        info = mlcp_driver(&_numerics_problem, _z->getArray(), _w->getArray(),
+                           &*_numerics_solver_options, &*_numerics_options);
+      }
+      catch (...)
+      {
+        std::cout << "exception catched" <<std::endl;
+        info = 1;
+      }
+      SICONOS_PROFILE_COUNT(profiler(), "MLCP::iterations", numericsIterations());
+      SICONOS_PROFILE_COUNT(profiler(), "MLCP::failures", info != 0);
+
+      if (!info)
+        updateActiveSetCache();
     }
 
     // --- Recovering of the desired variables from MLCP output ---
@@ -203,6 +213,25 @@ int MLCP::compute(double time)
   return info;
 }
 
+void MLCP::complementarityUnknowns(std::vector<bool>& isComp) const
+{
+  isComp.assign(_sizeOutput, true);
+  if (!_numerics_problem.blocksRows)
+  {
+    // the _n equalities first
+    for (int i = 0; i < _n && i < (int)_sizeOutput; i++)
+      isComp[i] = false;
+    return;
+  }
+  for (int numBlock = 0; _numerics_problem.blocksRows[numBlock] < _n + _m; numBlock++)
+  {
+    if (!_numerics_problem.blocksIsComp[numBlock])
+      for (int i = _numerics_problem.blocksRows[numBlock];
+           i < _numerics_problem.blocksRows[numBlock + 1]; i++)
+        isComp[i] = false;
+  }
+}
+
 void MLCP::display() const
 {
   std::cout << "======= MLCP of size " << _sizeOutput << " with: " <<std::endl;
@@ -77,6 +77,11 @@ protected:
   /** The MLCP instance */
   MixedLinearComplementarityProblem _numerics_problem;
 
+  /** the equality unknowns are given by the blocks of the problem
+   *  \param[out] isComp the vector of size _sizeOutput to be filled
+   */
+  virtual void complementarityUnknowns(std::vector<bool>& isComp) const;
+
 public:
 
   /** constructor from data
@@ -121,6 +126,16 @@ public:
    */
   virtual void reset();
 
+  /** the diagonal blocks gather the description of the problem and
+   *  are computed sequentially
+   *  \param nthreads the number of threads
+   *  \return false
+   */
+  virtual bool initializeParallelInteractionBlocks(unsigned int nthreads)
+  {
+    return false;
+  }
+
   /** compute extra-diagonal interactionBlock-matrix
    *  \param ed an edge descriptor
    */
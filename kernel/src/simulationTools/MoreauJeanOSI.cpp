@@ -27,8 +27,10 @@
 #include "MultipleImpactNSL.hpp"
 #include "NewtonImpactFrictionNSL.hpp"
 #include "CxxStd.hpp"
+#include <boost/numeric/ublas/matrix_sparse.hpp>
 
 #include "TypeName.hpp"
+#include "ParallelLoopError.hpp"
 
 #include "OneStepNSProblem.hpp"
 #include "BlockVector.hpp"
@@ -40,12 +42,16 @@
 //#define DEBUG_WHERE_MESSAGES
 #include <debug.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 using namespace RELATION;
 
 // --- constructor from a set of data ---
 MoreauJeanOSI::MoreauJeanOSI(double theta, double gamma):
-  OneStepIntegrator(OSI::MOREAUJEANOSI), _useGammaForRelation(false),_explicitNewtonEulerDSOperators(false)
+  OneStepIntegrator(OSI::MOREAUJEANOSI), _useGammaForRelation(false),_explicitNewtonEulerDSOperators(false), _sparseW(false), _threadsNumber(1)
 {
   _theta = theta;
   if (!isnan(gamma))
@@ -60,6 +66,29 @@ MoreauJeanOSI::MoreauJeanOSI(double theta, double gamma):
   }
 }
 
+void MoreauJeanOSI::dynamicalSystemsVertices(std::vector<DynamicalSystemsGraph::VDescriptor>& dsvs)
+{
+  dsvs.clear();
+  DynamicalSystemsGraph::VIterator dsi, dsend;
+  for (std11::tie(dsi, dsend) = _dynamicalSystemsGraph->vertices(); dsi != dsend; ++dsi)
+  {
+    if (!checkOSI(dsi)) continue;
+    dsvs.push_back(*dsi);
+  }
+}
+
+int MoreauJeanOSI::dynamicalSystemsThreadsNumber(int nbDS) const
+{
+#ifdef _OPENMP
+  if (_threadsNumber != 1 && nbDS > 1)
+  {
+    int nthreads = (_threadsNumber > 0) ? _threadsNumber : omp_get_max_threads();
+    return std::min(nthreads, nbDS);
+  }
+#endif
+  return 1;
+}
+
 const SimpleMatrix MoreauJeanOSI::getW(SP::DynamicalSystem ds)
 {
   assert(ds &&
@@ -148,7 +177,10 @@ void MoreauJeanOSI::initW(double t, SP::DynamicalSystem ds, DynamicalSystemsGrap
   if (dsType == Type::LagrangianDS)
   {
     SP::LagrangianDS d = std11::static_pointer_cast<LagrangianDS> (ds);
-    _dynamicalSystemsGraph->properties(dsv).W.reset((new SimpleMatrix(*d->mass()))); //*W = *d->mass();
+    if (_sparseW && !d->boundaryConditions())
+      _dynamicalSystemsGraph->properties(dsv).W.reset(new SimpleMatrix(d->dimension(), d->dimension(), Siconos::SPARSE, d->dimension()));
+    else
+      _dynamicalSystemsGraph->properties(dsv).W.reset((new SimpleMatrix(*d->mass()))); //*W = *d->mass();
     // Compute the W matrix
     computeW(t,ds, *_dynamicalSystemsGraph->properties(dsv).W);
     // WBoundaryConditions initialization
@@ -159,7 +191,13 @@ void MoreauJeanOSI::initW(double t, SP::DynamicalSystem ds, DynamicalSystemsGrap
   else if (dsType == Type::LagrangianLinearTIDS)
   {
     SP::LagrangianLinearTIDS d = std11::static_pointer_cast<LagrangianLinearTIDS> (ds);
-    _dynamicalSystemsGraph->properties(dsv).W.reset(new SimpleMatrix(*d->mass())); //*W = *d->mass();
+    if (_sparseW && !d->boundaryConditions())
+    {
+      _dynamicalSystemsGraph->properties(dsv).W.reset(new SimpleMatrix(d->dimension(), d->dimension(), Siconos::SPARSE, d->dimension()));
+      *_dynamicalSystemsGraph->properties(dsv).W = *d->mass();
+    }
+    else
+      _dynamicalSystemsGraph->properties(dsv).W.reset(new SimpleMatrix(*d->mass())); //*W = *d->mass();
 
     SP::SiconosMatrix K = d->K();
     SP::SiconosMatrix C = d->C();
@@ -189,6 +227,10 @@ void MoreauJeanOSI::initW(double t, SP::DynamicalSystem ds, DynamicalSystemsGrap
   }
   else RuntimeException::selfThrow("MoreauJeanOSI::initW - not yet implemented for Dynamical system of type : " + Type::name(*ds));
 
+  // a new W: the blocks of the one step nonsmooth problems computed
+  // with the previous one are not valid any more
+  ++_dynamicalSystemsGraph->WStamp[dsv];
+
   // Remark: W is not LU-factorized nor inversed here.
   // Function PLUForwardBackward will do that if required.
   DEBUG_END("MoreauJeanOSI::initW\n");
@@ -305,6 +347,11 @@ void MoreauJeanOSI::computeWBoundaryConditions(SP::DynamicalSystem ds, SiconosMa
     RuntimeException::selfThrow("MoreauJeanOSI::computeWBoundaryConditions - not yet implemented for Dynamical system type : " +  Type::name(*ds));
 }
 
+/* true if the jacobian m is not allocated or has only zero entries */
+static bool isZero(SP::SiconosMatrix m)
+{
+  return !m || m->normInf() == 0.0;
+}
 
 void MoreauJeanOSI::computeW(double t, SP::DynamicalSystem ds, SiconosMatrix& W)
 {
@@ -319,7 +366,7 @@ void MoreauJeanOSI::computeW(double t, SP::DynamicalSystem ds, SiconosMatrix& W)
 
   if (dsType == Type::LagrangianLinearTIDS)
   {
-    // Nothing: W does not depend on time.
+    // Nothing: W does not depend on time, and its factorization is kept.
   }
   else if (dsType == Type::LagrangianDS)
   {
@@ -329,19 +376,41 @@ void MoreauJeanOSI::computeW(double t, SP::DynamicalSystem ds, SiconosMatrix& W)
     SP::SiconosMatrix K = d->jacobianqForces(); // jacobian according to q
     SP::SiconosMatrix C = d->jacobianqDotForces(); // jacobian according to velocity
 
+    // W = M is kept as long as the jacobians of the forces stay zero
+    bool changed = !isZero(K) || !isZero(C);
     d->computeMass();
-    W = *d->mass();
-
     if (C)
-    {
       d->computeJacobianqDotForces(t);
-      scal(-h * _theta, *C, W, false); // W -= h*_theta*C
-    }
+    if (K)
+      d->computeJacobianqForces(t);
+
+    // A sparse W keeps its values once factorized: the new W is
+    // assembled aside and the factorization is kept if M, K and C have
+    // not changed.
+    SP::SimpleMatrix Wnew;
+    if (W.num() == Siconos::SPARSE && W.isPLUFactorized())
+      Wnew.reset(new SimpleMatrix(W.size(0), W.size(1), Siconos::SPARSE, W.sparse()->nnz()));
+    SiconosMatrix& Wassembled = Wnew ? *Wnew : W;
+
+    Wassembled = *d->mass();
+
+    if (C)
+      scal(-h * _theta, *C, Wassembled, false); // W -= h*_theta*C
 
     if (K)
+      scal(-h * h * _theta * _theta, *K, Wassembled, false); //*W -= h*h*_theta*_theta**K;
+
+    changed = changed || !isZero(K) || !isZero(C)
+      || d->getPluginMass()->isPlugged();
+    if (!Wnew)
     {
-      d->computeJacobianqForces(t);
-      scal(-h * h * _theta * _theta, *K, W, false); //*W -= h*h*_theta*_theta**K;
+      if (changed)
+        ++_dynamicalSystemsGraph->WStamp[_dynamicalSystemsGraph->descriptor(ds)];
+    }
+    else if (norm_inf(*Wnew->sparse() - *W.sparse()) != 0.0)
+    {
+      W = *Wnew;
+      ++_dynamicalSystemsGraph->WStamp[_dynamicalSystemsGraph->descriptor(ds)];
     }
   }
   // === ===
@@ -353,6 +422,8 @@ void MoreauJeanOSI::computeW(double t, SP::DynamicalSystem ds, SiconosMatrix& W)
     SP::SiconosMatrix K = d->jacobianqForces(); // jacobian according to q
     SP::SiconosMatrix C = d->jacobianvForces(); // jacobian according to velocity
 
+    // W = M is kept as long as the jacobians of the forces stay zero
+    bool changed = !isZero(K) || !isZero(C);
     if (C)
     {
       d->computeJacobianvForces(t);
@@ -372,6 +443,8 @@ void MoreauJeanOSI::computeW(double t, SP::DynamicalSystem ds, SiconosMatrix& W)
     DEBUG_EXPR(W->display(););
     DEBUG_EXPR_WE(std::cout <<  std::boolalpha << "W->isPLUFactorized() = "<< W->isPLUFactorized() << std::endl;);
 
+    if (changed || !isZero(K) || !isZero(C))
+      ++_dynamicalSystemsGraph->WStamp[_dynamicalSystemsGraph->descriptor(ds)];
   }
   else RuntimeException::selfThrow("MoreauJeanOSI::computeW - not yet implemented for Dynamical system of type : " +Type::name(*ds));
   DEBUG_PRINT("MoreauJeanOSI::computeW ends\n");
@@ -424,417 +497,448 @@ double MoreauJeanOSI::computeResidu()
 
   double t = _simulation->nextTime(); // End of the time step
   double told = _simulation->startingTime(); // Beginning of the time step
-  double h = t - told; // time step length
 
   DEBUG_PRINTF("nextTime %f\n", t);
   DEBUG_PRINTF("startingTime %f\n", told);
-  DEBUG_PRINTF("time step size %f\n", h);
+  DEBUG_PRINTF("time step size %f\n", t - told);
 
 
   // Operators computed at told have index i, and (i+1) at t.
 
   // Iteration through the set of Dynamical Systems.
   //
-  SP::DynamicalSystem ds; // Current Dynamical System.
-  Type::Siconos dsType ; // Type of the current DS.
-
   double maxResidu = 0;
-  double normResidu = maxResidu;
 
-  DynamicalSystemsGraph::VIterator dsi, dsend;
-  for (std11::tie(dsi, dsend) = _dynamicalSystemsGraph->vertices(); dsi != dsend; ++dsi)
-  {
-    if (!checkOSI(dsi)) continue;
-    ds = _dynamicalSystemsGraph->bundle(*dsi);
+  std::vector<DynamicalSystemsGraph::VDescriptor> dsvs;
+  dynamicalSystemsVertices(dsvs);
+  int nbDS = dsvs.size();
+  int nthreads = dynamicalSystemsThreadsNumber(nbDS);
+  int i;
 
-    dsType = Type::value(*ds); // Its type
-    SP::SiconosVector residuFree = ds->workspace(DynamicalSystem::freeresidu);
-    // 3 - Lagrangian Non Linear Systems
-    if (dsType == Type::LagrangianDS)
+  if (nthreads == 1)
+  {
+    for (i = 0; i < nbDS; ++i)
     {
-      DEBUG_PRINT("MoreauJeanOSI::computeResidu(), dsType == Type::LagrangianDS\n");
-      // residu = M(q*)(v_k,i+1 - v_i) - h*theta*forces(t_i+1,v_k,i+1, q_k,i+1) - h*(1-theta)*forces(ti,vi,qi) - p_i+1
+      double normResidu = computeDSResidu(dsvs[i], t, told);
+      if (normResidu > maxResidu) maxResidu = normResidu;
+    }
+  }
+#ifdef _OPENMP
+  else
+  {
+    ParallelLoopError error;
+#pragma omp parallel for num_threads(nthreads) schedule(dynamic, 16) reduction(max:maxResidu)
+    for (i = 0; i < nbDS; ++i)
+    {
+      try
+      {
+        double normResidu = computeDSResidu(dsvs[i], t, told);
+        if (normResidu > maxResidu) maxResidu = normResidu;
+      }
+      catch (...)
+      {
+        error.catchException(i);
+      }
+    }
+    if (error.failed())
+    {
+      // the failed iteration is run again to throw its exception
+      computeDSResidu(dsvs[error.index()], t, told);
+      error.rethrow();
+    }
+  }
+#endif
+  DEBUG_END("MoreauJeanOSI::computeResidu()\n");
+  return maxResidu;
+}
 
-      // -- Convert the DS into a Lagrangian one.
-      SP::LagrangianDS d = std11::static_pointer_cast<LagrangianDS> (ds);
+double MoreauJeanOSI::computeDSResidu(DynamicalSystemsGraph::VDescriptor dsv, double t, double told)
+{
+  double h = t - told; // time step length
+  SP::DynamicalSystem ds = _dynamicalSystemsGraph->bundle(dsv);
+  Type::Siconos dsType = Type::value(*ds); // Its type
+  double normResidu = 0.0;
+  SP::SiconosVector residuFree = ds->workspace(DynamicalSystem::freeresidu);
+  // 3 - Lagrangian Non Linear Systems
+  if (dsType == Type::LagrangianDS)
+  {
+    DEBUG_PRINT("MoreauJeanOSI::computeResidu(), dsType == Type::LagrangianDS\n");
+    // residu = M(q*)(v_k,i+1 - v_i) - h*theta*forces(t_i+1,v_k,i+1, q_k,i+1) - h*(1-theta)*forces(ti,vi,qi) - p_i+1
 
-      // Get state i (previous time step) from Memories -> var. indexed with "Old"
-      SP::SiconosVector qold = d->qMemory()->getSiconosVector(0);
-      SP::SiconosVector vold = d->velocityMemory()->getSiconosVector(0);
-      SP::SiconosVector q = d->q();
+    // -- Convert the DS into a Lagrangian one.
+    SP::LagrangianDS d = std11::static_pointer_cast<LagrangianDS> (ds);
 
+    // Get state i (previous time step) from Memories -> var. indexed with "Old"
+    SP::SiconosVector qold = d->qMemory()->getSiconosVector(0);
+    SP::SiconosVector vold = d->velocityMemory()->getSiconosVector(0);
+    SP::SiconosVector q = d->q();
 
-      d->computeMass();
-      SP::SiconosMatrix M = d->mass();
-      SP::SiconosVector v = d->velocity(); // v = v_k,i+1
-      //residuFree->zero();
-      DEBUG_EXPR(residuFree->display());
 
-      DEBUG_EXPR(qold->display());
-      DEBUG_EXPR(vold->display());
-      DEBUG_EXPR(q->display());
-      DEBUG_EXPR(v->display());
+    d->computeMass();
+    SP::SiconosMatrix M = d->mass();
+    SP::SiconosVector v = d->velocity(); // v = v_k,i+1
+    //residuFree->zero();
+    DEBUG_EXPR(residuFree->display());
 
-      DEBUG_EXPR(M->display());
+    DEBUG_EXPR(qold->display());
+    DEBUG_EXPR(vold->display());
+    DEBUG_EXPR(q->display());
+    DEBUG_EXPR(v->display());
 
+    DEBUG_EXPR(M->display());
 
-      //    std::cout << "(*v-*vold)->norm2()" << (*v-*vold).norm2() << std::endl;
 
-      prod(*M, (*v - *vold), *residuFree); // residuFree = M(v - vold)
+    //    std::cout << "(*v-*vold)->norm2()" << (*v-*vold).norm2() << std::endl;
 
-      if (d->forces())
-      {
-        // Cheaper version: get forces(ti,vi,qi) from memory
-        SP::SiconosVector fold = d->forcesMemory()->getSiconosVector(0);
-        double coef = -h * (1 - _theta);
-        scal(coef, *fold, *residuFree, false);
-
-        // Expensive computes forces(ti,vi,qi)
-        // d->computeForces(told, qold, vold);
-        // double coef = -h * (1 - _theta);
-        // // residuFree += coef * fL_i
-        // scal(coef, *d->forces(), *residuFree, false);
-
-        // computes forces(ti+1, v_k,i+1, q_k,i+1) = forces(t,v,q)
-        d->computeForces(t,q,v);
-        coef = -h * _theta;
-        scal(coef, *d->forces(), *residuFree, false);
-
-        // or  forces(ti+1, v_k,i+\theta, q(v_k,i+\theta))
-        //SP::SiconosVector qbasedonv(new SiconosVector(*qold));
-        //*qbasedonv +=  h * ((1 - _theta)* *vold + _theta * *v);
-        //d->computeForces(t, qbasedonv, v);
-        //coef = -h * _theta;
-        // residuFree += coef * fL_k,i+1
-        //scal(coef, *d->forces(), *residuFree, false);
+    prod(*M, (*v - *vold), *residuFree); // residuFree = M(v - vold)
 
+    if (d->forces())
+    {
+      // Cheaper version: get forces(ti,vi,qi) from memory
+      SP::SiconosVector fold = d->forcesMemory()->getSiconosVector(0);
+      double coef = -h * (1 - _theta);
+      scal(coef, *fold, *residuFree, false);
+
+      // Expensive computes forces(ti,vi,qi)
+      // d->computeForces(told, qold, vold);
+      // double coef = -h * (1 - _theta);
+      // // residuFree += coef * fL_i
+      // scal(coef, *d->forces(), *residuFree, false);
+
+      // computes forces(ti+1, v_k,i+1, q_k,i+1) = forces(t,v,q)
+      d->computeForces(t,q,v);
+      coef = -h * _theta;
+      scal(coef, *d->forces(), *residuFree, false);
+
+      // or  forces(ti+1, v_k,i+\theta, q(v_k,i+\theta))
+      //SP::SiconosVector qbasedonv(new SiconosVector(*qold));
+      //*qbasedonv +=  h * ((1 - _theta)* *vold + _theta * *v);
+      //d->computeForces(t, qbasedonv, v);
+      //coef = -h * _theta;
+      // residuFree += coef * fL_k,i+1
+      //scal(coef, *d->forces(), *residuFree, false);
 
-      }
 
-      if (d->boundaryConditions())
-      {
-        d->boundaryConditions()->computePrescribedVelocity(t);
+    }
 
-        unsigned int columnindex = 0;
-        SP::SimpleMatrix WBoundaryConditions = _dynamicalSystemsGraph->properties(*dsi).WBoundaryConditions ;
-        SP::SiconosVector columntmp(new SiconosVector(ds->dimension()));
+    if (d->boundaryConditions())
+    {
+      d->boundaryConditions()->computePrescribedVelocity(t);
 
-        for (std::vector<unsigned int>::iterator  itindex = d->boundaryConditions()->velocityIndices()->begin() ;
-             itindex != d->boundaryConditions()->velocityIndices()->end();
-             ++itindex)
-        {
-          double DeltaPrescribedVelocity =
-            d->boundaryConditions()->prescribedVelocity()->getValue(columnindex)
-            - v->getValue(*itindex);
+      unsigned int columnindex = 0;
+      SP::SimpleMatrix WBoundaryConditions = _dynamicalSystemsGraph->properties(dsv).WBoundaryConditions ;
+      SP::SiconosVector columntmp(new SiconosVector(ds->dimension()));
 
-          WBoundaryConditions->getCol(columnindex, *columntmp);
-          *residuFree -= *columntmp * (DeltaPrescribedVelocity);
+      for (std::vector<unsigned int>::iterator  itindex = d->boundaryConditions()->velocityIndices()->begin() ;
+           itindex != d->boundaryConditions()->velocityIndices()->end();
+           ++itindex)
+      {
+        double DeltaPrescribedVelocity =
+          d->boundaryConditions()->prescribedVelocity()->getValue(columnindex)
+          - v->getValue(*itindex);
 
-          residuFree->setValue(*itindex, - columntmp->getValue(*itindex)   * (DeltaPrescribedVelocity));
+        WBoundaryConditions->getCol(columnindex, *columntmp);
+        *residuFree -= *columntmp * (DeltaPrescribedVelocity);
 
-          columnindex ++;
-        }
+        residuFree->setValue(*itindex, - columntmp->getValue(*itindex)   * (DeltaPrescribedVelocity));
+
+        columnindex ++;
       }
+    }
 
-      *(d->workspace(DynamicalSystem::free)) = *residuFree; // copy residuFree in Workfree
+    *(d->workspace(DynamicalSystem::free)) = *residuFree; // copy residuFree in Workfree
 
-      //       std::cout << "MoreauJeanOSI::ComputeResidu LagrangianDS residufree :"  << std::endl;
-      DEBUG_EXPR(residuFree->display());
+    //       std::cout << "MoreauJeanOSI::ComputeResidu LagrangianDS residufree :"  << std::endl;
+    DEBUG_EXPR(residuFree->display());
 
-      if (d->p(1))
-        *(d->workspace(DynamicalSystem::free)) -= *d->p(1); // Compute Residu in Workfree Notation !!
-                                                            // We use DynamicalSystem::free as tmp buffer
+    if (d->p(1))
+      *(d->workspace(DynamicalSystem::free)) -= *d->p(1); // Compute Residu in Workfree Notation !!
+                                                          // We use DynamicalSystem::free as tmp buffer
 
-      if (d->boundaryConditions())
-      {
-        unsigned int columnindex = 0;
-        SP::SimpleMatrix WBoundaryConditions = _dynamicalSystemsGraph->properties(*dsi).W ;
-        SP::SiconosVector columntmp(new SiconosVector(ds->dimension()));
+    if (d->boundaryConditions())
+    {
+      unsigned int columnindex = 0;
+      SP::SimpleMatrix WBoundaryConditions = _dynamicalSystemsGraph->properties(dsv).W ;
+      SP::SiconosVector columntmp(new SiconosVector(ds->dimension()));
 
-        for (std::vector<unsigned int>::iterator  itindex = d->boundaryConditions()->velocityIndices()->begin() ;
-             itindex != d->boundaryConditions()->velocityIndices()->end();
-             ++itindex)
-        {
-          double DeltaPrescribedVelocity =
-            d->boundaryConditions()->prescribedVelocity()->getValue(columnindex)
-            - v->getValue(*itindex);
+      for (std::vector<unsigned int>::iterator  itindex = d->boundaryConditions()->velocityIndices()->begin() ;
+           itindex != d->boundaryConditions()->velocityIndices()->end();
+           ++itindex)
+      {
+        double DeltaPrescribedVelocity =
+          d->boundaryConditions()->prescribedVelocity()->getValue(columnindex)
+          - v->getValue(*itindex);
 
-          WBoundaryConditions->getCol(columnindex, *columntmp);
+        WBoundaryConditions->getCol(columnindex, *columntmp);
 
-          d->workspace(DynamicalSystem::free)->setValue(*itindex, - columntmp->getValue(*itindex)   * (DeltaPrescribedVelocity));
+        d->workspace(DynamicalSystem::free)->setValue(*itindex, - columntmp->getValue(*itindex)   * (DeltaPrescribedVelocity));
 
-          columnindex ++;
-        }
+        columnindex ++;
       }
+    }
 
 
-      DEBUG_EXPR(d->workspace(DynamicalSystem::free)->display());
-      normResidu = d->workspace(DynamicalSystem::free)->norm2();
-      DEBUG_PRINTF("normResidu= %e\n", normResidu);
-    }
-    // 4 - Lagrangian Linear Systems
-    else if (dsType == Type::LagrangianLinearTIDS)
-    {
-      DEBUG_PRINT("MoreauJeanOSI::computeResidu(), dsType == Type::LagrangianLinearTIDS\n");
-      // ResiduFree = h*C*v_i + h*Kq_i +h*h*theta*Kv_i+hFext_theta     (1)
-      // This formulae is only valid for the first computation of the residual for v = v_i
-      // otherwise the complete formulae must be applied, that is
-      // ResiduFree = M(v - vold) + h*((1-theta)*(C v_i + K q_i) +theta * ( C*v + K(q_i+h(1-theta)v_i+h theta v)))
-      //                     +hFext_theta     (2)
-      // for v != vi, the formulae (1) is wrong.
-      // in the sequel, only the equation (1) is implemented
-
-      // -- Convert the DS into a Lagrangian one.
-      SP::LagrangianLinearTIDS d = std11::static_pointer_cast<LagrangianLinearTIDS> (ds);
+    DEBUG_EXPR(d->workspace(DynamicalSystem::free)->display());
+    normResidu = d->workspace(DynamicalSystem::free)->norm2();
+    DEBUG_PRINTF("normResidu= %e\n", normResidu);
+  }
+  // 4 - Lagrangian Linear Systems
+  else if (dsType == Type::LagrangianLinearTIDS)
+  {
+    DEBUG_PRINT("MoreauJeanOSI::computeResidu(), dsType == Type::LagrangianLinearTIDS\n");
+    // ResiduFree = h*C*v_i + h*Kq_i +h*h*theta*Kv_i+hFext_theta     (1)
+    // This formulae is only valid for the first computation of the residual for v = v_i
+    // otherwise the complete formulae must be applied, that is
+    // ResiduFree = M(v - vold) + h*((1-theta)*(C v_i + K q_i) +theta * ( C*v + K(q_i+h(1-theta)v_i+h theta v)))
+    //                     +hFext_theta     (2)
+    // for v != vi, the formulae (1) is wrong.
+    // in the sequel, only the equation (1) is implemented
+
+    // -- Convert the DS into a Lagrangian one.
+    SP::LagrangianLinearTIDS d = std11::static_pointer_cast<LagrangianLinearTIDS> (ds);
 
-      // Get state i (previous time step) from Memories -> var. indexed with "Old"
-      SP::SiconosVector qold = d->qMemory()->getSiconosVector(0); // qi
-      SP::SiconosVector vold = d->velocityMemory()->getSiconosVector(0); //vi
+    // Get state i (previous time step) from Memories -> var. indexed with "Old"
+    SP::SiconosVector qold = d->qMemory()->getSiconosVector(0); // qi
+    SP::SiconosVector vold = d->velocityMemory()->getSiconosVector(0); //vi
 
-      DEBUG_EXPR(qold->display(););
-      DEBUG_EXPR(vold->display(););
-      DEBUG_EXPR(d->q()->display(););
-      DEBUG_EXPR(d->velocity()->display(););
+    DEBUG_EXPR(qold->display(););
+    DEBUG_EXPR(vold->display(););
+    DEBUG_EXPR(d->q()->display(););
+    DEBUG_EXPR(d->velocity()->display(););
 
-      // --- ResiduFree computation Equation (1) ---
-      residuFree->zero();
-      double coeff;
-      // -- No need to update W --
+    // --- ResiduFree computation Equation (1) ---
+    residuFree->zero();
+    double coeff;
+    // -- No need to update W --
 
-      SP::SiconosVector v = d->velocity(); // v = v_k,i+1
+    SP::SiconosVector v = d->velocity(); // v = v_k,i+1
 
-      SP::SiconosMatrix C = d->C();
-      if (C)
-        prod(h, *C, *vold, *residuFree, false); // vfree += h*C*vi
+    SP::SiconosMatrix C = d->C();
+    if (C)
+      prod(h, *C, *vold, *residuFree, false); // vfree += h*C*vi
 
-      SP::SiconosMatrix K = d->K();
-      if (K)
-      {
-        coeff = h * h * _theta;
-        prod(coeff, *K, *vold, *residuFree, false); // vfree += h^2*_theta*K*vi
-        prod(h, *K, *qold, *residuFree, false); // vfree += h*K*qi
-      }
+    SP::SiconosMatrix K = d->K();
+    if (K)
+    {
+      coeff = h * h * _theta;
+      prod(coeff, *K, *vold, *residuFree, false); // vfree += h^2*_theta*K*vi
+      prod(h, *K, *qold, *residuFree, false); // vfree += h*K*qi
+    }
 
-      SP::SiconosVector Fext = d->fExt();
-      if (Fext)
-      {
-        // computes Fext(ti)
-        d->computeFExt(told);
-        coeff = -h * (1 - _theta);
-        scal(coeff, *(d->fExt()), *residuFree, false); // vfree -= h*(1-_theta) * fext(ti)
-        // computes Fext(ti+1)
-        d->computeFExt(t);
-        coeff = -h * _theta;
-        scal(coeff, *(d->fExt()), *residuFree, false); // vfree -= h*_theta * fext(ti+1)
-      }
+    SP::SiconosVector Fext = d->fExt();
+    if (Fext)
+    {
+      // computes Fext(ti)
+      d->computeFExt(told);
+      coeff = -h * (1 - _theta);
+      scal(coeff, *(d->fExt()), *residuFree, false); // vfree -= h*(1-_theta) * fext(ti)
+      // computes Fext(ti+1)
+      d->computeFExt(t);
+      coeff = -h * _theta;
+      scal(coeff, *(d->fExt()), *residuFree, false); // vfree -= h*_theta * fext(ti+1)
+    }
 
 
-      // Computation of the complete residual Equation (2)
-      //   ResiduFree = M(v - vold) + h*((1-theta)*(C v_i + K q_i) +theta * ( C*v + K(q_i+h(1-theta)v_i+h theta v)))
-      //                     +hFext_theta     (2)
-      //       SP::SiconosMatrix M = d->mass();
-      //       SP::SiconosVector realresiduFree (new SiconosVector(*residuFree));
-      //       realresiduFree->zero();
-      //       prod(*M, (*v-*vold), *realresiduFree); // residuFree = M(v - vold)
-      //       SP::SiconosVector qkplustheta (new SiconosVector(*qold));
-      //       qkplustheta->zero();
-      //       *qkplustheta = *qold + h *((1-_theta)* *vold + _theta* *v);
-      //       if (C){
-      //         double coef = h*(1-_theta);
-      //         prod(coef, *C, *vold , *realresiduFree, false);
-      //         coef = h*(_theta);
-      //         prod(coef,*C, *v , *realresiduFree, false);
-      //       }
-      //       if (K){
-      //         double coef = h*(1-_theta);
-      //         prod(coef,*K , *qold , *realresiduFree, false);
-      //         coef = h*(_theta);
-      //         prod(coef,*K , *qkplustheta , *realresiduFree, false);
-      //       }
-
-      //       if (Fext)
-      //       {
-      //         // computes Fext(ti)
-      //         d->computeFExt(told);
-      //         coeff = -h*(1-_theta);
-      //         scal(coeff, *Fext, *realresiduFree, false); // vfree -= h*(1-_theta) * fext(ti)
-      //         // computes Fext(ti+1)
-      //         d->computeFExt(t);
-      //         coeff = -h*_theta;
-      //         scal(coeff, *Fext, *realresiduFree, false); // vfree -= h*_theta * fext(ti+1)
-      //       }
+    // Computation of the complete residual Equation (2)
+    //   ResiduFree = M(v - vold) + h*((1-theta)*(C v_i + K q_i) +theta * ( C*v + K(q_i+h(1-theta)v_i+h theta v)))
+    //                     +hFext_theta     (2)
+    //       SP::SiconosMatrix M = d->mass();
+    //       SP::SiconosVector realresiduFree (new SiconosVector(*residuFree));
+    //       realresiduFree->zero();
+    //       prod(*M, (*v-*vold), *realresiduFree); // residuFree = M(v - vold)
+    //       SP::SiconosVector qkplustheta (new SiconosVector(*qold));
+    //       qkplustheta->zero();
+    //       *qkplustheta = *qold + h *((1-_theta)* *vold + _theta* *v);
+    //       if (C){
+    //         double coef = h*(1-_theta);
+    //         prod(coef, *C, *vold , *realresiduFree, false);
+    //         coef = h*(_theta);
+    //         prod(coef,*C, *v , *realresiduFree, false);
+    //       }
+    //       if (K){
+    //         double coef = h*(1-_theta);
+    //         prod(coef,*K , *qold , *realresiduFree, false);
+    //         coef = h*(_theta);
+    //         prod(coef,*K , *qkplustheta , *realresiduFree, false);
+    //       }
+
+    //       if (Fext)
+    //       {
+    //         // computes Fext(ti)
+    //         d->computeFExt(told);
+    //         coeff = -h*(1-_theta);
+    //         scal(coeff, *Fext, *realresiduFree, false); // vfree -= h*(1-_theta) * fext(ti)
+    //         // computes Fext(ti+1)
+    //         d->computeFExt(t);
+    //         coeff = -h*_theta;
+    //         scal(coeff, *Fext, *realresiduFree, false); // vfree -= h*_theta * fext(ti+1)
+    //       }
 
 
-      if (d->boundaryConditions())
-      {
-        d->boundaryConditions()->computePrescribedVelocity(t);
+    if (d->boundaryConditions())
+    {
+      d->boundaryConditions()->computePrescribedVelocity(t);
 
-        unsigned int columnindex = 0;
-        SP::SimpleMatrix WBoundaryConditions =_dynamicalSystemsGraph->properties(*dsi).WBoundaryConditions;
-        SP::SiconosVector columntmp(new SiconosVector(ds->dimension()));
+      unsigned int columnindex = 0;
+      SP::SimpleMatrix WBoundaryConditions =_dynamicalSystemsGraph->properties(dsv).WBoundaryConditions;
+      SP::SiconosVector columntmp(new SiconosVector(ds->dimension()));
 
-        for (std::vector<unsigned int>::iterator  itindex = d->boundaryConditions()->velocityIndices()->begin() ;
-             itindex != d->boundaryConditions()->velocityIndices()->end();
-             ++itindex)
-        {
+      for (std::vector<unsigned int>::iterator  itindex = d->boundaryConditions()->velocityIndices()->begin() ;
+           itindex != d->boundaryConditions()->velocityIndices()->end();
+           ++itindex)
+      {
 
-          double DeltaPrescribedVelocity =
-            d->boundaryConditions()->prescribedVelocity()->getValue(columnindex)
-            - vold->getValue(*itindex);
+        double DeltaPrescribedVelocity =
+          d->boundaryConditions()->prescribedVelocity()->getValue(columnindex)
+          - vold->getValue(*itindex);
 
-          WBoundaryConditions->getCol(columnindex, *columntmp);
-          *residuFree += *columntmp * (DeltaPrescribedVelocity);
+        WBoundaryConditions->getCol(columnindex, *columntmp);
+        *residuFree += *columntmp * (DeltaPrescribedVelocity);
 
-          residuFree->setValue(*itindex, - columntmp->getValue(*itindex)   * (DeltaPrescribedVelocity));
+        residuFree->setValue(*itindex, - columntmp->getValue(*itindex)   * (DeltaPrescribedVelocity));
 
-          columnindex ++;
+        columnindex ++;
 
-        }
       }
+    }
 
-      (* d->workspace(DynamicalSystem::free)) = *residuFree; // copy residuFree in Workfree
-      if (d->p(1))
-        *(d->workspace(DynamicalSystem::free)) -= *d->p(1); // Compute Residu in Workfree Notation !!
-                                                            // We use DynamicalSystem::free as tmp buffer
+    (* d->workspace(DynamicalSystem::free)) = *residuFree; // copy residuFree in Workfree
+    if (d->p(1))
+      *(d->workspace(DynamicalSystem::free)) -= *d->p(1); // Compute Residu in Workfree Notation !!
+                                                          // We use DynamicalSystem::free as tmp buffer
 
-      //      std::cout << "MoreauJeanOSI::ComputeResidu LagrangianLinearTIDS residu :"  << std::endl;
-      //      d->workspace(DynamicalSystem::free)->display();
+    //      std::cout << "MoreauJeanOSI::ComputeResidu LagrangianLinearTIDS residu :"  << std::endl;
+    //      d->workspace(DynamicalSystem::free)->display();
 
 
-      //     normResidu = d->workspace(DynamicalSystem::free)->norm2();
-      normResidu = 0.0; // we assume that v = vfree + W^(-1) p
-      //     normResidu = realresiduFree->norm2();
-      //DEBUG_PRINTF("normResidu (really computed) = %e\n", d->workspace(DynamicalSystem::free)->norm2() );
-    }
-    else if (dsType == Type::NewtonEulerDS)
-    {
-      DEBUG_PRINT("MoreauJeanOSI::computeResidu(), dsType == Type::NewtonEulerDS\n");
-      // residu = M (v_k,i+1 - v_i) - h*_theta*forces(t,v_k,i+1, q_k,i+1) - h*(1-_theta)*forces(ti,vi,qi) - pi+1
+    //     normResidu = d->workspace(DynamicalSystem::free)->norm2();
+    normResidu = 0.0; // we assume that v = vfree + W^(-1) p
+    //     normResidu = realresiduFree->norm2();
+    //DEBUG_PRINTF("normResidu (really computed) = %e\n", d->workspace(DynamicalSystem::free)->norm2() );
+  }
+  else if (dsType == Type::NewtonEulerDS)
+  {
+    DEBUG_PRINT("MoreauJeanOSI::computeResidu(), dsType == Type::NewtonEulerDS\n");
+    // residu = M (v_k,i+1 - v_i) - h*_theta*forces(t,v_k,i+1, q_k,i+1) - h*(1-_theta)*forces(ti,vi,qi) - pi+1
 
-      // -- Convert the DS into a Lagrangian one.
-      SP::NewtonEulerDS d = std11::static_pointer_cast<NewtonEulerDS> (ds);
+    // -- Convert the DS into a Lagrangian one.
+    SP::NewtonEulerDS d = std11::static_pointer_cast<NewtonEulerDS> (ds);
 
-      // Get the state  (previous time step) from memory vector
-      // -> var. indexed with "Old"
-      SP::SiconosVector qold = d->qMemory()->getSiconosVector(0);
-      SP::SiconosVector vold = d->velocityMemory()->getSiconosVector(0);
+    // Get the state  (previous time step) from memory vector
+    // -> var. indexed with "Old"
+    SP::SiconosVector qold = d->qMemory()->getSiconosVector(0);
+    SP::SiconosVector vold = d->velocityMemory()->getSiconosVector(0);
+
+
+    // Get the current state vector
+    SP::SiconosVector q = d->q();
+    SP::SiconosVector v = d->velocity(); // v = v_k,i+1
+
+    // Get the (constant mass matrix)
+    SP::SiconosMatrix massMatrix = d->mass();
+    prod(*massMatrix, (*v - *vold), *residuFree, true); // residuFree = M(v - vold)
+    DEBUG_EXPR(residuFree->display(););
+
+    if (d->forces())  // if fL exists
+    {
+      DEBUG_PRINTF("MoreauJeanOSI:: _theta = %e\n",_theta);
+      DEBUG_PRINTF("MoreauJeanOSI:: h = %e\n",h );
 
+      // Cheaper version: get forces(ti,vi,qi) from memory
+      SP::SiconosVector fold = d->forcesMemory()->getSiconosVector(0);
+      double coef = -h * (1 - _theta);
+      scal(coef, *fold, *residuFree, false);
 
-      // Get the current state vector
-      SP::SiconosVector q = d->q();
-      SP::SiconosVector v = d->velocity(); // v = v_k,i+1
+      // Expensive version to check ...
+      //d->computeForces(told,qold,vold);
+      //double coef = -h * (1.0 - _theta);
+      //scal(coef, *d->forces(), *residuFree, false);
 
-      // Get the (constant mass matrix)
-      SP::SiconosMatrix massMatrix = d->mass();
-      prod(*massMatrix, (*v - *vold), *residuFree, true); // residuFree = M(v - vold)
+      DEBUG_PRINT("MoreauJeanOSI:: old forces :\n");
+      DEBUG_EXPR(d->forces()->display(););
       DEBUG_EXPR(residuFree->display(););
 
-      if (d->forces())  // if fL exists
-      {
-        DEBUG_PRINTF("MoreauJeanOSI:: _theta = %e\n",_theta);
-        DEBUG_PRINTF("MoreauJeanOSI:: h = %e\n",h );
-
-        // Cheaper version: get forces(ti,vi,qi) from memory
-        SP::SiconosVector fold = d->forcesMemory()->getSiconosVector(0);
-        double coef = -h * (1 - _theta);
-        scal(coef, *fold, *residuFree, false);
-
-        // Expensive version to check ...
-        //d->computeForces(told,qold,vold);
-        //double coef = -h * (1.0 - _theta);
-        //scal(coef, *d->forces(), *residuFree, false);
-
-        DEBUG_PRINT("MoreauJeanOSI:: old forces :\n");
-        DEBUG_EXPR(d->forces()->display(););
-        DEBUG_EXPR(residuFree->display(););
-
-        // computes forces(ti,v,q)
-        d->computeForces(t,q,v);
-        coef = -h * _theta;
-        scal(coef, *d->forces(), *residuFree, false);
-        DEBUG_PRINT("MoreauJeanOSI:: new forces :\n");
-        DEBUG_EXPR(d->forces()->display(););
-        DEBUG_EXPR(residuFree->display(););
+      // computes forces(ti,v,q)
+      d->computeForces(t,q,v);
+      coef = -h * _theta;
+      scal(coef, *d->forces(), *residuFree, false);
+      DEBUG_PRINT("MoreauJeanOSI:: new forces :\n");
+      DEBUG_EXPR(d->forces()->display(););
+      DEBUG_EXPR(residuFree->display(););
 
-      }
+    }
 
 
-      if (d->boundaryConditions())
-      {
-        d->boundaryConditions()->computePrescribedVelocity(t);
+    if (d->boundaryConditions())
+    {
+      d->boundaryConditions()->computePrescribedVelocity(t);
 
-        unsigned int columnindex = 0;
-        SP::SimpleMatrix WBoundaryConditions = _dynamicalSystemsGraph->properties(*dsi).WBoundaryConditions;
-        SP::SiconosVector columntmp(new SiconosVector(ds->dimension()));
+      unsigned int columnindex = 0;
+      SP::SimpleMatrix WBoundaryConditions = _dynamicalSystemsGraph->properties(dsv).WBoundaryConditions;
+      SP::SiconosVector columntmp(new SiconosVector(ds->dimension()));
 
-        for (std::vector<unsigned int>::iterator  itindex = d->boundaryConditions()->velocityIndices()->begin() ;
-             itindex != d->boundaryConditions()->velocityIndices()->end();
-             ++itindex)
-        {
+      for (std::vector<unsigned int>::iterator  itindex = d->boundaryConditions()->velocityIndices()->begin() ;
+           itindex != d->boundaryConditions()->velocityIndices()->end();
+           ++itindex)
+      {
 
-          DEBUG_PRINTF("columnindex = %i\n",columnindex);
-          DEBUG_PRINTF("*itindex = %i\n",*itindex);
-          double DeltaPrescribedVelocity =
-            d->boundaryConditions()->prescribedVelocity()->getValue(columnindex)
-            - v->getValue(*itindex);
+        DEBUG_PRINTF("columnindex = %i\n",columnindex);
+        DEBUG_PRINTF("*itindex = %i\n",*itindex);
+        double DeltaPrescribedVelocity =
+          d->boundaryConditions()->prescribedVelocity()->getValue(columnindex)
+          - v->getValue(*itindex);
 
-          DEBUG_EXPR(d->boundaryConditions()->prescribedVelocity()->display());
+        DEBUG_EXPR(d->boundaryConditions()->prescribedVelocity()->display());
 
-          WBoundaryConditions->getCol(columnindex, *columntmp);
-          *residuFree -= *columntmp * (DeltaPrescribedVelocity);
+        WBoundaryConditions->getCol(columnindex, *columntmp);
+        *residuFree -= *columntmp * (DeltaPrescribedVelocity);
 
 
-          residuFree->setValue(*itindex, - columntmp->getValue(*itindex)   * (DeltaPrescribedVelocity));
+        residuFree->setValue(*itindex, - columntmp->getValue(*itindex)   * (DeltaPrescribedVelocity));
 
-          columnindex ++;
-        }
+        columnindex ++;
       }
+    }
 
-      *(d->workspace(DynamicalSystem::free)) = *residuFree;
-      if (d->p(1))
-        *(d->workspace(DynamicalSystem::free)) -= *d->p(1);// We use DynamicalSystem::free as tmp buffer
+    *(d->workspace(DynamicalSystem::free)) = *residuFree;
+    if (d->p(1))
+      *(d->workspace(DynamicalSystem::free)) -= *d->p(1);// We use DynamicalSystem::free as tmp buffer
 
 
-      if (d->boundaryConditions())
-      {
-        unsigned int columnindex = 0;
-        SP::SimpleMatrix WBoundaryConditions = _dynamicalSystemsGraph->properties(*dsi).WBoundaryConditions;
-        SP::SiconosVector columntmp(new SiconosVector(ds->dimension()));
+    if (d->boundaryConditions())
+    {
+      unsigned int columnindex = 0;
+      SP::SimpleMatrix WBoundaryConditions = _dynamicalSystemsGraph->properties(dsv).WBoundaryConditions;
+      SP::SiconosVector columntmp(new SiconosVector(ds->dimension()));
 
-        for (std::vector<unsigned int>::iterator  itindex = d->boundaryConditions()->velocityIndices()->begin() ;
-             itindex != d->boundaryConditions()->velocityIndices()->end();
-             ++itindex)
-        {
-          double DeltaPrescribedVelocity =
-            d->boundaryConditions()->prescribedVelocity()->getValue(columnindex)
-            - v->getValue(*itindex);
+      for (std::vector<unsigned int>::iterator  itindex = d->boundaryConditions()->velocityIndices()->begin() ;
+           itindex != d->boundaryConditions()->velocityIndices()->end();
+           ++itindex)
+      {
+        double DeltaPrescribedVelocity =
+          d->boundaryConditions()->prescribedVelocity()->getValue(columnindex)
+          - v->getValue(*itindex);
 
-          WBoundaryConditions->getCol(columnindex, *columntmp);
+        WBoundaryConditions->getCol(columnindex, *columntmp);
 
-          d->workspace(DynamicalSystem::free)->setValue(*itindex, - columntmp->getValue(*itindex)   * (DeltaPrescribedVelocity));
+        d->workspace(DynamicalSystem::free)->setValue(*itindex, - columntmp->getValue(*itindex)   * (DeltaPrescribedVelocity));
 
-          columnindex ++;
-        }
+        columnindex ++;
       }
-
-      DEBUG_PRINT("MoreauJeanOSI::computeResidu :\n");
-      DEBUG_EXPR(residuFree->display(););
-      DEBUG_EXPR(if (d->p(1)) d->p(1)->display(););
-      DEBUG_EXPR((d->workspace(DynamicalSystem::free))->display(););
-
-      normResidu = d->workspace(DynamicalSystem::free)->norm2();
-      DEBUG_PRINTF("normResidu= %e\n", normResidu);
     }
-    else
-      RuntimeException::selfThrow("MoreauJeanOSI::computeResidu - not yet implemented for Dynamical system of type: " + Type::name(*ds));
 
-    if (normResidu > maxResidu) maxResidu = normResidu;
+    DEBUG_PRINT("MoreauJeanOSI::computeResidu :\n");
+    DEBUG_EXPR(residuFree->display(););
+    DEBUG_EXPR(if (d->p(1)) d->p(1)->display(););
+    DEBUG_EXPR((d->workspace(DynamicalSystem::free))->display(););
 
+    normResidu = d->workspace(DynamicalSystem::free)->norm2();
+    DEBUG_PRINTF("normResidu= %e\n", normResidu);
   }
-  DEBUG_END("MoreauJeanOSI::computeResidu()\n");
-  return maxResidu;
-
+  else
+    RuntimeException::selfThrow("MoreauJeanOSI::computeResidu - not yet implemented for Dynamical system of type: " + Type::name(*ds));
 
+  return normResidu;
 }
 
 void MoreauJeanOSI::computeFreeState()
@@ -854,195 +958,247 @@ void MoreauJeanOSI::computeFreeState()
   //
 
 
-  SP::DynamicalSystem ds; // Current Dynamical System.
-  SP::SiconosMatrix W; // W MoreauJeanOSI matrix of the current DS.
-  Type::Siconos dsType ; // Type of the current DS.
+  std::vector<DynamicalSystemsGraph::VDescriptor> dsvs;
+  dynamicalSystemsVertices(dsvs);
+  int nbDS = dsvs.size();
+  int nthreads = dynamicalSystemsThreadsNumber(nbDS);
+  int i;
 
-  DynamicalSystemsGraph::VIterator dsi, dsend;
-
-  for (std11::tie(dsi, dsend) = _dynamicalSystemsGraph->vertices(); dsi != dsend; ++dsi)
-   {
-    if (!checkOSI(dsi)) continue;
-    ds = _dynamicalSystemsGraph->bundle(*dsi);
-    dsType = Type::value(*ds); // Its type
-    W = _dynamicalSystemsGraph->properties(*dsi).W; // Its W MoreauJeanOSI matrix of iteration.
-    // 3 - Lagrangian Non Linear Systems
-    if (dsType == Type::LagrangianDS)
+  if (nthreads == 1)
+  {
+    for (i = 0; i < nbDS; ++i)
+      computeDSFreeState(dsvs[i], t);
+  }
+#ifdef _OPENMP
+  else
+  {
+    ParallelLoopError error;
+#pragma omp parallel for num_threads(nthreads) schedule(dynamic, 16)
+    for (i = 0; i < nbDS; ++i)
+    {
+      try
+      {
+        computeDSFreeState(dsvs[i], t);
+      }
+      catch (...)
+      {
+        error.catchException(i);
+      }
+    }
+    if (error.failed())
     {
-      DEBUG_PRINT("MoreauJeanOSI::computeFreeState(), dsType == Type::LagrangianDS\n");
-      // IN to be updated at current time: W, M, q, v, fL
-      // IN at told: qi,vi, fLi
+      // the failed iteration is run again to throw its exception
+      computeDSFreeState(dsvs[error.index()], t);
+      error.rethrow();
+    }
+  }
+#endif
+  DEBUG_END("MoreauJeanOSI::computeFreeState()\n");
 
-      // Note: indices i/i+1 corresponds to value at the beginning/end of the time step.
-      // Index k stands for Newton iteration and thus corresponds to the last computed
-      // value, ie the one saved in the DynamicalSystem.
-      // "i" values are saved in memory vectors.
+}
 
-      // vFree = v_k,i+1 - W^{-1} ResiduFree
-      // with
-      // ResiduFree = M(q_k,i+1)(v_k,i+1 - v_i) - h*theta*forces(t,v_k,i+1, q_k,i+1) - h*(1-theta)*forces(ti,vi,qi)
+void MoreauJeanOSI::computeDSFreeState(DynamicalSystemsGraph::VDescriptor dsv, double t)
+{
+  SP::DynamicalSystem ds = _dynamicalSystemsGraph->bundle(dsv);
+  Type::Siconos dsType = Type::value(*ds); // Its type
+  SP::SiconosMatrix W = _dynamicalSystemsGraph->properties(dsv).W; // Its W MoreauJeanOSI matrix of iteration.
+  // 3 - Lagrangian Non Linear Systems
+  if (dsType == Type::LagrangianDS)
+  {
+    DEBUG_PRINT("MoreauJeanOSI::computeFreeState(), dsType == Type::LagrangianDS\n");
+    // IN to be updated at current time: W, M, q, v, fL
+    // IN at told: qi,vi, fLi
 
-      // -- Convert the DS into a Lagrangian one.
-      SP::LagrangianDS d = std11::static_pointer_cast<LagrangianDS> (ds);
+    // Note: indices i/i+1 corresponds to value at the beginning/end of the time step.
+    // Index k stands for Newton iteration and thus corresponds to the last computed
+    // value, ie the one saved in the DynamicalSystem.
+    // "i" values are saved in memory vectors.
 
-      // Get state i (previous time step) from Memories -> var. indexed with "Old"
-      SP::SiconosVector vold = d->velocityMemory()->getSiconosVector(0);
-      SP::SiconosVector v = d->velocity(); // v = v_k,i+1
-      DEBUG_EXPR(vold->display());
-      DEBUG_EXPR(v->display());
+    // vFree = v_k,i+1 - W^{-1} ResiduFree
+    // with
+    // ResiduFree = M(q_k,i+1)(v_k,i+1 - v_i) - h*theta*forces(t,v_k,i+1, q_k,i+1) - h*(1-theta)*forces(ti,vi,qi)
 
+    // -- Convert the DS into a Lagrangian one.
+    SP::LagrangianDS d = std11::static_pointer_cast<LagrangianDS> (ds);
 
-      // --- ResiduFree computation ---
-      // ResFree = M(v-vold) - h*[theta*forces(t) + (1-theta)*forces(told)]
-      //
-      // vFree pointer is used to compute and save ResiduFree in this first step.
-      SP::SiconosVector vfree = d->workspace(DynamicalSystem::free);//workX[d];
-      (*vfree) = *(d->workspace(DynamicalSystem::freeresidu));
-
-      // -- Update W --
-      // Note: during computeW, mass and jacobians of forces will be computed/
-      computeW(t, d, *W);
-
-      // -- vfree =  v - W^{-1} ResiduFree --
-      // At this point vfree = residuFree
-      // -> Solve WX = vfree and set vfree = X
-      W->PLUForwardBackwardInPlace(*vfree);
-      // -> compute real vfree
-      *vfree *= -1.0;
-      *vfree += *v;
-      DEBUG_EXPR(vfree->display());
+    // Get state i (previous time step) from Memories -> var. indexed with "Old"
+    SP::SiconosVector vold = d->velocityMemory()->getSiconosVector(0);
+    SP::SiconosVector v = d->velocity(); // v = v_k,i+1
+    DEBUG_EXPR(vold->display());
+    DEBUG_EXPR(v->display());
 
-    }
-    // 4 - Lagrangian Linear Systems
-    else if (dsType == Type::LagrangianLinearTIDS)
-    {
-      DEBUG_PRINT("MoreauJeanOSI::computeFreeState(), dsType == Type::LagrangianLinearTIDS\n");
-      // IN to be updated at current time: Fext
-      // IN at told: qi,vi, fext
-      // IN constants: K,C
 
-      // Note: indices i/i+1 corresponds to value at the beginning/end of the time step.
-      // "i" values are saved in memory vectors.
+    // --- ResiduFree computation ---
+    // ResFree = M(v-vold) - h*[theta*forces(t) + (1-theta)*forces(told)]
+    //
+    // vFree pointer is used to compute and save ResiduFree in this first step.
+    SP::SiconosVector vfree = d->workspace(DynamicalSystem::free);//workX[d];
+    (*vfree) = *(d->workspace(DynamicalSystem::freeresidu));
+
+    // -- Update W --
+    // Note: during computeW, mass and jacobians of forces will be computed/
+    computeW(t, d, *W);
+
+    // -- vfree =  v - W^{-1} ResiduFree --
+    // At this point vfree = residuFree
+    // -> Solve WX = vfree and set vfree = X
+    W->PLUForwardBackwardInPlace(*vfree);
+    // -> compute real vfree
+    *vfree *= -1.0;
+    *vfree += *v;
+    DEBUG_EXPR(vfree->display());
 
-      // vFree = v_i + W^{-1} ResiduFree    // with
-      // ResiduFree = (-h*C -h^2*theta*K)*vi - h*K*qi + h*theta * Fext_i+1 + h*(1-theta)*Fext_i
+  }
+  // 4 - Lagrangian Linear Systems
+  else if (dsType == Type::LagrangianLinearTIDS)
+  {
+    DEBUG_PRINT("MoreauJeanOSI::computeFreeState(), dsType == Type::LagrangianLinearTIDS\n");
+    // IN to be updated at current time: Fext
+    // IN at told: qi,vi, fext
+    // IN constants: K,C
 
-      // -- Convert the DS into a Lagrangian one.
-      SP::LagrangianLinearTIDS d = std11::static_pointer_cast<LagrangianLinearTIDS> (ds);
+    // Note: indices i/i+1 corresponds to value at the beginning/end of the time step.
+    // "i" values are saved in memory vectors.
 
-      // Get state i (previous time step) from Memories -> var. indexed with "Old"
-      SP::SiconosVector vold = d->velocityMemory()->getSiconosVector(0); //vi
+    // vFree = v_i + W^{-1} ResiduFree    // with
+    // ResiduFree = (-h*C -h^2*theta*K)*vi - h*K*qi + h*theta * Fext_i+1 + h*(1-theta)*Fext_i
 
-      // --- ResiduFree computation ---
-      // vFree pointer is used to compute and save ResiduFree in this first step.
+    // -- Convert the DS into a Lagrangian one.
+    SP::LagrangianLinearTIDS d = std11::static_pointer_cast<LagrangianLinearTIDS> (ds);
 
-      // Velocity free and residu. vFree = RESfree (pointer equality !!).
-      SP::SiconosVector vfree = d->workspace(DynamicalSystem::free);//workX[d];
-      (*vfree) = *(d->workspace(DynamicalSystem::freeresidu));
+    // Get state i (previous time step) from Memories -> var. indexed with "Old"
+    SP::SiconosVector vold = d->velocityMemory()->getSiconosVector(0); //vi
 
-      W->PLUForwardBackwardInPlace(*vfree);
-      *vfree *= -1.0;
-      *vfree += *vold;
+    // --- ResiduFree computation ---
+    // vFree pointer is used to compute and save ResiduFree in this first step.
 
-      DEBUG_EXPR(vfree->display());
+    // Velocity free and residu. vFree = RESfree (pointer equality !!).
+    SP::SiconosVector vfree = d->workspace(DynamicalSystem::free);//workX[d];
+    (*vfree) = *(d->workspace(DynamicalSystem::freeresidu));
 
+    W->PLUForwardBackwardInPlace(*vfree);
+    *vfree *= -1.0;
+    *vfree += *vold;
 
-    }
-    else if (dsType == Type::NewtonEulerDS)
-    {
-      // IN to be updated at current time: W, M, q, v, fL
-      // IN at told: qi,vi, fLi
+    DEBUG_EXPR(vfree->display());
 
-      // Note: indices i/i+1 corresponds to value at the beginning/end of the time step.
-      // Index k stands for Newton iteration and thus corresponds to the last computed
-      // value, ie the one saved in the DynamicalSystem.
-      // "i" values are saved in memory vectors.
 
-      // vFree = v_k,i+1 - W^{-1} ResiduFree
-      // with
-      // ResiduFree = M(q_k,i+1)(v_k,i+1 - v_i) - h*theta*forces(t,v_k,i+1, q_k,i+1)
-      //                                        - h*(1-theta)*forces(ti,vi,qi)
+  }
+  else if (dsType == Type::NewtonEulerDS)
+  {
+    // IN to be updated at current time: W, M, q, v, fL
+    // IN at told: qi,vi, fLi
 
-      // -- Convert the DS into a NewtonEuler one.
-      SP::NewtonEulerDS d = std11::static_pointer_cast<NewtonEulerDS> (ds);
+    // Note: indices i/i+1 corresponds to value at the beginning/end of the time step.
+    // Index k stands for Newton iteration and thus corresponds to the last computed
+    // value, ie the one saved in the DynamicalSystem.
+    // "i" values are saved in memory vectors.
 
-      // Get state i (previous time step) from Memories -> var. indexed with "Old"
-      SP::SiconosVector qold = d->qMemory()->getSiconosVector(0);
-      SP::SiconosVector vold = d->velocityMemory()->getSiconosVector(0);
+    // vFree = v_k,i+1 - W^{-1} ResiduFree
+    // with
+    // ResiduFree = M(q_k,i+1)(v_k,i+1 - v_i) - h*theta*forces(t,v_k,i+1, q_k,i+1)
+    //                                        - h*(1-theta)*forces(ti,vi,qi)
 
-      // --- ResiduFree computation ---
-      // ResFree = M(v-vold) - h*[theta*forces(t) + (1-theta)*forces(told)]
-      //
-      // vFree pointer is used to compute and save ResiduFree in this first step.
-      SP::SiconosVector vfree = d->workspace(DynamicalSystem::free);//workX[d];
-      (*vfree) = *(d->workspace(DynamicalSystem::freeresidu));
-      //*(d->vPredictor())=*(d->workspace(DynamicalSystem::freeresidu));
-
-      // -- Update W --
-      // Note: during computeW, mass and jacobians of forces will be computed/
-      SP::SimpleMatrix W = _dynamicalSystemsGraph->properties(*dsi).W;
-      computeW(t, d, *W);
-      SP::SiconosVector v = d->velocity(); // v = v_k,i+1
-
-      // -- vfree =  v - W^{-1} ResiduFree --
-      // At this point vfree = residuFree
-      // -> Solve WX = vfree and set vfree = X
-      //    std::cout<<"MoreauJeanOSI::computeFreeState residu free"<<endl;
-      //    vfree->display();
-
-      W->PLUForwardBackwardInPlace(*vfree);
-      //    std::cout<<"MoreauJeanOSI::computeFreeState -WRfree"<<endl;
-      //    vfree->display();
-      //    scal(h,*vfree,*vfree);
-      // -> compute real vfree
-      *vfree *= -1.0;
-      *vfree += *v;
-    }
-    else
-      RuntimeException::selfThrow("MoreauJeanOSI::computeFreeState - not yet implemented for Dynamical system of type: " +  Type::name(*ds));
-  }
-  DEBUG_END("MoreauJeanOSI::computeFreeState()\n");
+    // -- Convert the DS into a NewtonEuler one.
+    SP::NewtonEulerDS d = std11::static_pointer_cast<NewtonEulerDS> (ds);
+
+    // Get state i (previous time step) from Memories -> var. indexed with "Old"
+    SP::SiconosVector qold = d->qMemory()->getSiconosVector(0);
+    SP::SiconosVector vold = d->velocityMemory()->getSiconosVector(0);
 
+    // --- ResiduFree computation ---
+    // ResFree = M(v-vold) - h*[theta*forces(t) + (1-theta)*forces(told)]
+    //
+    // vFree pointer is used to compute and save ResiduFree in this first step.
+    SP::SiconosVector vfree = d->workspace(DynamicalSystem::free);//workX[d];
+    (*vfree) = *(d->workspace(DynamicalSystem::freeresidu));
+    //*(d->vPredictor())=*(d->workspace(DynamicalSystem::freeresidu));
+
+    // -- Update W --
+    // Note: during computeW, mass and jacobians of forces will be computed/
+    SP::SimpleMatrix W = _dynamicalSystemsGraph->properties(dsv).W;
+    computeW(t, d, *W);
+    SP::SiconosVector v = d->velocity(); // v = v_k,i+1
+
+    // -- vfree =  v - W^{-1} ResiduFree --
+    // At this point vfree = residuFree
+    // -> Solve WX = vfree and set vfree = X
+    //    std::cout<<"MoreauJeanOSI::computeFreeState residu free"<<endl;
+    //    vfree->display();
+
+    W->PLUForwardBackwardInPlace(*vfree);
+    //    std::cout<<"MoreauJeanOSI::computeFreeState -WRfree"<<endl;
+    //    vfree->display();
+    //    scal(h,*vfree,*vfree);
+    // -> compute real vfree
+    *vfree *= -1.0;
+    *vfree += *v;
+  }
+  else
+    RuntimeException::selfThrow("MoreauJeanOSI::computeFreeState - not yet implemented for Dynamical system of type: " +  Type::name(*ds));
 }
 
 void MoreauJeanOSI::prepareNewtonIteration(double time)
 {
   DEBUG_BEGIN(" MoreauJeanOSI::prepareNewtonIteration(double time)\n");
-  DynamicalSystemsGraph::VIterator dsi, dsend;
-  for (std11::tie(dsi, dsend) = _dynamicalSystemsGraph->vertices(); dsi != dsend; ++dsi)
-   {
-    if (!checkOSI(dsi)) continue;
-    SP::DynamicalSystem ds = _dynamicalSystemsGraph->bundle(*dsi);
-    computeW(time, ds, *_dynamicalSystemsGraph->properties(*dsi).W);
-  }
+  std::vector<DynamicalSystemsGraph::VDescriptor> dsvs;
+  dynamicalSystemsVertices(dsvs);
+  int nbDS = dsvs.size();
+  int nthreads = dynamicalSystemsThreadsNumber(nbDS);
+  int i;
 
-  if (!_explicitNewtonEulerDSOperators)
+  if (nthreads == 1)
   {
-    DynamicalSystemsGraph::VIterator dsi, dsend;
-
-    for (std11::tie(dsi, dsend) = _dynamicalSystemsGraph->vertices(); dsi != dsend; ++dsi)
+    for (i = 0; i < nbDS; ++i)
+      prepareDSNewtonIteration(dsvs[i], time);
+  }
+#ifdef _OPENMP
+  else
+  {
+    ParallelLoopError error;
+#pragma omp parallel for num_threads(nthreads) schedule(dynamic, 16)
+    for (i = 0; i < nbDS; ++i)
     {
-      if (!checkOSI(dsi)) continue;
-
-      SP::DynamicalSystem ds = _dynamicalSystemsGraph->bundle(*dsi);
-
-      //  VA <2016-04-19 Tue> We compute T and MObjToAbs to be consitent with the Jacobian at the beginning of the Newton iteration and not at the end
-      Type::Siconos dsType = Type::value(*ds);
-      if (dsType == Type::NewtonEulerDS)
+      try
       {
-        SP::NewtonEulerDS d = std11::static_pointer_cast<NewtonEulerDS> (ds);
-        computeT(d->q(),d->T());
-        computeMObjToAbs(d->q(),d->MObjToAbs());
+        prepareDSNewtonIteration(dsvs[i], time);
+      }
+      catch (...)
+      {
+        error.catchException(i);
       }
     }
-
+    if (error.failed())
+    {
+      // the failed iteration is run again to throw its exception
+      prepareDSNewtonIteration(dsvs[error.index()], time);
+      error.rethrow();
+    }
   }
-
+#endif
 
   DEBUG_END(" MoreauJeanOSI::prepareNewtonIteration(double time)\n");
 
 }
 
+void MoreauJeanOSI::prepareDSNewtonIteration(DynamicalSystemsGraph::VDescriptor dsv, double time)
+{
+  SP::DynamicalSystem ds = _dynamicalSystemsGraph->bundle(dsv);
+  computeW(time, ds, *_dynamicalSystemsGraph->properties(dsv).W);
+
+  if (!_explicitNewtonEulerDSOperators)
+  {
+    //  VA <2016-04-19 Tue> We compute T and MObjToAbs to be consitent with the Jacobian at the beginning of the Newton iteration and not at the end
+    Type::Siconos dsType = Type::value(*ds);
+    if (dsType == Type::NewtonEulerDS)
+    {
+      SP::NewtonEulerDS d = std11::static_pointer_cast<NewtonEulerDS> (ds);
+      computeT(d->q(),d->T());
+      computeMObjToAbs(d->q(),d->MObjToAbs());
+    }
+  }
+}
+
 
 struct MoreauJeanOSI::_NSLEffectOnFreeOutput : public SiconosVisitor
 {
@@ -1377,177 +1533,212 @@ void MoreauJeanOSI::updateState(const unsigned int level)
 
   DEBUG_BEGIN("MoreauJeanOSI::updateState(const unsigned int level)\n");
 
-  double RelativeTol = _simulation->relativeConvergenceTol();
   bool useRCC = _simulation->useRelativeConvergenceCriteron();
   if (useRCC)
     _simulation->setRelativeConvergenceCriterionHeld(true);
 
-  SP::SiconosMatrix W;
+  std::vector<DynamicalSystemsGraph::VDescriptor> dsvs;
+  dynamicalSystemsVertices(dsvs);
+  int nbDS = dsvs.size();
+  int nthreads = dynamicalSystemsThreadsNumber(nbDS);
+  int i;
+  bool held = true;
 
-  DynamicalSystemsGraph::VIterator dsi, dsend;
-  for (std11::tie(dsi, dsend) = _dynamicalSystemsGraph->vertices(); dsi != dsend; ++dsi)
+  if (nthreads == 1)
   {
-    if (!checkOSI(dsi)) continue;
-    SP::DynamicalSystem ds = _dynamicalSystemsGraph->bundle(*dsi);
+    for (i = 0; i < nbDS; ++i)
+      held = updateDSState(dsvs[i], level, useRCC) && held;
+  }
+#ifdef _OPENMP
+  else
+  {
+    ParallelLoopError error;
+#pragma omp parallel for num_threads(nthreads) schedule(dynamic, 16) reduction(&&:held)
+    for (i = 0; i < nbDS; ++i)
+    {
+      try
+      {
+        held = updateDSState(dsvs[i], level, useRCC) && held;
+      }
+      catch (...)
+      {
+        error.catchException(i);
+      }
+    }
+    if (error.failed())
+    {
+      // the failed iteration is run again to throw its exception
+      updateDSState(dsvs[error.index()], level, useRCC);
+      error.rethrow();
+    }
+  }
+#endif
+
+  if (useRCC && !held)
+    _simulation->setRelativeConvergenceCriterionHeld(false);
+
+  DEBUG_END("MoreauJeanOSI::updateState(const unsigned int level)\n");
+}
 
+bool MoreauJeanOSI::updateDSState(DynamicalSystemsGraph::VDescriptor dsv, unsigned int level, bool useRCC)
+{
+  SP::DynamicalSystem ds = _dynamicalSystemsGraph->bundle(dsv);
+  SP::SiconosMatrix W = _dynamicalSystemsGraph->properties(dsv).W;
+  // Get the DS type
 
-    W = _dynamicalSystemsGraph->properties(*dsi).W;
-    // Get the DS type
+  Type::Siconos dsType = Type::value(*ds);
+  bool held = true;
 
-    Type::Siconos dsType = Type::value(*ds);
+  // 3 - Lagrangian Systems
+  if (dsType == Type::LagrangianDS || dsType == Type::LagrangianLinearTIDS)
+  {
+    DEBUG_PRINT("MoreauJeanOSI::updateState(const unsigned int level), dsType == Type::LagrangianDS || dsType == Type::LagrangianLinearTIDS \n");
+    // get dynamical system
+    SP::LagrangianDS d = std11::static_pointer_cast<LagrangianDS> (ds);
 
-    // 3 - Lagrangian Systems
-    if (dsType == Type::LagrangianDS || dsType == Type::LagrangianLinearTIDS)
+    //    SiconosVector *vfree = d->velocityFree();
+    SP::SiconosVector v = d->velocity();
+    bool baux = dsType == Type::LagrangianDS && useRCC;
+
+    // level == LEVELMAX => p(level) does not even exists (segfault)
+    // \warning VA 04/08/2015. Why must we check that  d->p(level)->size() > 0 ?
+    if (level != LEVELMAX && d->p(level) && d->p(level)->size() > 0)
     {
-      DEBUG_PRINT("MoreauJeanOSI::updateState(const unsigned int level), dsType == Type::LagrangianDS || dsType == Type::LagrangianLinearTIDS \n");
-      // get dynamical system
-      SP::LagrangianDS d = std11::static_pointer_cast<LagrangianDS> (ds);
 
-      //    SiconosVector *vfree = d->velocityFree();
-      SP::SiconosVector v = d->velocity();
-      bool baux = dsType == Type::LagrangianDS && useRCC && _simulation->relativeConvergenceCriterionHeld();
+      assert(((d->p(level)).get()) &&
+             " MoreauJeanOSI::updateState() *d->p(level) == NULL.");
+      *v = *d->p(level); // v = p
+      if (d->boundaryConditions())
+        for (std::vector<unsigned int>::iterator
+               itindex = d->boundaryConditions()->velocityIndices()->begin() ;
+             itindex != d->boundaryConditions()->velocityIndices()->end();
+             ++itindex)
+          v->setValue(*itindex, 0.0);
+      W->PLUForwardBackwardInPlace(*v);
 
-      // level == LEVELMAX => p(level) does not even exists (segfault)
-      // \warning VA 04/08/2015. Why must we check that  d->p(level)->size() > 0 ?
-      if (level != LEVELMAX && d->p(level) && d->p(level)->size() > 0)
-      {
+      *v +=  * ds->workspace(DynamicalSystem::free);
+    }
+    else
+    {
+      *v =  * ds->workspace(DynamicalSystem::free);
+    }
+    DEBUG_EXPR(v->display());
 
-        assert(((d->p(level)).get()) &&
-               " MoreauJeanOSI::updateState() *d->p(level) == NULL.");
-        *v = *d->p(level); // v = p
-        if (d->boundaryConditions())
-          for (std::vector<unsigned int>::iterator
-                 itindex = d->boundaryConditions()->velocityIndices()->begin() ;
-               itindex != d->boundaryConditions()->velocityIndices()->end();
-               ++itindex)
-            v->setValue(*itindex, 0.0);
-        W->PLUForwardBackwardInPlace(*v);
-
-        *v +=  * ds->workspace(DynamicalSystem::free);
-      }
-      else
-      {
-        *v =  * ds->workspace(DynamicalSystem::free);
-      }
-      DEBUG_EXPR(v->display());
 
 
+    if (d->boundaryConditions())
+    {
+      int bc = 0;
+      SP::SiconosVector columntmp(new SiconosVector(ds->dimension()));
 
-      if (d->boundaryConditions())
+      for (std::vector<unsigned int>::iterator  itindex = d->boundaryConditions()->velocityIndices()->begin() ;
+           itindex != d->boundaryConditions()->velocityIndices()->end();
+           ++itindex)
       {
-        int bc = 0;
-        SP::SiconosVector columntmp(new SiconosVector(ds->dimension()));
-
-        for (std::vector<unsigned int>::iterator  itindex = d->boundaryConditions()->velocityIndices()->begin() ;
-             itindex != d->boundaryConditions()->velocityIndices()->end();
-             ++itindex)
+         _dynamicalSystemsGraph->properties(dsv).WBoundaryConditions->getCol(bc, *columntmp);
+        /*\warning we assume that W is symmetric in the Lagrangian case*/
+        double value = - inner_prod(*columntmp, *v);
+        if (level != LEVELMAX && d->p(level)&& d->p(level)->size() > 0)
         {
-           _dynamicalSystemsGraph->properties(*dsi).WBoundaryConditions->getCol(bc, *columntmp);
-          /*\warning we assume that W is symmetric in the Lagrangian case*/
-          double value = - inner_prod(*columntmp, *v);
-          if (level != LEVELMAX && d->p(level)&& d->p(level)->size() > 0)
-          {
-            value += (d->p(level))->getValue(*itindex);
-          }
-          /* \warning the computation of reactionToBoundaryConditions take into
-             account the contact impulse but not the external and internal forces.
-             A complete computation of the residu should be better */
-          d->reactionToBoundaryConditions()->setValue(bc, value) ;
-          bc++;
+          value += (d->p(level))->getValue(*itindex);
         }
+        /* \warning the computation of reactionToBoundaryConditions take into
+           account the contact impulse but not the external and internal forces.
+           A complete computation of the residu should be better */
+        d->reactionToBoundaryConditions()->setValue(bc, value) ;
+        bc++;
       }
+    }
 
-      SP::SiconosVector q = d->q();
-      // Save value of q in stateTmp for future convergence computation
-      if (baux)
-        ds->addWorkVector(q, DynamicalSystem::local_buffer);
-
-      updatePosition(ds);
+    SP::SiconosVector q = d->q();
+    // Save value of q in stateTmp for future convergence computation
+    if (baux)
+      ds->addWorkVector(q, DynamicalSystem::local_buffer);
 
-      if (baux)
-      {
-        ds->subWorkVector(q, DynamicalSystem::local_buffer);
-        double aux = ((ds->workspace(DynamicalSystem::local_buffer))->norm2()) / (ds->normRef());
-        if (aux > RelativeTol)
-          _simulation->setRelativeConvergenceCriterionHeld(false);
-      }
+    updatePosition(ds);
 
-    }
-    else if (dsType == Type::NewtonEulerDS)
+    if (baux)
     {
-      DEBUG_PRINT("MoreauJeanOSI::updateState(const unsigned int level), dsType == Type::NewtonEulerDS \n");
-
-      // get dynamical system
-      SP::NewtonEulerDS d = std11::static_pointer_cast<NewtonEulerDS> (ds);
-      SP::SiconosVector v = d->velocity();
-      DEBUG_PRINT("MoreauJeanOSI::updateState()\n ")
-      DEBUG_EXPR(d->display());
-      DEBUG_PRINT("MoreauJeanOSI::updateState() prev v\n")
-      DEBUG_EXPR(v->display());
+      ds->subWorkVector(q, DynamicalSystem::local_buffer);
+      double aux = ((ds->workspace(DynamicalSystem::local_buffer))->norm2()) / (ds->normRef());
+      if (aux > _simulation->relativeConvergenceTol())
+        held = false;
+    }
 
-      // failure on bullet sims
-      // d->p(level) is checked in next condition
-      // assert(((d->p(level)).get()) &&
-      //       " MoreauJeanOSI::updateState() *d->p(level) == NULL.");
+  }
+  else if (dsType == Type::NewtonEulerDS)
+  {
+    DEBUG_PRINT("MoreauJeanOSI::updateState(const unsigned int level), dsType == Type::NewtonEulerDS \n");
 
-      if (level != LEVELMAX && d->p(level) && d->p(level)->size() > 0)
-      {
-        /*d->p has been fill by the Relation->computeInput, it contains
-          B \lambda _{k+1}*/
-        *v = *d->p(level); // v = p
-        if (d->boundaryConditions())
-          for (std::vector<unsigned int>::iterator
-                 itindex = d->boundaryConditions()->velocityIndices()->begin() ;
-               itindex != d->boundaryConditions()->velocityIndices()->end();
-               ++itindex)
-            v->setValue(*itindex, 0.0);
-
-        _dynamicalSystemsGraph->properties(*dsi).W->PLUForwardBackwardInPlace(*v);
-
-        DEBUG_EXPR(d->p(level)->display());
-        DEBUG_PRINT("MoreauJeanOSI::updatestate W CT lambda\n");
-        DEBUG_EXPR(v->display());
-        *v +=  * ds->workspace(DynamicalSystem::free);
-      }
-      else
-        *v =  * ds->workspace(DynamicalSystem::free);
+    // get dynamical system
+    SP::NewtonEulerDS d = std11::static_pointer_cast<NewtonEulerDS> (ds);
+    SP::SiconosVector v = d->velocity();
+    DEBUG_PRINT("MoreauJeanOSI::updateState()\n ")
+    DEBUG_EXPR(d->display());
+    DEBUG_PRINT("MoreauJeanOSI::updateState() prev v\n")
+    DEBUG_EXPR(v->display());
 
-      DEBUG_PRINT("MoreauJeanOSI::updatestate work free\n");
-      DEBUG_EXPR(ds->workspace(DynamicalSystem::free)->display());
-      DEBUG_PRINT("MoreauJeanOSI::updatestate new v\n");
-      DEBUG_EXPR(v->display());
+    // failure on bullet sims
+    // d->p(level) is checked in next condition
+    // assert(((d->p(level)).get()) &&
+    //       " MoreauJeanOSI::updateState() *d->p(level) == NULL.");
 
+    if (level != LEVELMAX && d->p(level) && d->p(level)->size() > 0)
+    {
+      /*d->p has been fill by the Relation->computeInput, it contains
+        B \lambda _{k+1}*/
+      *v = *d->p(level); // v = p
       if (d->boundaryConditions())
-      {
-        int bc = 0;
-        SP::SiconosVector columntmp(new SiconosVector(ds->dimension()));
-
-        for (std::vector<unsigned int>::iterator  itindex = d->boundaryConditions()->velocityIndices()->begin() ;
+        for (std::vector<unsigned int>::iterator
+               itindex = d->boundaryConditions()->velocityIndices()->begin() ;
              itindex != d->boundaryConditions()->velocityIndices()->end();
              ++itindex)
+          v->setValue(*itindex, 0.0);
+
+      _dynamicalSystemsGraph->properties(dsv).W->PLUForwardBackwardInPlace(*v);
+
+      DEBUG_EXPR(d->p(level)->display());
+      DEBUG_PRINT("MoreauJeanOSI::updatestate W CT lambda\n");
+      DEBUG_EXPR(v->display());
+      *v +=  * ds->workspace(DynamicalSystem::free);
+    }
+    else
+      *v =  * ds->workspace(DynamicalSystem::free);
+
+    DEBUG_PRINT("MoreauJeanOSI::updatestate work free\n");
+    DEBUG_EXPR(ds->workspace(DynamicalSystem::free)->display());
+    DEBUG_PRINT("MoreauJeanOSI::updatestate new v\n");
+    DEBUG_EXPR(v->display());
+
+    if (d->boundaryConditions())
+    {
+      int bc = 0;
+      SP::SiconosVector columntmp(new SiconosVector(ds->dimension()));
+
+      for (std::vector<unsigned int>::iterator  itindex = d->boundaryConditions()->velocityIndices()->begin() ;
+           itindex != d->boundaryConditions()->velocityIndices()->end();
+           ++itindex)
+      {
+        _dynamicalSystemsGraph->properties(dsv).WBoundaryConditions->getCol(bc, *columntmp);
+        /*\warning we assume that W is symmetric in the Lagrangian case*/
+        double value = - inner_prod(*columntmp, *v);
+        if (level != LEVELMAX && d->p(level) && d->p(level)->size() > 0)
         {
-          _dynamicalSystemsGraph->properties(*dsi).WBoundaryConditions->getCol(bc, *columntmp);
-          /*\warning we assume that W is symmetric in the Lagrangian case*/
-          double value = - inner_prod(*columntmp, *v);
-          if (level != LEVELMAX && d->p(level) && d->p(level)->size() > 0)
-          {
-            value += (d->p(level))->getValue(*itindex);
-          }
-          /* \warning the computation of reactionToBoundaryConditions take into
-             account the contact impulse but not the external and internal forces.
-             A complete computation of the residu should be better */
-          d->reactionToBoundaryConditions()->setValue(bc, value) ;
-          bc++;
+          value += (d->p(level))->getValue(*itindex);
         }
+        /* \warning the computation of reactionToBoundaryConditions take into
+           account the contact impulse but not the external and internal forces.
+           A complete computation of the residu should be better */
+        d->reactionToBoundaryConditions()->setValue(bc, value) ;
+        bc++;
       }
-
-      updatePosition(ds);
-
     }
-    else RuntimeException::selfThrow("MoreauJeanOSI::updateState - not yet implemented for Dynamical system of type: " +  Type::name(*ds));
+
+    updatePosition(ds);
 
   }
-  DEBUG_END("MoreauJeanOSI::updateState(const unsigned int level)\n");
+  else RuntimeException::selfThrow("MoreauJeanOSI::updateState - not yet implemented for Dynamical system of type: " +  Type::name(*ds));
+  return held;
 }
 
 
@@ -90,6 +90,11 @@ const unsigned int MOREAUSTEPSINMEMORY = 1;
  * W matrices are initialized and computed in initW and computeW. Depending on the DS type,
  * they may depend on time t and DS state x.
  *
+ * The LU factorization of W is kept as long as W does not change: W of a
+ * LagrangianLinearTIDS is factorized once, and W of a LagrangianDS held as a
+ * sparse matrix (see setSparseW) is factorized again only if M, K or C have
+ * changed.
+ *
  * For mechanical systems, the implementation uses _p for storing the
  * the input due to the nonsmooth law. This MoreauJeanOSI scheme assumes that the
  * relative degree is two.
@@ -135,11 +140,62 @@ protected:
    */
   bool _explicitNewtonEulerDSOperators;
 
+  /** a boolean to hold the W matrices of the Lagrangian systems as
+   *  sparse matrices
+   */
+  bool _sparseW;
+
+  /** number of threads used in the loops over the dynamical systems,
+   *  1 for sequential, 0 for the OpenMP default
+   */
+  int _threadsNumber;
+
   /** nslaw effects
    */
   struct _NSLEffectOnFreeOutput;
   friend struct _NSLEffectOnFreeOutput;
 
+  /** the vertices of the dynamical systems integrated by this OSI
+   *  \param[out] dsvs the descriptors of the dynamical systems
+   */
+  void dynamicalSystemsVertices(std::vector<DynamicalSystemsGraph::VDescriptor>& dsvs);
+
+  /** number of threads of a loop over the dynamical systems
+   *  \param nbDS the number of dynamical systems
+   *  \return 1 without OpenMP
+   */
+  int dynamicalSystemsThreadsNumber(int nbDS) const;
+
+  /** compute the residu of a dynamical system (see computeResidu)
+   *  \param dsv the descriptor of the dynamical system
+   *  \param t the time at the end of the time step
+   *  \param told the time at the beginning of the time step
+   *  \return the norm of the residu
+   */
+  double computeDSResidu(DynamicalSystemsGraph::VDescriptor dsv, double t, double told);
+
+  /** compute the free state of a dynamical system (see computeFreeState)
+   *  \param dsv the descriptor of the dynamical system
+   *  \param t the time at the end of the time step
+   */
+  void computeDSFreeState(DynamicalSystemsGraph::VDescriptor dsv, double t);
+
+  /** compute W, and T for a NewtonEulerDS, before a Newton iteration
+   *  (see prepareNewtonIteration)
+   *  \param dsv the descriptor of the dynamical system
+   *  \param time the current time
+   */
+  void prepareDSNewtonIteration(DynamicalSystemsGraph::VDescriptor dsv, double time);
+
+  /** update the state of a dynamical system (see updateState)
+   *  \param dsv the descriptor of the dynamical system
+   *  \param level the level of interest for the dynamics
+   *  \param useRCC true if the relative convergence criterion is used
+   *  \return false if the relative convergence criterion does not hold
+   *  for this dynamical system
+   */
+  bool updateDSState(DynamicalSystemsGraph::VDescriptor dsv, unsigned int level, bool useRCC);
+
 public:
 
   /** constructor from theta value only
@@ -273,6 +329,49 @@ public:
     _explicitNewtonEulerDSOperators = newExplicitNewtonEulerDSOperators;
   };
 
+  /** get boolean _sparseW
+   *  \return a Boolean
+   */
+  inline bool sparseW()
+  {
+    return _sparseW;
+  };
+
+  /** set the boolean to hold the W matrices of the Lagrangian systems
+   *  as sparse matrices, factorized with the sparse LU of CSparse. It
+   *  must be set before the initialization of the simulation. W is
+   *  kept dense for the systems with boundary conditions, and is
+   *  sparse anyway if the mass matrix is sparse.
+   *  \param newSparseW a Boolean
+   */
+  inline void setSparseW(bool newSparseW)
+  {
+    _sparseW = newSparseW;
+  };
+
+  /** get the number of threads of the loops over the dynamical systems
+   *  \return an int
+   */
+  inline int threadsNumber()
+  {
+    return _threadsNumber;
+  };
+
+  /** set the number of threads of the loops over the dynamical systems
+   *  in computeResidu, computeFreeState, prepareNewtonIteration and
+   *  updateState. The dynamical systems are independent in these
+   *  loops, and each of them is computed by a single thread, so the
+   *  results do not depend on the number of threads. The plugins and
+   *  the overloaded methods of the dynamical systems must then be
+   *  thread-safe: keep 1 thread if they are written in Python.
+   *  Without OpenMP, the loops are sequential.
+   *  \param n 1 for sequential (default), 0 for the OpenMP default
+   */
+  inline void setThreadsNumber(int n)
+  {
+    _threadsNumber = n;
+  };
+
   // --- OTHER FUNCTIONS ---
 
   /** initialization of the MoreauJeanOSI integrator; for linear time
@@ -22,6 +22,7 @@
 #include "DynamicalSystem.hpp"
 #include "NonSmoothDynamicalSystem.hpp"
 #include "ExtraAdditionalTerms.hpp"
+#include "BlockVector.hpp"
 
 #include <SiconosConfig.h>
 #if defined(SICONOS_STD_FUNCTIONAL) && !defined(SICONOS_USE_BOOST_FOR_CXX11)
@@ -91,6 +92,30 @@ void OneStepIntegrator::resetNonSmoothPart(unsigned int level)
   }
 }
 
+SP::SiconosVector OneStepIntegrator::contiguousState(SP::SiconosVector tmp, BlockVector& work)
+{
+  if (work.getNumberOfBlocks() == 1)
+    return work.vector(0);
+  if (!tmp || tmp->size() != work.size())
+    tmp.reset(new SiconosVector(work.size()));
+  *tmp = work;
+  return tmp;
+}
+
+void OneStepIntegrator::fillState(const double* x, BlockVector& work)
+{
+  if (work.getNumberOfBlocks() == 1 && work.vector(0)->getArray() == x)
+    return;
+  work = x;
+}
+
+void OneStepIntegrator::restoreState(const SiconosVector& tmp, BlockVector& work)
+{
+  if (work.getNumberOfBlocks() == 1 && work.vector(0).get() == &tmp)
+    return;
+  work = tmp;
+}
+
 void OneStepIntegrator::display()
 {
   std::cout << "==== OneStepIntegrator display =====" <<std::endl;
@@ -106,6 +106,32 @@ protected:
   /** struct to add terms in the integration. Useful for Control */
   SP::ExtraAdditionalTerms _extraAdditionalTerms;
 
+/** get the contiguous vector given to an external integrator (LSODAR)
+ *  for a state made of the vectors of the dynamical systems.
+ *  If the state has only one block, it is the vector of the dynamical
+ *  system itself: the integrator works directly on its memory, and the
+ *  copies between the integrator and the dynamical system are skipped.
+ *  Else, it is tmp, allocated if needed, and filled with the state.
+ *  \param tmp the vector returned by the previous call, may be null
+ *  \param work the state, a vector per dynamical system
+ *  \return the contiguous vector
+ */
+  static SP::SiconosVector contiguousState(SP::SiconosVector tmp, BlockVector& work);
+
+/** copy an array computed by an external integrator into the state,
+ *  unless it is the memory of the state (see contiguousState)
+ *  \param x the array
+ *  \param work the state
+ */
+  static void fillState(const double* x, BlockVector& work);
+
+/** copy the contiguous vector back into the state, unless they share
+ *  their memory (see contiguousState)
+ *  \param tmp the contiguous vector
+ *  \param work the state
+ */
+  static void restoreState(const SiconosVector& tmp, BlockVector& work);
+
 private:
 
 
@@ -19,8 +19,12 @@
 #include "NonSmoothDynamicalSystem.hpp"
 //#include "Interaction.hpp"
 #include "Interaction.hpp"
+#include "Relation.hpp"
+#include "LagrangianR.hpp"
+#include "NewtonEulerR.hpp"
 #include "Topology.hpp"
 #include "Simulation.hpp"
+#include "ParallelLoopError.hpp"
 #include "Model.hpp"
 #include "EulerMoreauOSI.hpp"
 #include "MoreauJeanOSI.hpp"
@@ -33,6 +37,14 @@
 #include "Simulation.hpp"
 
 #include <NumericsOptions.h>
+#include <SolverOptions.h>
+#include <Friction_cst.h>
+
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 // #define DEBUG_STDOUT
 // #define DEBUG_MESSAGES
@@ -41,7 +53,9 @@
 
 
 OneStepNSProblem::OneStepNSProblem():
-  _indexSetLevel(0), _inputOutputLevel(0), _maxSize(0), _nbIter(0), _hasBeenUpdated(false)
+  _indexSetLevel(0), _inputOutputLevel(0), _maxSize(0), _nbIter(0), _hasBeenUpdated(false),
+  _reuseInteractionBlocks(true),
+  _interactionBlocksThreadsNumber(1)
 {
   _numerics_solver_options.reset(new SolverOptions);
   _numerics_solver_options->iWork = NULL;   _numerics_solver_options->callback = NULL;
@@ -57,7 +71,9 @@ OneStepNSProblem::OneStepNSProblem():
 // Constructor with given simulation and a pointer on Solver (Warning, solver is an optional argument)
 OneStepNSProblem::OneStepNSProblem(int numericsSolverId):
   _numerics_solver_id(numericsSolverId), _sizeOutput(0),
-  _indexSetLevel(0), _inputOutputLevel(0), _maxSize(0), _nbIter(0), _hasBeenUpdated(false)
+  _indexSetLevel(0), _inputOutputLevel(0), _maxSize(0), _nbIter(0), _hasBeenUpdated(false),
+  _reuseInteractionBlocks(true),
+  _interactionBlocksThreadsNumber(1)
 {
 
   // Numerics general options
@@ -77,6 +93,125 @@ bool OneStepNSProblem::hasInteractions() const
    //return _simulation->nonSmoothDynamicalSystem()->topology()->indexSet(0)->size() > 0 ;
 }
 
+/* append the values of a dense matrix to a key, or return false */
+static bool matrixKey(SiconosMatrix& m, std::vector<double>& key)
+{
+  if (m.num() != 1)
+    return false;
+  double* a = m.getArray();
+  key.push_back(m.size(0));
+  key.push_back(m.size(1));
+  key.insert(key.end(), a, a + m.size(0) * m.size(1));
+  return true;
+}
+
+/* the relation of an interaction enters its blocks through its
+   jacobians: they are constant for a linear time invariant relation,
+   and are compared with their values at the previous step for the
+   lagrangian and Newton-Euler relations. Return false if the
+   jacobians are neither constant nor comparable. */
+static bool relationKey(InteractionsGraph& indexSet, const InteractionsGraph::VDescriptor& vd,
+                        std::vector<double>& key)
+{
+  key.clear();
+  SP::Relation relation = indexSet.bundle(vd)->relation();
+  if (relation->getSubType() == RELATION::LinearTIR)
+    return true;
+
+  SP::SiconosMatrix left, D;
+  if (relation->getType() == RELATION::Lagrangian)
+  {
+    SP::LagrangianR r = std11::static_pointer_cast<LagrangianR>(relation);
+    left = r->jachq();
+    D = r->jachlambda();
+  }
+  else if (relation->getType() == RELATION::NewtonEuler)
+  {
+    SP::NewtonEulerR r = std11::static_pointer_cast<NewtonEulerR>(relation);
+    left = r->jachqT();
+    D = r->jachlambda();
+  }
+  else
+    return false;
+  return left && matrixKey(*left, key) && (!D || matrixKey(*D, key));
+}
+
+/* the parameters of a theta-method integrator used in the blocks */
+template <class ThetaOSI>
+static void thetaMethodKey(ThetaOSI& osi, std::vector<double>& key)
+{
+  key.push_back(osi.theta());
+  key.push_back(osi.gamma());
+  key.push_back(osi.useGamma());
+  key.push_back(osi.useGammaForRelation());
+}
+
+void OneStepNSProblem::interactionBlocksKey(SP::OneStepIntegrator osi, SP::DynamicalSystem ds,
+                                            std::vector<double>& key)
+{
+  key.clear();
+  key.push_back(simulation()->currentTimeStep());
+  OSI::TYPES osiType = osi->getType();
+  if (osiType == OSI::MOREAUJEANOSI || osiType == OSI::MOREAUDIRECTPROJECTIONOSI)
+    thetaMethodKey(static_cast<MoreauJeanOSI&>(*osi), key);
+  else if (osiType == OSI::EULERMOREAUOSI)
+    thetaMethodKey(static_cast<EulerMoreauOSI&>(*osi), key);
+  else if (osiType == OSI::SCHATZMANPAOLIOSI)
+    thetaMethodKey(static_cast<SchatzmanPaoliOSI&>(*osi), key);
+  else
+  {
+    // NaN is not equal to itself: the blocks are always computed
+    key.push_back(std::numeric_limits<double>::quiet_NaN());
+    return;
+  }
+
+  // W, through the stamp incremented by the integrator each time it
+  // may change
+  if (getOSIMatrix(osi, ds))
+  {
+    SP::DynamicalSystemsGraph dsg = simulation()->nonSmoothDynamicalSystem()->topology()->dSG(0);
+    key.push_back(dsg->WStamp[dsg->descriptor(ds)]);
+  }
+  else
+    key.push_back(std::numeric_limits<double>::quiet_NaN());
+}
+
+/* an extra-diagonal block, the edges that contribute to it and, in
+   the symmetric case, the block that receives its transpose */
+struct InteractionBlockTask
+{
+  SP::SiconosMatrix block;
+  SP::SiconosMatrix transposed;
+  std::vector<InteractionsGraph::EDescriptor> edges;
+};
+
+static InteractionBlockTask& extraDiagonalBlockTask(std::vector<InteractionBlockTask>& tasks,
+                                                    std::map<SiconosMatrix*, unsigned int>& number,
+                                                    SP::SiconosMatrix block)
+{
+  std::map<SiconosMatrix*, unsigned int>::iterator it = number.find(block.get());
+  if (it != number.end())
+    return tasks[it->second];
+  number[block.get()] = tasks.size();
+  tasks.push_back(InteractionBlockTask());
+  tasks.back().block = block;
+  return tasks.back();
+}
+
+static void computeExtraDiagonalBlock(OneStepNSProblem& osnsp, InteractionBlockTask& task)
+{
+  /* interactionBlock must be zeroed at init, the contributions of
+     the edges are added */
+  task.block->zero();
+  for (std::vector<InteractionsGraph::EDescriptor>::iterator ed = task.edges.begin();
+       ed != task.edges.end(); ++ed)
+  {
+    osnsp.computeInteractionBlock(*ed);
+  }
+  if (task.transposed && !task.edges.empty())
+    task.transposed->trans(*task.block);
+}
+
 void OneStepNSProblem::updateInteractionBlocks()
 {
   DEBUG_PRINT("OneStepNSProblem::updateInteractionBlocks() starts\n");
@@ -105,35 +240,89 @@ void OneStepNSProblem::updateInteractionBlocks()
   SP::InteractionsGraph indexSet = simulation()->indexSet(indexSetLevel());
 
   bool isLinear = simulation()->nonSmoothDynamicalSystem()->isLinear();
-
-  // we put diagonal informations on vertices
-  // self loops with bgl are a *nightmare* at the moment
-  // (patch 65198 on standard boost install)
-
-  if (indexSet->properties().symmetric)
+  bool compute = !isLinear || !_hasBeenUpdated;
+
+  // Blocks computed at the previous step are kept for the interactions
+  // whose relation jacobians (see relationKey) and the keys of their
+  // dynamical systems (time step, parameters of the integrator and
+  // stamp of W) have not changed. Only the blocks actually computed
+  // are registered: if the relative order of two interactions
+  // changes, the transposed block is computed again.
+  std::set<SP::SiconosMatrix> previousInteractionBlocks;
+  previousInteractionBlocks.swap(_computedInteractionBlocks);
+  _reusedInteractionBlocks.clear();
+  std::map<int, std::vector<double> > previousKeys, previousRelationKeys;
+  previousKeys.swap(_interactionBlocksKeys);
+  previousRelationKeys.swap(_relationKeys);
+
+  std::vector<bool> timeInvariant(indexSet->size(), false);
+  if (_reuseInteractionBlocks)
   {
-    DEBUG_PRINT("OneStepNSProblem::updateInteractionBlocks(). Symmetric case");
+    std::vector<double> key;
+    std::map<int, std::vector<double> >::iterator previous;
     InteractionsGraph::VIterator vi, viend;
     for (std11::tie(vi, viend) = indexSet->vertices();
          vi != viend; ++vi)
     {
-      SP::Interaction inter = indexSet->bundle(*vi);
-      unsigned int nslawSize = inter->nonSmoothLaw()->size();
-      if (! indexSet->properties(*vi).block)
+      if (!relationKey(*indexSet, *vi, key))
+        continue;
+      int number = indexSet->bundle(*vi)->number();
+      previous = previousRelationKeys.find(number);
+      bool same = previous != previousRelationKeys.end() && key == previous->second;
+      _relationKeys[number].swap(key);
+
+      SP::OneStepIntegrator osi = indexSet->properties(*vi).osi;
+      SP::DynamicalSystem ds[2] = { indexSet->properties(*vi).source,
+                                    indexSet->properties(*vi).target };
+      for (unsigned int k = 0; k < 2; ++k)
       {
-        indexSet->properties(*vi).block.reset(new SimpleMatrix(nslawSize, nslawSize));
+        interactionBlocksKey(osi, ds[k], key);
+        previous = previousKeys.find(ds[k]->number());
+        same = same && previous != previousKeys.end() && key == previous->second;
+        _interactionBlocksKeys[ds[k]->number()] = key;
       }
+      timeInvariant[indexSet->index(*vi)] = same;
+    }
+  }
 
-      if (!isLinear || !_hasBeenUpdated)
-      {
-        computeDiagonalInteractionBlock(*vi);
-      }
+  // The blocks to be computed are listed first, with the memory
+  // allocations, then they are computed, possibly in parallel: each
+  // block is written by a single task.
+  std::vector<InteractionsGraph::VDescriptor> diagonalBlocks;
+  std::vector<InteractionBlockTask> extraDiagonalBlocks;
+  std::map<SiconosMatrix*, unsigned int> extraDiagonalBlockNumber;
+
+  // we put diagonal informations on vertices
+  // self loops with bgl are a *nightmare* at the moment
+  // (patch 65198 on standard boost install)
+
+  InteractionsGraph::VIterator vi, viend;
+  for (std11::tie(vi, viend) = indexSet->vertices();
+       vi != viend; ++vi)
+  {
+    SP::Interaction inter = indexSet->bundle(*vi);
+    unsigned int nslawSize = inter->nonSmoothLaw()->size();
+    if (! indexSet->properties(*vi).block)
+    {
+      indexSet->properties(*vi).block.reset(new SimpleMatrix(nslawSize, nslawSize));
     }
 
-    /* interactionBlock must be zeroed at init */
-    std::vector<bool> initialized;
-    initialized.resize(indexSet->edges_number());
-    std::fill(initialized.begin(), initialized.end(), false);
+    SP::SiconosMatrix block = indexSet->properties(*vi).block;
+    if (compute && timeInvariant[indexSet->index(*vi)] && previousInteractionBlocks.count(block))
+      _reusedInteractionBlocks.insert(block);
+    _computedInteractionBlocks.insert(block);
+
+    if (compute)
+    {
+      // still called for a kept block, for the problems that
+      // gather informations on the interactions in this function
+      diagonalBlocks.push_back(*vi);
+    }
+  }
+
+  if (indexSet->properties().symmetric)
+  {
+    DEBUG_PRINT("OneStepNSProblem::updateInteractionBlocks(). Symmetric case");
 
     InteractionsGraph::EIterator ei, eiend;
     for (std11::tie(ei, eiend) = indexSet->edges();
@@ -180,21 +369,25 @@ void OneStepNSProblem::updateInteractionBlocks()
         currentInteractionBlock = indexSet->properties(ed1).lower_block;
       }
 
-      if (!initialized[indexSet->index(ed1)])
+      bool reuse = compute && timeInvariant[isrc] && timeInvariant[itar]
+        && previousInteractionBlocks.count(currentInteractionBlock);
+      _computedInteractionBlocks.insert(currentInteractionBlock);
+      if (reuse)
       {
-        initialized[indexSet->index(ed1)] = true;
-        currentInteractionBlock->zero();
+        _reusedInteractionBlocks.insert(currentInteractionBlock);
+        continue;
       }
-      if (!isLinear || !_hasBeenUpdated)
+
+      InteractionBlockTask& task = extraDiagonalBlockTask(extraDiagonalBlocks, extraDiagonalBlockNumber,
+                                                          currentInteractionBlock);
+      if (compute)
       {
-        {
-          computeInteractionBlock(*ei);
-        }
+        task.edges.push_back(*ei);
 
         // allocation for transposed block
         // should be avoided
 
-        if (itar > isrc) // upper block has been computed
+        if (itar > isrc) // upper block is computed
         {
           if (!indexSet->properties(ed1).lower_block)
           {
@@ -202,20 +395,20 @@ void OneStepNSProblem::updateInteractionBlocks()
             reset(new SimpleMatrix(indexSet->properties(ed1).upper_block->size(1),
                                    indexSet->properties(ed1).upper_block->size(0)));
           }
-          indexSet->properties(ed1).lower_block->trans(*indexSet->properties(ed1).upper_block);
           indexSet->properties(ed2).lower_block = indexSet->properties(ed1).lower_block;
+          task.transposed = indexSet->properties(ed1).lower_block;
         }
         else
         {
-          assert(itar < isrc);    // lower block has been computed
+          assert(itar < isrc);    // lower block is computed
           if (!indexSet->properties(ed1).upper_block)
           {
             indexSet->properties(ed1).upper_block.
             reset(new SimpleMatrix(indexSet->properties(ed1).lower_block->size(1),
                                    indexSet->properties(ed1).lower_block->size(0)));
           }
-          indexSet->properties(ed1).upper_block->trans(*indexSet->properties(ed1).lower_block);
           indexSet->properties(ed2).upper_block = indexSet->properties(ed1).upper_block;
+          task.transposed = indexSet->properties(ed1).upper_block;
         }
       }
     }
@@ -224,54 +417,11 @@ void OneStepNSProblem::updateInteractionBlocks()
   {
     DEBUG_PRINT("OneStepNSProblem::updateInteractionBlocks(). Non symmetric case\n");
 
-    InteractionsGraph::VIterator vi, viend;
-
     for (std11::tie(vi, viend) = indexSet->vertices();
          vi != viend; ++vi)
     {
-      DEBUG_PRINT("OneStepNSProblem::updateInteractionBlocks(). Computation of diaganal block\n");
-      SP::Interaction inter = indexSet->bundle(*vi);
-      unsigned int nslawSize = inter->nonSmoothLaw()->size();
-      if (! indexSet->properties(*vi).block)
-      {
-        indexSet->properties(*vi).block.reset(new SimpleMatrix(nslawSize, nslawSize));
-      }
-
-      if (!isLinear || !_hasBeenUpdated)
-      {
-        computeDiagonalInteractionBlock(*vi);
-      }
-
       /* on a undirected graph, out_edges gives all incident edges */
       InteractionsGraph::OEIterator oei, oeiend;
-      /* interactionBlock must be zeroed at init */
-      std::map<SP::SiconosMatrix, bool> initialized;
-      for (std11::tie(oei, oeiend) = indexSet->out_edges(*vi);
-           oei != oeiend; ++oei)
-      {
-        /* on adjoint graph there is at most 2 edges between source and target */
-        InteractionsGraph::EDescriptor ed1, ed2;
-        std11::tie(ed1, ed2) = indexSet->edges(indexSet->source(*oei), indexSet->target(*oei));
-        if (indexSet->properties(ed1).upper_block)
-        {
-          initialized[indexSet->properties(ed1).upper_block] = false;
-        }
-        // if(indexSet->properties(ed2).upper_block)
-        // {
-        //   initialized[indexSet->properties(ed2).upper_block] = false;
-        // }
-
-        if (indexSet->properties(ed1).lower_block)
-        {
-          initialized[indexSet->properties(ed1).lower_block] = false;
-        }
-        // if(indexSet->properties(ed2).lower_block)
-        // {
-        //   initialized[indexSet->properties(ed2).lower_block] = false;
-        // }
-
-      }
-
       for (std11::tie(oei, oeiend) = indexSet->out_edges(*vi);
            oei != oeiend; ++oei)
       {
@@ -302,7 +452,6 @@ void OneStepNSProblem::updateInteractionBlocks()
           if (! indexSet->properties(ed1).upper_block)
           {
             indexSet->properties(ed1).upper_block.reset(new SimpleMatrix(nslawSize1, nslawSize2));
-            initialized[indexSet->properties(ed1).upper_block] = false;
             if (ed2 != ed1)
               indexSet->properties(ed2).upper_block = indexSet->properties(ed1).upper_block;
           }
@@ -314,31 +463,90 @@ void OneStepNSProblem::updateInteractionBlocks()
           if (! indexSet->properties(ed1).lower_block)
           {
             indexSet->properties(ed1).lower_block.reset(new SimpleMatrix(nslawSize1, nslawSize2));
-            initialized[indexSet->properties(ed1).lower_block] = false;
             if (ed2 != ed1)
               indexSet->properties(ed2).lower_block = indexSet->properties(ed1).lower_block;
           }
           currentInteractionBlock = indexSet->properties(ed1).lower_block;
         }
 
-
-        if (!initialized[currentInteractionBlock])
-        {
-          initialized[currentInteractionBlock] = true;
-          currentInteractionBlock->zero();
-        }
-
-        if (!isLinear || !_hasBeenUpdated)
+        bool reuse = compute && timeInvariant[isrc] && timeInvariant[itar]
+          && previousInteractionBlocks.count(currentInteractionBlock);
+        _computedInteractionBlocks.insert(currentInteractionBlock);
+        if (reuse)
         {
-          if (isrc != itar)
-            computeInteractionBlock(*oei);
+          _reusedInteractionBlocks.insert(currentInteractionBlock);
+          continue;
         }
 
+        InteractionBlockTask& task = extraDiagonalBlockTask(extraDiagonalBlocks, extraDiagonalBlockNumber,
+                                                            currentInteractionBlock);
+        if (compute && isrc != itar)
+          task.edges.push_back(*oei);
       }
     }
   }
 
+  // === Computation of the blocks ===
+#ifdef _OPENMP
+  int nthreads = 1;
+  if (compute && _interactionBlocksThreadsNumber != 1)
+  {
+    nthreads = (_interactionBlocksThreadsNumber > 0) ?
+      _interactionBlocksThreadsNumber : omp_get_max_threads();
+    if (nthreads > 1 && !initializeParallelInteractionBlocks(nthreads))
+      nthreads = 1;
+  }
+  DEBUG_PRINTF("OneStepNSProblem::updateInteractionBlocks(). computation with %i thread(s)\n", nthreads);
+#endif
+
+  int nbDiagonalBlocks = diagonalBlocks.size();
+  int i;
+  ParallelLoopError diagonalError;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) if(nthreads > 1) schedule(dynamic, 16)
+#endif
+  for (i = 0; i < nbDiagonalBlocks; ++i)
+  {
+    try
+    {
+      computeDiagonalInteractionBlock(diagonalBlocks[i]);
+    }
+    catch (...)
+    {
+      diagonalError.catchException(i);
+    }
+  }
+  if (diagonalError.failed())
+  {
+    // the failed block is computed again to throw its exception
+    computeDiagonalInteractionBlock(diagonalBlocks[diagonalError.index()]);
+    diagonalError.rethrow();
+  }
 
+  int nbExtraDiagonalBlocks = extraDiagonalBlocks.size();
+  ParallelLoopError extraDiagonalError;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) if(nthreads > 1) schedule(dynamic, 16)
+#endif
+  for (i = 0; i < nbExtraDiagonalBlocks; ++i)
+  {
+    try
+    {
+      computeExtraDiagonalBlock(*this, extraDiagonalBlocks[i]);
+    }
+    catch (...)
+    {
+      extraDiagonalError.catchException(i);
+    }
+  }
+  if (extraDiagonalError.failed())
+  {
+    computeExtraDiagonalBlock(*this, extraDiagonalBlocks[extraDiagonalError.index()]);
+    extraDiagonalError.rethrow();
+  }
+
+  DEBUG_PRINTF("OneStepNSProblem::updateInteractionBlocks(). %zu blocks, %zu reused\n",
+               _computedInteractionBlocks.size(), _reusedInteractionBlocks.size());
   DEBUG_EXPR(displayBlocks(indexSet););
 
   DEBUG_PRINT("OneStepNSProblem::updateInteractionBlocks() ends\n");
@@ -388,6 +596,25 @@ void OneStepNSProblem::displayBlocks(SP::InteractionsGraph indexSet)
   }
 }
 
+SP::Profiler OneStepNSProblem::profiler() const
+{
+  return _simulation ? _simulation->profiler() : SP::Profiler();
+}
+
+int OneStepNSProblem::numericsIterations() const
+{
+  if (!_numerics_solver_options)
+    return 0;
+  int id = _numerics_solver_options->solverId;
+  // the 3D friction solvers, except the nonsmooth Newton ones, store
+  // the number of iterations in iparam[7]
+  if (id >= SICONOS_FRICTION_3D_NSGS && id <= SICONOS_GLOBAL_FRICTION_3D_GAMS_PATHVI
+      && id != SICONOS_FRICTION_3D_NSN_AC && id != SICONOS_FRICTION_3D_NSN_FB
+      && id != SICONOS_FRICTION_3D_NSN_NM && id != SICONOS_GLOBAL_FRICTION_3D_NSN_AC)
+    return _numerics_solver_options->iparam[7];
+  return _numerics_solver_options->iparam[SICONOS_IPARAM_ITER_DONE];
+}
+
 void OneStepNSProblem::initialize(SP::Simulation sim)
 {
   // Link with the simulation that owns this osnsp
@@ -515,3 +742,8 @@ void OneStepNSProblem::setNumericsVerboseMode(bool vMode)
 {
   _numerics_options->verboseMode = vMode;
 }
+
+void OneStepNSProblem::setNumericsThreadsNumber(int n)
+{
+  _numerics_options->threadsNumber = n;
+}
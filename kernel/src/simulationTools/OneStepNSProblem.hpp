@@ -25,6 +25,11 @@
 #include "SiconosFwd.hpp"
 #include "SimulationTypeDef.hpp"
 #include "SimulationGraphs.hpp"
+#include "Profiler.hpp"
+
+#include <set>
+#include <map>
+#include <vector>
 
 /** Non Smooth Problem Formalization and Simulation
 
@@ -120,6 +125,33 @@ protected:
   /*During Newton it, this flag allows to update the numerics matrices only once if necessary.*/
   bool _hasBeenUpdated;
 
+  /** if true, the blocks of the interactions computed at the previous
+      call of updateInteractionBlocks are kept, as long as the
+      jacobians of their relations and the keys of their dynamical
+      systems do not change */
+  bool _reuseInteractionBlocks;
+
+  /** keys of the dynamical systems of the interactions at the last
+      call of updateInteractionBlocks, indexed by the number of the
+      dynamical system (see interactionBlocksKey) */
+  std::map<int, std::vector<double> > _interactionBlocksKeys;
+
+  /** jacobians of the lagrangian and Newton-Euler relations at the
+      last call of updateInteractionBlocks, indexed by the number of
+      the interaction (empty for a linear time invariant relation) */
+  std::map<int, std::vector<double> > _relationKeys;
+
+  /** number of threads used to compute the interaction blocks, 1 for
+      sequential, 0 for the OpenMP default */
+  int _interactionBlocksThreadsNumber;
+
+  /** blocks computed or kept during the last call of updateInteractionBlocks */
+  std::set<SP::SiconosMatrix> _computedInteractionBlocks;
+
+  /** blocks kept from the previous step during the last call of
+      updateInteractionBlocks */
+  std::set<SP::SiconosMatrix> _reusedInteractionBlocks;
+
   // --- CONSTRUCTORS/DESTRUCTOR ---
   /** default constructor
    */
@@ -137,6 +169,20 @@ private:
    */
   OneStepNSProblem& operator=(const OneStepNSProblem& osnsp);
 
+  /** compute the data, other than the interaction, on which the blocks
+   *  of an interaction depend for one of its dynamical systems: the
+   *  time step, theta and gamma of the integrator and the stamp of its
+   *  matrix W (DynamicalSystemsGraph::WStamp), incremented by the
+   *  integrator each time W may change. The key contains a NaN, hence
+   *  differs from any other key, if the integrator is not a
+   *  theta-method.
+   *  \param osi the integrator of the dynamical system
+   *  \param ds the dynamical system
+   *  \param[out] key the key
+   */
+  void interactionBlocksKey(SP::OneStepIntegrator osi, SP::DynamicalSystem ds,
+                            std::vector<double>& key);
+
 public:
   /**  constructor with a solver from Numerics
    *  \param numericsSolverId id of numerics solver, see Numerics for the meaning
@@ -190,6 +236,17 @@ public:
     return _simulation;
   }
 
+  /** get the timers and counters of the Simulation
+   *  \return a SP::Profiler, null if the problem is not initialized
+   */
+  SP::Profiler profiler() const;
+
+  /** get the number of iterations done by the last call of the
+   *  Numerics solver, as stored by the solver in its options
+   *  \return an int
+   */
+  int numericsIterations() const;
+
   /** set the Simulation of the OneStepNSProblem
    *  \param newS a pointer to Simulation
    */
@@ -261,6 +318,21 @@ public:
    */
   void setNumericsVerboseMode(bool vMode);
 
+  /** set the number of threads of the Numerics matrix-vector products
+      \param n 1 for sequential, 0 for the OpenMP default
+   */
+  void setNumericsThreadsNumber(int n);
+
+  /** set the number of threads used to compute the interaction
+      blocks. Without OpenMP, or if the problem does not support it,
+      the blocks are computed sequentially.
+      \param n 1 for sequential (default), 0 for the OpenMP default
+   */
+  void setInteractionBlocksThreadsNumber(int n)
+  {
+    _interactionBlocksThreadsNumber = n;
+  }
+
   /** reset stat (nbIter and CPUtime)
    */
   inline void resetStat()
@@ -292,6 +364,16 @@ public:
    */
   virtual void updateInteractionBlocks();
 
+  /** prepare the computation of the interaction blocks by several
+   *  threads
+   *  \param nthreads the number of threads
+   *  \return false if the blocks must be computed sequentially
+   */
+  virtual bool initializeParallelInteractionBlocks(unsigned int nthreads)
+  {
+    return false;
+  }
+
   /** compute extra-diagonal interactionBlock-matrix
    *  \param ed an edge descriptor
    */
@@ -302,6 +384,48 @@ public:
    */
   virtual void computeDiagonalInteractionBlock(const InteractionsGraph::VDescriptor& vd) = 0;
 
+  /** set the reuse of the interaction blocks between two steps. A
+   *  block is computed again if the jacobians of the relations, the
+   *  time step, theta or gamma of the integrator or the matrix W of
+   *  one of its dynamical systems have changed. The jacobians are
+   *  compared for the lagrangian and Newton-Euler relations and are
+   *  constant for the linear time invariant ones; the blocks of the
+   *  other relations are always computed.
+   *  \param v true to keep the blocks (default), false to compute
+   *  them at each step
+   */
+  void setReuseInteractionBlocks(bool v)
+  {
+    _reuseInteractionBlocks = v;
+  }
+
+  /** get the number of interaction blocks handled during the last call
+   *  of updateInteractionBlocks
+   *  \return unsigned int
+   */
+  unsigned int numberOfInteractionBlocks() const
+  {
+    return _computedInteractionBlocks.size();
+  }
+
+  /** get the number of interaction blocks kept from the previous step
+   *  during the last call of updateInteractionBlocks
+   *  \return unsigned int
+   */
+  unsigned int numberOfReusedInteractionBlocks() const
+  {
+    return _reusedInteractionBlocks.size();
+  }
+
+  /** get the ratio of interaction blocks kept from the previous step
+   *  \return double, in [0, 1]
+   */
+  double interactionBlocksReuseRatio() const
+  {
+    return _computedInteractionBlocks.empty() ? 0. :
+      (double) _reusedInteractionBlocks.size() / _computedInteractionBlocks.size();
+  }
+
   /**
    * \return bool _hasBeenUpdated
    */
@@ -0,0 +1,123 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/*! \file ParallelLoopError.hpp
+ */
+
+#ifndef ParallelLoopError_hpp
+#define ParallelLoopError_hpp
+
+#include "RuntimeException.hpp"
+#include <string>
+#include <exception>
+
+/** Exception raised in an iteration of an OpenMP parallel loop
+ *
+ * An exception must not escape an OpenMP parallel region: each
+ * iteration catches it and calls catchException(), which keeps the
+ * index of the first failed iteration in the loop order. After the
+ * loop, the caller runs this iteration again, serially, so that the
+ * original exception is thrown with its type, as in a serial loop:
+ *
+ * \code
+ * ParallelLoopError error;
+ * #pragma omp parallel for
+ * for (i = 0; i < n; ++i)
+ * {
+ *   try { f(i); }
+ *   catch (...) { error.catchException(i); }
+ * }
+ * if (error.failed())
+ * {
+ *   f(error.index());
+ *   error.rethrow();
+ * }
+ * \endcode
+ *
+ * rethrow() throws a RuntimeException with the report of the first
+ * exception, in case the iteration succeeds the second time.
+ */
+class ParallelLoopError
+{
+private:
+
+  /** index of the first failed iteration, -1 if none */
+  int _index;
+
+  /** report of the exception of this iteration */
+  std::string _report;
+
+public:
+
+  /** constructor */
+  ParallelLoopError(): _index(-1) {};
+
+  /** record the exception being handled, to be called in a catch
+   *  block
+   *  \param i the index of the iteration
+   */
+  void catchException(int i)
+  {
+    std::string r;
+    try
+    {
+      throw;
+    }
+    catch (SiconosException& e)
+    {
+      r = e.report();
+    }
+    catch (std::exception& e)
+    {
+      r = e.what();
+    }
+    catch (...)
+    {
+      r = "unknown exception";
+    }
+#ifdef _OPENMP
+#pragma omp critical(ParallelLoopError)
+#endif
+    if (_index < 0 || i < _index)
+    {
+      _index = i;
+      _report = r;
+    }
+  }
+
+  /** \return true if an iteration has thrown an exception */
+  bool failed() const
+  {
+    return _index >= 0;
+  }
+
+  /** \return the index of the first failed iteration */
+  int index() const
+  {
+    return _index;
+  }
+
+  /** throw a RuntimeException with the report of the first
+   *  exception, if any */
+  void rethrow() const
+  {
+    if (_index >= 0)
+      RuntimeException::selfThrow(_report);
+  }
+};
+
+#endif
@@ -0,0 +1,204 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "Profiler.hpp"
+#include "RuntimeException.hpp"
+
+#include <ctime>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+Profiler::Profiler(): _trace(false), _steps(0), _origin(now())
+{
+}
+
+bool Profiler::enabled()
+{
+#ifdef WITH_TIMERS
+  return true;
+#else
+  return false;
+#endif
+}
+
+double Profiler::now()
+{
+#if defined(HAVE_TIME_H) && defined(CLOCK_MONOTONIC)
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec + 1e-9 * (double)t.tv_nsec;
+#else
+  return (double)std::clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+void Profiler::start(const std::string& name)
+{
+  Records::iterator it = _records.insert(std::make_pair(name, Record())).first;
+  _stack.push_back(std::make_pair(it, now()));
+}
+
+void Profiler::stop()
+{
+  if (_stack.empty())
+    RuntimeException::selfThrow("Profiler::stop - no phase has been started.");
+
+  double end = now();
+  Records::iterator it = _stack.back().first;
+  double start = _stack.back().second;
+  _stack.pop_back();
+
+  Record& r = it->second;
+  r.calls++;
+  r.stepCalls++;
+  r.time += end - start;
+  r.stepTime += end - start;
+
+  if (_trace)
+  {
+    Event e;
+    e.name = it->first;
+    e.start = start - _origin;
+    e.duration = end - start;
+    e.depth = _stack.size();
+    _events.push_back(e);
+  }
+}
+
+void Profiler::count(const std::string& name, double value)
+{
+  Record& r = _records[name];
+  r.count += value;
+  r.stepCount += value;
+}
+
+void Profiler::newStep()
+{
+  for (Records::iterator it = _records.begin(); it != _records.end(); ++it)
+  {
+    it->second.stepCalls = 0;
+    it->second.stepTime = 0.;
+    it->second.stepCount = 0.;
+  }
+  _steps++;
+}
+
+void Profiler::clear()
+{
+  if (!_stack.empty())
+    RuntimeException::selfThrow("Profiler::clear - a phase is being timed.");
+  _records.clear();
+  _events.clear();
+  _steps = 0;
+  _origin = now();
+}
+
+std::vector<std::string> Profiler::names() const
+{
+  std::vector<std::string> n;
+  n.reserve(_records.size());
+  for (Records::const_iterator it = _records.begin(); it != _records.end(); ++it)
+    n.push_back(it->first);
+  return n;
+}
+
+const Profiler::Record* Profiler::record(const std::string& name) const
+{
+  Records::const_iterator it = _records.find(name);
+  return (it == _records.end()) ? 0 : &it->second;
+}
+
+unsigned long Profiler::calls(const std::string& name) const
+{
+  const Record* r = record(name);
+  return r ? r->calls : 0;
+}
+
+double Profiler::time(const std::string& name) const
+{
+  const Record* r = record(name);
+  return r ? r->time : 0.;
+}
+
+unsigned long Profiler::stepCalls(const std::string& name) const
+{
+  const Record* r = record(name);
+  return r ? r->stepCalls : 0;
+}
+
+double Profiler::stepTime(const std::string& name) const
+{
+  const Record* r = record(name);
+  return r ? r->stepTime : 0.;
+}
+
+double Profiler::counter(const std::string& name) const
+{
+  const Record* r = record(name);
+  return r ? r->count : 0.;
+}
+
+double Profiler::stepCounter(const std::string& name) const
+{
+  const Record* r = record(name);
+  return r ? r->stepCount : 0.;
+}
+
+bool Profiler::writeChromeTrace(const std::string& filename) const
+{
+  std::ofstream out(filename.c_str());
+  if (!out)
+    return false;
+
+  /* complete events ("ph": "X"), times in microseconds. The depth is
+   * used as thread id so that nested phases are drawn on separate
+   * lines. */
+  out << "{\"traceEvents\": [" << std::endl;
+  out << std::setprecision(15);
+  for (std::vector<Event>::const_iterator it = _events.begin(); it != _events.end(); ++it)
+  {
+    if (it != _events.begin())
+      out << "," << std::endl;
+    out << "{\"name\": \"" << it->name << "\", \"cat\": \"siconos\", \"ph\": \"X\""
+        << ", \"ts\": " << 1e6 * it->start
+        << ", \"dur\": " << 1e6 * it->duration
+        << ", \"pid\": 0, \"tid\": " << it->depth << "}";
+  }
+  out << std::endl << "], \"displayTimeUnit\": \"ms\"}" << std::endl;
+  return out.good();
+}
+
+void Profiler::display() const
+{
+  std::cout << "===== Profiler: " << _steps << " steps =====" << std::endl;
+  if (!enabled())
+    std::cout << "siconos is built without WITH_TIMERS, nothing is recorded." << std::endl;
+  std::cout << std::left << std::setw(50) << "phase" << std::right
+            << std::setw(12) << "calls" << std::setw(14) << "time (s)"
+            << std::setw(14) << "step (s)" << std::setw(14) << "counter" << std::endl;
+  for (Records::const_iterator it = _records.begin(); it != _records.end(); ++it)
+  {
+    const Record& r = it->second;
+    std::cout << std::left << std::setw(50) << it->first << std::right
+              << std::setw(12) << r.calls << std::setw(14) << r.time
+              << std::setw(14) << r.stepTime << std::setw(14) << r.count << std::endl;
+  }
+  std::cout << "===============================" << std::endl;
+}
@@ -0,0 +1,250 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/*! \file Profiler.hpp
+  \brief Timers and counters of the phases of a simulation
+*/
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include "SiconosConfig.h"
+#include "SiconosPointers.hpp"
+#include "SiconosFwd.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+/** Timers and counters of the phases of a simulation.
+ *
+ * A phase is identified by its name, for instance
+ * "TimeStepping::newtonSolve", "MoreauJeanOSI::computeFreeState" or
+ * "FrictionContact::solve". For each phase, the number of calls and
+ * the wall time are accumulated over the whole simulation and over
+ * the current step, see newStep(). Counters, like the number of
+ * iterations of the numerics solvers, are accumulated the same way
+ * with count().
+ *
+ * The Simulation owns a Profiler, filled by the kernel through the
+ * SICONOS_PROFILE and SICONOS_PROFILE_COUNT macros. These macros
+ * expand to nothing unless siconos is built with WITH_TIMERS, see
+ * enabled().
+ *
+ * When the trace is on, each timed call is also stored as an event,
+ * and the events can be written in the Chrome trace format (to be
+ * loaded in chrome://tracing) with writeChromeTrace().
+ */
+class Profiler
+{
+private:
+
+  /** accumulated values of a phase */
+  struct Record
+  {
+    Record(): calls(0), time(0.), stepCalls(0), stepTime(0.),
+              count(0.), stepCount(0.) {};
+    unsigned long calls;
+    double time;
+    unsigned long stepCalls;
+    double stepTime;
+    double count;
+    double stepCount;
+  };
+
+  /** a timed call, for the trace */
+  struct Event
+  {
+    std::string name;
+    double start;
+    double duration;
+    unsigned int depth;
+  };
+
+  typedef std::map<std::string, Record> Records;
+
+  /** the phases and counters, by name */
+  Records _records;
+
+  /** the phases being timed, innermost last */
+  std::vector<std::pair<Records::iterator, double> > _stack;
+
+  /** the timed calls, if _trace is true */
+  std::vector<Event> _events;
+
+  /** keep the timed calls */
+  bool _trace;
+
+  /** number of steps, see newStep() */
+  unsigned long _steps;
+
+  /** origin of the times of the events */
+  double _origin;
+
+  /** copy constructor. Private => no copy nor pass-by value. */
+  Profiler(const Profiler&);
+
+  /** assignment. Private => no copy nor pass-by value. */
+  Profiler& operator=(const Profiler&);
+
+  /** get the record of a name, null if not found */
+  const Record* record(const std::string& name) const;
+
+public:
+
+  /** default constructor */
+  Profiler();
+
+  /** destructor */
+  virtual ~Profiler() {};
+
+  /** \return true if siconos is built with the timers (WITH_TIMERS)
+   *  i.e. if the simulation fills the profiler
+   */
+  static bool enabled();
+
+  /** \return the current wall time in seconds */
+  static double now();
+
+  /** start the timer of a phase. The phases may be nested and
+   *  must be stopped in the reverse order.
+   *  \param name the name of the phase
+   */
+  void start(const std::string& name);
+
+  /** stop the timer of the last started phase */
+  void stop();
+
+  /** add a value to a counter
+   *  \param name the name of the counter
+   *  \param value the value to add
+   */
+  void count(const std::string& name, double value);
+
+  /** start a new step: the values of the current step are reset */
+  void newStep();
+
+  /** remove all the phases, counters and events */
+  void clear();
+
+  /** \return the names of the phases and counters */
+  std::vector<std::string> names() const;
+
+  /** \return the number of steps */
+  inline unsigned long steps() const
+  {
+    return _steps;
+  };
+
+  /** \param name the name of the phase
+   *  \return the number of calls of the phase */
+  unsigned long calls(const std::string& name) const;
+
+  /** \param name the name of the phase
+   *  \return the time spent in the phase, in seconds */
+  double time(const std::string& name) const;
+
+  /** \param name the name of the phase
+   *  \return the number of calls of the phase during the current step */
+  unsigned long stepCalls(const std::string& name) const;
+
+  /** \param name the name of the phase
+   *  \return the time spent in the phase during the current step, in seconds */
+  double stepTime(const std::string& name) const;
+
+  /** \param name the name of the counter
+   *  \return the value of the counter */
+  double counter(const std::string& name) const;
+
+  /** \param name the name of the counter
+   *  \return the value of the counter during the current step */
+  double stepCounter(const std::string& name) const;
+
+  /** keep (or not) each timed call for writeChromeTrace()
+   *  \param b true to keep the calls
+   */
+  inline void setTrace(bool b)
+  {
+    _trace = b;
+  };
+
+  /** \return true if the timed calls are kept */
+  inline bool trace() const
+  {
+    return _trace;
+  };
+
+  /** write the timed calls in the Chrome trace format
+   *  \param filename the name of the json file
+   *  \return true if the file has been written
+   */
+  bool writeChromeTrace(const std::string& filename) const;
+
+  /** print the phases and counters */
+  void display() const;
+};
+
+/** Time a phase of the simulation from its construction to its
+ *  destruction, see SICONOS_PROFILE.
+ */
+class ProfilerScope
+{
+private:
+  Profiler* _profiler;
+
+  ProfilerScope(const ProfilerScope&);
+  ProfilerScope& operator=(const ProfilerScope&);
+
+public:
+
+  /** start the phase
+   *  \param profiler the profiler, may be null
+   *  \param name the name of the phase
+   */
+  ProfilerScope(SP::Profiler profiler, const std::string& name):
+    _profiler(profiler.get())
+  {
+    if (_profiler)
+      _profiler->start(name);
+  };
+
+  /** stop the phase */
+  ~ProfilerScope()
+  {
+    if (_profiler)
+      _profiler->stop();
+  };
+};
+
+#define SICONOS_PROFILE_CONCAT_(a, b) a ## b
+#define SICONOS_PROFILE_CONCAT(a, b) SICONOS_PROFILE_CONCAT_(a, b)
+
+#ifdef WITH_TIMERS
+/** time the phase name until the end of the current scope with
+ *  profiler (a SP::Profiler, may be null) */
+#define SICONOS_PROFILE(profiler, name)                                 \
+  ProfilerScope SICONOS_PROFILE_CONCAT(_profilerScope, __LINE__)(profiler, name)
+/** add value to the counter name of profiler (a SP::Profiler, may be null) */
+#define SICONOS_PROFILE_COUNT(profiler, name, value)                    \
+  do { if (profiler) (profiler)->count(name, value); } while (0)
+#else
+#define SICONOS_PROFILE(profiler, name)
+#define SICONOS_PROFILE_COUNT(profiler, name, value)
+#endif
+
+#endif
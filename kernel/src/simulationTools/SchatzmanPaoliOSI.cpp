@@ -202,6 +202,9 @@ void SchatzmanPaoliOSI::initW(double t, SP::DynamicalSystem ds, DynamicalSystems
   }
   else RuntimeException::selfThrow("SchatzmanPaoliOSI::initW - not yet implemented for Dynamical system type :" + dsType);
 
+  // a new W, see MoreauJeanOSI::initW
+  ++_dynamicalSystemsGraph->WStamp[dsv];
+
   // Remark: W is not LU-factorized nor inversed here.
   // Function PLUForwardBackward will do that if required.
 
@@ -71,6 +71,7 @@ Simulation::Simulation(SP::TimeDiscretisation td):
   _allOSI.reset(new OSISet());
   _allNSProblems.reset(new OneStepNSProblems());
   _eventsManager.reset(new EventsManager(td)); //
+  _profiler.reset(new Profiler());
 }
 
 // --- Destructor ---
@@ -159,6 +160,7 @@ void Simulation::updateIndexSets()
 {
 
   DEBUG_BEGIN("Simulation::updateIndexSets()\n");
+  SICONOS_PROFILE(_profiler, "Simulation::updateIndexSets");
   // update I0 indices
   unsigned int nindexsets = _nsds->topology()->indexSetsSize();
 
@@ -336,6 +338,7 @@ int Simulation::computeOneStepNSProblem(int Id)
     RuntimeException::selfThrow("Simulation - computeOneStepNSProblem, OneStepNSProblem == NULL, Id: " + Id);
 
   DEBUG_END("Simulation::computeOneStepNSProblem(int Id)\n");
+  SICONOS_PROFILE(_profiler, Type::name(*(*_allNSProblems)[Id]) + "::compute");
   return (*_allNSProblems)[Id]->compute(nextTime());
 
 
@@ -25,6 +25,7 @@
 #include "SiconosConst.hpp"
 #include "SimulationTypeDef.hpp"
 #include "SiconosFwd.hpp"
+#include "Profiler.hpp"
 // #include "EventsManager.hpp"
 // #include "SiconosPointers.hpp"
 // #include "DynamicalSystemsSet.hpp"
@@ -149,6 +150,9 @@ protected:
    */
   double _relativeConvergenceTol;
 
+  /** timers and counters of the phases of the simulation */
+  SP::Profiler _profiler;
+
   /** initializations of levels
    *
    */
@@ -158,7 +162,7 @@ protected:
 
   /** default constructor.
    */
-  Simulation() {};
+  Simulation(): _profiler(new Profiler()) {};
 
 
 
@@ -373,6 +377,15 @@ public:
     return _nsds;
   }
 
+  /** get the timers and counters of the phases of the simulation.
+   *  They are filled only if siconos is built with WITH_TIMERS.
+   *  \return a SP::Profiler
+   */
+  inline SP::Profiler profiler() const
+  {
+    return _profiler;
+  }
+
   /** get tolerance
    *  \return a double
    */
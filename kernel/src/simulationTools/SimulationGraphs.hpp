@@ -148,6 +148,7 @@ struct DynamicalSystemsGraph : public _DynamicalSystemsGraph
                            ((VertexSP, SiconosVector, tmpXdot)) // For Controlled System (nonlinear w.r.t u); tmpXdot = g(x, u)
                            ((VertexSP, SimpleMatrix, jacgx)) // For Controlled System (nonlinear w.r.t u); jacgx = nabla_x g(x, u)
                            ((Vertex, std::string, name)) // a name for a dynamical system
+                           ((Vertex, unsigned int, WStamp)) // incremented by the integrator each time W may change
                            ((Vertex, unsigned int, groupId))); // For group manipulations (example assign
                                                                // a material id for contact law
                                                                // determination
@@ -174,6 +175,7 @@ struct DynamicalSystemsGraph : public _DynamicalSystemsGraph
     tmpXdot._store->erase(vd);
     jacgx._store->erase(vd);
     name._store->erase(vd);
+    WStamp._store->erase(vd);
     groupId._store->erase(vd);
   }
 };
@@ -339,22 +339,30 @@ void TimeStepping::initOSNS()
 
 void TimeStepping::nextStep()
 {
+  SICONOS_PROFILE(_profiler, "TimeStepping::nextStep");
   processEvents();
 }
 
 void TimeStepping::update(unsigned int levelInput)
 {
   DEBUG_BEGIN("TimeStepping::update(unsigned int levelInput)\n");
+  SICONOS_PROFILE(_profiler, "TimeStepping::update");
   // 1 - compute input (lambda -> r)
   if (!_allNSProblems->empty())
+  {
+    SICONOS_PROFILE(_profiler, "TimeStepping::updateInput");
     _nsds->updateInput(nextTime(),levelInput);
+  }
 
 
   
   // 2 - compute state for each dynamical system
   OSIIterator itOSI;
   for (itOSI = _allOSI->begin(); itOSI != _allOSI->end() ; ++itOSI)
+  {
+    SICONOS_PROFILE(_profiler, Type::name(**itOSI) + "::updateState");
     (*itOSI)->updateState(levelInput);
+  }
   /*Because the dof of DS have been updated,
     the world (CAO for example) must be updated.*/
   updateWorldFromDS();
@@ -362,6 +370,7 @@ void TimeStepping::update(unsigned int levelInput)
   // 3 - compute output ( x ... -> y)
   if (!_allNSProblems->empty())
   {
+    SICONOS_PROFILE(_profiler, "TimeStepping::updateOutput");
     for (unsigned int level = _levelMinForOutput;
          level < _levelMaxForOutput + 1;
          level++)
@@ -373,7 +382,11 @@ void TimeStepping::update(unsigned int levelInput)
 
 void TimeStepping::computeFreeState()
 {
-  std::for_each(_allOSI->begin(), _allOSI->end(), std11::bind(&OneStepIntegrator::computeFreeState, _1));
+  for (OSIIterator it = _allOSI->begin(); it != _allOSI->end() ; ++it)
+  {
+    SICONOS_PROFILE(_profiler, Type::name(**it) + "::computeFreeState");
+    (*it)->computeFreeState();
+  }
 }
 
 // compute simulation between current and next event.  Initial
@@ -388,6 +401,7 @@ void TimeStepping::computeOneStep()
 void TimeStepping::initializeNewtonLoop()
 {
   DEBUG_BEGIN("TimeStepping::initializeNewtonLoop()\n");
+  SICONOS_PROFILE(_profiler, "TimeStepping::initializeNewtonLoop");
   double tkp1 = getTkp1();
   assert(!isnan(tkp1));
 
@@ -448,6 +462,10 @@ void TimeStepping::run()
 void TimeStepping::advanceToEvent()
 {
   DEBUG_PRINTF("TimeStepping::advanceToEvent(). Time =%f\n",getTkp1());
+#ifdef WITH_TIMERS
+  _profiler->newStep();
+#endif
+  SICONOS_PROFILE(_profiler, "TimeStepping::advanceToEvent");
 
   // Initialize lambdas of all interactions.
   SP::InteractionsGraph indexSet0 = _nsds->
@@ -468,6 +486,7 @@ void TimeStepping::advanceToEvent()
 void   TimeStepping::prepareNewtonIteration()
 {
   DEBUG_BEGIN("TimeStepping::prepareNewtonIteration()\n");
+  SICONOS_PROFILE(_profiler, "TimeStepping::prepareNewtonIteration");
   for (OSIIterator itosi = _allOSI->begin();
        itosi != _allOSI->end(); ++itosi)
   {
@@ -521,6 +540,7 @@ void TimeStepping::newtonSolve(double criterion, unsigned int maxStep)
 {
 
   DEBUG_BEGIN("TimeStepping::newtonSolve(double criterion, unsigned int maxStep)\n");
+  SICONOS_PROFILE(_profiler, "TimeStepping::newtonSolve");
   _isNewtonConverge = false;
   _newtonNbIterations = 0; // number of Newton iterations
   int info = 0;
@@ -608,12 +628,14 @@ void TimeStepping::newtonSolve(double criterion, unsigned int maxStep)
   }
   else
     RuntimeException::selfThrow("TimeStepping::NewtonSolve failed. Unknow newtonOptions: " + _newtonOptions);
+  SICONOS_PROFILE_COUNT(_profiler, "TimeStepping::newtonIterations", _newtonNbIterations);
   DEBUG_END("TimeStepping::newtonSolve(double criterion, unsigned int maxStep)\n");
 
 }
 
 bool TimeStepping::newtonCheckConvergence(double criterion)
 {
+  SICONOS_PROFILE(_profiler, "TimeStepping::newtonCheckConvergence");
   bool checkConvergence = true;
   //_relativeConvergenceCriterionHeld is true means that the RCC is
   //activated, and the relative criteron helds.  In this case the
@@ -32,6 +32,7 @@
 
 
 #include <algorithm>
+#include <set>
 #include <limits>
 
 //#define DEBUG_STDOUT
@@ -44,7 +45,9 @@
 
 // default
 Topology::Topology(): _isTopologyUpToDate(false), _hasChanged(true),
-  _numberOfConstraints(0), _symmetric(false)
+  _numberOfConstraints(0), _symmetric(false), _updateDepth(0),
+  _indexSet0EdgesCleared(false), _indexSet0HasRemovals(false),
+  _indexSet0RemovalCost(0)
 {
   _IG.resize(1);
   _DSG.resize(1);
@@ -121,7 +124,17 @@ Topology::addInteractionInIndexSet0(SP::Interaction inter, SP::DynamicalSystem d
   assert(!_IG[0]->is_vertex(inter));
   InteractionsGraph::VDescriptor ig_new_ve;
   DynamicalSystemsGraph::EDescriptor new_ed;
-  std11::tie(new_ed, ig_new_ve) = _DSG[0]->add_edge(dsgv1, dsgv2, inter, *_IG[0]);
+  if (_updateDepth > 0)
+  {
+    // the edges of _IG are built on commit()
+    new_ed = _DSG[0]->add_edge(dsgv1, dsgv2, inter);
+    ig_new_ve = _IG[0]->add_vertex(inter);
+    _pendingInteractions.push_back(inter);
+  }
+  else
+  {
+    std11::tie(new_ed, ig_new_ve) = _DSG[0]->add_edge(dsgv1, dsgv2, inter, *_IG[0]);
+  }
   InteractionProperties& interProp = _IG[0]->properties(ig_new_ve);
   interProp.DSlink.reset(new VectorOfBlockVectors);
   interProp.workVectors.reset(new VectorOfVectors);
@@ -197,6 +210,9 @@ struct VertexIsRemoved
    corresponding vertices are removed from _IG */
 void Topology::removeInteractionFromIndexSet(SP::Interaction inter)
 {
+  if (_updateDepth > 0)
+    prepareIndexSet0Removal(inter);
+  removeInteractionFromHigherIndexSets(inter);
 
   SP::DynamicalSystem ds1 = _IG[0]->properties(_IG[0]->descriptor(inter)).source;
   SP::DynamicalSystem ds2 = _IG[0]->properties(_IG[0]->descriptor(inter)).target;
@@ -206,6 +222,210 @@ void Topology::removeInteractionFromIndexSet(SP::Interaction inter)
 }
 
 
+void Topology::removeInteractionFromHigherIndexSets(SP::Interaction inter)
+{
+  for (unsigned int i = 1; i < _IG.size(); ++i)
+  {
+    if (!_IG[i] || !_IG[i]->is_vertex(inter))
+      continue;
+
+    InteractionsGraph& indexSet = *_IG[i];
+    InteractionsGraph::VDescriptor vd = indexSet.descriptor(inter);
+    indexSet.eraseProperties(vd);
+    InteractionsGraph::OEIterator oei, oeiend;
+    for (std11::tie(oei, oeiend) = indexSet.out_edges(vd); oei != oeiend; ++oei)
+    {
+      InteractionsGraph::EDescriptor ed1, ed2;
+      std11::tie(ed1, ed2) = indexSet.edges(indexSet.source(*oei), indexSet.target(*oei));
+      indexSet.eraseProperties(ed1);
+      if (ed2 != ed1)
+        indexSet.eraseProperties(ed2);
+    }
+    indexSet.remove_vertex(inter);
+  }
+}
+
+
+/* an edge is removed from _DSG graph if its Interaction is in the set
+   of the removed ones. The corresponding vertex is removed from _IG,
+   with its edges if they have not been cleared. */
+struct InteractionIsRemoved
+{
+  InteractionIsRemoved(const std::set<SP::Interaction>& removed,
+                       SP::DynamicalSystemsGraph sg, SP::InteractionsGraph asg) :
+    _removed(removed), __DSG(sg), __IG(asg) {};
+  bool operator()(DynamicalSystemsGraph::EDescriptor ed)
+  {
+    SP::Interaction inter = __DSG->bundle(ed);
+    if (_removed.find(inter) == _removed.end())
+      return false;
+
+    if (__IG->is_vertex(inter))
+      __IG->remove_vertex(inter);
+
+    return true;
+  }
+  const std::set<SP::Interaction>& _removed;
+  SP::DynamicalSystemsGraph __DSG;
+  SP::InteractionsGraph __IG;
+};
+
+void Topology::removeInteractions(const std::vector<SP::Interaction>& inters)
+{
+  DEBUG_PRINTF("removeInteractions : %zu interactions\n", inters.size());
+
+  std::set<SP::Interaction> removed;
+  std::set<DynamicalSystemsGraph::VDescriptor> involvedDS;
+  for (std::vector<SP::Interaction>::const_iterator it = inters.begin();
+       it != inters.end(); ++it)
+  {
+    if (_IG[0]->is_vertex(*it))
+    {
+      InteractionProperties& interProp = _IG[0]->properties(_IG[0]->descriptor(*it));
+      removed.insert(*it);
+      involvedDS.insert(_DSG[0]->descriptor(interProp.source));
+      involvedDS.insert(_DSG[0]->descriptor(interProp.target));
+    }
+  }
+
+  if (removed.empty())
+    return;
+
+  beginUpdate();
+  for (std::set<SP::Interaction>::iterator it = removed.begin();
+       it != removed.end(); ++it)
+  {
+    prepareIndexSet0Removal(*it);
+    removeInteractionFromHigherIndexSets(*it);
+  }
+
+  for (std::set<DynamicalSystemsGraph::VDescriptor>::iterator it = involvedDS.begin();
+       it != involvedDS.end(); ++it)
+  {
+    _DSG[0]->remove_out_edge_if(*it, InteractionIsRemoved(removed, _DSG[0], _IG[0]));
+  }
+  assert(_DSG[0]->edges_number() == _IG[0]->size());
+  commit();
+}
+
+void Topology::beginUpdate()
+{
+  ++_updateDepth;
+}
+
+void Topology::commit()
+{
+  assert(_updateDepth > 0);
+  if (--_updateDepth > 0)
+    return;
+
+  bool hasChanged = _indexSet0HasRemovals || !_pendingInteractions.empty();
+
+  if (_indexSet0EdgesCleared)
+  {
+    // rebuild all the edges in one pass
+    std::vector<SP::Interaction> inters;
+    inters.reserve(_IG[0]->size());
+    InteractionsGraph::VIterator vi, viend;
+    for (std11::tie(vi, viend) = _IG[0]->vertices(); vi != viend; ++vi)
+    {
+      inters.push_back(_IG[0]->bundle(*vi));
+    }
+    buildIndexSet0Edges(inters);
+  }
+  else if (!_pendingInteractions.empty())
+  {
+    buildIndexSet0Edges(_pendingInteractions);
+  }
+
+  _pendingInteractions.clear();
+  _indexSet0EdgesCleared = false;
+  _indexSet0HasRemovals = false;
+  _indexSet0RemovalCost = 0;
+
+  if (hasChanged)
+  {
+    _IG[0]->update_vertices_indices();
+    _IG[0]->update_edges_indices();
+    _hasChanged = true;
+  }
+  assert(_DSG[0]->edges_number() == _IG[0]->size());
+}
+
+void Topology::clearIndexSet0Edges()
+{
+  InteractionsGraph::EIterator ei, eiend;
+  for (std11::tie(ei, eiend) = _IG[0]->edges(); ei != eiend; ++ei)
+  {
+    _IG[0]->eraseProperties(*ei);
+  }
+  _IG[0]->clear_edges();
+  _indexSet0EdgesCleared = true;
+}
+
+void Topology::prepareIndexSet0Removal(SP::Interaction inter)
+{
+  _indexSet0HasRemovals = true;
+  if (_indexSet0EdgesCleared)
+    return;
+
+  // removing the vertex looks for each of its edges in the incidence
+  // list of the neighbour
+  InteractionsGraph::VDescriptor ivd = _IG[0]->descriptor(inter);
+  InteractionsGraph::AVIterator avi, aviend;
+  for (std11::tie(avi, aviend) = _IG[0]->adjacent_vertices(ivd); avi != aviend; ++avi)
+  {
+    _indexSet0RemovalCost += _IG[0]->out_degree(*avi);
+  }
+  if (_indexSet0RemovalCost > _IG[0]->edges_number())
+    clearIndexSet0Edges();
+}
+
+void Topology::buildIndexSet0Edges(const std::vector<SP::Interaction>& inters)
+{
+  // Interactions not yet linked to their neighbours: an edge is added
+  // from each of them to the neighbours that are not in this set, and
+  // it leaves the set once done
+  std::set<SP::Interaction> unlinked;
+  for (std::vector<SP::Interaction>::const_iterator it = inters.begin();
+       it != inters.end(); ++it)
+  {
+    if (_IG[0]->is_vertex(*it))
+      unlinked.insert(*it);
+  }
+
+  for (std::vector<SP::Interaction>::const_iterator it = inters.begin();
+       it != inters.end(); ++it)
+  {
+    // removed during the update, or already linked
+    if (unlinked.erase(*it) == 0)
+      continue;
+
+    InteractionsGraph::VDescriptor ivd = _IG[0]->descriptor(*it);
+    SP::DynamicalSystem ds1 = _IG[0]->properties(ivd).source;
+    SP::DynamicalSystem ds2 = _IG[0]->properties(ivd).target;
+
+    bool endl = false;
+    for (SP::DynamicalSystem ds = ds1; !endl; ds = ds2)
+    {
+      if (ds == ds2) endl = true;
+
+      std::set<SP::Interaction> done;
+      DynamicalSystemsGraph::OEIterator oei, oeiend;
+      for (std11::tie(oei, oeiend) = _DSG[0]->out_edges(_DSG[0]->descriptor(ds));
+           oei != oeiend; ++oei)
+      {
+        SP::Interaction other = _DSG[0]->bundle(*oei);
+        if (other != *it && unlinked.find(other) == unlinked.end()
+            && done.insert(other).second)
+        {
+          _IG[0]->add_edge(ivd, _IG[0]->descriptor(other), ds);
+        }
+      }
+    }
+  }
+}
+
 void Topology::insertDynamicalSystem(SP::DynamicalSystem ds)
 {
   DynamicalSystemsGraph::VDescriptor dsgv = _DSG[0]->add_vertex(ds);
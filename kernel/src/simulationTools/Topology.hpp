@@ -86,6 +86,25 @@ private:
   /** symmetry in the blocks computation */
   bool _symmetric;
 
+  /** number of nested beginUpdate() calls not yet committed */
+  unsigned int _updateDepth;
+
+  /** true if the edges of indexSet0 have been removed during the
+      current update, they are all rebuilt on commit() */
+  bool _indexSet0EdgesCleared;
+
+  /** true if Interactions have been removed during the current update */
+  bool _indexSet0HasRemovals;
+
+  /** cost of the removals from indexSet0 during the current update,
+      as the sum of the degrees of the neighbours of the removed
+      Interactions */
+  size_t _indexSet0RemovalCost;
+
+  /** Interactions linked during the current update, their edges in
+      indexSet0 are built on commit() */
+  std::vector<SP::Interaction> _pendingInteractions;
+
   /** initializations ( time invariance) from non
       smooth laws kind */
   struct SetupFromNslaw;
@@ -110,6 +129,34 @@ private:
    */
   void removeInteractionFromIndexSet(SP::Interaction inter);
 
+  /** remove an Interaction from the index sets of level greater than
+   *  0, so that an Interaction inserted again in indexSet0 (a recycled
+   *  one) does not keep the properties of its former insertion
+   * \param inter the Interaction to remove
+   */
+  void removeInteractionFromHigherIndexSets(SP::Interaction inter);
+
+  /** remove all the edges of indexSet0 during an update, so that the
+   *  removal of an Interaction does not have to walk through the
+   *  Interactions that share its dynamical systems
+   */
+  void clearIndexSet0Edges();
+
+  /** account for the removal of an Interaction from indexSet0 during
+   *  an update: its edges are removed with it, unless the cost of the
+   *  removals exceeds the number of edges, in which case all the edges
+   *  are cleared and rebuilt on commit()
+   * \param inter the Interaction to be removed
+   */
+  void prepareIndexSet0Removal(SP::Interaction inter);
+
+  /** build the edges of indexSet0 between the given Interactions and
+   *  the Interactions they share a dynamical system with. Each pair of
+   *  Interactions is linked once for each shared dynamical system.
+   * \param inters the Interactions whose edges are missing
+   */
+  void buildIndexSet0Edges(const std::vector<SP::Interaction>& inters);
+
 public:
 
   // --- CONSTRUCTORS/DESTRUCTOR ---
@@ -137,6 +184,39 @@ public:
    */
   void removeInteraction(SP::Interaction inter);
 
+  /** remove a set of Interactions from the topology in one
+   *  update. Each dynamical system involved is visited only once.
+   *  \param inters the Interactions to remove
+   */
+  void removeInteractions(const std::vector<SP::Interaction>& inters);
+
+  /** start a batch of modifications of the topology. Until the
+   *  matching commit(), link() and removeInteraction() update the
+   *  dynamical systems graph and the vertices of indexSet0 (the
+   *  Interaction properties are available at once), but the edges of
+   *  indexSet0 between the linked Interactions and those sharing a
+   *  dynamical system with them are built only once on commit(). The
+   *  edges of a removed Interaction are removed with it, unless the
+   *  removals are numerous enough for all the edges to be cleared and
+   *  rebuilt on commit(). Calls may be nested.
+   */
+  void beginUpdate();
+
+  /** end a batch of modifications started with beginUpdate(): the
+   *  edges of indexSet0 are rebuilt, then its indices are
+   *  recomputed. Does nothing but decrease the nesting level for an
+   *  inner batch.
+   */
+  void commit();
+
+  /** check if a batch of modifications is in progress
+   *  \return a bool
+   */
+  inline bool isUpdating() const
+  {
+    return _updateDepth > 0;
+  }
+
   /** add a dynamical system
    * \param ds the DynamicalSystem to add
    */
@@ -0,0 +1,137 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "ActiveSetCacheTest.hpp"
+#include "ActiveSetCache.hpp"
+#include "SimpleMatrix.hpp"
+#include "SiconosVector.hpp"
+
+// test suite registration
+CPPUNIT_TEST_SUITE_REGISTRATION(ActiveSetCacheTest);
+
+
+void ActiveSetCacheTest::setUp()
+{
+  // w = q + M z, 0 <= z _|_ w >= 0
+  _M.reset(new SimpleMatrix(2, 2));
+  (*_M)(0, 0) = 2.;
+  (*_M)(0, 1) = 1.;
+  (*_M)(1, 0) = 1.;
+  (*_M)(1, 1) = 2.;
+  _q.reset(new SiconosVector(2));
+  _z.reset(new SiconosVector(2));
+  _w.reset(new SiconosVector(2));
+  _isComp.assign(2, true);
+}
+
+void ActiveSetCacheTest::tearDown()
+{}
+
+void ActiveSetCacheTest::testHitMiss()
+{
+  std::cout << "--> Test: ActiveSetCache hit and miss." <<std::endl;
+  ActiveSetCache cache;
+  (*_q)(0) = -1.;
+  (*_q)(1) = 1.;
+  CPPUNIT_ASSERT_MESSAGE("testHitMiss : empty cache", !cache.solve(*_M, *_q, _isComp, *_z, *_w));
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testHitMiss : misses", 1ul, cache.misses());
+
+  // the solution of a solver: z0 > 0, w1 > 0
+  (*_z)(0) = 0.5;
+  (*_z)(1) = 0.;
+  (*_w)(0) = 0.;
+  (*_w)(1) = 1.5;
+  cache.insert(*_M, _isComp, *_z, *_w);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testHitMiss : size", 1u, cache.size());
+
+  // same active set, another q
+  (*_q)(0) = -2.;
+  _z->zero();
+  _w->zero();
+  CPPUNIT_ASSERT_MESSAGE("testHitMiss : hit", cache.solve(*_M, *_q, _isComp, *_z, *_w));
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testHitMiss : hits", 1ul, cache.hits());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("testHitMiss : z0", 1., (*_z)(0), 1e-14);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("testHitMiss : z1", 0., (*_z)(1), 1e-14);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("testHitMiss : w0", 0., (*_w)(0), 1e-14);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("testHitMiss : w1", 2., (*_w)(1), 1e-14);
+
+  // the solution is z = 0, the cached active set gives z0 < 0
+  (*_q)(0) = 1.;
+  CPPUNIT_ASSERT_MESSAGE("testHitMiss : infeasible", !cache.solve(*_M, *_q, _isComp, *_z, *_w));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("testHitMiss : z unchanged", 1., (*_z)(0), 1e-14);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testHitMiss : misses", 2ul, cache.misses());
+  std::cout << "--> testHitMiss ended with success." <<std::endl;
+}
+
+void ActiveSetCacheTest::testMixed()
+{
+  std::cout << "--> Test: ActiveSetCache with an equality." <<std::endl;
+  ActiveSetCache cache;
+  // the first unknown is free
+  _isComp[0] = false;
+  (*_q)(0) = 1.;
+  (*_q)(1) = 1.;
+  // z0 = -0.5, z1 = 0, w1 = 0.5
+  (*_z)(0) = -0.5;
+  (*_w)(1) = 0.5;
+  cache.insert(*_M, _isComp, *_z, *_w);
+  (*_q)(0) = 2.;
+  CPPUNIT_ASSERT_MESSAGE("testMixed : hit", cache.solve(*_M, *_q, _isComp, *_z, *_w));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("testMixed : z0", -1., (*_z)(0), 1e-14);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("testMixed : w1", 0., (*_w)(1), 1e-14);
+  std::cout << "--> testMixed ended with success." <<std::endl;
+}
+
+void ActiveSetCacheTest::testInvalidation()
+{
+  std::cout << "--> Test: ActiveSetCache invalidation." <<std::endl;
+  ActiveSetCache cache;
+  (*_q)(0) = -1.;
+  (*_q)(1) = 1.;
+  (*_z)(0) = 0.5;
+  (*_w)(1) = 1.5;
+  cache.insert(*_M, _isComp, *_z, *_w);
+  (*_M)(1, 1) = 3.;
+  CPPUNIT_ASSERT_MESSAGE("testInvalidation : M changed", !cache.solve(*_M, *_q, _isComp, *_z, *_w));
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testInvalidation : size", 0u, cache.size());
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testInvalidation : invalidations", 1ul, cache.invalidations());
+  std::cout << "--> testInvalidation ended with success." <<std::endl;
+}
+
+void ActiveSetCacheTest::testEviction()
+{
+  std::cout << "--> Test: ActiveSetCache eviction." <<std::endl;
+  ActiveSetCache cache(1);
+  (*_z)(0) = 0.5;
+  (*_w)(1) = 1.5;
+  cache.insert(*_M, _isComp, *_z, *_w);
+  _z->zero();
+  _w->zero();
+  (*_w)(0) = 1.;
+  (*_w)(1) = 1.;
+  cache.insert(*_M, _isComp, *_z, *_w);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testEviction : size", 1u, cache.size());
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testEviction : evictions", 1ul, cache.evictions());
+  // only the last active set (z = 0) is kept
+  (*_q)(0) = 2.;
+  (*_q)(1) = 3.;
+  CPPUNIT_ASSERT_MESSAGE("testEviction : hit", cache.solve(*_M, *_q, _isComp, *_z, *_w));
+  (*_q)(0) = -1.;
+  (*_q)(1) = 1.;
+  CPPUNIT_ASSERT_MESSAGE("testEviction : evicted", !cache.solve(*_M, *_q, _isComp, *_z, *_w));
+  std::cout << "--> testEviction ended with success." <<std::endl;
+}
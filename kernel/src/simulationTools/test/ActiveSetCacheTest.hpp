@@ -0,0 +1,61 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef __ActiveSetCacheTest__
+#define __ActiveSetCacheTest__
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "SiconosFwd.hpp"
+
+#include <vector>
+
+class ActiveSetCacheTest : public CppUnit::TestFixture
+{
+
+private:
+
+  // Name of the tests suite
+  CPPUNIT_TEST_SUITE(ActiveSetCacheTest);
+
+  // tests to be done ...
+
+  CPPUNIT_TEST(testHitMiss);
+  CPPUNIT_TEST(testMixed);
+  CPPUNIT_TEST(testInvalidation);
+  CPPUNIT_TEST(testEviction);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  void testHitMiss();
+  void testMixed();
+  void testInvalidation();
+  void testEviction();
+
+  SP::SimpleMatrix _M;
+  SP::SiconosVector _q;
+  SP::SiconosVector _z;
+  SP::SiconosVector _w;
+  std::vector<bool> _isComp;
+
+public:
+
+  void setUp();
+  void tearDown();
+
+};
+
+#endif
@@ -0,0 +1,311 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "InteractionBlocksTest.hpp"
+#include "Model.hpp"
+#include "NonSmoothDynamicalSystem.hpp"
+#include "Topology.hpp"
+#include "LagrangianLinearTIDS.hpp"
+#include "LagrangianLinearTIR.hpp"
+#include "NewtonEulerDS.hpp"
+#include "NewtonEulerFrom3DLocalFrameR.hpp"
+#include "NewtonImpactNSL.hpp"
+#include "NewtonImpactFrictionNSL.hpp"
+#include "Interaction.hpp"
+#include "MoreauJeanOSI.hpp"
+#include "LCP.hpp"
+#include "FrictionContact.hpp"
+#include "OSNSMatrix.hpp"
+#include "TimeDiscretisation.hpp"
+#include "TimeStepping.hpp"
+#include "SimpleMatrix.hpp"
+#include "SiconosVector.hpp"
+#include "BlockVector.hpp"
+
+#include <vector>
+
+// test suite registration
+CPPUNIT_TEST_SUITE_REGISTRATION(InteractionBlocksTest);
+
+/* a column of beads falling on the ground, all the contacts are
+   active after a few steps. The beads are linear time invariant
+   systems, or lagrangian systems with a constant mass. */
+struct LinearColumn
+{
+  SP::Model model;
+  SP::TimeStepping simulation;
+  SP::MoreauJeanOSI osi;
+  SP::LCP lcp;
+  std::vector<SP::LagrangianDS> beads;
+
+  LinearColumn(unsigned int nBeads, bool reuse, bool timeInvariant = true)
+  {
+    double R = 0.1;
+    SP::SiconosVector weight(new SiconosVector(3));
+    (*weight)(0) = -9.81;
+
+    model.reset(new Model(0.0, 1.0));
+    SP::NonSmoothDynamicalSystem nsds = model->nonSmoothDynamicalSystem();
+    for (unsigned int i = 0; i < nBeads; ++i)
+    {
+      SP::SiconosMatrix mass(new SimpleMatrix(3, 3));
+      (*mass)(0, 0) = 1.0 + 0.1 * i;
+      (*mass)(1, 1) = 1.0 + 0.1 * i;
+      (*mass)(2, 2) = 3. / 5 * R * R;
+      SP::SiconosVector q0(new SiconosVector(3));
+      SP::SiconosVector v0(new SiconosVector(3));
+      (*q0)(0) = R + 2 * R * i;
+      if (timeInvariant)
+        beads.push_back(SP::LagrangianDS(new LagrangianLinearTIDS(q0, v0, mass)));
+      else
+        beads.push_back(SP::LagrangianDS(new LagrangianDS(q0, v0, mass)));
+      beads.back()->setFExtPtr(weight);
+      nsds->insertDynamicalSystem(beads.back());
+    }
+
+    SP::NonSmoothLaw nslaw(new NewtonImpactNSL(0.0));
+    SP::SimpleMatrix H(new SimpleMatrix(1, 3));
+    (*H)(0, 0) = 1.0;
+    SP::SiconosVector b(new SiconosVector(1));
+    (*b)(0) = -R;
+    SP::Relation relation(new LagrangianLinearTIR(H, b));
+    nsds->link(SP::Interaction(new Interaction(1, nslaw, relation)), beads[0]);
+
+    SP::SimpleMatrix HOfBeads(new SimpleMatrix(1, 6));
+    (*HOfBeads)(0, 0) = -1.0;
+    (*HOfBeads)(0, 3) = 1.0;
+    SP::SiconosVector bOfBeads(new SiconosVector(1));
+    (*bOfBeads)(0) = -2 * R;
+    for (unsigned int i = 0; i + 1 < nBeads; ++i)
+    {
+      SP::Relation relationOfBeads(new LagrangianLinearTIR(HOfBeads, bOfBeads));
+      nsds->link(SP::Interaction(new Interaction(1, nslaw, relationOfBeads)),
+                 beads[i], beads[i + 1]);
+    }
+
+    osi.reset(new MoreauJeanOSI(0.5));
+    lcp.reset(new LCP());
+    lcp->setReuseInteractionBlocks(reuse);
+    SP::TimeDiscretisation td(new TimeDiscretisation(0.0, 1e-3));
+    simulation.reset(new TimeStepping(td, osi, lcp));
+    model->setSimulation(simulation);
+    model->initialize();
+  }
+
+  void step()
+  {
+    simulation->computeOneStep();
+    simulation->nextStep();
+  }
+
+  /* steps until the column rests on the ground */
+  void settle()
+  {
+    for (unsigned int k = 0; k < 20; ++k)
+      step();
+  }
+
+  /* change the mass of a bead and its W = M, which is not computed
+     again for a time invariant system, and increment the stamp of W
+     as the integrator does when it computes W */
+  void changeMass(unsigned int i)
+  {
+    (*beads[i]->mass())(0, 0) *= 2.0;
+    SP::SimpleMatrix W = osi->W(beads[i]);
+    *W = *beads[i]->mass();
+    W->resetLU();
+    SP::DynamicalSystemsGraph dsg = model->nonSmoothDynamicalSystem()->topology()->dSG(0);
+    ++dsg->WStamp[dsg->descriptor(beads[i])];
+  }
+};
+
+/* contact of a sphere of radius r with the plane z = 0 */
+class SphereGroundR : public NewtonEulerFrom3DLocalFrameR
+{
+  double _r;
+
+public:
+
+  SphereGroundR(double r): NewtonEulerFrom3DLocalFrameR(), _r(r) {};
+
+  void computeh(double time, BlockVector& q0, SiconosVector& y)
+  {
+    y.setValue(0, q0(2) - _r);
+    _Pc1->setValue(0, q0(0));
+    _Pc1->setValue(1, q0(1));
+    _Pc1->setValue(2, q0(2) - _r);
+    _Pc2->setValue(0, q0(0));
+    _Pc2->setValue(1, q0(1));
+    _Pc2->setValue(2, 0.);
+    _Nc->setValue(0, 0.);
+    _Nc->setValue(1, 0.);
+    _Nc->setValue(2, 1.);
+  }
+};
+
+/* a sphere falling on the ground, with friction */
+struct FallingSphere
+{
+  SP::Model model;
+  SP::TimeStepping simulation;
+  SP::FrictionContact osnspb;
+
+  FallingSphere()
+  {
+    double r = 0.1;
+    model.reset(new Model(0.0, 1.0));
+    SP::SiconosVector q0(new SiconosVector(7));
+    SP::SiconosVector v0(new SiconosVector(6));
+    SP::SimpleMatrix inertia(new SimpleMatrix(3, 3));
+    inertia->eye();
+    *inertia *= 2. / 5 * r * r;
+    (*q0)(2) = r + 0.0005;
+    (*q0)(3) = 1.0;
+    SP::NewtonEulerDS sphere(new NewtonEulerDS(q0, v0, 1.0, inertia));
+    SP::SiconosVector weight(new SiconosVector(3));
+    (*weight)(2) = -9.81;
+    sphere->setFExtPtr(weight);
+    model->nonSmoothDynamicalSystem()->insertDynamicalSystem(sphere);
+
+    SP::NonSmoothLaw nslaw(new NewtonImpactFrictionNSL(0.0, 0.0, 0.3, 3));
+    model->nonSmoothDynamicalSystem()->link(
+      SP::Interaction(new Interaction(3, nslaw, SP::Relation(new SphereGroundR(r)))), sphere);
+
+    osnspb.reset(new FrictionContact(3));
+    SP::TimeDiscretisation td(new TimeDiscretisation(0.0, 1e-3));
+    simulation.reset(new TimeStepping(td, SP::OneStepIntegrator(new MoreauJeanOSI(0.5)), osnspb));
+    model->setSimulation(simulation);
+    model->initialize();
+  }
+};
+
+/* the LCP matrices of both columns are equal */
+static bool sameM(LinearColumn& a, LinearColumn& b)
+{
+  SP::SiconosMatrix Ma = a.lcp->M()->defaultMatrix();
+  SP::SiconosMatrix Mb = b.lcp->M()->defaultMatrix();
+  if (Ma->size(0) != Mb->size(0) || Ma->size(1) != Mb->size(1))
+    return false;
+  for (unsigned int i = 0; i < Ma->size(0); ++i)
+    for (unsigned int j = 0; j < Ma->size(1); ++j)
+      if ((*Ma)(i, j) != (*Mb)(i, j))
+        return false;
+  return true;
+}
+
+void InteractionBlocksTest::setUp()
+{}
+
+void InteractionBlocksTest::tearDown()
+{}
+
+void InteractionBlocksTest::testReuse()
+{
+  std::cout << "--> Test: reuse of the interaction blocks." <<std::endl;
+  LinearColumn column(10, true);
+  column.step();
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testReuse : first step", 0u, column.lcp->numberOfReusedInteractionBlocks());
+  column.settle();
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testReuse : all the blocks", 28u, column.lcp->numberOfInteractionBlocks());
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testReuse : all the blocks are kept",
+                               column.lcp->numberOfInteractionBlocks(),
+                               column.lcp->numberOfReusedInteractionBlocks());
+  std::cout << "--> testReuse ended with success." <<std::endl;
+}
+
+void InteractionBlocksTest::testThetaChange()
+{
+  std::cout << "--> Test: interaction blocks after a change of theta." <<std::endl;
+  LinearColumn column(10, true);
+  LinearColumn reference(10, false);
+  column.settle();
+  reference.settle();
+  column.osi->setTheta(0.7);
+  reference.osi->setTheta(0.7);
+  column.step();
+  reference.step();
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testThetaChange : no block kept", 0u, column.lcp->numberOfReusedInteractionBlocks());
+  CPPUNIT_ASSERT_MESSAGE("testThetaChange : M", sameM(column, reference));
+  column.step();
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testThetaChange : blocks kept with the new theta",
+                               column.lcp->numberOfInteractionBlocks(),
+                               column.lcp->numberOfReusedInteractionBlocks());
+  std::cout << "--> testThetaChange ended with success." <<std::endl;
+}
+
+void InteractionBlocksTest::testGammaChange()
+{
+  std::cout << "--> Test: interaction blocks after a change of gamma." <<std::endl;
+  LinearColumn column(10, true);
+  column.settle();
+  column.osi->setGamma(0.6);
+  column.step();
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testGammaChange : no block kept", 0u, column.lcp->numberOfReusedInteractionBlocks());
+  std::cout << "--> testGammaChange ended with success." <<std::endl;
+}
+
+void InteractionBlocksTest::testWChange()
+{
+  std::cout << "--> Test: interaction blocks after a change of W." <<std::endl;
+  LinearColumn column(10, true);
+  LinearColumn reference(10, false);
+  column.settle();
+  reference.settle();
+  column.changeMass(4);
+  reference.changeMass(4);
+  column.step();
+  reference.step();
+  // the 2 diagonal and 3 x 2 extra-diagonal blocks of the two
+  // contacts of bead 4 are computed again
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testWChange : blocks of bead 4 computed",
+                               column.lcp->numberOfInteractionBlocks() - 8,
+                               column.lcp->numberOfReusedInteractionBlocks());
+  CPPUNIT_ASSERT_MESSAGE("testWChange : M", sameM(column, reference));
+  std::cout << "--> testWChange ended with success." <<std::endl;
+}
+
+void InteractionBlocksTest::testLagrangianDS()
+{
+  std::cout << "--> Test: interaction blocks of lagrangian systems." <<std::endl;
+  LinearColumn column(10, true, false);
+  LinearColumn reference(10, false, false);
+  column.settle();
+  reference.settle();
+  // W = M is not changed by the integrator
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testLagrangianDS : all the blocks are kept",
+                               column.lcp->numberOfInteractionBlocks(),
+                               column.lcp->numberOfReusedInteractionBlocks());
+  CPPUNIT_ASSERT_MESSAGE("testLagrangianDS : M", sameM(column, reference));
+  std::cout << "--> testLagrangianDS ended with success." <<std::endl;
+}
+
+void InteractionBlocksTest::testNewtonEuler()
+{
+  std::cout << "--> Test: interaction blocks of a Newton-Euler contact." <<std::endl;
+  FallingSphere sphere;
+  for (unsigned int k = 0; k < 40; ++k)
+  {
+    sphere.simulation->computeOneStep();
+    sphere.simulation->nextStep();
+  }
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testNewtonEuler : contact", 1u, sphere.osnspb->numberOfInteractionBlocks());
+  // the sphere rests on the ground without rotation: the jacobians
+  // of the relation are unchanged
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testNewtonEuler : the block is kept", 1u,
+                               sphere.osnspb->numberOfReusedInteractionBlocks());
+  std::cout << "--> testNewtonEuler ended with success." <<std::endl;
+}
@@ -0,0 +1,59 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef __InteractionBlocksTest__
+#define __InteractionBlocksTest__
+
+#include <cppunit/extensions/HelperMacros.h>
+
+/* The interaction blocks are kept between two steps only if the
+   jacobians of the relations, the time step, the parameters of the
+   integrator and its matrices W have not changed. */
+class InteractionBlocksTest : public CppUnit::TestFixture
+{
+
+private:
+
+  // Name of the tests suite
+  CPPUNIT_TEST_SUITE(InteractionBlocksTest);
+
+  // tests to be done ...
+
+  CPPUNIT_TEST(testReuse);
+  CPPUNIT_TEST(testThetaChange);
+  CPPUNIT_TEST(testGammaChange);
+  CPPUNIT_TEST(testWChange);
+  CPPUNIT_TEST(testLagrangianDS);
+  CPPUNIT_TEST(testNewtonEuler);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  void testReuse();
+  void testThetaChange();
+  void testGammaChange();
+  void testWChange();
+  void testLagrangianDS();
+  void testNewtonEuler();
+
+public:
+
+  void setUp();
+  void tearDown();
+
+};
+
+#endif
@@ -0,0 +1,237 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "InteractionRecycleTest.hpp"
+#include "Model.hpp"
+#include "NonSmoothDynamicalSystem.hpp"
+#include "NewtonEulerDS.hpp"
+#include "NewtonEulerFrom1DLocalFrameR.hpp"
+#include "NewtonEulerFrom3DLocalFrameR.hpp"
+#include "NewtonImpactNSL.hpp"
+#include "NewtonImpactFrictionNSL.hpp"
+#include "Interaction.hpp"
+#include "MoreauJeanOSI.hpp"
+#include "LCP.hpp"
+#include "FrictionContact.hpp"
+#include "TimeDiscretisation.hpp"
+#include "TimeStepping.hpp"
+#include "BlockVector.hpp"
+#include "SimpleMatrix.hpp"
+#include "SiconosVector.hpp"
+
+#include <cmath>
+#include <vector>
+
+// test suite registration
+CPPUNIT_TEST_SUITE_REGISTRATION(InteractionRecycleTest);
+
+/* contact of a sphere of radius r with the ground z = 0 */
+template <class LocalFrameR>
+class SphereGroundR : public LocalFrameR
+{
+  double _r;
+
+public:
+
+  SphereGroundR(double r): LocalFrameR(), _r(r) {};
+
+  void computeh(double time, BlockVector& q0, SiconosVector& y)
+  {
+    y.setValue(0, q0(2) - _r);
+    this->_Pc1->setValue(0, q0(0));
+    this->_Pc1->setValue(1, q0(1));
+    this->_Pc1->setValue(2, q0(2) - _r);
+    this->_Pc2->setValue(0, q0(0));
+    this->_Pc2->setValue(1, q0(1));
+    this->_Pc2->setValue(2, 0.0);
+    this->_Nc->setValue(0, 0.0);
+    this->_Nc->setValue(1, 0.0);
+    this->_Nc->setValue(2, 1.0);
+  }
+};
+
+/* two spheres, the first one resting on the ground and the second one
+   falling on it. After a few steps, the contact of the first sphere is
+   removed and a contact is added for the second one, with a new
+   Interaction or with the Interaction of the removed contact. */
+template <class LocalFrameR>
+struct TwoSpheres
+{
+  SP::Model model;
+  SP::TimeStepping simulation;
+  SP::NonSmoothDynamicalSystem nsds;
+  std::vector<SP::NewtonEulerDS> spheres;
+  SP::NonSmoothLaw nslaw;
+  SP::Interaction contact;
+  double r;
+
+  TwoSpheres(SP::NonSmoothLaw nslaw, SP::OneStepNSProblem osnspb):
+    nslaw(nslaw), r(0.1)
+  {
+    model.reset(new Model(0.0, 1.0));
+    nsds = model->nonSmoothDynamicalSystem();
+    SP::SiconosVector weight(new SiconosVector(3));
+    (*weight)(2) = -9.81;
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+      SP::SiconosVector q0(new SiconosVector(7));
+      SP::SiconosVector v0(new SiconosVector(6));
+      SP::SimpleMatrix inertia(new SimpleMatrix(3, 3));
+      inertia->eye();
+      *inertia *= 2. / 5 * r * r;
+      (*q0)(0) = 3 * r * i;
+      (*q0)(2) = r + 0.02 * i;
+      (*q0)(3) = 1.0;
+      (*v0)(0) = 0.5 * i;
+      (*v0)(2) = -1.0 * i;
+      (*v0)(4) = 2.0 * i;
+      spheres.push_back(SP::NewtonEulerDS(new NewtonEulerDS(q0, v0, 1.0, inertia)));
+      spheres.back()->setFExtPtr(weight);
+      nsds->insertDynamicalSystem(spheres.back());
+    }
+    contact.reset(new Interaction(nslaw->size(), nslaw,
+                                  SP::Relation(new SphereGroundR<LocalFrameR>(r)), 0));
+    nsds->link(contact, spheres[0]);
+
+    SP::TimeDiscretisation td(new TimeDiscretisation(0.0, 5e-3));
+    simulation.reset(new TimeStepping(td, SP::OneStepIntegrator(new MoreauJeanOSI(0.5)), osnspb));
+    model->setSimulation(simulation);
+    model->initialize();
+  }
+
+  void step()
+  {
+    simulation->computeOneStep();
+    simulation->nextStep();
+  }
+
+  /* move the contact from the first sphere to the second one, as
+     BulletSpaceFilter does with its pool of interactions */
+  void moveContact(bool recycle)
+  {
+    nsds->removeInteraction(contact);
+    if (recycle)
+      contact->recycle(nslaw, contact->relation(), 1);
+    else
+      contact.reset(new Interaction(nslaw->size(), nslaw,
+                                    SP::Relation(new SphereGroundR<LocalFrameR>(r)), 1));
+    nsds->link(contact, spheres[1]);
+    simulation->initializeInteraction(simulation->nextTime(), contact);
+    simulation->initOSNS();
+  }
+
+  SP::NewtonEulerR relation()
+  {
+    return std11::static_pointer_cast<NewtonEulerR>(contact->relation());
+  }
+};
+
+static bool sameVectors(const SiconosVector& a, const SiconosVector& b)
+{
+  if (a.size() != b.size())
+    return false;
+  for (unsigned int i = 0; i < a.size(); ++i)
+    if (std::fabs(a(i) - b(i)) > 1e-12 * (1.0 + std::fabs(a(i))))
+      return false;
+  return true;
+}
+
+static bool sameMatrices(const SiconosMatrix& a, const SiconosMatrix& b)
+{
+  if (a.size(0) != b.size(0) || a.size(1) != b.size(1))
+    return false;
+  for (unsigned int i = 0; i < a.size(0); ++i)
+    for (unsigned int j = 0; j < a.size(1); ++j)
+      if (std::fabs(a(i, j) - b(i, j)) > 1e-12 * (1.0 + std::fabs(a(i, j))))
+        return false;
+  return true;
+}
+
+template <class LocalFrameR>
+static void checkRecycle(SP::NonSmoothLaw nslaw,
+                         SP::OneStepNSProblem osnspbFresh,
+                         SP::OneStepNSProblem osnspbRecycled)
+{
+  TwoSpheres<LocalFrameR> fresh(nslaw, osnspbFresh);
+  TwoSpheres<LocalFrameR> recycled(nslaw, osnspbRecycled);
+  for (unsigned int k = 0; k < 10; ++k)
+  {
+    fresh.step();
+    recycled.step();
+  }
+  // the contact has been active, its reaction is not zero
+  CPPUNIT_ASSERT_MESSAGE("active contact", recycled.contact->lambda(1)->normInf() > 0.0);
+
+  SP::Interaction inter = recycled.contact;
+  SiconosVector* y0 = inter->y(0).get();
+  SiconosVector* lambda1 = inter->lambda(1).get();
+  SiconosMatrix* jachq = recycled.relation()->jachq().get();
+  SiconosMatrix* jachqT = recycled.relation()->jachqT().get();
+
+  fresh.moveContact(false);
+  recycled.moveContact(true);
+
+  // the vectors and matrices of the interaction and of its relation are reused
+  CPPUNIT_ASSERT_MESSAGE("same interaction", recycled.contact == inter);
+  CPPUNIT_ASSERT_MESSAGE("y reused", inter->y(0).get() == y0);
+  CPPUNIT_ASSERT_MESSAGE("lambda reused", inter->lambda(1).get() == lambda1);
+  CPPUNIT_ASSERT_MESSAGE("jachq reused", recycled.relation()->jachq().get() == jachq);
+  CPPUNIT_ASSERT_MESSAGE("jachqT reused", recycled.relation()->jachqT().get() == jachqT);
+  CPPUNIT_ASSERT_MESSAGE("initial y", sameVectors(*fresh.contact->y(0), *recycled.contact->y(0)));
+  CPPUNIT_ASSERT_MESSAGE("initial lambda", sameVectors(*fresh.contact->lambda(1), *recycled.contact->lambda(1)));
+
+  for (unsigned int k = 0; k < 40; ++k)
+  {
+    fresh.step();
+    recycled.step();
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+      CPPUNIT_ASSERT_MESSAGE("q", sameVectors(*fresh.spheres[i]->q(), *recycled.spheres[i]->q()));
+      CPPUNIT_ASSERT_MESSAGE("v", sameVectors(*fresh.spheres[i]->velocity(), *recycled.spheres[i]->velocity()));
+    }
+    CPPUNIT_ASSERT_MESSAGE("y", sameVectors(*fresh.contact->y(0), *recycled.contact->y(0)));
+    CPPUNIT_ASSERT_MESSAGE("ydot", sameVectors(*fresh.contact->y(1), *recycled.contact->y(1)));
+    CPPUNIT_ASSERT_MESSAGE("lambda", sameVectors(*fresh.contact->lambda(1), *recycled.contact->lambda(1)));
+    CPPUNIT_ASSERT_MESSAGE("jachqT", sameMatrices(*fresh.relation()->jachqT(), *recycled.relation()->jachqT()));
+  }
+  // the second sphere has reached the ground
+  CPPUNIT_ASSERT_MESSAGE("new contact active", recycled.contact->lambda(1)->normInf() > 0.0);
+}
+
+void InteractionRecycleTest::setUp()
+{}
+
+void InteractionRecycleTest::tearDown()
+{}
+
+void InteractionRecycleTest::testRecycle1DLocalFrame()
+{
+  std::cout << "--> Test: recycle an Interaction with a NewtonEulerFrom1DLocalFrameR." <<std::endl;
+  SP::NonSmoothLaw nslaw(new NewtonImpactNSL(0.0));
+  checkRecycle<NewtonEulerFrom1DLocalFrameR>(nslaw, SP::OneStepNSProblem(new LCP()),
+                                             SP::OneStepNSProblem(new LCP()));
+  std::cout << "--> testRecycle1DLocalFrame ended with success." <<std::endl;
+}
+
+void InteractionRecycleTest::testRecycle3DLocalFrame()
+{
+  std::cout << "--> Test: recycle an Interaction with a NewtonEulerFrom3DLocalFrameR." <<std::endl;
+  SP::NonSmoothLaw nslaw(new NewtonImpactFrictionNSL(0.0, 0.0, 0.3, 3));
+  checkRecycle<NewtonEulerFrom3DLocalFrameR>(nslaw, SP::OneStepNSProblem(new FrictionContact(3)),
+                                             SP::OneStepNSProblem(new FrictionContact(3)));
+  std::cout << "--> testRecycle3DLocalFrame ended with success." <<std::endl;
+}
@@ -0,0 +1,51 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef __InteractionRecycleTest__
+#define __InteractionRecycleTest__
+
+#include <cppunit/extensions/HelperMacros.h>
+
+/* An Interaction removed from the topology and recycled, with its
+   relation, for a new contact gives the same simulation as a new
+   Interaction with a new relation. */
+class InteractionRecycleTest : public CppUnit::TestFixture
+{
+
+private:
+
+  // Name of the tests suite
+  CPPUNIT_TEST_SUITE(InteractionRecycleTest);
+
+  // tests to be done ...
+
+  CPPUNIT_TEST(testRecycle1DLocalFrame);
+  CPPUNIT_TEST(testRecycle3DLocalFrame);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  void testRecycle1DLocalFrame();
+  void testRecycle3DLocalFrame();
+
+public:
+
+  void setUp();
+  void tearDown();
+
+};
+
+#endif
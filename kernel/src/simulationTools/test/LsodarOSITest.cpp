@@ -0,0 +1,374 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "LsodarOSITest.hpp"
+#include "Model.hpp"
+#include "NonSmoothDynamicalSystem.hpp"
+#include "LagrangianLinearTIDS.hpp"
+#include "LagrangianLinearTIR.hpp"
+#include "FirstOrderLinearTIDS.hpp"
+#include "NewtonImpactNSL.hpp"
+#include "Interaction.hpp"
+#include "LsodarOSI.hpp"
+#include "LCP.hpp"
+#include "TimeDiscretisation.hpp"
+#include "EventDriven.hpp"
+#include "SimpleMatrix.hpp"
+#include "SiconosVector.hpp"
+#include "BlockVector.hpp"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// test suite registration
+CPPUNIT_TEST_SUITE_REGISTRATION(LsodarOSITest);
+
+/* a column of beads with springs and dampers in free flight above the
+   ground, the interactions between neighbours are not active */
+struct FallingColumn
+{
+  SP::Model model;
+  SP::EventDriven simulation;
+  SP::LsodarOSI osi;
+  std::vector<SP::LagrangianLinearTIDS> beads;
+
+  FallingColumn(unsigned int nBeads, unsigned int jacobianType)
+  {
+    double R = 0.1;
+    SP::SiconosVector weight(new SiconosVector(3));
+    (*weight)(0) = -9.81;
+
+    model.reset(new Model(0.0, 0.2));
+    SP::NonSmoothDynamicalSystem nsds = model->nonSmoothDynamicalSystem();
+    for (unsigned int i = 0; i < nBeads; ++i)
+    {
+      SP::SiconosMatrix mass(new SimpleMatrix(3, 3));
+      (*mass)(0, 0) = 1.0 + 0.1 * i;
+      (*mass)(1, 1) = 1.0 + 0.1 * i;
+      (*mass)(2, 2) = 3. / 5 * R * R;
+      SP::SiconosMatrix K(new SimpleMatrix(3, 3));
+      (*K)(0, 0) = 20.0;
+      (*K)(1, 1) = 30.0 + i;
+      (*K)(2, 2) = 0.4;
+      (*K)(0, 1) = (*K)(1, 0) = 10.0;
+      (*K)(1, 2) = (*K)(2, 1) = 0.1;
+      SP::SiconosMatrix C(new SimpleMatrix(3, 3));
+      (*C)(0, 0) = (*C)(1, 1) = 0.1;
+      (*C)(2, 2) = 0.01;
+      SP::SiconosVector q0(new SiconosVector(3));
+      SP::SiconosVector v0(new SiconosVector(3));
+      (*q0)(0) = 1.0 + 3 * R * i;
+      (*q0)(1) = 0.01 * i;
+      (*v0)(2) = 0.5;
+      beads.push_back(SP::LagrangianLinearTIDS(new LagrangianLinearTIDS(q0, v0, mass, K, C)));
+      beads.back()->setFExtPtr(weight);
+      nsds->insertDynamicalSystem(beads.back());
+    }
+
+    SP::NonSmoothLaw nslaw(new NewtonImpactNSL(0.5));
+    SP::SimpleMatrix H(new SimpleMatrix(1, 3));
+    (*H)(0, 0) = 1.0;
+    SP::SiconosVector b(new SiconosVector(1));
+    (*b)(0) = -R;
+    SP::Relation relation(new LagrangianLinearTIR(H, b));
+    nsds->link(SP::Interaction(new Interaction(1, nslaw, relation)), beads[0]);
+
+    SP::SimpleMatrix HOfBeads(new SimpleMatrix(1, 6));
+    (*HOfBeads)(0, 0) = -1.0;
+    (*HOfBeads)(0, 3) = 1.0;
+    SP::SiconosVector bOfBeads(new SiconosVector(1));
+    (*bOfBeads)(0) = -2 * R;
+    for (unsigned int i = 0; i + 1 < nBeads; ++i)
+    {
+      SP::Relation relationOfBeads(new LagrangianLinearTIR(HOfBeads, bOfBeads));
+      nsds->link(SP::Interaction(new Interaction(1, nslaw, relationOfBeads)),
+                 beads[i], beads[i + 1]);
+    }
+
+    osi.reset(new LsodarOSI());
+    osi->setJacobianType(jacobianType);
+    SP::TimeDiscretisation td(new TimeDiscretisation(0.0, 0.02));
+    simulation.reset(new EventDriven(td));
+    simulation->insertIntegrator(osi);
+    simulation->insertNonSmoothProblem(SP::OneStepNSProblem(new LCP()), SICONOS_OSNSP_ED_IMPACT);
+    simulation->insertNonSmoothProblem(SP::OneStepNSProblem(new LCP()), SICONOS_OSNSP_ED_SMOOTH_ACC);
+    model->setSimulation(simulation);
+    model->initialize();
+  }
+
+  /* the state given to LSODAR, in the order of the graph */
+  void state(std::vector<doublereal>& x)
+  {
+    x.clear();
+    DynamicalSystemsGraph& dsg = *osi->dynamicalSystemsGraph();
+    DynamicalSystemsGraph::VIterator dsi, dsend;
+    for (std11::tie(dsi, dsend) = dsg.vertices(); dsi != dsend; ++dsi)
+    {
+      LagrangianDS& ds = static_cast<LagrangianDS&>(*dsg.bundle(*dsi));
+      for (unsigned int k = 0; k < 3; ++k)
+        x.push_back((*ds.q())(k));
+      for (unsigned int k = 0; k < 3; ++k)
+        x.push_back((*ds.velocity())(k));
+    }
+  }
+
+  /* the full Jacobian by difference quotients, column j being
+     perturbed alone, with the increments of the colored differences */
+  void fullDifferences(std::vector<doublereal>& x, SimpleMatrix& J)
+  {
+    integer n = x.size();
+    doublereal t = simulation->startingTime();
+    std::vector<doublereal> f0(n), f1(n);
+    osi->f(&n, &t, &x[0], &f0[0]);
+    double sqrtPrec = std::sqrt(std::numeric_limits<double>::epsilon());
+    for (integer j = 0; j < n; ++j)
+    {
+      doublereal xj = x[j];
+      x[j] = xj + sqrtPrec * std::max(std::fabs(xj), 1.0);
+      doublereal h = x[j] - xj;
+      osi->f(&n, &t, &x[0], &f1[0]);
+      x[j] = xj;
+      for (integer i = 0; i < n; ++i)
+        J(i, j) = (f1[i] - f0[i]) / h;
+    }
+    osi->fillXWork(&n, &x[0]);
+  }
+
+  /* the banded Jacobian given to LSODAR, as a full matrix */
+  void bandedJacobian(std::vector<doublereal>& x, SimpleMatrix& J)
+  {
+    integer n = x.size();
+    doublereal t = simulation->startingTime();
+    integer ml = osi->getIwork()[0];
+    integer mu = osi->getIwork()[1];
+    integer nrowpd = ml + mu + 1;
+    std::vector<doublereal> f0(n);
+    osi->f(&n, &t, &x[0], &f0[0]);
+    std::vector<doublereal> band(nrowpd * n, 0.0);
+    osi->jacobianfx(&n, &t, &x[0], &ml, &mu, &band[0], &nrowpd);
+    J.zero();
+    for (integer j = 0; j < n; ++j)
+      for (integer i = std::max((integer)0, j - mu); i <= std::min(n - 1, j + ml); ++i)
+        J(i, j) = band[(i - j + mu) + j * nrowpd];
+  }
+};
+
+/* copies of a damped linear system without interactions: with one
+   copy, the state given to LSODAR is the vector of the system itself,
+   with two copies it is a contiguous copy of both vectors. The
+   weighted norms of LSODAR are the same in both cases. */
+struct LinearSystems
+{
+  SP::Model model;
+  SP::EventDriven simulation;
+  SP::LsodarOSI osi;
+  std::vector<SP::FirstOrderLinearTIDS> systems;
+
+  LinearSystems(unsigned int nCopies)
+  {
+    model.reset(new Model(0.0, 1.0));
+    for (unsigned int c = 0; c < nCopies; ++c)
+    {
+      SP::SiconosMatrix A(new SimpleMatrix(4, 4));
+      (*A)(0, 1) = (*A)(2, 3) = 1.0;
+      (*A)(1, 0) = -40.0;
+      (*A)(1, 1) = -0.5;
+      (*A)(1, 2) = 10.0;
+      (*A)(3, 0) = 10.0;
+      (*A)(3, 2) = -25.0;
+      (*A)(3, 3) = -0.2;
+      SP::SiconosVector b(new SiconosVector(4));
+      (*b)(1) = -9.81;
+      SP::SiconosVector x0(new SiconosVector(4));
+      (*x0)(0) = 1.0;
+      (*x0)(3) = -0.5;
+      systems.push_back(SP::FirstOrderLinearTIDS(new FirstOrderLinearTIDS(x0, A, b)));
+      model->nonSmoothDynamicalSystem()->insertDynamicalSystem(systems.back());
+    }
+    osi.reset(new LsodarOSI());
+    SP::TimeDiscretisation td(new TimeDiscretisation(0.0, 0.05));
+    simulation.reset(new EventDriven(td, 0));
+    simulation->insertIntegrator(osi);
+    model->setSimulation(simulation);
+    model->initialize();
+    osi->setTol(1, 1e-10, 1e-12);
+  }
+
+  void step()
+  {
+    simulation->advanceToEvent();
+    simulation->processEvents();
+  }
+};
+
+/* gives access to the state helpers of OneStepIntegrator */
+struct StateHelpers : public LsodarOSI
+{
+  static SP::SiconosVector contiguous(SP::SiconosVector tmp, BlockVector& work)
+  {
+    return contiguousState(tmp, work);
+  }
+  static void fill(const double* x, BlockVector& work)
+  {
+    fillState(x, work);
+  }
+  static void restore(const SiconosVector& tmp, BlockVector& work)
+  {
+    restoreState(tmp, work);
+  }
+};
+
+/* maximal absolute difference between two matrices */
+static double maxDifference(const SimpleMatrix& A, const SimpleMatrix& B)
+{
+  double d = 0.0;
+  for (unsigned int i = 0; i < A.size(0); ++i)
+    for (unsigned int j = 0; j < A.size(1); ++j)
+      d = std::max(d, std::fabs(A(i, j) - B(i, j)));
+  return d;
+}
+
+void LsodarOSITest::setUp()
+{}
+
+void LsodarOSITest::tearDown()
+{}
+
+void LsodarOSITest::testColoredDifferences()
+{
+  std::cout << "--> Test: LsodarOSI colored differences." <<std::endl;
+  FallingColumn column(6, LsodarOSI::banded_colored_differences);
+  // neighbours are coupled: 3 blocks of size 6 in the band
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testColoredDifferences : ml", (integer)11, column.osi->getIwork()[0]);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testColoredDifferences : mu", (integer)11, column.osi->getIwork()[1]);
+  // 3 groups of 6 columns instead of 36 columns
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testColoredDifferences : colors", 18u, column.osi->numberOfColors());
+
+  std::vector<doublereal> x;
+  column.state(x);
+  SimpleMatrix Jfull(x.size(), x.size());
+  SimpleMatrix Jband(x.size(), x.size());
+  column.fullDifferences(x, Jfull);
+  column.bandedJacobian(x, Jband);
+  CPPUNIT_ASSERT_MESSAGE("testColoredDifferences : nonzero Jacobian", Jfull.normInf() > 1.0);
+  CPPUNIT_ASSERT_MESSAGE("testColoredDifferences : J", maxDifference(Jfull, Jband) <= 1e-10 * Jfull.normInf());
+  std::cout << "--> testColoredDifferences ended with success." <<std::endl;
+}
+
+void LsodarOSITest::testBandedAnalytic()
+{
+  std::cout << "--> Test: LsodarOSI banded analytic Jacobian." <<std::endl;
+  FallingColumn column(6, LsodarOSI::banded_analytic);
+  // only the diagonal blocks of size 6 are in the band
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testBandedAnalytic : ml", (integer)5, column.osi->getIwork()[0]);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testBandedAnalytic : mu", (integer)5, column.osi->getIwork()[1]);
+
+  std::vector<doublereal> x;
+  column.state(x);
+  SimpleMatrix Jfull(x.size(), x.size());
+  SimpleMatrix Jband(x.size(), x.size());
+  column.fullDifferences(x, Jfull);
+  column.bandedJacobian(x, Jband);
+  CPPUNIT_ASSERT_MESSAGE("testBandedAnalytic : J", maxDifference(Jfull, Jband) <= 1e-6 * Jfull.normInf());
+  std::cout << "--> testBandedAnalytic ended with success." <<std::endl;
+}
+
+void LsodarOSITest::testJacobianTypes()
+{
+  std::cout << "--> Test: LsodarOSI Jacobian types." <<std::endl;
+  unsigned int types[4] = { LsodarOSI::full_differences, LsodarOSI::full_analytic,
+                            LsodarOSI::banded_analytic, LsodarOSI::banded_colored_differences };
+  std::vector<doublereal> x0, x[4];
+  for (unsigned int k = 0; k < 4; ++k)
+  {
+    FallingColumn column(6, types[k]);
+    column.osi->setTol(1, 1e-10, 1e-12);
+    column.state(x0);
+    while (column.simulation->hasNextEvent() && column.simulation->nextTime() <= 0.2)
+    {
+      column.simulation->advanceToEvent();
+      column.simulation->processEvents();
+    }
+    column.state(x[k]);
+  }
+  CPPUNIT_ASSERT_MESSAGE("testJacobianTypes : the beads move", std::fabs(x[0][0] - x0[0]) > 1e-2);
+  for (unsigned int k = 1; k < 4; ++k)
+    for (unsigned int i = 0; i < x[0].size(); ++i)
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("testJacobianTypes : state", x[0][i], x[k][i], 1e-7);
+  std::cout << "--> testJacobianTypes ended with success." <<std::endl;
+}
+
+void LsodarOSITest::testAliasedState()
+{
+  std::cout << "--> Test: LsodarOSI state aliased with a single dynamical system." <<std::endl;
+  // one block: the state is the vector of the system, nothing is copied
+  SP::SiconosVector x1(new SiconosVector(4, 1.0));
+  BlockVector single;
+  single.insertPtr(x1);
+  SP::SiconosVector tmp = StateHelpers::contiguous(SP::SiconosVector(), single);
+  CPPUNIT_ASSERT_MESSAGE("testAliasedState : aliased", tmp == x1);
+  (*tmp)(2) = 3.0;
+  StateHelpers::fill(tmp->getArray(), single);
+  StateHelpers::restore(*tmp, single);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("testAliasedState : aliased value", 3.0, (*x1)(2), 0.0);
+
+  // two blocks: a contiguous copy, filled and copied back
+  SP::SiconosVector x2(new SiconosVector(2, 2.0));
+  BlockVector two;
+  two.insertPtr(x1);
+  two.insertPtr(x2);
+  tmp = StateHelpers::contiguous(SP::SiconosVector(), two);
+  CPPUNIT_ASSERT_MESSAGE("testAliasedState : copy", tmp != x1 && tmp->size() == 6);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("testAliasedState : copied value", 2.0, (*tmp)(5), 0.0);
+  (*tmp)(5) = 5.0;
+  StateHelpers::restore(*tmp, two);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("testAliasedState : restored value", 5.0, (*x2)(1), 0.0);
+  double x[6] = { 0., 1., 2., 3., 4., 6. };
+  StateHelpers::fill(x, two);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("testAliasedState : filled value", 6.0, (*x2)(1), 0.0);
+
+  // the aliased integration of one system and the copying integration
+  // of two copies of it give the same trajectory. LSODAR keeps its
+  // state in common blocks: the integrations are not interleaved.
+  std::vector<double> times;
+  std::vector<SiconosVector> states;
+  {
+    LinearSystems aliased(1);
+    while (aliased.simulation->hasNextEvent() && aliased.simulation->nextTime() <= 1.0)
+    {
+      aliased.step();
+      times.push_back(aliased.simulation->startingTime());
+      states.push_back(*aliased.systems[0]->x());
+    }
+  }
+  CPPUNIT_ASSERT_MESSAGE("testAliasedState : steps", times.size() >= 20);
+  CPPUNIT_ASSERT_MESSAGE("testAliasedState : the system moves", std::fabs(states.back()(0) - 1.0) > 1e-2);
+
+  LinearSystems copied(2);
+  for (unsigned int k = 0; k < times.size(); ++k)
+  {
+    copied.step();
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("testAliasedState : time", times[k],
+                                         copied.simulation->startingTime(), 1e-14);
+    for (unsigned int c = 0; c < 2; ++c)
+      for (unsigned int i = 0; i < 4; ++i)
+        CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("testAliasedState : state", states[k](i),
+                                             (*copied.systems[c]->x())(i), 1e-8);
+  }
+  std::cout << "--> testAliasedState ended with success." <<std::endl;
+}
@@ -0,0 +1,57 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef __LsodarOSITest__
+#define __LsodarOSITest__
+
+#include <cppunit/extensions/HelperMacros.h>
+
+/* The banded Jacobians of LsodarOSI are the ones of the full
+   difference quotients, and an event-driven simulation gives the same
+   states with all the Jacobian types. The state of a single dynamical
+   system is given to LSODAR without copies, with the same results as
+   the copies of several systems. */
+class LsodarOSITest : public CppUnit::TestFixture
+{
+
+private:
+
+  // Name of the tests suite
+  CPPUNIT_TEST_SUITE(LsodarOSITest);
+
+  // tests to be done ...
+
+  CPPUNIT_TEST(testColoredDifferences);
+  CPPUNIT_TEST(testBandedAnalytic);
+  CPPUNIT_TEST(testJacobianTypes);
+  CPPUNIT_TEST(testAliasedState);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  void testColoredDifferences();
+  void testBandedAnalytic();
+  void testJacobianTypes();
+  void testAliasedState();
+
+public:
+
+  void setUp();
+  void tearDown();
+
+};
+
+#endif
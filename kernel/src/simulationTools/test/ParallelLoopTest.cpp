@@ -0,0 +1,197 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "ParallelLoopTest.hpp"
+#include "Model.hpp"
+#include "NonSmoothDynamicalSystem.hpp"
+#include "LagrangianDS.hpp"
+#include "LagrangianLinearTIR.hpp"
+#include "NewtonImpactNSL.hpp"
+#include "Interaction.hpp"
+#include "MoreauJeanOSI.hpp"
+#include "LCP.hpp"
+#include "OSNSMatrix.hpp"
+#include "TimeDiscretisation.hpp"
+#include "TimeStepping.hpp"
+#include "SimpleMatrix.hpp"
+#include "SiconosVector.hpp"
+#include "SiconosVectorException.hpp"
+
+#include <vector>
+
+// test suite registration
+CPPUNIT_TEST_SUITE_REGISTRATION(ParallelLoopTest);
+
+/* a bead whose forces may throw */
+class ColumnBead : public LagrangianDS
+{
+public:
+
+  bool fail;
+
+  ColumnBead(SP::SiconosVector q0, SP::SiconosVector v0, SP::SiconosMatrix mass):
+    LagrangianDS(q0, v0, mass), fail(false) {}
+
+  using LagrangianDS::computeForces;
+
+  void computeForces(double time, SP::SiconosVector q, SP::SiconosVector velocity)
+  {
+    if (fail)
+      SiconosVectorException::selfThrow("ColumnBead::computeForces failed");
+    LagrangianDS::computeForces(time, q, velocity);
+  }
+};
+TYPEDEF_SPTR(ColumnBead)
+
+/* a column of beads in contact on the ground, as in the ColumnOfBeads
+   example */
+struct Column
+{
+  SP::Model model;
+  SP::TimeStepping simulation;
+  SP::MoreauJeanOSI osi;
+  SP::LCP lcp;
+  std::vector<SP::ColumnBead> beads;
+
+  Column(unsigned int nBeads)
+  {
+    double R = 0.1;
+    SP::SiconosMatrix mass(new SimpleMatrix(3, 3));
+    (*mass)(0, 0) = 1.0;
+    (*mass)(1, 1) = 1.0;
+    (*mass)(2, 2) = 3. / 5 * R * R;
+    SP::SiconosVector weight(new SiconosVector(3));
+    (*weight)(0) = -9.81;
+
+    model.reset(new Model(0.0, 1.0));
+    SP::NonSmoothDynamicalSystem nsds = model->nonSmoothDynamicalSystem();
+    for (unsigned int i = 0; i < nBeads; ++i)
+    {
+      SP::SiconosVector q0(new SiconosVector(3));
+      SP::SiconosVector v0(new SiconosVector(3));
+      (*q0)(0) = R + 2 * R * i;
+      (*v0)(0) = -0.1 * i;
+      beads.push_back(SP::ColumnBead(new ColumnBead(q0, v0, mass)));
+      beads.back()->setFExtPtr(weight);
+      nsds->insertDynamicalSystem(beads.back());
+    }
+
+    SP::NonSmoothLaw nslaw(new NewtonImpactNSL(0.5));
+    SP::SimpleMatrix H(new SimpleMatrix(1, 3));
+    (*H)(0, 0) = 1.0;
+    SP::SiconosVector b(new SiconosVector(1));
+    (*b)(0) = -R;
+    SP::Relation relation(new LagrangianLinearTIR(H, b));
+    nsds->link(SP::Interaction(new Interaction(1, nslaw, relation)), beads[0]);
+
+    SP::SimpleMatrix HOfBeads(new SimpleMatrix(1, 6));
+    (*HOfBeads)(0, 0) = -1.0;
+    (*HOfBeads)(0, 3) = 1.0;
+    SP::SiconosVector bOfBeads(new SiconosVector(1));
+    (*bOfBeads)(0) = -2 * R;
+    for (unsigned int i = 0; i + 1 < nBeads; ++i)
+    {
+      SP::Relation relationOfBeads(new LagrangianLinearTIR(HOfBeads, bOfBeads));
+      nsds->link(SP::Interaction(new Interaction(1, nslaw, relationOfBeads)),
+                 beads[i], beads[i + 1]);
+    }
+
+    osi.reset(new MoreauJeanOSI(0.5));
+    lcp.reset(new LCP());
+    SP::TimeDiscretisation td(new TimeDiscretisation(0.0, 1e-3));
+    simulation.reset(new TimeStepping(td, osi, lcp));
+    model->setSimulation(simulation);
+    model->initialize();
+  }
+};
+
+static bool sameState(const Column& a, const Column& b)
+{
+  for (unsigned int i = 0; i < a.beads.size(); ++i)
+  {
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+      if ((*a.beads[i]->q())(k) != (*b.beads[i]->q())(k) ||
+          (*a.beads[i]->velocity())(k) != (*b.beads[i]->velocity())(k))
+        return false;
+    }
+  }
+  return true;
+}
+
+void ParallelLoopTest::setUp()
+{}
+
+void ParallelLoopTest::tearDown()
+{}
+
+void ParallelLoopTest::testDynamicalSystemsThreads()
+{
+  std::cout << "--> Test: MoreauJeanOSI threads." <<std::endl;
+  Column serial(20);
+  Column parallel(20);
+  parallel.osi->setThreadsNumber(4);
+  for (unsigned int k = 0; k < 50; ++k)
+  {
+    serial.simulation->computeOneStep();
+    parallel.simulation->computeOneStep();
+    CPPUNIT_ASSERT_MESSAGE("testDynamicalSystemsThreads : same state", sameState(serial, parallel));
+    serial.simulation->nextStep();
+    parallel.simulation->nextStep();
+  }
+  std::cout << "--> testDynamicalSystemsThreads ended with success." <<std::endl;
+}
+
+void ParallelLoopTest::testDynamicalSystemsException()
+{
+  std::cout << "--> Test: MoreauJeanOSI exception with threads." <<std::endl;
+  Column column(20);
+  column.osi->setThreadsNumber(4);
+  column.simulation->computeOneStep();
+  column.simulation->nextStep();
+  column.beads[13]->fail = true;
+  CPPUNIT_ASSERT_THROW(column.simulation->computeOneStep(), SiconosVectorException);
+  std::cout << "--> testDynamicalSystemsException ended with success." <<std::endl;
+}
+
+void ParallelLoopTest::testInteractionBlocksThreads()
+{
+  std::cout << "--> Test: OneStepNSProblem interaction blocks threads." <<std::endl;
+  Column serial(20);
+  Column parallel(20);
+  serial.lcp->setReuseInteractionBlocks(false);
+  parallel.lcp->setReuseInteractionBlocks(false);
+  parallel.lcp->setInteractionBlocksThreadsNumber(4);
+  for (unsigned int k = 0; k < 50; ++k)
+  {
+    serial.simulation->computeOneStep();
+    parallel.simulation->computeOneStep();
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("testInteractionBlocksThreads : blocks",
+                                 serial.lcp->numberOfInteractionBlocks(),
+                                 parallel.lcp->numberOfInteractionBlocks());
+    SP::SiconosMatrix Ms = serial.lcp->M()->defaultMatrix();
+    SP::SiconosMatrix Mp = parallel.lcp->M()->defaultMatrix();
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("testInteractionBlocksThreads : size", Ms->size(0), Mp->size(0));
+    for (unsigned int i = 0; i < Ms->size(0); ++i)
+      for (unsigned int j = 0; j < Ms->size(1); ++j)
+        CPPUNIT_ASSERT_EQUAL_MESSAGE("testInteractionBlocksThreads : M", (*Ms)(i, j), (*Mp)(i, j));
+    CPPUNIT_ASSERT_MESSAGE("testInteractionBlocksThreads : same state", sameState(serial, parallel));
+    serial.simulation->nextStep();
+    parallel.simulation->nextStep();
+  }
+  std::cout << "--> testInteractionBlocksThreads ended with success." <<std::endl;
+}
@@ -0,0 +1,55 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef __ParallelLoopTest__
+#define __ParallelLoopTest__
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "SiconosFwd.hpp"
+
+/* The loops of MoreauJeanOSI over the dynamical systems and of
+   OneStepNSProblem over the interaction blocks give the same results
+   with several threads as with one, and keep the exceptions of the
+   systems. */
+class ParallelLoopTest : public CppUnit::TestFixture
+{
+
+private:
+
+  // Name of the tests suite
+  CPPUNIT_TEST_SUITE(ParallelLoopTest);
+
+  // tests to be done ...
+
+  CPPUNIT_TEST(testDynamicalSystemsThreads);
+  CPPUNIT_TEST(testDynamicalSystemsException);
+  CPPUNIT_TEST(testInteractionBlocksThreads);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  void testDynamicalSystemsThreads();
+  void testDynamicalSystemsException();
+  void testInteractionBlocksThreads();
+
+public:
+
+  void setUp();
+  void tearDown();
+
+};
+
+#endif
@@ -0,0 +1,271 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "TopologyTest.hpp"
+#include "NonSmoothDynamicalSystem.hpp"
+#include "Topology.hpp"
+#include "LagrangianLinearTIDS.hpp"
+#include "LagrangianLinearTIR.hpp"
+#include "NewtonImpactNSL.hpp"
+#include "Interaction.hpp"
+#include "SimpleMatrix.hpp"
+#include "SiconosVector.hpp"
+
+#include <map>
+#include <set>
+#include <vector>
+#include <algorithm>
+
+// test suite registration
+CPPUNIT_TEST_SUITE_REGISTRATION(TopologyTest);
+
+/* 5 beads, with 4 contacts with the ground for each bead and a contact
+   between each pair of neighbours. The interactions are numbered in
+   the order of their creation, so that two scenes can be compared. */
+struct Scene
+{
+  SP::NonSmoothDynamicalSystem nsds;
+  std::vector<SP::DynamicalSystem> beads;
+  std::vector<SP::Interaction> inters;
+  std::map<Interaction*, unsigned int> interNumber;
+  std::map<DynamicalSystem*, unsigned int> dsNumber;
+
+  Scene()
+  {
+    nsds.reset(new NonSmoothDynamicalSystem());
+    for (unsigned int i = 0; i < 5; ++i)
+    {
+      SP::SiconosVector q0(new SiconosVector(1));
+      SP::SiconosVector v0(new SiconosVector(1));
+      SP::SiconosMatrix mass(new SimpleMatrix(1, 1));
+      (*mass)(0, 0) = 1.0;
+      (*q0)(0) = i;
+      beads.push_back(SP::DynamicalSystem(new LagrangianLinearTIDS(q0, v0, mass)));
+      dsNumber[beads.back().get()] = i;
+      nsds->insertDynamicalSystem(beads.back());
+    }
+    for (unsigned int i = 0; i < 5; ++i)
+      for (unsigned int k = 0; k < 4; ++k)
+        link(i);
+    for (unsigned int i = 0; i + 1 < 5; ++i)
+      link(i, i + 1);
+  }
+
+  /* link a new interaction to bead i, or to beads i and j */
+  SP::Interaction link(unsigned int i, int j = -1)
+  {
+    SP::SimpleMatrix H(new SimpleMatrix(1, j < 0 ? 1 : 2));
+    (*H)(0, 0) = 1.0;
+    SP::Relation relation(new LagrangianLinearTIR(H));
+    SP::NonSmoothLaw nslaw(new NewtonImpactNSL(0.5));
+    SP::Interaction inter(new Interaction(1, nslaw, relation));
+    interNumber[inter.get()] = inters.size();
+    inters.push_back(inter);
+    if (j < 0)
+      nsds->link(inter, beads[i]);
+    else
+      nsds->link(inter, beads[i], beads[j]);
+    return inter;
+  }
+
+  void remove(unsigned int k)
+  {
+    nsds->removeInteraction(inters[k]);
+  }
+
+  /* the edges of indexSet0, as (interaction, interaction, ds) with the
+     interactions sorted */
+  std::multiset<std::vector<unsigned int> > indexSet0Edges()
+  {
+    std::multiset<std::vector<unsigned int> > edges;
+    InteractionsGraph& IG0 = *nsds->topology()->indexSet0();
+    InteractionsGraph::EIterator ei, eiend;
+    for (std11::tie(ei, eiend) = IG0.edges(); ei != eiend; ++ei)
+    {
+      std::vector<unsigned int> e(3);
+      e[0] = interNumber[IG0.bundle(IG0.source(*ei)).get()];
+      e[1] = interNumber[IG0.bundle(IG0.target(*ei)).get()];
+      if (e[0] > e[1])
+        std::swap(e[0], e[1]);
+      e[2] = dsNumber[IG0.bundle(*ei).get()];
+      edges.insert(e);
+    }
+    return edges;
+  }
+
+  /* the edges of the dynamical systems graph, as (ds, ds, interaction)
+     with the ds sorted */
+  std::multiset<std::vector<unsigned int> > dsgEdges()
+  {
+    std::multiset<std::vector<unsigned int> > edges;
+    DynamicalSystemsGraph& DSG0 = *nsds->topology()->dSG(0);
+    DynamicalSystemsGraph::EIterator ei, eiend;
+    for (std11::tie(ei, eiend) = DSG0.edges(); ei != eiend; ++ei)
+    {
+      std::vector<unsigned int> e(3);
+      e[0] = dsNumber[DSG0.bundle(DSG0.source(*ei)).get()];
+      e[1] = dsNumber[DSG0.bundle(DSG0.target(*ei)).get()];
+      if (e[0] > e[1])
+        std::swap(e[0], e[1]);
+      e[2] = interNumber[DSG0.bundle(*ei).get()];
+      edges.insert(e);
+    }
+    return edges;
+  }
+
+  /* the interactions of indexSet0 and their indices */
+  std::map<unsigned int, unsigned int> indexSet0Vertices()
+  {
+    std::map<unsigned int, unsigned int> vertices;
+    InteractionsGraph& IG0 = *nsds->topology()->indexSet0();
+    InteractionsGraph::VIterator vi, viend;
+    for (std11::tie(vi, viend) = IG0.vertices(); vi != viend; ++vi)
+      vertices[interNumber[IG0.bundle(*vi).get()]] = IG0.index(*vi);
+    return vertices;
+  }
+};
+
+/* compare the graphs of a and b, b being updated in a batch if
+   batch is true */
+static void checkSameGraphs(Scene& a, Scene& b, const std::string& msg, bool batch = true)
+{
+  CPPUNIT_ASSERT_MESSAGE(msg + " : indexSet0 edges", a.indexSet0Edges() == b.indexSet0Edges());
+  CPPUNIT_ASSERT_MESSAGE(msg + " : DSG0 edges", a.dsgEdges() == b.dsgEdges());
+  std::map<unsigned int, unsigned int> va = a.indexSet0Vertices();
+  std::map<unsigned int, unsigned int> vb = b.indexSet0Vertices();
+  CPPUNIT_ASSERT_EQUAL_MESSAGE(msg + " : indexSet0 vertices", va.size(), vb.size());
+  std::set<unsigned int> indices;
+  for (std::map<unsigned int, unsigned int>::iterator it = vb.begin(); it != vb.end(); ++it)
+  {
+    CPPUNIT_ASSERT_MESSAGE(msg + " : same interactions", va.count(it->first) == 1);
+    indices.insert(it->second);
+  }
+  // the indices of a batch are recomputed, from 0 to size - 1
+  if (batch)
+    CPPUNIT_ASSERT_MESSAGE(msg + " : indices", indices.size() == vb.size() &&
+                           *indices.rbegin() == vb.size() - 1);
+}
+
+/* set the upper block of the indexSet0 edges between interactions k1 and k2 */
+static unsigned int markEdges(Scene& s, unsigned int k1, unsigned int k2)
+{
+  InteractionsGraph& IG0 = *s.nsds->topology()->indexSet0();
+  unsigned int n = 0;
+  InteractionsGraph::EIterator ei, eiend;
+  for (std11::tie(ei, eiend) = IG0.edges(); ei != eiend; ++ei)
+  {
+    SP::Interaction i1 = IG0.bundle(IG0.source(*ei));
+    SP::Interaction i2 = IG0.bundle(IG0.target(*ei));
+    if ((i1 == s.inters[k1] && i2 == s.inters[k2]) || (i1 == s.inters[k2] && i2 == s.inters[k1]))
+    {
+      if (!IG0.properties(*ei).upper_block)
+        IG0.properties(*ei).upper_block.reset(new SimpleMatrix(1, 1));
+      else
+        n++;
+    }
+  }
+  return n;
+}
+
+void TopologyTest::setUp()
+{}
+
+void TopologyTest::tearDown()
+{}
+
+void TopologyTest::testBatchSingleRemoval()
+{
+  std::cout << "--> Test: Topology batch with a single removal." <<std::endl;
+  Scene serial, batch;
+  checkSameGraphs(serial, batch, "testBatchSingleRemoval : initial", false);
+
+  // the edge between the contacts 8 and 9 of bead 2 is not modified
+  markEdges(batch, 8, 9);
+
+  serial.remove(0);
+  serial.link(0);
+  serial.link(1, 3);
+
+  batch.nsds->topology()->beginUpdate();
+  batch.remove(0);
+  batch.link(0);
+  batch.link(1, 3);
+  CPPUNIT_ASSERT_MESSAGE("testBatchSingleRemoval : updating", batch.nsds->topology()->isUpdating());
+  batch.nsds->topology()->commit();
+
+  checkSameGraphs(serial, batch, "testBatchSingleRemoval");
+  // a single removal does not rebuild the other edges
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testBatchSingleRemoval : edges kept", 1u, markEdges(batch, 8, 9));
+  std::cout << "--> testBatchSingleRemoval ended with success." <<std::endl;
+}
+
+void TopologyTest::testBatchManyRemovals()
+{
+  std::cout << "--> Test: Topology batch with many removals." <<std::endl;
+  Scene serial, batch;
+
+  // the contacts of beads 0, 1 and 2 with the ground, in another order
+  unsigned int removed[12] = { 4, 0, 8, 1, 5, 9, 2, 6, 10, 3, 7, 11 };
+  for (unsigned int k = 0; k < 12; ++k)
+    serial.remove(removed[k]);
+  serial.link(1);
+  serial.link(0, 2);
+  serial.remove(21);
+
+  batch.nsds->topology()->beginUpdate();
+  for (unsigned int k = 0; k < 6; ++k)
+    batch.remove(removed[k]);
+  batch.nsds->topology()->beginUpdate(); // nested
+  for (unsigned int k = 6; k < 12; ++k)
+    batch.remove(removed[k]);
+  batch.nsds->topology()->commit();
+  CPPUNIT_ASSERT_MESSAGE("testBatchManyRemovals : still updating", batch.nsds->topology()->isUpdating());
+  batch.link(1);
+  batch.link(0, 2);
+  batch.remove(21);
+  batch.nsds->topology()->commit();
+  CPPUNIT_ASSERT_MESSAGE("testBatchManyRemovals : update done", !batch.nsds->topology()->isUpdating());
+
+  checkSameGraphs(serial, batch, "testBatchManyRemovals");
+  std::cout << "--> testBatchManyRemovals ended with success." <<std::endl;
+}
+
+void TopologyTest::testRemoveInteractions()
+{
+  std::cout << "--> Test: Topology::removeInteractions." <<std::endl;
+  Scene serial, batch, single;
+  std::vector<SP::Interaction> inters;
+  unsigned int removed[5] = { 17, 2, 20, 3, 23 };
+  for (unsigned int k = 0; k < 5; ++k)
+  {
+    serial.remove(removed[k]);
+    inters.push_back(batch.inters[removed[k]]);
+  }
+  batch.nsds->topology()->removeInteractions(inters);
+  checkSameGraphs(serial, batch, "testRemoveInteractions");
+
+  // a single interaction
+  serial.remove(12);
+  single.remove(17);
+  single.remove(2);
+  single.remove(20);
+  single.remove(3);
+  single.remove(23);
+  single.nsds->topology()->removeInteractions(std::vector<SP::Interaction>(1, single.inters[12]));
+  checkSameGraphs(serial, single, "testRemoveInteractions : single");
+  std::cout << "--> testRemoveInteractions ended with success." <<std::endl;
+}
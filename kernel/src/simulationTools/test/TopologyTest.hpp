@@ -0,0 +1,53 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef __TopologyTest__
+#define __TopologyTest__
+
+#include <cppunit/extensions/HelperMacros.h>
+
+/* A batch of modifications of the topology between beginUpdate() and
+   commit() gives the same graphs as the same modifications done one by
+   one. */
+class TopologyTest : public CppUnit::TestFixture
+{
+
+private:
+
+  // Name of the tests suite
+  CPPUNIT_TEST_SUITE(TopologyTest);
+
+  // tests to be done ...
+
+  CPPUNIT_TEST(testBatchSingleRemoval);
+  CPPUNIT_TEST(testBatchManyRemovals);
+  CPPUNIT_TEST(testRemoveInteractions);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  void testBatchSingleRemoval();
+  void testBatchManyRemovals();
+  void testRemoveInteractions();
+
+public:
+
+  void setUp();
+  void tearDown();
+
+};
+
+#endif
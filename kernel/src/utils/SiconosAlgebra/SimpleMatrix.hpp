@@ -84,6 +84,23 @@ private:
    */
   bool _isPLUInversed;
 
+  /** std11::shared_ptr<cs_lu_factors> _sparseLU;
+   *  The CSparse LU factors of a sparse matrix (PLUFactorizationInPlace).
+   *  Unlike the dense case, the matrix itself is not modified.
+   */
+  std11::shared_ptr<cs_lu_factors> _sparseLU;
+
+  /** computes the CSparse LU factorization of a sparse matrix into _sparseLU
+   */
+  void sparseLUFactorization();
+
+  /** solves in place the linear system with the CSparse LU factors,
+   *  factorizing the matrix first if needed
+   * \param[in,out] b on input the RHS; on output the solution
+   * \param nrhs the number of RHS, stored contiguously in b
+   */
+  void sparseLUSolve(double* b, unsigned int nrhs);
+
   /**  computes res = subA*x +res, subA being a submatrix of A (rows from startRow to startRow+sizeY and columns between startCol and startCol+sizeX).
    * If x is a block vector, it call the present function for all blocks.
    * \param A a pointer to SiconosMatrix 
@@ -607,6 +624,8 @@ public:
 
   /** computes an LU factorization of a general M-by-N matrix using partial pivoting with row interchanges.
    *  The result is returned in this (InPlace). Based on Blas dgetrf function.
+   *  For a sparse matrix, the LU factors are computed with CSparse and
+   *  stored aside, the matrix itself is kept.
    */
   void PLUFactorizationInPlace();
 
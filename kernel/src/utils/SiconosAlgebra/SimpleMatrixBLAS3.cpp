@@ -983,6 +983,13 @@ void scal(double a, const SiconosMatrix& A, SiconosMatrix& B, bool init)
             B += tmp; // bof bof ...
           }
         }
+        else if (numB == 4 && numA == 1) // sparse B, only the non-zero elements of A are inserted
+        {
+          if (init)
+            noalias(*B.sparse()) = a ** A.dense();
+          else
+            noalias(*B.sparse()) += a ** A.dense();
+        }
         else
         {
           if (numB != 1)
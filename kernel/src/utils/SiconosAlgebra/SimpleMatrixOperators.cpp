@@ -175,6 +175,9 @@ SimpleMatrix& SimpleMatrix::operator = (const SiconosMatrix& m)
     case 4:
       switch (numM)
       {
+      case 1: // only the non-zero elements of m are inserted
+        noalias(*(mat.Sparse)) = *m.dense();
+        break;
       case 2:
         noalias(*(mat.Sparse)) = *m.triang();
         break;
@@ -280,6 +283,9 @@ SimpleMatrix& SimpleMatrix::operator = (const SimpleMatrix& m)
   case 4:
     switch (numM)
     {
+    case 1: // only the non-zero elements of m are inserted
+      noalias(*(mat.Sparse)) = *m.dense();
+      break;
     case 2:
       noalias(*(mat.Sparse)) = *m.triang();
       break;
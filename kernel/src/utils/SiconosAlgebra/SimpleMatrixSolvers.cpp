@@ -18,6 +18,8 @@
 
 #include "SiconosConfig.h"
 
+#include <float.h>
+
 #pragma GCC diagnostic ignored "-Wunused-local-typedefs"
 
 #include <boost/numeric/ublas/lu.hpp>
@@ -38,7 +40,6 @@ namespace lapack = boost::numeric::bindings::lapack;
 
 
 #include "SiconosVector.hpp"
-#include "cholesky.hpp"
 #include "SimpleMatrix.hpp"
 #include "BlockMatrixIterators.hpp"
 #include "BlockMatrix.hpp"
@@ -70,18 +71,71 @@ void SimpleMatrix::PLUFactorizationInPlace()
   }
   else
   {
-    int info = cholesky_decompose(*sparse());
-    // \warning: VA 24/11/2010: work only for symmetric matrices. Should be replaced by efficient implementatation (e.g. mumps )
-    if (info != 0)
+    sparseLUFactorization();
+    _isPLUFactorized = true;
+  }
+
+}
+
+void SimpleMatrix::sparseLUFactorization()
+{
+  const SparseMat& A = *sparse();
+  size_t n = size(0);
+  if (n != size(1))
+    SiconosMatrixException::selfThrow("SimpleMatrix::PLUFactorizationInPlace failed: the sparse matrix is not square.");
+
+  // copy of A in compressed column format, explicit zeros are dropped.
+  CSparseMatrix* csc = cs_spalloc(n, n, std::max<size_t>(A.nnz(), 1), 1, 0);
+  csi nz = 0;
+  size_t col = 0;
+  csc->p[0] = 0;
+  for (SparseMat::const_iterator2 it2 = A.begin2(); it2 != A.end2(); ++it2)
+  {
+    size_t j = it2.index2();
+    for (; col < j; ++col)
+      csc->p[col + 1] = nz;
+    for (SparseMat::const_iterator1 it1 = it2.begin(); it1 != it2.end(); ++it1)
     {
-      display();
-      _isPLUFactorized = false;
-      std::cout << "Problem in Cholesky Decomposition for the row number" << info   << std::endl;
-      SiconosMatrixException::selfThrow("SimpleMatrix::PLUFactorizationInPlace failed. ");
+      if (*it1 != 0.0)
+      {
+        csc->i[nz] = it1.index1();
+        csc->x[nz++] = *it1;
+      }
     }
-    else _isPLUFactorized = true;
+    csc->p[j + 1] = nz;
+    col = j + 1;
+  }
+  for (; col < n; ++col)
+    csc->p[col + 1] = nz;
+
+  _sparseLU.reset((cs_lu_factors*) malloc(sizeof(cs_lu_factors)), cs_sparse_free);
+  _sparseLU->S = NULL;
+  _sparseLU->N = NULL;
+  int info = cs_lu_factorization(1, csc, DBL_EPSILON, _sparseLU.get());
+  cs_spfree(csc);
+  if (!info)
+  {
+    _sparseLU.reset();
+    _isPLUFactorized = false;
+    SiconosMatrixException::selfThrow("SimpleMatrix::PLUFactorizationInPlace failed: the sparse matrix is singular.");
   }
+}
 
+void SimpleMatrix::sparseLUSolve(double* b, unsigned int nrhs)
+{
+  // The flag may have been copied or restored without the factors.
+  if (!_isPLUFactorized || !_sparseLU)
+  {
+    _isPLUFactorized = false;
+    PLUFactorizationInPlace();
+  }
+  size_t n = size(0);
+  std::vector<double> work(n);
+  for (unsigned int k = 0; k < nrhs; ++k)
+  {
+    if (!cs_solve(_sparseLU.get(), &work[0], b + k * n))
+      SiconosMatrixException::selfThrow("SimpleMatrix::PLUForwardBackwardInPlace failed.");
+  }
 }
 
 void SimpleMatrix::PLUInverseInPlace()
@@ -139,20 +193,16 @@ void SimpleMatrix::PLUForwardBackwardInPlace(SiconosMatrix &B)
   }
   else
   {
-    if (!_isPLUFactorized) // call first PLUFactorizationInPlace
-    {
-      PLUFactorizationInPlace();
-    }
-    // and then solve
+    // B is column-major: its columns are solved one after the other.
     if (B.num() == 1)
     {
-      inplace_solve(*sparse(), *(B.dense()), ublas::lower_tag());
-      inplace_solve(ublas::trans(*sparse()), *(B.dense()), ublas::upper_tag());
+      sparseLUSolve(B.getArray(), B.size(1));
     }
     else if (B.num() == 4)
     {
-      inplace_solve(*sparse(), *(B.sparse()), ublas::lower_tag());
-      inplace_solve(ublas::trans(*sparse()), *(B.sparse()), ublas::upper_tag());
+      DenseMat tmpB(*B.sparse());
+      sparseLUSolve(&(tmpB.data()[0]), B.size(1));
+      noalias(*B.sparse()) = tmpB;
     }
     else
       SiconosMatrixException::selfThrow(" SimpleMatrix::PLUInverseInPlace: only implemented for dense ans sparse matrices in RHS.");
@@ -205,13 +255,7 @@ void SimpleMatrix::PLUForwardBackwardInPlace(SiconosVector &B)
   }
   else
   {
-    if (!_isPLUFactorized) // call first PLUFactorizationInPlace
-    {
-      PLUFactorizationInPlace();
-    }
-    // and then solve
-    inplace_solve(*sparse(), tmpB, ublas::lower_tag());
-    inplace_solve(ublas::trans(*sparse()), tmpB, ublas::upper_tag());
+    sparseLUSolve(&(tmpB.data()[0]), 1);
     info = 0;
   }
   if (info != 0)
@@ -225,6 +269,7 @@ void SimpleMatrix::PLUForwardBackwardInPlace(SiconosVector &B)
 void SimpleMatrix::resetLU()
 {
   if (_ipiv) _ipiv->clear();
+  _sparseLU.reset();
   _isPLUFactorized = false;
   _isPLUInversed = false;
 }
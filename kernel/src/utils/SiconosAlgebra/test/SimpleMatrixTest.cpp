@@ -3346,6 +3346,56 @@ void SimpleMatrixTest::testGemm()
 
 
 
+void SimpleMatrixTest::testPLUForwardBackwardSparse()
+{
+  std::cout << "--> Test: PLUForwardBackwardInPlace, sparse matrix." <<std::endl;
+
+  // non symmetric tridiagonal matrix
+  unsigned int n = 20;
+  SimpleMatrix Ad(n, n);
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    Ad(i, i) = 4.0;
+    if (i > 0) Ad(i, i - 1) = -1.0;
+    if (i < n - 1) Ad(i, i + 1) = -2.0;
+  }
+  SimpleMatrix As(n, n, Siconos::SPARSE, 3 * n);
+  As = Ad;
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testPLUForwardBackwardSparse: ", As.sparse()->nnz(), (size_t)(3 * n - 2));
+
+  SiconosVector b(n), x(n), y(n);
+  for (unsigned int i = 0; i < n; ++i)
+    b(i) = (double) i - 3.0;
+
+  x = b;
+  As.PLUForwardBackwardInPlace(x);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testPLUForwardBackwardSparse: ", As.isPLUFactorized(), true);
+  prod(Ad, x, y);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testPLUForwardBackwardSparse: ", (y - b).normInf() < tol, true);
+
+  // the factorization is reused and the matrix is kept
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testPLUForwardBackwardSparse: ", norm_inf(*As.sparse() - *Ad.dense()) < tol, true);
+  SimpleMatrix B(n, 2);
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    B(i, 0) = b(i);
+    B(i, 1) = 1.0;
+  }
+  SimpleMatrix X(B);
+  As.PLUForwardBackwardInPlace(X);
+  SimpleMatrix Y(n, 2);
+  prod(Ad, X, Y);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testPLUForwardBackwardSparse: ", norm_inf(*Y.dense() - *B.dense()) < tol, true);
+
+  // a copy is factorized again
+  SimpleMatrix As2(As);
+  x = b;
+  As2.PLUForwardBackwardInPlace(x);
+  prod(Ad, x, y);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testPLUForwardBackwardSparse: ", (y - b).normInf() < tol, true);
+  std::cout << "-->  test PLUForwardBackwardInPlace (sparse) ended with success." <<std::endl;
+}
+
 void SimpleMatrixTest::End()
 {
   std::cout << "======================================" <<std::endl;
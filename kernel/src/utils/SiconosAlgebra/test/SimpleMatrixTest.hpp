@@ -92,6 +92,7 @@ private:
   CPPUNIT_TEST(testProd6);
   CPPUNIT_TEST(testGemv);
   CPPUNIT_TEST(testGemm);
+  CPPUNIT_TEST(testPLUForwardBackwardSparse);
   CPPUNIT_TEST(End);
   CPPUNIT_TEST_SUITE_END();
 
@@ -150,6 +151,7 @@ private:
   void testProd6();
   void testGemm();
   void testGemv();
+  void testPLUForwardBackwardSparse();
   void End();
 
   unsigned int size, size2;
@@ -73,15 +73,16 @@ SiconosMemory::SiconosMemory(const unsigned int newMemorySize, const MemoryConta
 SiconosMemory::SiconosMemory(const SiconosMemory& Mem)
 {
   _size = Mem.getMemorySize();
-  _indx = _size-1;
+  // the slots are copied in place, so the index of the ring buffer is kept
+  _indx = Mem._indx;
   _nbVectorsInMemory = Mem.nbVectorsInMemory();
   _vectorMemory.reset(new MemoryContainer);
   _vectorMemory->resize(_size);
-  // XXX is this correct ?
-  const MemoryContainer VtoCopy = *(Mem.vectorMemory());
+  const MemoryContainer& VtoCopy = *(Mem.vectorMemory());
   for (unsigned int i = 0; i < VtoCopy.size(); i++)
   {
-    (*_vectorMemory)[i].reset(new SiconosVector(*VtoCopy[i]));
+    if (VtoCopy[i])
+      (*_vectorMemory)[i].reset(new SiconosVector(*VtoCopy[i]));
   }
 
 }
@@ -98,24 +99,18 @@ void SiconosMemory::setVectorMemory(const MemoryContainer& V)
 {
   _size = V.size();
   _indx = _size-1;
-  _vectorMemory->resize(_size);
   _nbVectorsInMemory = _size;
   _vectorMemory->clear();
+  _vectorMemory->resize(_size);
   for (unsigned int i = 0; i < V.size(); i++)
   {
     (*_vectorMemory)[i].reset(new SiconosVector(*V[i]));
   }
 }
 
-SP::SiconosVector SiconosMemory::getSiconosVector(const unsigned int index) const
-{
-  assert(index < _nbVectorsInMemory && "getSiconosVector(index) : inconsistent index value");
-  return _vectorMemory->at( (_indx + 1 + index) % _size);
-}
-
 void SiconosMemory::swap(const SiconosVector& v)
 {
-  // If vectorMemory size is _size, we remove its last element.
+  // v overwrites the oldest vector, no vector is allocated
   *(*_vectorMemory)[_indx] = v;
   _nbVectorsInMemory = std::min(_nbVectorsInMemory+1, _size);
   if (_indx > 0)
@@ -124,6 +119,17 @@ void SiconosMemory::swap(const SiconosVector& v)
     _indx = _size-1;
 }
 
+void SiconosMemory::reset()
+{
+  for (unsigned int i = 0; i < _vectorMemory->size(); i++)
+  {
+    if ((*_vectorMemory)[i])
+      (*_vectorMemory)[i]->zero();
+  }
+  _nbVectorsInMemory = 0;
+  _indx = _size-1;
+}
+
 void SiconosMemory::display() const
 {
   std::cout << " ====== Memory vector display ======= " <<std::endl;
@@ -132,8 +138,8 @@ void SiconosMemory::display() const
   std::cout << "| vectorMemory size : " << _vectorMemory->size() <<std::endl;
   for (unsigned int i = 0; i < _nbVectorsInMemory; i++)
   {
-    std::cout << "vector number " << i << ": adress = " << (*_vectorMemory)[i] << " | " <<std::endl; ;
-    (*_vectorMemory)[i]->display();
+    std::cout << "vector number " << i << ": adress = " << getSiconosVector(i) << " | " <<std::endl; ;
+    getSiconosVector(i)->display();
   }
   std::cout << " ===================================== " <<std::endl;
 }
@@ -27,11 +27,11 @@
 
 #include "SiconosMemoryException.hpp"
 #include "SiconosPointers.hpp"
-#include <deque>
+#include <vector>
 #include "SiconosAlgebraTypeDef.hpp"
 
 /** Container used to save vectors in SiconosMemory */
-typedef std::deque<SP::SiconosVector> MemoryContainer;
+typedef std::vector<SP::SiconosVector> MemoryContainer;
 TYPEDEF_SPTR(MemoryContainer)
 
 /** This class is a backup for vectors of previous time step
@@ -42,6 +42,14 @@ TYPEDEF_SPTR(MemoryContainer)
     There is a max number of saved vector (memorySize) and all the vector (simple or block)
     should have the same size.
 
+    The vectors are kept in a ring buffer: swap() copies the new
+    vector into the oldest slot and moves the index of the most recent
+    one, without any allocation or shift of the other vectors. Each
+    slot is a SiconosVector with its own storage, the data of the
+    memory is not one contiguous block: a SiconosVector owns the
+    std::vector of its DenseVect and cannot be a view on a part of a
+    larger array.
+
 */
 class SiconosMemory
 {
@@ -57,10 +65,12 @@ private:
   /** the real number of SiconosVectors saved in the Memory (ie the ones for which memory has been allocated) */
   unsigned int _nbVectorsInMemory;
 
-  /** the stl deque which contains the SiconosVectors kept in memory */
+  /** the ring buffer of the SiconosVectors kept in memory, one
+   * pointer per slot */
   SP::MemoryContainer _vectorMemory;
 
-  /** index to avoid removal and creation of vectors */
+  /** slot of the ring buffer where the next vector is saved, the most
+   * recent one is in the next slot */
   unsigned int _indx;
 
   /** default constructor, private. */
@@ -79,18 +89,18 @@ public:
    */
   SiconosMemory(const unsigned int size, const unsigned int vectorSize);
 
-  /** constructor with deque parameter.
-   * \param deque MemoryContainer, the deque of siconosVector which must be stored
-   * _size is set to the size of the deque given in parameters
+  /** constructor with container parameter.
+   * \param v MemoryContainer, the siconosVectors which must be stored
+   * _size is set to the size of the container given in parameters
    */
-  SiconosMemory(const MemoryContainer& deque);
+  SiconosMemory(const MemoryContainer& v);
 
-  /** constructor with size and deque parameter.
+  /** constructor with size and container parameter.
    * \param size int , the size of the memory
-   * \param deque MemoryContainer, the deque of siconosVector which must be stored
-   * this constructor is useful if the deque given in parameters has a size lower than the normal size of the memory
+   * \param v MemoryContainer, the siconosVectors which must be stored
+   * this constructor is useful if the container given in parameters has a size lower than the normal size of the memory
    */
-  SiconosMemory(const unsigned int size, const MemoryContainer& deque);
+  SiconosMemory(const unsigned int size, const MemoryContainer& v);
 
   /** Copy constructor
    * \param Mem a SiconosMemory
@@ -104,15 +114,21 @@ public:
 
   /** fill the memory with a vector of siconosVector
    * \param v MemoryContainer
-   *       _size is set to the size of the deque given in parameters
+   *       _size is set to the size of the container given in parameters
    */
   void setVectorMemory(const MemoryContainer& v );
 
   /** To get SiconosVector number i of the memory
-   * \param int i: the position in the memory of the wanted SiconosVector
+   * \param index the position in the memory of the wanted SiconosVector,
+   * 0 for the most recent one
    * \return a SP::SiconosVector
    */
-  SP::SiconosVector getSiconosVector(const unsigned int) const;
+  inline const SP::SiconosVector& getSiconosVector(const unsigned int index) const
+  {
+    assert(index < _nbVectorsInMemory && "getSiconosVector(index) : inconsistent index value");
+    unsigned int i = _indx + 1 + index;
+    return (*_vectorMemory)[i < _size ? i : i - _size];
+  };
 
   /** gives the size of the memory
    * \return int >= 0
@@ -138,8 +154,9 @@ public:
     return _nbVectorsInMemory;
   };
 
-  /** gives the vector of SiconosVectors of the memory
-   * \return stl deque of  SiconosVector
+  /** gives the vector of SiconosVectors of the memory, in the order
+   * of the ring buffer
+   * \return stl vector of SiconosVector
    */
   inline SP::MemoryContainer vectorMemory() const
   {
@@ -151,6 +168,11 @@ public:
    */
   void swap(const SiconosVector& v);
 
+  /** empty the memory: the vectors are zeroed and kept allocated for
+   * the next calls of swap()
+   */
+  void reset();
+
   /** displays the data of the memory object
    */
   void display() const;
@@ -164,6 +164,49 @@ void SiconosMemoryTest::testSwap()
   std::cout << "-->  swap test ended with success." <<std::endl;
 }
 
+// swap several times around the ring buffer, then copy
+
+void SiconosMemoryTest::testRingBuffer()
+{
+  std::cout << "--> Test: ring buffer." <<std::endl;
+  SP::SiconosMemory tmp1(new SiconosMemory(_sizeMem, sizeVect));
+  SP::SiconosVector slot = tmp1->vectorMemory()->front();
+  tmp1->swap(*q1);
+  tmp1->swap(*q2);
+  tmp1->swap(*q3);
+  tmp1->swap(*q1);
+  tmp1->swap(*q2);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testRingBuffer : _nbVectorsInMemory OK", tmp1->nbVectorsInMemory() == _sizeMem, true);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testRingBuffer : vector OK", *(tmp1->getSiconosVector(0)) == *q2, true);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testRingBuffer : vector OK", *(tmp1->getSiconosVector(1)) == *q1, true);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testRingBuffer : vector OK", *(tmp1->getSiconosVector(2)) == *q3, true);
+  // the vectors are not reallocated by swap
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testRingBuffer : no allocation", tmp1->vectorMemory()->front() == slot, true);
+
+  SiconosMemory tmp2(*tmp1);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testRingBuffer : copy OK", *(tmp2.getSiconosVector(0)) == *q2, true);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testRingBuffer : copy OK", *(tmp2.getSiconosVector(1)) == *q1, true);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testRingBuffer : copy OK", *(tmp2.getSiconosVector(2)) == *q3, true);
+  std::cout << "-->  ring buffer test ended with success." <<std::endl;
+}
+
+void SiconosMemoryTest::testReset()
+{
+  std::cout << "--> Test: reset." <<std::endl;
+  SP::SiconosMemory tmp1(new SiconosMemory(_sizeMem, sizeVect));
+  SP::SiconosVector slot = tmp1->vectorMemory()->front();
+  tmp1->swap(*q1);
+  tmp1->swap(*q2);
+  tmp1->reset();
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testReset : _nbVectorsInMemory OK", tmp1->nbVectorsInMemory() == 0, true);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testReset : vector OK", tmp1->getSiconosVector(0)->norm2() == 0., true);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testReset : no allocation", tmp1->vectorMemory()->front() == slot, true);
+  tmp1->swap(*q3);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testReset : _nbVectorsInMemory OK", tmp1->nbVectorsInMemory() == 1, true);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE("testReset : vector OK", *(tmp1->getSiconosVector(0)) == *q3, true);
+  std::cout << "-->  reset test ended with success." <<std::endl;
+}
+
 void SiconosMemoryTest::End()
 {
   //   std::cout <<"======================================" <<std::endl;
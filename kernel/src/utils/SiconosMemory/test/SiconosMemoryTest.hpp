@@ -40,6 +40,8 @@ private:
   CPPUNIT_TEST(testSetVectorMemory);
   CPPUNIT_TEST(testGetSiconosVector);
   CPPUNIT_TEST(testSwap);
+  CPPUNIT_TEST(testRingBuffer);
+  CPPUNIT_TEST(testReset);
   CPPUNIT_TEST(End);
   CPPUNIT_TEST_SUITE_END();
 
@@ -49,6 +51,8 @@ private:
   void testSetVectorMemory();
   void testGetSiconosVector();
   void testSwap();
+  void testRingBuffer();
+  void testReset();
   void End();
 
   SP::MemoryContainer V1, V2, V3;
@@ -500,6 +500,11 @@ public:
     return boost::out_edges(vd, g);
   };
 
+  inline size_t out_degree(const VDescriptor& vd) const
+  {
+    return boost::out_degree(vd, g);
+  };
+
   inline VDescriptor target(const EDescriptor& ed) const
   {
     return boost::target(ed, g);
@@ -784,6 +789,27 @@ public:
 #endif
   }
 
+  /** Remove all the edges, the vertices and their properties are
+   * kept. On an undirected graph, boost::remove_edge looks for the
+   * edge in the incidence lists of its two vertices, so that clearing
+   * the vertices one by one is quadratic in the degrees. The edges are
+   * appended to the global edge list and to the incidence lists, hence
+   * removed in the order of the global list each edge is the first
+   * one of both incidence lists: the graph is cleared in O(E).
+   */
+  void clear_edges()
+  {
+    EIterator ei, eiend, next;
+    std11::tie(ei, eiend) = edges();
+    for (next = ei; ei != eiend; ei = next)
+    {
+      ++next;
+      boost::remove_edge(*ei, g);
+    }
+
+    assert(edges_number() == 0);
+  }
+
   /** Remove all the out-edges of vertex u for which the predicate p
    * returns true. This expression is only required when the graph
    * also models IncidenceGraph.
@@ -153,6 +153,13 @@ namespace std
 %shared_ptr(FrictionContactProblem);
 %shared_ptr(GlobalFrictionContactProblem);
 
+// timers and counters of the simulation, see Simulation::profiler()
+%shared_ptr(Profiler);
+%ignore ProfilerScope;
+
+// active sets of the previous solutions, see LinearOSNS::setActiveSetCache()
+%shared_ptr(ActiveSetCache);
+
 %import NumericsOptions.h
 %include solverOptions.i
 
@@ -224,6 +231,10 @@ namespace std
 
 %include "Tools.hpp"
 
+%template (stringv) std::vector<std::string>;
+%include "Profiler.hpp"
+%include "ActiveSetCache.hpp"
+
 %include "addons.hpp"
 
 // fix : how to prevent swig to generate getter/setter for mpz_t ?
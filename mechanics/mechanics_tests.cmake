@@ -21,6 +21,12 @@ if(WITH_${COMPONENT}_TESTING)
     END_TEST()
   ENDIF()
 
+  IF(WITH_BULLET)
+    BEGIN_TEST(src/contactDetection/bullet/test)
+    NEW_TEST(testBullet BulletTest.cpp)
+    END_TEST()
+  ENDIF()
+
   IF(WITH_MECHANISMS)
     MESSAGE("   ")
     MESSAGE("-------------------------------------- ************************ ")
@@ -25,9 +25,19 @@
 
 
 #include <cmath>
+#include <algorithm>
+#include <numeric>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 //#define DEBUG_MESSAGES 1
 #include "debug.h"
 
+/* below this number of buckets, the pairs are searched by one thread */
+#define SPACE_FILTER_PARALLEL_MIN_BUCKETS 4096
+
 
 
 
@@ -55,6 +65,159 @@ std::size_t hash_value(SP::Hashed const& h)
   return seed;
 }
 
+
+/* spatial hash of a cell, see Teschner et al. */
+static unsigned int cellHash(int i, int j, int k, unsigned int mask)
+{
+  return (((unsigned int) i * 73856093u) ^
+          ((unsigned int) j * 19349663u) ^
+          ((unsigned int) k * 83492791u)) & mask;
+}
+
+void cell_list::clear()
+{
+  bodies.clear();
+  lower.clear();
+  entries.clear();
+  _sorted = false;
+}
+
+void cell_list::insert(SP::DynamicalSystem ds, int i, int j, int k)
+{
+  // the cells of a body are inserted one after the other
+  if (bodies.empty() || bodies.back() != ds)
+  {
+    bodies.push_back(ds);
+    Cell c = {{ i, j, k }};
+    lower.push_back(c);
+  }
+  unsigned int b = bodies.size() - 1;
+  lower[b][0] = (std::min)(lower[b][0], i);
+  lower[b][1] = (std::min)(lower[b][1], j);
+  lower[b][2] = (std::min)(lower[b][2], k);
+
+  Entry e;
+  e.body = b;
+  e.cell[0] = i;
+  e.cell[1] = j;
+  e.cell[2] = k;
+  e.bucket = 0;
+  entries.push_back(e);
+  _sorted = false;
+}
+
+void cell_list::sort()
+{
+  unsigned int n = entries.size();
+  unsigned int nbuckets = 1;
+  while (nbuckets < n)
+    nbuckets <<= 1;
+  _mask = nbuckets - 1;
+
+  // count the entries of each bucket
+  start.assign(nbuckets + 1, 0);
+  for (std::vector<Entry>::iterator e = entries.begin(); e != entries.end(); ++e)
+  {
+    e->bucket = cellHash(e->cell[0], e->cell[1], e->cell[2], _mask);
+    start[e->bucket + 1]++;
+  }
+  std::partial_sum(start.begin(), start.end(), start.begin());
+
+  // and put them in place
+  _next.assign(start.begin(), start.end() - 1);
+  _work.resize(n);
+  for (std::vector<Entry>::iterator e = entries.begin(); e != entries.end(); ++e)
+    _work[_next[e->bucket]++] = *e;
+  entries.swap(_work);
+  _sorted = true;
+}
+
+void cell_list::findPairs()
+{
+  if (!_sorted)
+    sort();
+
+  int nbuckets = start.size() - 1;
+  int nthreads = 1;
+#ifdef _OPENMP
+  if (nbuckets >= SPACE_FILTER_PARALLEL_MIN_BUCKETS)
+    nthreads = omp_get_max_threads();
+#endif
+  _threadPairs.resize(nthreads);
+  for (int t = 0; t < nthreads; ++t)
+    _threadPairs[t].clear();
+
+  // the buckets are split in contiguous ranges (static schedule) and the
+  // pairs of the threads are concatenated in order: the result does not
+  // depend on the number of threads
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1)
+#endif
+  {
+    int t = 0;
+#ifdef _OPENMP
+    t = omp_get_thread_num();
+#endif
+    std::vector<std::pair<unsigned int, unsigned int> >& pairs = _threadPairs[t];
+    int b;
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+    for (b = 0; b < nbuckets; ++b)
+    {
+      for (unsigned int p = start[b]; p < start[b + 1]; ++p)
+      {
+        const Entry& ep = entries[p];
+        for (unsigned int q = p + 1; q < start[b + 1]; ++q)
+        {
+          const Entry& eq = entries[q];
+          // another body in the same cell, not only in the same bucket
+          if (ep.body == eq.body || ep.cell != eq.cell)
+            continue;
+          // keep the pair in the lowest common cell only
+          const Cell& lp = lower[ep.body];
+          const Cell& lq = lower[eq.body];
+          if (ep.cell[0] != (std::max)(lp[0], lq[0]) ||
+              ep.cell[1] != (std::max)(lp[1], lq[1]) ||
+              ep.cell[2] != (std::max)(lp[2], lq[2]))
+            continue;
+          pairs.push_back(std::pair<unsigned int, unsigned int>
+                          ((std::min)(ep.body, eq.body), (std::max)(ep.body, eq.body)));
+        }
+      }
+    }
+  }
+
+  // counting sort of the pairs by their first body
+  firstNeighbour.assign(bodies.size() + 1, 0);
+  for (int t = 0; t < nthreads; ++t)
+    for (unsigned int p = 0; p < _threadPairs[t].size(); ++p)
+      firstNeighbour[_threadPairs[t][p].first + 1]++;
+  std::partial_sum(firstNeighbour.begin(), firstNeighbour.end(), firstNeighbour.begin());
+
+  neighbours.resize(firstNeighbour.back());
+  _next.assign(firstNeighbour.begin(), firstNeighbour.end() - 1);
+  for (int t = 0; t < nthreads; ++t)
+    for (unsigned int p = 0; p < _threadPairs[t].size(); ++p)
+      neighbours[_next[_threadPairs[t][p].first]++] = _threadPairs[t][p].second;
+}
+
+void cell_list::bodiesInCell(int i, int j, int k, std::vector<unsigned int>& found)
+{
+  found.clear();
+  if (entries.empty())
+    return;
+  if (!_sorted)
+    sort();
+  unsigned int b = cellHash(i, j, k, _mask);
+  for (unsigned int p = start[b]; p < start[b + 1]; ++p)
+  {
+    const Entry& e = entries[p];
+    if (e.cell[0] == i && e.cell[1] == j && e.cell[2] == k)
+      found.push_back(e.body);
+  }
+}
+
 SpaceFilter::SpaceFilter(unsigned int bboxfactor,
               unsigned int cellsize,
               SP::Model model,
@@ -69,6 +232,8 @@ SpaceFilter::SpaceFilter(unsigned int bboxfactor,
     _moving_plans(moving_plans),
     _osnsinit(false),
     _hash_table(new space_hash()),
+    _cells(new cell_list()),
+    _pair_interactions(new interaction_hash()),
     diskdisk_relations(new DiskDiskRDeclaredPool()),
     diskplan_relations(new DiskPlanRDeclaredPool()),
   circlecircle_relations(new CircleCircleRDeclaredPool())
@@ -86,6 +251,8 @@ SpaceFilter::SpaceFilter(unsigned int bboxfactor,
     _plans(plans),
     _osnsinit(false),
     _hash_table(new space_hash()),
+    _cells(new cell_list()),
+    _pair_interactions(new interaction_hash()),
     diskdisk_relations(new DiskDiskRDeclaredPool()),
     diskplan_relations(new DiskPlanRDeclaredPool()),
     circlecircle_relations(new CircleCircleRDeclaredPool())
@@ -96,6 +263,8 @@ SpaceFilter::SpaceFilter(SP::Model model) :
   _nslaws(new NSLawMatrix()),
   _osnsinit(false),
   _hash_table(new space_hash()),
+  _cells(new cell_list()),
+  _pair_interactions(new interaction_hash()),
   diskdisk_relations(new DiskDiskRDeclaredPool()),
   diskplan_relations(new DiskPlanRDeclaredPool()),
   circlecircle_relations(new CircleCircleRDeclaredPool())
@@ -104,6 +273,8 @@ SpaceFilter::SpaceFilter(SP::Model model) :
 SpaceFilter::SpaceFilter() :
   _osnsinit(false),
   _hash_table(new space_hash()),
+  _cells(new cell_list()),
+  _pair_interactions(new interaction_hash()),
   diskdisk_relations(new DiskDiskRDeclaredPool()),
   diskplan_relations(new DiskPlanRDeclaredPool()),
   circlecircle_relations(new CircleCircleRDeclaredPool())
@@ -307,54 +478,26 @@ struct SpaceFilter::_CircularFilter : public SiconosVisitor
       }
     }
 
+    // is interaction in graph ?
+    SP::Interaction inter = parent->_PairInteraction(ds1, ds2);
+
     if (rel)
     {
-      bool found = false;
-      DynamicalSystemsGraph::OEIterator oei, oeiend;
-      for (std11::tie(oei, oeiend) = DSG0->out_edges(DSG0->descriptor(ds1));
-           oei != oeiend; ++oei)
-      {
-        if (DSG0->bundle(DSG0->target(*oei)) == ds2)
-        {
-          found = true;
-          break;
-        }
-      }
-
-      if (!found)
+      if (!inter)
       {
         SP::NonSmoothLaw nslaw = (*parent->_nslaws)(DSG0->groupId[DSG0->descriptor(ds1)],
                                                     DSG0->groupId[DSG0->descriptor(ds2)]);
 
-        SP::Interaction inter(new Interaction(2,
-                                              nslaw,
-                                              rel, parent->_interID++));
+        inter.reset(new Interaction(2,
+                                    nslaw,
+                                    rel, parent->_interID++));
         parent->link(inter, ds1, ds2);
       }
     }
-    else
+    else if (inter)
     {
-      // is interaction in graph ?
-      bool found = false;
-      DynamicalSystemsGraph::OEIterator oei, oeiend;
-      for (std11::tie(oei, oeiend) = DSG0->out_edges(DSG0->descriptor(ds1));
-           oei != oeiend; ++oei)
-      {
-        if (DSG0->bundle(DSG0->target(*oei)) == ds2)
-        {
-          found = true;
-          break;
-        }
-      }
-
-      if (found)
-      {
-
-
-        DEBUG_PRINTF("remove interaction : %d\n", DSG0->bundle(*oei)->number());
-        parent->model()->nonSmoothDynamicalSystem()->topology()->
-        removeInteraction(DSG0->bundle(*oei));
-      }
+      DEBUG_PRINTF("remove interaction : %d\n", inter->number());
+      parent->_RemovePairInteraction(inter, ds1, ds2);
     }
   }
 
@@ -411,54 +554,28 @@ struct SpaceFilter::_SphereLDSFilter : public SiconosVisitor
 
     double d = sqrt(dx * dx + dy * dy + dz * dz);
 
+    // is interaction in graph ?
+    SP::Interaction inter = parent->_PairInteraction(ds1, ds2);
+
     if (d < 2 * tol)
     {
       rel.reset(new SphereLDSSphereLDSR(r1, r2));
 
-      bool found = false;
-      DynamicalSystemsGraph::OEIterator oei, oeiend;
-      for (std11::tie(oei, oeiend) = DSG0->out_edges(DSG0->descriptor(ds1));
-           oei != oeiend; ++oei)
-      {
-        if (DSG0->bundle(DSG0->target(*oei)) == ds2)
-        {
-          found = true;
-          break;
-        }
-      }
-
-      if (!found)
+      if (!inter)
       {
         SP::NonSmoothLaw nslaw = (*parent->_nslaws)(DSG0->groupId[DSG0->descriptor(ds1)],
                                                     DSG0->groupId[DSG0->descriptor(ds2)]);
 
-        SP::Interaction inter(new Interaction(3,
-                                              nslaw,
-                                              rel, parent->_interID++));
+        inter.reset(new Interaction(3,
+                                    nslaw,
+                                    rel, parent->_interID++));
 
         parent->link(inter, ds1, ds2);
       }
     }
-    else
+    else if (inter)
     {
-      // is interaction in graph ?
-      bool found = false;
-      DynamicalSystemsGraph::OEIterator oei, oeiend;
-      for (std11::tie(oei, oeiend) = DSG0->out_edges(DSG0->descriptor(ds1));
-           oei != oeiend; ++oei)
-      {
-        if (DSG0->bundle(DSG0->target(*oei)) == ds2)
-        {
-          found = true;
-          break;
-        }
-      }
-
-      if (found)
-      {
-        parent->model()->nonSmoothDynamicalSystem()->topology()->
-        removeInteraction(DSG0->bundle(*oei));
-      }
+      parent->_RemovePairInteraction(inter, ds1, ds2);
 
     }
   }
@@ -500,54 +617,28 @@ struct SpaceFilter::_SphereNEDSFilter : public SiconosVisitor
 
     double d = sqrt(dx * dx + dy * dy + dz * dz);
 
+    // is interaction in graph ?
+    SP::Interaction inter = parent->_PairInteraction(ds1, ds2);
+
     if (d < 2 * tol)
     {
       rel.reset(new SphereNEDSSphereNEDSR(r1, r2));
 
-      bool found = false;
-      DynamicalSystemsGraph::OEIterator oei, oeiend;
-      for (std11::tie(oei, oeiend) = DSG0->out_edges(DSG0->descriptor(ds1));
-           oei != oeiend; ++oei)
-      {
-        if (DSG0->bundle(DSG0->target(*oei)) == ds2)
-        {
-          found = true;
-          break;
-        }
-      }
-
-      if (!found)
+      if (!inter)
       {
         SP::NonSmoothLaw nslaw = (*parent->_nslaws)(DSG0->groupId[DSG0->descriptor(ds1)],
                                                     DSG0->groupId[DSG0->descriptor(ds2)]);
 
-        SP::Interaction inter(new Interaction(3,
-                                              nslaw,
-                                              rel, parent->_interID++));
+        inter.reset(new Interaction(3,
+                                    nslaw,
+                                    rel, parent->_interID++));
 
         parent->link(inter, ds1, ds2);
       }
     }
-    else
+    else if (inter)
     {
-      // is interaction in graph ?
-      bool found = false;
-      DynamicalSystemsGraph::OEIterator oei, oeiend;
-      for (std11::tie(oei, oeiend) = DSG0->out_edges(DSG0->descriptor(ds1));
-           oei != oeiend; ++oei)
-      {
-        if (DSG0->bundle(DSG0->target(*oei)) == ds2)
-        {
-          found = true;
-          break;
-        }
-      }
-
-      if (found)
-      {
-        parent->model()->nonSmoothDynamicalSystem()->topology()->
-        removeInteraction(DSG0->bundle(*oei));
-      }
+      parent->_RemovePairInteraction(inter, ds1, ds2);
 
     }
   }
@@ -977,30 +1068,22 @@ void SpaceFilter::_PlanSphereNEDSFilter(double A, double B, double C, double D,
 /* insertion */
 void SpaceFilter::insert(SP::Disk ds, int i, int j, int k)
 {
-
-  SP::Hashed hashed(new Hashed(std11::static_pointer_cast<DynamicalSystem>(ds), i, j));
-  _hash_table->insert(hashed);
+  _cells->insert(ds, i, j, 0);
 }
 
 void SpaceFilter::insert(SP::Circle ds, int i, int j, int k)
 {
-
-  SP::Hashed hashed(new Hashed(std11::static_pointer_cast<DynamicalSystem>(ds), i, j));
-  _hash_table->insert(hashed);
+  _cells->insert(ds, i, j, 0);
 }
 
 void SpaceFilter::insert(SP::SphereLDS ds, int i, int j, int k)
 {
-
-  SP::Hashed hashed(new Hashed(ds, i, j, k));
-  _hash_table->insert(hashed);
+  _cells->insert(ds, i, j, k);
 }
 
 void SpaceFilter::insert(SP::SphereNEDS ds, int i, int j, int k)
 {
-
-  SP::Hashed hashed(new Hashed(ds, i, j, k));
-  _hash_table->insert(hashed);
+  _cells->insert(ds, i, j, k);
 }
 
 void SpaceFilter::insert(SP::Hashed hashed)
@@ -1013,7 +1096,6 @@ void SpaceFilter::insert(SP::Hashed hashed)
 
 
 /* dynamical systems proximity detection */
-typedef std::pair<int, int> interPair;
 bool operator ==(interPair const& a, interPair const& b);
 bool operator ==(interPair const& a, interPair const& b)
 {
@@ -1039,14 +1121,13 @@ bool operator ==(DiskPlanRDeclared const& a, DiskPlanRDeclared const& b)
            a[5] == b[5]));
 }
 
+/* proximity detection with the plans, the neighbours are handled by
+   _NeighboursFilter */
 struct SpaceFilter::_FindInteractions : public SiconosVisitor
 {
 
   using SiconosVisitor::visit;
 
-  typedef boost::unordered_multiset < interPair,
-          boost::hash<interPair> > interPairs;
-
   SP::SpaceFilter parent;
   double time;
   _FindInteractions(SP::SpaceFilter p, double time) : parent(p), time(time) {};
@@ -1078,47 +1159,6 @@ struct SpaceFilter::_FindInteractions : public SiconosVisitor
         parent->_MovingPlanCircularFilter(i, ds1, time);
       }
     }
-
-    SP::SiconosVector Q1 = ds1->q();
-
-    double x1 = Q1->getValue(0);
-    double y1 = Q1->getValue(1);
-    SP::Hashed hds1(new Hashed(std11::static_pointer_cast<DynamicalSystem>(ds1),
-                             (int) floor(x1 / parent->_cellsize),
-                               (int) floor(y1 / parent->_cellsize)));
-
-    // find all other systems that are in the same cells
-    std::pair<space_hash::iterator, space_hash::iterator>
-    neighbours = parent->_hash_table->equal_range(hds1);
-
-    unsigned int j;
-    interPairs declaredInteractions;
-    std11::shared_ptr<_CircularFilter>
-    circularFilter(new _CircularFilter(parent, ds1));
-
-    for (j = 0; neighbours.first != neighbours.second; ++neighbours.first, ++j)
-    {
-      SP::DynamicalSystem ds2 = (*neighbours.first)->body;
-      int ids1 = ds1->number();
-      int ids2 = ds2->number();
-      int imax = (std::max)(ids1, ids2);
-      int imin = (std::min)(ids1, ids2);
-      if (ids1 != ids2)
-      {
-        // is interaction already treated ?
-        interPair interpair;
-        interpair = std::pair<int, int>(imin, imax);
-
-        if (declaredInteractions.find(interpair)
-            == declaredInteractions.end())
-        {
-          // no, check proximity
-          declaredInteractions.insert(interpair);
-          ds2->acceptSP(circularFilter);
-        }
-
-      }
-    }
   };
 
   void visit(SP::Circle circle)
@@ -1142,48 +1182,6 @@ struct SpaceFilter::_FindInteractions : public SiconosVisitor
                                    (*parent->_plans)(i, 2),
                                    (*parent->_plans)(i, 3), ds1);
     }
-
-    SP::SiconosVector Q1 = ds1->q();
-
-    double x1 = Q1->getValue(0);
-    double y1 = Q1->getValue(1);
-    double z1 = Q1->getValue(2);
-    SP::Hashed hds1(new Hashed(ds1, (int) floor(x1 / parent->_cellsize),
-                               (int) floor(y1 / parent->_cellsize),
-                               (int) floor(z1 / parent->_cellsize)));
-
-    // find all other systems that are in the same cells
-    std::pair<space_hash::iterator, space_hash::iterator>
-    neighbours = parent->_hash_table->equal_range(hds1);
-
-    unsigned int j;
-    interPairs declaredInteractions;
-
-    std11::shared_ptr<_SphereLDSFilter> sphereFilter(new _SphereLDSFilter(parent, ds1));
-
-    for (j = 0; neighbours.first != neighbours.second; ++neighbours.first, ++j)
-    {
-      SP::DynamicalSystem ds2 = (*neighbours.first)->body;
-      int ids1 = ds1->number();
-      int ids2 = ds2->number();
-      int imax = (std::max)(ids1, ids2);
-      int imin = (std::min)(ids1, ids2);
-      if (ids1 != ids2)
-      {
-        // is interaction already treated ?
-        interPair interpair;
-        interpair = std::pair<int, int>(imin, imax);
-
-        if (declaredInteractions.find(interpair)
-            == declaredInteractions.end())
-        {
-          // no, check proximity
-          declaredInteractions.insert(interpair);
-          ds2->acceptSP(sphereFilter);
-        }
-
-      }
-    }
   }
 
 
@@ -1197,64 +1195,80 @@ struct SpaceFilter::_FindInteractions : public SiconosVisitor
                                     (*parent->_plans)(i, 2),
                                     (*parent->_plans)(i, 3), ds1);
     }
+  }
 
-    SP::SiconosVector Q1 = ds1->q();
-
-    double x1 = Q1->getValue(0);
-    double y1 = Q1->getValue(1);
-    double z1 = Q1->getValue(2);
-    SP::Hashed hds1(new Hashed(ds1, (int) floor(x1 / parent->_cellsize),
-                               (int) floor(y1 / parent->_cellsize),
-                               (int) floor(z1 / parent->_cellsize)));
+  void visit(SP::ExternalBody d)
+  {
+    d->selfFindInteractions(parent);
+  }
 
-    // find all other systems that are in the same cells
-    std::pair<space_hash::iterator, space_hash::iterator>
-    neighbours = parent->_hash_table->equal_range(hds1);
 
-    unsigned int j;
-    interPairs declaredInteractions;
+};
 
-    std11::shared_ptr<_SphereNEDSFilter> sphereFilter(new _SphereNEDSFilter(parent, ds1));
+/* proximity detection between a body and its neighbours: visited by
+   the body, it gives the filter the neighbours have to accept */
+struct SpaceFilter::_NeighboursFilter : public SiconosVisitor
+{
 
-    for (j = 0; neighbours.first != neighbours.second; ++neighbours.first, ++j)
-    {
-      SP::DynamicalSystem ds2 = (*neighbours.first)->body;
-      int ids1 = ds1->number();
-      int ids2 = ds2->number();
-      int imax = (std::max)(ids1, ids2);
-      int imin = (std::min)(ids1, ids2);
-      if (ids1 != ids2)
-      {
-        // is interaction already treated ?
-        interPair interpair;
-        interpair = std::pair<int, int>(imin, imax);
+  using SiconosVisitor::visit;
 
-        if (declaredInteractions.find(interpair)
-            == declaredInteractions.end())
-        {
-          // no, check proximity
-          declaredInteractions.insert(interpair);
-          ds2->acceptSP(sphereFilter);
-        }
+  SP::SpaceFilter parent;
+  SP::SiconosVisitor filter;
+  _NeighboursFilter(SP::SpaceFilter p) : parent(p) {};
 
-      }
-    }
-  }
+  void visit(SP::Circle circle)
+  {
+    filter.reset(new _CircularFilter(parent, circle));
+  };
 
-  void visit(SP::ExternalBody d)
+  void visit(SP::Disk disk)
   {
-    d->selfFindInteractions(parent);
-  }
+    filter.reset(new _CircularFilter(parent, disk));
+  };
 
+  void visit(SP::SphereLDS ds1)
+  {
+    filter.reset(new _SphereLDSFilter(parent, ds1));
+  };
 
+  void visit(SP::SphereNEDS ds1)
+  {
+    filter.reset(new _SphereNEDSFilter(parent, ds1));
+  };
 };
 
+static interPair dsPair(SP::DynamicalSystem ds1, SP::DynamicalSystem ds2)
+{
+  int ids1 = ds1->number();
+  int ids2 = ds2->number();
+  return interPair((std::min)(ids1, ids2), (std::max)(ids1, ids2));
+}
+
+SP::Interaction SpaceFilter::_PairInteraction(SP::DynamicalSystem ds1,
+                                              SP::DynamicalSystem ds2)
+{
+  interaction_hash::iterator it = _pair_interactions->find(dsPair(ds1, ds2));
+  if (it == _pair_interactions->end())
+    return SP::Interaction();
+  return it->second;
+}
+
+void SpaceFilter::_RemovePairInteraction(SP::Interaction inter,
+                                         SP::DynamicalSystem ds1,
+                                         SP::DynamicalSystem ds2)
+{
+  model()->nonSmoothDynamicalSystem()->topology()->removeInteraction(inter);
+  _pair_interactions->erase(dsPair(ds1, ds2));
+}
+
 
 void SpaceFilter::link(SP::Interaction inter, SP::DynamicalSystem ds1,
                        SP::DynamicalSystem ds2)
 {
   DEBUG_PRINTF("link interaction : %d\n", inter->number());
   model()->nonSmoothDynamicalSystem()->link(inter, ds1, ds2);
+  if (ds2 && ds2 != ds1)
+    (*_pair_interactions)[dsPair(ds1, ds2)] = inter;
   model()->simulation()->computeLevelsForInputAndOutput(inter);
   // Note FP : ds init should probably be done once and only once for
   // all ds (like in simulation->initialize()) but where/when?
@@ -1288,7 +1302,11 @@ void SpaceFilter::buildInteractions(double time)
   std11::shared_ptr<_FindInteractions>
   findInteractions(new _FindInteractions(shared_from_this(), time));
 
+  std11::shared_ptr<_NeighboursFilter>
+  neighboursFilter(new _NeighboursFilter(shared_from_this()));
+
   _hash_table->clear();
+  _cells->clear();
 
   // 1: rehash DS
   DynamicalSystemsGraph::VIterator vi, viend;
@@ -1299,12 +1317,45 @@ void SpaceFilter::buildInteractions(double time)
     DSG0->bundle(*vi)->acceptSP(hasher);
   }
 
-  // 2: prox detection
+  // 2: sort the bodies by cell and find the pairs sharing a cell
+  _cells->sort();
+  _cells->findPairs();
+
+  // 3: the interactions between two bodies, the interactions with the
+  // plans are loops
+  _pair_interactions->clear();
+  _pair_interactions->rehash(DSG0->edges_number());
+  DynamicalSystemsGraph::EIterator ei, eiend;
+  for (std11::tie(ei, eiend) = DSG0->edges(); ei != eiend; ++ei)
+  {
+    SP::DynamicalSystem ds1 = DSG0->bundle(DSG0->source(*ei));
+    SP::DynamicalSystem ds2 = DSG0->bundle(DSG0->target(*ei));
+    if (ds1 != ds2)
+      (*_pair_interactions)[dsPair(ds1, ds2)] = DSG0->bundle(*ei);
+  }
+
+  // 4: prox detection with plans and external bodies
   for (std11::tie(vi, viend) = DSG0->vertices();
        vi != viend; ++vi)
   {
     DSG0->bundle(*vi)->acceptSP(findInteractions);
   }
+
+  // 5: prox detection between neighbours
+  cell_list& cells = *_cells;
+  for (unsigned int b = 0; b < cells.bodies.size(); ++b)
+  {
+    unsigned int first = cells.firstNeighbour[b];
+    unsigned int last = cells.firstNeighbour[b + 1];
+    if (first == last)
+      continue;
+    cells.bodies[b]->acceptSP(neighboursFilter);
+    for (unsigned int n = first; n < last; ++n)
+    {
+      cells.bodies[cells.neighbours[n]]->acceptSP(neighboursFilter->filter);
+    }
+  }
+
   model()->simulation()->initOSNS();
 }
 
@@ -1315,6 +1366,11 @@ void SpaceFilter::buildInteractions(double time)
 
 bool SpaceFilter::haveNeighbours(SP::Hashed h)
 {
+  std::vector<unsigned int> found;
+  _cells->bodiesInCell(h->i, h->j, h->k, found);
+  if (!found.empty())
+    return true;
+
   std::pair<space_hash::iterator, space_hash::iterator> neighbours
     = _hash_table->equal_range(h);
   return (neighbours.first != neighbours.second);
@@ -1350,8 +1406,8 @@ struct SpaceFilter::_DiskDistance : public SiconosVisitor
 /* only for disks at the moment */
 double SpaceFilter::minDistance(SP::Hashed h)
 {
-  std::pair<space_hash::iterator, space_hash::iterator> neighbours
-    = _hash_table->equal_range(h);
+  std::vector<unsigned int> found;
+  _cells->bodiesInCell(h->i, h->j, h->k, found);
 
   SP::SiconosVector q = std11::static_pointer_cast<LagrangianDS>(h->body)->q();
 
@@ -1362,9 +1418,9 @@ double SpaceFilter::minDistance(SP::Hashed h)
 
     std11::shared_ptr<_DiskDistance> distance(new _DiskDistance((*q)(0), (*q)(1), disk->getRadius()));
 
-    for (; neighbours.first != neighbours.second; ++neighbours.first)
+    for (unsigned int n = 0; n < found.size(); ++n)
     {
-      (*neighbours.first)->body->acceptSP(distance);
+      _cells->bodies[found[n]]->acceptSP(distance);
 
       dmin = (std::min)(dmin, distance->result);
     }
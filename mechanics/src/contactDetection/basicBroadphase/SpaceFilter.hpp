@@ -30,6 +30,13 @@
  *   Munich, Germany
  *   pp. 47-54
  *   November 19-21, 2003
+ *
+ *  The disks, circles and spheres are put in the cells covered by
+ *  their bounding box, and sorted by cell with a counting sort (see
+ *  cell_list in SpaceFilter_impl.hpp). The candidate pairs are the
+ *  bodies sharing a cell, they are found in parallel over the cells
+ *  when OpenMP is enabled. The existing interactions between two
+ *  bodies are found in a hash table keyed by the pair of bodies.
  */
 
 #ifndef SpaceFilter_hpp
@@ -42,6 +49,8 @@
 
 /* local forwards (see SpaceFilter_impl.hpp) */
 DEFINE_SPTR(space_hash);
+DEFINE_SPTR(cell_list);
+DEFINE_SPTR(interaction_hash);
 DEFINE_SPTR(DiskDiskRDeclaredPool);
 DEFINE_SPTR(DiskPlanRDeclaredPool);
 DEFINE_SPTR(CircleCircleRDeclaredPool);
@@ -81,9 +90,15 @@ protected:
   /* kee track of one step ns integrator initialization */
   bool _osnsinit;
 
-  /* the hash table */
+  /* the hash table of the external bodies */
   SP::space_hash _hash_table;
 
+  /* the disks, circles and spheres sorted by cell */
+  SP::cell_list _cells;
+
+  /* the interactions between two bodies, keyed by the pair of bodies */
+  SP::interaction_hash _pair_interactions;
+
   /* relations pool */
   SP::DiskDiskRDeclaredPool  diskdisk_relations;
   SP::DiskPlanRDeclaredPool  diskplan_relations;
@@ -103,6 +118,23 @@ protected:
   void _PlanSphereNEDSFilter(double A, double B, double C, double D,
                              SP::SphereNEDS ds);
 
+  /** the interaction between two bodies, if any
+      \param ds1 a SP::DynamicalSystem.
+      \param ds2 a SP::DynamicalSystem.
+      \return the interaction, null if there is none
+  */
+  SP::Interaction _PairInteraction(SP::DynamicalSystem ds1,
+                                   SP::DynamicalSystem ds2);
+
+  /** remove the interaction between two bodies from the model
+      \param inter the interaction.
+      \param ds1 a SP::DynamicalSystem.
+      \param ds2 a SP::DynamicalSystem.
+  */
+  void _RemovePairInteraction(SP::Interaction inter,
+                              SP::DynamicalSystem ds1,
+                              SP::DynamicalSystem ds2);
+
   /* visitors defined as Inner class */
   /* note : cf Thinking in C++, vol2, the inner class idiom. */
 
@@ -119,6 +151,9 @@ protected:
   /* the proximity detection */
   struct _FindInteractions;
 
+  /* the proximity detection between a body and its neighbours */
+  struct _NeighboursFilter;
+
   /* to compare relation */
   struct _IsSameDiskPlanR;
   struct _IsSameDiskMovingPlanR;
@@ -133,6 +168,7 @@ protected:
   friend struct SpaceFilter::_SphereNEDSFilter;
   friend struct SpaceFilter::_BodyHash;
   friend struct SpaceFilter::_FindInteractions;
+  friend struct SpaceFilter::_NeighboursFilter;
   friend struct SpaceFilter::_IsSameDiskPlanR;
   friend struct SpaceFilter::_IsSameDiskMovingPlanR;
   friend struct SpaceFilter::_IsSameSpherePlanR;
@@ -155,8 +191,9 @@ public:
 
   SpaceFilter();
 
-  /** 2D/3D objects insertion
-   *
+  /** 2D/3D objects insertion in the cell (i, j, k), k is ignored
+   *  for 2D objects. The cells of an object are expected to form a
+   *  box, as the ones of its bounding box.
    */
   void insert(SP::Disk, int, int, int);
 
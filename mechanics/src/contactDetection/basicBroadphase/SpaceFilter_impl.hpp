@@ -24,11 +24,13 @@
 #define SpaceFilter_impl_hpp
 
 #include <map>
+#include <vector>
 
 #include <SpaceFilter.hpp>
 #include "DiskMovingPlanR.hpp"
 #include <boost/numeric/ublas/symmetric.hpp>
 #include <boost/unordered_set.hpp>
+#include <boost/unordered_map.hpp>
 #include <boost/throw_exception.hpp>
 #include <boost/functional/hash.hpp>
 
@@ -73,6 +75,85 @@ class space_hash : public boost::unordered_multiset < SP::Hashed,
   ACCEPT_SERIALIZATION(space_hash);
 };
 
+/* the bodies sorted by cell.
+ *
+ * The cells are gathered in buckets by a spatial hash of their
+ * coordinates, there are as many buckets as entries (rounded up to a
+ * power of 2) so that the memory does not depend on the extent of the
+ * scene. After sort(), a counting sort, the entries of the bucket b are
+ * entries[start[b]] to entries[start[b + 1] - 1].
+ *
+ * findPairs() gives for each body its neighbours, the bodies with a
+ * greater index sharing at least one cell with it. A pair of bodies is
+ * found in the lowest common cell only, so that there are no
+ * duplicates.
+ *
+ * It is rebuilt at each SpaceFilter::buildInteractions() and is not
+ * serialized. */
+class cell_list
+{
+public:
+  typedef std11::array<int, 3> Cell;
+
+  struct Entry
+  {
+    /* index of the body in bodies */
+    unsigned int body;
+    Cell cell;
+    unsigned int bucket;
+  };
+
+  /* the bodies, in order of insertion */
+  std::vector<SP::DynamicalSystem> bodies;
+
+  /* the lowest cell of each body */
+  std::vector<Cell> lower;
+
+  /* one entry per body and per cell */
+  std::vector<Entry> entries;
+
+  /* first entry of each bucket, after sort() */
+  std::vector<unsigned int> start;
+
+  /* neighbours of the body b, after findPairs():
+     neighbours[firstNeighbour[b]] to neighbours[firstNeighbour[b + 1] - 1] */
+  std::vector<unsigned int> firstNeighbour;
+  std::vector<unsigned int> neighbours;
+
+  cell_list() : _mask(0), _sorted(false) {};
+
+  /* remove all the bodies */
+  void clear();
+
+  /* put a body in a cell */
+  void insert(SP::DynamicalSystem ds, int i, int j, int k);
+
+  /* counting sort of the entries by bucket */
+  void sort();
+
+  /* find the pairs of bodies sharing a cell */
+  void findPairs();
+
+  /* the bodies in a cell, with repetitions if they have been inserted
+     several times in it */
+  void bodiesInCell(int i, int j, int k, std::vector<unsigned int>& found);
+
+private:
+  unsigned int _mask;
+  bool _sorted;
+  std::vector<Entry> _work;
+  std::vector<unsigned int> _next;
+  std::vector<std::vector<std::pair<unsigned int, unsigned int> > > _threadPairs;
+};
+
+/* a pair of dynamical systems numbers, the smallest first */
+typedef std::pair<int, int> interPair;
+
+class interaction_hash : public boost::unordered_map < interPair, SP::Interaction,
+                                                        boost::hash<interPair> >
+{
+};
+
 /* relations pool */
 typedef std::pair<double, double> CircleCircleRDeclared;
 typedef std::pair<double, double> DiskDiskRDeclared;
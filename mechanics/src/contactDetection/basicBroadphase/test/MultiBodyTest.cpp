@@ -377,8 +377,53 @@ void MultiBodyTest::t2()
 
 }
 
+// the interactions between disks are the ones of a brute force search
 void MultiBodyTest::t3()
 {
+  SP::Disks disks(new Disks());
+
+  disks->init("disks.dat");
+
+  disks->spaceFilter()->buildInteractions(disks->model()->currentTime());
+
+  SP::DynamicalSystemsGraph DSG0 = disks->model()->nonSmoothDynamicalSystem()->topology()->dSG(0);
+
+  std::vector<SP::Disk> all;
+  DynamicalSystemsGraph::VIterator vi, viend;
+  for (std11::tie(vi, viend) = DSG0->vertices(); vi != viend; ++vi)
+  {
+    all.push_back(std11::static_pointer_cast<Disk>(DSG0->bundle(*vi)));
+  }
+
+  unsigned int expected = 0;
+  for (unsigned int i = 0; i < all.size(); ++i)
+  {
+    for (unsigned int j = i + 1; j < all.size(); ++j)
+    {
+      double r = all[i]->getRadius() + all[j]->getRadius();
+      double d = hypot(all[i]->getQ(0) - all[j]->getQ(0),
+                       all[i]->getQ(1) - all[j]->getQ(1));
+      if (d - r < r)
+        expected++;
+    }
+  }
+
+  unsigned int found = 0;
+  DynamicalSystemsGraph::EIterator ei, eiend;
+  for (std11::tie(ei, eiend) = DSG0->edges(); ei != eiend; ++ei)
+  {
+    if (DSG0->source(*ei) != DSG0->target(*ei))
+      found++;
+  }
+
+  CPPUNIT_ASSERT(expected > 0);
+  CPPUNIT_ASSERT_EQUAL(expected, found);
+
+  // the existing interactions are kept at the second call
+  SP::InteractionsGraph indexSet0 = disks->model()->nonSmoothDynamicalSystem()->topology()->indexSet0();
+  size_t nbInteractions = indexSet0->size();
+  disks->spaceFilter()->buildInteractions(disks->model()->currentTime());
+  CPPUNIT_ASSERT_EQUAL(nbInteractions, indexSet0->size());
 }
 
 void MultiBodyTest::t4()
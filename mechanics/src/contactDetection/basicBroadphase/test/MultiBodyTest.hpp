@@ -33,7 +33,7 @@ private:
 
   CPPUNIT_TEST(t2);
 
-  //  CPPUNIT_TEST(t3);
+  CPPUNIT_TEST(t3);
 
   //  CPPUNIT_TEST(t4);
 
@@ -39,6 +39,15 @@ public:
     return _contactPoints;
   };
 
+  /** attach the relation to another contact point, when it is
+   *  recycled for a new contact
+   * \param point the new contact point
+   */
+  void setContactPoint(SP::btManifoldPoint point)
+  {
+    _contactPoints = point;
+  };
+
   virtual void computeh(double time, BlockVector&, SiconosVector&);
 
   ACCEPT_STD_VISITORS();
@@ -46,9 +46,15 @@
 #include <Interaction.hpp>
 
 BulletR::BulletR(SP::btManifoldPoint point) :
-  NewtonEulerFrom3DLocalFrameR(),
-  _contactPoints(point)
+  NewtonEulerFrom3DLocalFrameR()
 {
+  setContactPoint(point);
+}
+
+void BulletR::setContactPoint(SP::btManifoldPoint point)
+{
+  _contactPoints = point;
+
   btVector3 posa = _contactPoints->getPositionWorldOnA();
   btVector3 posb = _contactPoints->getPositionWorldOnB();
 
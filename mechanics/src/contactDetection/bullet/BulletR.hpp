@@ -29,7 +29,7 @@ private:
   */
   ACCEPT_SERIALIZATION(BulletR);
 
-  const SP::btManifoldPoint _contactPoints;
+  SP::btManifoldPoint _contactPoints;
 
 public:
   BulletR(SP::btManifoldPoint);
@@ -39,6 +39,12 @@ public:
     return _contactPoints;
   };
 
+  /** attach the relation to another contact point, when it is
+   *  recycled for a new contact
+   * \param point the new contact point
+   */
+  void setContactPoint(SP::btManifoldPoint point);
+
   virtual void computeh(double time, BlockVector& q0, SiconosVector& y);
 
   ACCEPT_STD_VISITORS();
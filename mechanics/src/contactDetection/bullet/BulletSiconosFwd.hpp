@@ -50,6 +50,8 @@ DEFINE_SPTR(BulletWeightedShape);
 //DEFINE_SPTR(BulletTimeStepping);
 DEFINE_SPTR(CollisionObjects);
 DEFINE_SPTR(StaticObjects);
+DEFINE_SPTR(ContactPoints);
+DEFINE_SPTR(WarmStartReactions);
 
 #include "MechanicsFwd.hpp"
 
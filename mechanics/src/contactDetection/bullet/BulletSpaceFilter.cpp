@@ -26,6 +26,10 @@
 #include <SimulationTypeDef.hpp>
 #include <NonSmoothLaw.hpp>
 #include <OneStepIntegrator.hpp>
+#include <Topology.hpp>
+#include <Interaction.hpp>
+
+#include <op3x3.h>
 
 #include <BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
 #include <BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
@@ -50,17 +54,14 @@ extern ContactDestroyedCallback gContactDestroyedCallback;
 extern ContactProcessedCallback gContactProcessedCallback;
 
 
-std::map<Interaction*, bool> gOrphanedInteractions;
-
+/* The interactions of destroyed contact points are found in
+   buildInteractions, the callback only lets Bullet reset the user
+   persistent data. It may be called concurrently by a multithreaded
+   dispatcher. */
 bool contactClear(void* userPersistentData);
 bool contactClear(void* userPersistentData)
 {
-  if (true)
-  {
-    DEBUG_PRINTF("contactClear : Interaction : %p\n",   static_cast<Interaction *>(userPersistentData));
-    gOrphanedInteractions[static_cast<Interaction *>(userPersistentData)] = true;
-  }
-
+  DEBUG_PRINTF("contactClear : Interaction : %p\n",   static_cast<Interaction *>(userPersistentData));
   return true;
 }
 
@@ -85,12 +86,19 @@ BulletSpaceFilter::BulletSpaceFilter(SP::Model model) :
   SpaceFilter(),
   _dynamicCollisionsObjectsInserted(false),
   _staticCollisionsObjectsInserted(false),
-  _closeContactsThreshold(0.)
+  _closeContactsThreshold(0.),
+  _contactPointsStamp(0),
+  _warmStart(true),
+  _recycleContacts(true),
+  _createdContacts(0),
+  _recycledContacts(0)
 {
 
   _model = model;
   _nslaws.reset(new NSLawMatrix());
   _staticObjects.reset(new StaticObjects());
+  _contactPoints.reset(new ContactPoints());
+  _warmStartReactions.reset(new WarmStartReactions());
 
   _collisionConfiguration.reset(new btDefaultCollisionConfiguration());
 
@@ -140,6 +148,26 @@ void BulletSpaceFilter::setCollisionConfiguration(
   _staticCollisionsObjectsInserted = false;
 }
 
+/* an interaction to be linked at the end of buildInteractions */
+struct NewInteraction
+{
+  SP::Interaction inter;
+  SP::BulletDS dsa;
+  SP::BulletDS dsb;
+  ContactPointInteraction contact;
+  double distance;
+};
+
+void BulletSpaceFilter::setCollisionDispatcher(SP::btCollisionDispatcher dispatcher)
+{
+  _dispatcher = dispatcher;
+  btGImpactCollisionAlgorithm::registerAlgorithm(&*_dispatcher);
+  _collisionWorld.reset(new btCollisionWorld(&*_dispatcher, &*_broadphase, &*_collisionConfiguration));
+  _collisionWorld->getDispatchInfo().m_useContinuous = false;
+  _dynamicCollisionsObjectsInserted = false;
+  _staticCollisionsObjectsInserted = false;
+}
+
 void BulletSpaceFilter::buildInteractions(double time)
 {
   DEBUG_PRINT("-----start build interaction\n");
@@ -181,42 +209,41 @@ void BulletSpaceFilter::buildInteractions(double time)
 
   //  1. perform bullet collision detection
   DEBUG_PRINT("-----  1. perform bullet collision detection\n");
-  gOrphanedInteractions.clear();
   _collisionWorld->performDiscreteCollisionDetection();
 
-
-  
-  // 2. collect old contact points from Siconos graph
-  DEBUG_PRINT("-----  2. collect old contact points from Siconos graph\n");
-  std::map<btManifoldPoint*, bool> contactPoints;
-
-  std::map<Interaction*, bool> activeInteractions;
-
-  SP::InteractionsGraph indexSet0 = model()->nonSmoothDynamicalSystem()->topology()->indexSet(0);
-  InteractionsGraph::VIterator ui0, ui0end, v0next;
-  std11::tie(ui0, ui0end) = indexSet0->vertices();
-  for (v0next = ui0 ;
-       ui0 != ui0end; ui0 = v0next)
+  // 2. match the contact points of the manifolds with the cache of
+  // the previous calls. The cache is keyed by the address of the
+  // contact point, i.e. the manifold of a pair of collision objects
+  // and the slot in this manifold. A cached interaction is kept if
+  // the point still carries it in its user persistent data:
+  // otherwise the point has been destroyed, replaced, or moved to
+  // this slot by Bullet and a new interaction is created.
+  DEBUG_PRINT("-----  2. match contact points with the cached interactions\n");
+  ++_contactPointsStamp;
+
+  /* the reactions of the contacts removed by the previous call may
+     still warm start new contacts, older ones are dropped */
+  for (WarmStartReactions::iterator itw = _warmStartReactions->begin();
+       itw != _warmStartReactions->end();)
   {
-    ++v0next;  // trick to iterate on a dynamic bgl graph
-    SP::Interaction inter0 = indexSet0->bundle(*ui0);
-
-    if (gOrphanedInteractions.find(&*inter0) != gOrphanedInteractions.end())
+    std::vector<WarmStartReaction>& reactions = (*itw).second;
+    unsigned int kept = 0;
+    for (unsigned int k = 0; k < reactions.size(); ++k)
     {
-      model()->nonSmoothDynamicalSystem()->removeInteraction(inter0);
+      if (reactions[k].stamp + 1 >= _contactPointsStamp)
+        reactions[kept++] = reactions[k];
     }
-
+    reactions.resize(kept);
+    if (reactions.empty())
+      _warmStartReactions->erase(itw++);
     else
-    {
-      SP::btManifoldPoint cp = ask<ForContactPoint>(*(inter0->relation()));
-      if(cp)
-      {
-        DEBUG_PRINTF("Contact point in interaction : %p\n", &*cp);
-
-        contactPoints[&*cp] = false;
-      }
-    }
+      ++itw;
   }
+
+  std::vector<SP::Interaction> removedInteractions;
+
+  std::vector<NewInteraction> newInteractions;
+
   unsigned int numManifolds =
     _collisionWorld->getDispatcher()->getNumManifolds();
 
@@ -243,9 +270,17 @@ void BulletSpaceFilter::buildInteractions(double time)
       for (unsigned int z = 0; z < numContacts; ++z)
       {
 
-        SP::btManifoldPoint cpoint(createSPtrbtManifoldPoint(contactManifold->getContactPoint(z)));
-        DEBUG_PRINTF("manifold %d, contact %d, &contact %p, lifetime %d\n", i, z, &*cpoint, cpoint->getLifeTime());
+        btManifoldPoint& point = contactManifold->getContactPoint(z);
+        DEBUG_PRINTF("manifold %d, contact %d, &contact %p, lifetime %d\n", i, z, &point, point.getLifeTime());
 
+        ContactPoints::iterator itc = _contactPoints->find(&point);
+        if (itc != _contactPoints->end() &&
+            point.m_userPersistentData == &*(*itc).second.interaction)
+        {
+          /* same contact as in the previous call */
+          (*itc).second.stamp = _contactPointsStamp;
+          continue;
+        }
 
         // should no be mixed with something else that use UserPointer!
         SP::BulletDS dsa;
@@ -287,101 +322,96 @@ void BulletSpaceFilter::buildInteractions(double time)
 
         if (nslaw)
         {
-          std::map<btManifoldPoint*, bool>::iterator itc;
-          itc = contactPoints.find(&*cpoint);
-
-          DEBUG_EXPR(if (itc == contactPoints.end())
-                     {
-                       DEBUG_PRINT("contact point not found\n");
-                       for(std::map<btManifoldPoint*, bool>::iterator itd=contactPoints.begin();
-                           itd != contactPoints.end(); ++itd)
-                       {
-                         DEBUG_PRINTF("-->%p != %p\n", &*cpoint, &*(*itd).first);
-                       }
-                     });
+          /* new interaction */
+          SP::btManifoldPoint cpoint(createSPtrbtManifoldPoint(point));
 
+          SP::Interaction inter = newInteraction(nslaw, cpoint, 4 * i + z);
 
-          if (itc == contactPoints.end() || !cpoint->m_userPersistentData)
+          if (dsa != dsb)
           {
-            /* new interaction */
+            DEBUG_PRINTF("LINK obA:%p obB:%p inter:%p\n", obA, obB, &*inter);
+            assert(inter);
 
-            SP::Interaction inter;
-            if (nslaw->size() == 3)
-            {
-              SP::BulletR rel(new BulletR(cpoint));
-              inter.reset(new Interaction(3, nslaw, rel, 4 * i + z));
-            }
-            else
+            /* the interaction of a destroyed or moved contact point
+               is replaced */
+            if (itc != _contactPoints->end())
             {
-              if (nslaw->size() == 1)
-              {
-              SP::BulletFrom1DLocalFrameR rel(new BulletFrom1DLocalFrameR(cpoint));
-              inter.reset(new Interaction(1, nslaw, rel, 4 * i + z));
-              }
+              saveReaction((*itc).second);
+              removedInteractions.push_back((*itc).second.interaction);
             }
 
-            if (obB->getUserPointer())
-            {
-              SP::BulletDS dsb(static_cast<BulletDS*>(obB->getUserPointer())->shared_ptr());
-
-              if (dsa != dsb)
-              {
-                DEBUG_PRINTF("LINK obA:%p obB:%p inter:%p\n", obA, obB, &*inter);
-                assert(inter);
-
-                cpoint->m_userPersistentData = &*inter;
-                link(inter, dsa, dsb);
-              }
-              /* else collision shapes belong to the same object do nothing */
-            }
-            else
-            {
-              DEBUG_PRINTF("LINK obA:%p inter :%p\n", obA, &*inter);
-              assert(inter);
-
-              cpoint->m_userPersistentData = &*inter;
-              link(inter, dsa);
-            }
-          }
-
-          if (cpoint->m_userPersistentData)
-          {
-            activeInteractions[static_cast<Interaction *>(cpoint->m_userPersistentData)] = true;
-            DEBUG_PRINTF("Interaction %p = true\n", static_cast<Interaction *>(cpoint->m_userPersistentData));
-            DEBUG_PRINTF("cpoint %p  = true\n", &*cpoint);
-          }
-          else
-          {
-            assert(false);
-            DEBUG_PRINT("cpoint->m_userPersistentData is empty\n");
+            cpoint->m_userPersistentData = &*inter;
+            ContactPointInteraction& contact = (*_contactPoints)[&point];
+            contact.interaction = inter;
+            contact.stamp = _contactPointsStamp;
+            contact.objectA = obA;
+            contact.objectB = obB;
+            contact.localPointA[0] = point.m_localPointA[0];
+            contact.localPointA[1] = point.m_localPointA[1];
+            contact.localPointA[2] = point.m_localPointA[2];
+
+            NewInteraction newInter;
+            newInter.inter = inter;
+            newInter.dsa = dsa;
+            newInter.dsb = dsb;
+            newInter.contact = contact;
+            newInter.distance = contactManifold->getContactBreakingThreshold();
+            newInteractions.push_back(newInter);
           }
-
-          contactPoints[&*cpoint] = true;
-          DEBUG_PRINTF("cpoint %p  = true\n", &*cpoint);
+          /* else collision shapes belong to the same object do nothing */
         }
       }
     }
   }
-  // 4. remove old contact points
-  std11::tie(ui0, ui0end) = indexSet0->vertices();
-  for (v0next = ui0 ;
-       ui0 != ui0end; ui0 = v0next)
+
+  // 3. remove the interactions of the contact points that have not
+  // been found
+  DEBUG_PRINT("-----  3. remove old contact points\n");
+  for (ContactPoints::iterator itc = _contactPoints->begin();
+       itc != _contactPoints->end();)
   {
-    ++v0next;  // trick to iterate on a dynamic bgl graph
-    SP::Interaction inter0 = indexSet0->bundle(*ui0);
-    SP::btManifoldPoint cp = ask<ForContactPoint>(*(inter0->relation()));
-    if (cp)
+    if ((*itc).second.stamp != _contactPointsStamp)
     {
-      if (!contactPoints[&*cp])
-      {
+      DEBUG_PRINTF("remove contact %p\n", (*itc).first);
+      saveReaction((*itc).second);
+      removedInteractions.push_back((*itc).second.interaction);
+      _contactPoints->erase(itc++);
+    }
+    else
+      ++itc;
+  }
 
-        //      assert (!contactPoints[&*ask<ForContactPoint>(*(inter0->relation()))]);
+  // 4. update the topology in one batch: removed interactions first,
+  // then the new ones, warm started with the reactions of the removed
+  // contacts once initialized
+  DEBUG_PRINTF("-----  4. update topology, %zu removed, %zu new interactions\n",
+               removedInteractions.size(), newInteractions.size());
+  SP::Topology topology = model()->nonSmoothDynamicalSystem()->topology();
+  topology->beginUpdate();
+  topology->removeInteractions(removedInteractions);
+
+  for (std::vector<NewInteraction>::iterator it = newInteractions.begin();
+       it != newInteractions.end(); ++it)
+  {
+    if ((*it).dsb)
+      link((*it).inter, (*it).dsa, (*it).dsb);
+    else
+      link((*it).inter, (*it).dsa);
 
-        DEBUG_PRINTF("remove contact %p, lifetime %d\n",
-                     &*ask<ForContactPoint>(*(inter0->relation())),
-                     ask<ForContactPoint>(*(inter0->relation()))->getLifeTime());
-        model()->nonSmoothDynamicalSystem()->removeInteraction(inter0);
-      }
+    restoreReaction((*it).contact, (*it).distance);
+  }
+  topology->commit();
+
+  // 5. keep the removed interactions for the next new contacts
+  if (_recycleContacts)
+  {
+    for (std::vector<SP::Interaction>::iterator it = removedInteractions.begin();
+         it != removedInteractions.end(); ++it)
+    {
+      if ((*it)->nslaw()->size() == 3)
+        _interactionsPool3.push_back(*it);
+      else
+        _interactionsPool1.push_back(*it);
     }
   }
 
@@ -391,6 +421,160 @@ void BulletSpaceFilter::buildInteractions(double time)
 
 }
 
+SP::Interaction BulletSpaceFilter::newInteraction(SP::NonSmoothLaw nslaw,
+                                                  SP::btManifoldPoint cpoint,
+                                                  unsigned int number)
+{
+  unsigned int size = nslaw->size();
+  if (size != 3 && size != 1)
+    return SP::Interaction();
+
+  std::vector<SP::Interaction>& pool =
+    (size == 3) ? _interactionsPool3 : _interactionsPool1;
+  while (!pool.empty())
+  {
+    SP::Interaction inter = pool.back();
+    pool.pop_back();
+
+    /* an interaction still used elsewhere is left to its owners */
+    if (!inter.unique())
+      continue;
+
+    SP::Relation rel = inter->relation();
+    if (size == 3)
+      std11::static_pointer_cast<BulletR>(rel)->setContactPoint(cpoint);
+    else
+      std11::static_pointer_cast<BulletFrom1DLocalFrameR>(rel)->setContactPoint(cpoint);
+    inter->recycle(nslaw, rel, number);
+    ++_recycledContacts;
+    DEBUG_PRINTF("recycle interaction %p\n", &*inter);
+    return inter;
+  }
+
+  SP::Interaction inter;
+  if (size == 3)
+  {
+    SP::BulletR rel(new BulletR(cpoint));
+    inter.reset(new Interaction(3, nslaw, rel, number));
+  }
+  else
+  {
+    SP::BulletFrom1DLocalFrameR rel(new BulletFrom1DLocalFrameR(cpoint));
+    inter.reset(new Interaction(1, nslaw, rel, number));
+  }
+  ++_createdContacts;
+  return inter;
+}
+
+void BulletSpaceFilter::clearContactsPool()
+{
+  _interactionsPool3.clear();
+  _interactionsPool1.clear();
+}
+
+unsigned int BulletSpaceFilter::liveContacts() const
+{
+  return _contactPoints->size();
+}
+
+void BulletSpaceFilter::saveReaction(const ContactPointInteraction& contact)
+{
+  const Interaction& inter = *contact.interaction;
+  if (!_warmStart || inter.upperLevelForInput() < 1)
+    return;
+
+  const SiconosVector& lambda = *inter.lambda(1);
+  if (lambda.size() != 1 && lambda.size() != 3)
+    return;
+
+  /* the normal of the last computeh, the one of the reaction */
+  const SiconosVector& nc =
+    *std11::static_pointer_cast<NewtonEulerFrom1DLocalFrameR>
+    (inter.relation())->nc();
+  double n[3] = { nc(0), nc(1), nc(2) };
+  double t[6] = { 0., 0., 0., 0., 0., 0. };
+  if (lambda.size() == 3)
+    orthoBaseFromVector(&n[0], &n[1], &n[2], &t[0], &t[1], &t[2],
+                        &t[3], &t[4], &t[5]);
+
+  WarmStartReaction reaction;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    reaction.localPointA[i] = contact.localPointA[i];
+    reaction.force[i] = lambda(0) * n[i];
+    if (lambda.size() == 3)
+      reaction.force[i] += lambda(1) * t[i] + lambda(2) * t[3+i];
+  }
+  reaction.stamp = _contactPointsStamp;
+
+  DEBUG_PRINTF("save reaction of %p : %g %g %g\n", &inter,
+               reaction.force[0], reaction.force[1], reaction.force[2]);
+  (*_warmStartReactions)[std::make_pair(contact.objectA, contact.objectB)]
+    .push_back(reaction);
+}
+
+void BulletSpaceFilter::restoreReaction(const ContactPointInteraction& contact,
+                                        double distance)
+{
+  Interaction& inter = *contact.interaction;
+  if (!_warmStart || inter.upperLevelForInput() < 1)
+    return;
+
+  WarmStartReactions::iterator itw = _warmStartReactions->find(
+    std::make_pair(contact.objectA, contact.objectB));
+  if (itw == _warmStartReactions->end())
+    return;
+
+  /* closest removed contact point in the frame of the first object */
+  std::vector<WarmStartReaction>& reactions = (*itw).second;
+  unsigned int closest = reactions.size();
+  double dmin = distance * distance;
+  for (unsigned int k = 0; k < reactions.size(); ++k)
+  {
+    double d = 0.;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      double di = reactions[k].localPointA[i] - contact.localPointA[i];
+      d += di * di;
+    }
+    if (d <= dmin)
+    {
+      dmin = d;
+      closest = k;
+    }
+  }
+  if (closest == reactions.size())
+    return;
+
+  SiconosVector& lambda = *inter.lambda(1);
+  SiconosVector& lambdaOld = *inter.lambdaOld(1);
+  if (lambda.size() != 1 && lambda.size() != 3)
+    return;
+
+  const double* f = reactions[closest].force;
+  const SiconosVector& nc =
+    *std11::static_pointer_cast<NewtonEulerFrom1DLocalFrameR>
+    (inter.relation())->nc();
+  double n[3] = { nc(0), nc(1), nc(2) };
+  double t[6];
+  orthoBaseFromVector(&n[0], &n[1], &n[2], &t[0], &t[1], &t[2],
+                      &t[3], &t[4], &t[5]);
+
+  lambda(0) = f[0] * n[0] + f[1] * n[1] + f[2] * n[2];
+  if (lambda.size() == 3)
+  {
+    lambda(1) = f[0] * t[0] + f[1] * t[1] + f[2] * t[2];
+    lambda(2) = f[0] * t[3] + f[1] * t[4] + f[2] * t[5];
+  }
+  lambdaOld = lambda;
+
+  DEBUG_PRINTF("restore reaction of %p : %g\n", &inter, lambda(0));
+
+  /* a removed reaction warm starts one contact only */
+  reactions[closest] = reactions.back();
+  reactions.pop_back();
+}
+
 void BulletSpaceFilter::addStaticObject(SP::btCollisionObject co, unsigned int id)
 {
   (*_staticObjects)[&*co]= std::pair<SP::btCollisionObject, int>(co, id);
@@ -21,6 +21,9 @@
 
 #include "BulletSiconosFwd.hpp"
 #include "SpaceFilter.hpp"
+#include <vector>
+
+struct ContactPointInteraction;
 
 class BulletSpaceFilter : public SpaceFilter
 {
@@ -41,6 +44,58 @@ protected:
 
   double _closeContactsThreshold;
 
+  /** interactions of the contact points found by the last call of
+      buildInteractions, persistent between calls */
+  SP::ContactPoints _contactPoints;
+
+  /** number of calls of buildInteractions */
+  unsigned int _contactPointsStamp;
+
+  /** reactions of the contacts removed by the last calls of
+      buildInteractions */
+  SP::WarmStartReactions _warmStartReactions;
+
+  /** seed the reactions of new contacts with the ones of removed
+      contacts */
+  bool _warmStart;
+
+  /** interactions of removed contacts, with a non smooth law of size
+      3 or 1, kept with their relation and buffers to be recycled by
+      new contacts */
+  std::vector<SP::Interaction> _interactionsPool3;
+  std::vector<SP::Interaction> _interactionsPool1;
+
+  /** recycle the interactions of removed contacts */
+  bool _recycleContacts;
+
+  /** number of interactions created and recycled for new contacts */
+  unsigned long int _createdContacts;
+  unsigned long int _recycledContacts;
+
+  /** get an interaction for a new contact point, recycled from the
+   * pool if possible
+   * \param nslaw the non smooth law of the contact
+   * \param cpoint the contact point
+   * \param number the number of the interaction
+   * \return the interaction, null if the size of nslaw is not 1 or 3
+   */
+  SP::Interaction newInteraction(SP::NonSmoothLaw nslaw,
+                                 SP::btManifoldPoint cpoint,
+                                 unsigned int number);
+
+  /** record the reaction of a removed contact in _warmStartReactions
+   * \param contact the removed contact
+   */
+  void saveReaction(const ContactPointInteraction& contact);
+
+  /** set the reaction of a new contact from the closest reaction
+   * recorded for the same pair of collision objects, if any
+   * \param contact the new contact
+   * \param distance maximum distance between the contact points
+   */
+  void restoreReaction(const ContactPointInteraction& contact,
+                       double distance);
+
 public:
   BulletSpaceFilter(SP::Model model);
 
@@ -109,6 +164,78 @@ public:
     _closeContactsThreshold = threshold;
   }
 
+  /** warm start the new contacts with the reactions of the removed
+   *  contacts of the same pair of collision objects. Bullet may
+   *  replace a contact point by a new one at the same place, and its
+   *  interaction is then recreated with a zero reaction. The reaction
+   *  of the closest removed contact point is expressed in the local
+   *  frame of the new one and set in its lambda and lambdaOld.
+   *  \param val true to warm start the new contacts (default)
+   */
+  void setWarmStart(bool val)
+  {
+    _warmStart = val;
+  }
+
+  /** \return true if the new contacts are warm started
+   */
+  bool warmStart() const
+  {
+    return _warmStart;
+  }
+
+  /** recycle the Interaction and the relation of the removed contacts
+   *  for the new ones, with their vectors and matrices, instead of
+   *  allocating new objects. An interaction still referenced outside
+   *  of the space filter when it is needed again is not recycled.
+   *  \param val true to recycle the contacts (default)
+   */
+  void setRecycleContacts(bool val)
+  {
+    _recycleContacts = val;
+    if (!val)
+      clearContactsPool();
+  }
+
+  /** \return true if the removed contacts are recycled
+   */
+  bool recycleContacts() const
+  {
+    return _recycleContacts;
+  }
+
+  /** release the interactions kept for recycling
+   */
+  void clearContactsPool();
+
+  /** \return the number of contacts found by the last call of
+   *  buildInteractions
+   */
+  unsigned int liveContacts() const;
+
+  /** \return the number of interactions of removed contacts kept for
+   *  recycling
+   */
+  unsigned int pooledContacts() const
+  {
+    return _interactionsPool3.size() + _interactionsPool1.size();
+  }
+
+  /** \return the number of interactions allocated for new contacts
+   */
+  unsigned long int createdContacts() const
+  {
+    return _createdContacts;
+  }
+
+  /** \return the number of new contacts that recycled the interaction
+   *  of a removed contact
+   */
+  unsigned long int recycledContacts() const
+  {
+    return _recycledContacts;
+  }
+
   ACCEPT_STD_VISITORS();
 
   /** set a new collision configuration
@@ -117,6 +244,14 @@ public:
   void setCollisionConfiguration(
     SP::btDefaultCollisionConfiguration collisionConfig);
 
+  /** set a new collision dispatcher, for instance a
+   *  btCollisionDispatcherMt of a Bullet library built with
+   *  BT_THREADSAFE, to run the narrowphase on several threads
+   * \param dispatcher the new bullet collision dispatcher, built on
+   *        collisionConfiguration()
+   */
+  void setCollisionDispatcher(SP::btCollisionDispatcher dispatcher);
+
 
 };
 
@@ -3,8 +3,14 @@
 
 
 #include <map>
+#include <vector>
 #include <Question.hpp>
 
+#include <SiconosConfig.h>
+#if defined(SICONOS_STD_UNORDERED_MAP) && !defined(SICONOS_USE_MAP_FOR_HASH)
+#include <unordered_map>
+#endif
+
 struct StaticObjects :
   public std::map<const btCollisionObject*,
                   std::pair<SP::btCollisionObject, long unsigned int> >
@@ -13,6 +19,50 @@ struct StaticObjects :
 };
 
 
+/** interaction attached to a contact point and number of the last
+    call of BulletSpaceFilter::buildInteractions that found the point.
+    The pair of collision objects and the contact point in the frame
+    of the first one identify the contact when the point is gone */
+struct ContactPointInteraction
+{
+  SP::Interaction interaction;
+  unsigned int stamp;
+  const btCollisionObject* objectA;
+  const btCollisionObject* objectB;
+  double localPointA[3];
+};
+
+/** contact points cache of BulletSpaceFilter, keyed by the address of
+    the point: a manifold of a pair of collision objects and a slot
+    in this manifold */
+struct ContactPoints :
+#if defined(SICONOS_STD_UNORDERED_MAP) && !defined(SICONOS_USE_MAP_FOR_HASH)
+  public std::unordered_map<const btManifoldPoint*, ContactPointInteraction>
+#else
+  public std::map<const btManifoldPoint*, ContactPointInteraction>
+#endif
+{
+};
+
+/** reaction of a removed contact, as a force in the world frame,
+    and number of the call of BulletSpaceFilter::buildInteractions
+    that removed it */
+struct WarmStartReaction
+{
+  double localPointA[3];
+  double force[3];
+  unsigned int stamp;
+};
+
+/** reactions of the removed contacts of each pair of collision
+    objects, used to warm start the new contacts of this pair */
+struct WarmStartReactions :
+  public std::map<std::pair<const btCollisionObject*,
+                            const btCollisionObject*>,
+                  std::vector<WarmStartReaction> >
+{
+};
+
 struct ForStaticObjects : public Question< SP::StaticObjects >
 {
   ANSWER(BulletSpaceFilter, staticObjects());
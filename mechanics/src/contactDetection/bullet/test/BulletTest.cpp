@@ -0,0 +1,310 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "BulletTest.hpp"
+
+#include <SiconosKernel.hpp>
+
+#include <BulletSpaceFilter.hpp>
+#include <BulletTimeStepping.hpp>
+#include <BulletDS.hpp>
+#include <BulletR.hpp>
+#include <BulletWeightedShape.hpp>
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunreachable-code"
+#pragma clang diagnostic ignored "-Woverloaded-virtual"
+#elif !(__INTEL_COMPILER || __APPLE__ )
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Woverloaded-virtual"
+#endif
+#include <BulletCollision/CollisionShapes/btConvexHullShape.h>
+#include <BulletCollision/CollisionDispatch/btCollisionObject.h>
+#include <BulletCollision/CollisionShapes/btBoxShape.h>
+#include <BulletCollision/CollisionDispatch/btCollisionWorld.h>
+#include <BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
+#include <BulletCollision/NarrowPhaseCollision/btManifoldPoint.h>
+#include <BulletCollision/NarrowPhaseCollision/btPersistentManifold.h>
+#include <BulletCollision/BroadphaseCollision/btDispatcher.h>
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#elif !(__INTEL_COMPILER || __APPLE__ )
+#pragma GCC diagnostic pop
+#endif
+
+#include <set>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BulletTest);
+
+void BulletTest::setUp()
+{
+  double h = 0.005;
+
+  model.reset(new Model(0., 100.));
+
+  // a cube of side 2, built as a convex hull, see BulletBouncingBox
+  SP::btCollisionShape cube(new btConvexHullShape());
+  for (int i = -1; i <= 1; i += 2)
+    for (int j = -1; j <= 1; j += 2)
+      for (int k = -1; k <= 1; k += 2)
+        std11::static_pointer_cast<btConvexHullShape>(cube)->addPoint(btVector3(i, j, k));
+  SP::BulletWeightedShape shape(new BulletWeightedShape(cube, 1.0));
+
+  SP::SiconosVector q0(new SiconosVector(7));
+  SP::SiconosVector v0(new SiconosVector(6));
+  (*q0)(2) = 1.2;
+  (*q0)(3) = 1.0;
+  box.reset(new BulletDS(shape, q0, v0));
+
+  weight.reset(new SiconosVector(3));
+  (*weight)(2) = -9.81 * shape->mass();
+  box->setFExtPtr(weight);
+  model->nonSmoothDynamicalSystem()->insertDynamicalSystem(box);
+
+  // the top of the ground is z = 0
+  ground.reset(new btCollisionObject());
+  ground->setCollisionFlags(btCollisionObject::CF_STATIC_OBJECT);
+  groundShape.reset(new btBoxShape(btVector3(30, 30, .5)));
+  btMatrix3x3 basis;
+  basis.setIdentity();
+  ground->getWorldTransform().setBasis(basis);
+  ground->setCollisionShape(&*groundShape);
+  ground->getWorldTransform().getOrigin().setZ(-.5);
+
+  SP::FrictionContact osnspb(new FrictionContact(3));
+  osnspb->numericsSolverOptions()->iparam[0] = 1000;
+  osnspb->numericsSolverOptions()->dparam[0] = 1e-8;
+  osnspb->setMaxSize(16384);
+  osnspb->setMStorageType(1);
+  osnspb->setKeepLambdaAndYState(true);
+
+  SP::NonSmoothLaw nslaw(new NewtonImpactFrictionNSL(0., 0., 0.3, 3));
+  spaceFilter.reset(new BulletSpaceFilter(model));
+  spaceFilter->insert(nslaw, 0, 0);
+  spaceFilter->collisionConfiguration()->setConvexConvexMultipointIterations();
+  spaceFilter->collisionConfiguration()->setPlaneConvexMultipointIterations();
+  spaceFilter->addStaticObject(ground, 0);
+
+  simulation.reset(new BulletTimeStepping(SP::TimeDiscretisation(new TimeDiscretisation(0., h))));
+  simulation->insertIntegrator(SP::OneStepIntegrator(new MoreauJeanOSI(0.5)));
+  simulation->insertNonSmoothProblem(osnspb);
+
+  model->initialize(simulation);
+}
+
+void BulletTest::tearDown()
+{
+  spaceFilter.reset();
+  simulation.reset();
+  model.reset();
+  box.reset();
+}
+
+void BulletTest::step()
+{
+  spaceFilter->buildInteractions(model->currentTime());
+  simulation->computeOneStep();
+  simulation->nextStep();
+}
+
+void BulletTest::checkCache()
+{
+  SP::InteractionsGraph indexSet0 =
+    model->nonSmoothDynamicalSystem()->topology()->indexSet0();
+  CPPUNIT_ASSERT_EQUAL((size_t) spaceFilter->liveContacts(), indexSet0->size());
+
+  // each interaction is carried by its contact point, the cache has
+  // not kept an interaction of a destroyed or replaced point
+  std::set<btManifoldPoint*> points;
+  InteractionsGraph::VIterator vi, viend;
+  for (std11::tie(vi, viend) = indexSet0->vertices(); vi != viend; ++vi)
+  {
+    SP::Interaction inter = indexSet0->bundle(*vi);
+    SP::btManifoldPoint point =
+      std11::static_pointer_cast<BulletR>(inter->relation())->contactPoint();
+    CPPUNIT_ASSERT(point->m_userPersistentData == &*inter);
+    CPPUNIT_ASSERT(points.insert(&*point).second);
+  }
+}
+
+// a box at rest on the ground keeps its contact points, and their
+// interactions are neither removed nor created again
+void BulletTest::contactCache()
+{
+  unsigned int k;
+  for (k = 0; k < 400 && spaceFilter->liveContacts() < 4; ++k)
+  {
+    step();
+    checkCache();
+  }
+  CPPUNIT_ASSERT(spaceFilter->liveContacts() >= 4);
+
+  // let the box settle
+  for (k = 0; k < 100; ++k)
+  {
+    step();
+    checkCache();
+  }
+
+  SP::InteractionsGraph indexSet0 =
+    model->nonSmoothDynamicalSystem()->topology()->indexSet0();
+  std::set<Interaction*> interactions;
+  InteractionsGraph::VIterator vi, viend;
+  for (std11::tie(vi, viend) = indexSet0->vertices(); vi != viend; ++vi)
+    interactions.insert(&*indexSet0->bundle(*vi));
+  unsigned long int newContacts =
+    spaceFilter->createdContacts() + spaceFilter->recycledContacts();
+
+  for (k = 0; k < 50; ++k)
+  {
+    step();
+    checkCache();
+  }
+
+  std::set<Interaction*> interactionsAfter;
+  for (std11::tie(vi, viend) = indexSet0->vertices(); vi != viend; ++vi)
+    interactionsAfter.insert(&*indexSet0->bundle(*vi));
+  CPPUNIT_ASSERT(interactions == interactionsAfter);
+  CPPUNIT_ASSERT_EQUAL(newContacts,
+                       spaceFilter->createdContacts() + spaceFilter->recycledContacts());
+}
+
+// the interactions of the contacts removed when the box is lifted are
+// pooled and recycled when it falls back on the ground
+void BulletTest::recycleContacts()
+{
+  CPPUNIT_ASSERT(spaceFilter->recycleContacts());
+
+  unsigned int k;
+  for (k = 0; k < 400 && spaceFilter->liveContacts() < 4; ++k)
+    step();
+  CPPUNIT_ASSERT(spaceFilter->liveContacts() >= 4);
+  unsigned long int created = spaceFilter->createdContacts();
+  unsigned int pooled = spaceFilter->pooledContacts();
+
+  // lift the box
+  (*weight)(2) = -2. * (*weight)(2);
+  for (k = 0; k < 400 && spaceFilter->liveContacts() > 0; ++k)
+    step();
+  CPPUNIT_ASSERT_EQUAL(0u, spaceFilter->liveContacts());
+  CPPUNIT_ASSERT_EQUAL((size_t) 0,
+                       model->nonSmoothDynamicalSystem()->topology()->indexSet0()->size());
+  CPPUNIT_ASSERT(spaceFilter->pooledContacts() >= pooled + 4);
+
+  // and let it fall back
+  (*weight)(2) = -0.5 * (*weight)(2);
+  unsigned long int recycled = spaceFilter->recycledContacts();
+  for (k = 0; k < 1000 && spaceFilter->liveContacts() < 4; ++k)
+  {
+    step();
+    checkCache();
+  }
+  CPPUNIT_ASSERT(spaceFilter->liveContacts() >= 4);
+  CPPUNIT_ASSERT(spaceFilter->recycledContacts() >= recycled + 4);
+  CPPUNIT_ASSERT_EQUAL(created, spaceFilter->createdContacts());
+
+  // without recycling, the pool is released
+  spaceFilter->setRecycleContacts(false);
+  CPPUNIT_ASSERT_EQUAL(0u, spaceFilter->pooledContacts());
+}
+
+// a contact point destroyed and replaced by a new point in the same
+// slot of its manifold, hence at the same address, between two calls
+// of buildInteractions is not taken for the previous contact: its
+// interaction is replaced, and the new one is warm started with the
+// reaction of the destroyed contact
+void BulletTest::reusedContactPoint()
+{
+  unsigned int k;
+  for (k = 0; k < 400 && spaceFilter->liveContacts() < 4; ++k)
+    step();
+  CPPUNIT_ASSERT(spaceFilter->liveContacts() >= 4);
+
+  // let the box settle
+  for (k = 0; k < 100; ++k)
+    step();
+
+  btDispatcher* dispatcher = spaceFilter->collisionWorld()->getDispatcher();
+  btPersistentManifold* manifold = NULL;
+  for (int i = 0; i < dispatcher->getNumManifolds() && !manifold; ++i)
+  {
+    if (dispatcher->getManifoldByIndexInternal(i)->getNumContacts() > 0)
+      manifold = dispatcher->getManifoldByIndexInternal(i);
+  }
+  CPPUNIT_ASSERT(manifold);
+  int last = manifold->getNumContacts() - 1;
+  btManifoldPoint& point = manifold->getContactPoint(last);
+
+  SP::InteractionsGraph indexSet0 =
+    model->nonSmoothDynamicalSystem()->topology()->indexSet0();
+  std::set<Interaction*> interactions;
+  SP::Interaction destroyed;
+  InteractionsGraph::VIterator vi, viend;
+  for (std11::tie(vi, viend) = indexSet0->vertices(); vi != viend; ++vi)
+  {
+    interactions.insert(&*indexSet0->bundle(*vi));
+    if (&*indexSet0->bundle(*vi) == point.m_userPersistentData)
+      destroyed = indexSet0->bundle(*vi);
+  }
+  CPPUNIT_ASSERT(destroyed);
+  double reaction = (*destroyed->lambda(1))(0);
+  CPPUNIT_ASSERT(reaction > 0.);
+  unsigned long int newContacts =
+    spaceFilter->createdContacts() + spaceFilter->recycledContacts();
+
+  // the new point is built from the geometry of the destroyed one,
+  // without user persistent data. The data of the destroyed point is
+  // cleared as clearUserCache does with a contact destroyed callback.
+  btManifoldPoint newPoint(point.m_localPointA, point.m_localPointB,
+                           point.m_normalWorldOnB, point.getDistance());
+  newPoint.m_positionWorldOnA = point.m_positionWorldOnA;
+  newPoint.m_positionWorldOnB = point.m_positionWorldOnB;
+  point.m_userPersistentData = NULL;
+  manifold->removeContactPoint(last);
+  CPPUNIT_ASSERT_EQUAL(last, manifold->addManifoldPoint(newPoint));
+  CPPUNIT_ASSERT(&manifold->getContactPoint(last) == &point);
+
+  spaceFilter->buildInteractions(model->currentTime());
+  checkCache();
+
+  // exactly one new interaction, in place of the one of the destroyed
+  // point, which is kept in the pool
+  SP::Interaction created;
+  unsigned int nbCreated = 0;
+  for (std11::tie(vi, viend) = indexSet0->vertices(); vi != viend; ++vi)
+  {
+    CPPUNIT_ASSERT(indexSet0->bundle(*vi) != destroyed);
+    if (!interactions.count(&*indexSet0->bundle(*vi)))
+    {
+      created = indexSet0->bundle(*vi);
+      ++nbCreated;
+    }
+  }
+  CPPUNIT_ASSERT_EQUAL(1u, nbCreated);
+  CPPUNIT_ASSERT_EQUAL(newContacts + 1,
+                       spaceFilter->createdContacts() + spaceFilter->recycledContacts());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(reaction, (*created->lambda(1))(0), 1e-12 * reaction);
+
+  simulation->computeOneStep();
+  simulation->nextStep();
+  for (k = 0; k < 10; ++k)
+  {
+    step();
+    checkCache();
+  }
+}
@@ -0,0 +1,70 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef BulletTest_h
+#define BulletTest_h
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <SiconosFwd.hpp>
+#include <BulletSiconosFwd.hpp>
+
+class BulletTest : public CppUnit::TestFixture
+{
+
+private:
+
+  // Name of the tests suite
+  CPPUNIT_TEST_SUITE(BulletTest);
+
+  CPPUNIT_TEST(contactCache);
+
+  CPPUNIT_TEST(recycleContacts);
+
+  CPPUNIT_TEST(reusedContactPoint);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  // a box falling on the ground
+  SP::Model model;
+  SP::BulletTimeStepping simulation;
+  SP::BulletSpaceFilter spaceFilter;
+  SP::BulletDS box;
+  SP::SiconosVector weight;
+  SP::btCollisionShape groundShape;
+  SP::btCollisionObject ground;
+
+  // one step of the simulation
+  void step();
+
+  // check that the contacts of the cache and the interactions of
+  // indexSet0 match
+  void checkCache();
+
+  // Members
+  void contactCache();
+
+  void recycleContacts();
+
+  void reusedContactPoint();
+
+public:
+  void setUp();
+  void tearDown();
+
+};
+
+#endif
@@ -688,6 +688,7 @@ void  MBTB_initSimu(double hTS, int withProj)
   _MBTB_printHeader(fp);
   fclose(fp) ;
   NumericsOptions global_options;
+  setDefaultNumericsOptions(&global_options);
   global_options.verboseMode=0;
   setNumericsOptions(&global_options);
   cout <<"====> end of initialisation" <<endl<<endl;
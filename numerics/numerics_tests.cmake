@@ -10,6 +10,8 @@ if(WITH_${COMPONENT}_TESTING)
     NEW_TEST(pinvtest testpinv.c)
   endif()
   NEW_TEST(test_op3x3 test_op3x3.c)
+  NEW_TEST(test_projectionOnCone test_projectionOnCone.c)
+  NEW_TEST(test_projectionOnCylinder test_projectionOnCylinder.c)
   NEW_TEST(test_timers_interf test_timers_interf.c)
   NEW_TEST(test_cblas test_cblas.c)
   NEW_TEST(test_dgesv test_dgesv.c)
@@ -28,11 +30,14 @@ if(WITH_${COMPONENT}_TESTING)
   NEW_TEST(NumericsMatrixTest4 NumericsMatrix_test4.c)
   NEW_TEST(NumericsMatrixTest5 NumericsMatrix_test5.c)
   NEW_TEST(NumericsMatrixTest6 NumericsMatrix_test6.c)
+  NEW_TEST(NumericsMatrixTest7 NumericsMatrix_test7.c)
+  NEW_TEST(NumericsMatrixTest8 NumericsMatrix_test8.c)
   NEW_TEST(SBMTest1 SBM_test1.c)
   NEW_TEST(SBMTest2 SBM_test2.c)
   NEW_TEST(SBMTest3 SBM_test3.c)
   NEW_TEST(SBMTest4 SBM_test4.c)
   NEW_TEST(SBMTest5 SBM_test5.c)
+  NEW_TEST(SBMTest6 SBM_test6.c)
   NEW_TEST(SparseMatrix0 SparseMatrix_test0.c)
   IF(HAS_ONE_LP_SOLVER)
    NEW_TEST(Vertex_extraction vertex_problem.c)
@@ -197,6 +202,7 @@ if(WITH_${COMPONENT}_TESTING)
     endif()
   ENDIF(HAVE_SYSTIMES_H)
   NEW_TEST(ReadWrite_MLCPtest MixedLinearComplementarity_ReadWrite_test.c)
+  NEW_TEST(MLCP_enum_tool_test mlcp_enum_tool_test.c)
   END_TEST()
 
   BEGIN_TEST(src/MCP/test)
@@ -396,6 +402,8 @@ if(WITH_${COMPONENT}_TESTING)
 
   NEW_TEST(FC3Dtest125 fc3d_test125.c) # TFP with other strategy for internal solver
   NEW_TEST(FC3Dtest126 fc3d_test126.c) # ACLMFPwith other strategy for internal solver
+  NEW_TEST(FC3Dtest127 fc3d_test127.c) # NSGS with graph-colored parallel sweep
+  NEW_TEST(FC3Dtest128 fc3d_test128.c) # NSGS with graph-colored sweep and batched Alart-Curnier
  
 
   NEW_TEST(FC3Dtest130 fc3d_test130.c)
@@ -539,6 +547,10 @@ if(WITH_${COMPONENT}_TESTING)
   
   ## Alart Curnier functions
   NEW_TEST(AlartCurnierFunctions_test fc3d_AlartCurnierFunctions_test.c)
+  NEW_TEST(AlartCurnierBatch_test fc3d_AlartCurnier_batch_test.c)
+
+  ## NSGS plan
+  NEW_TEST(FC3D_nsgs_plan_test fc3d_nsgs_plan_test.c)
   IF(WITH_FCLIB)
   NEW_TEST(FCLIB_test1 fc3d_writefclib_local_test.c)
   NEW_TEST(FCLIB_GFC3D_test1 gfc3d_fclib_cubeH8.c)
@@ -692,4 +704,38 @@ if(WITH_${COMPONENT}_TESTING)
   windows_library_extra_setup("numerics-test" "numerics-test")
   target_link_libraries(numerics-test ${PRIVATE} ${COMPONENT})
   target_link_libraries(numerics-test ${PRIVATE} ${${COMPONENT}_LINK_LIBRARIES})
+
+  # --- Benchmark of the FC3D/GFC3D solvers on FrictionContact/test/data ---
+  # make fc3d-benchmark : all the solvers on all the problems, results in
+  #   fc3d_benchmark.csv, fc3d_benchmark.json and fc3d_benchmark_profile.csv
+  # make fc3d-benchmark-check : same run, compared to the csv of a previous
+  #   run given by FC3D_BENCHMARK_REFERENCE, fails on regressions.
+  # The test is a short run to check that the benchmark itself works.
+  set(FC3D_BENCHMARK_DIR ${CMAKE_CURRENT_BINARY_DIR}/src/FrictionContact/test)
+  set(FC3D_BENCHMARK_THRESHOLD 1.5 CACHE STRING "Time ratio above which fc3d-benchmark-check reports a regression")
+  set(FC3D_BENCHMARK_ARGS --repeat 3 --time-limit 600
+    --csv fc3d_benchmark.csv --json fc3d_benchmark.json --profile fc3d_benchmark_profile.csv)
+  add_executable(fc3d_benchmark src/FrictionContact/test/fc3d_benchmark.c)
+  set_target_properties(fc3d_benchmark PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${FC3D_BENCHMARK_DIR})
+  target_link_libraries(fc3d_benchmark ${PRIVATE} ${COMPONENT})
+  target_link_libraries(fc3d_benchmark ${PRIVATE} ${${COMPONENT}_LINK_LIBRARIES})
+  add_custom_target(fc3d-benchmark
+    COMMAND fc3d_benchmark ${FC3D_BENCHMARK_ARGS}
+    DEPENDS fc3d_benchmark
+    WORKING_DIRECTORY ${FC3D_BENCHMARK_DIR}
+    COMMENT "Run the friction contact benchmark")
+  if(FC3D_BENCHMARK_REFERENCE)
+    add_custom_target(fc3d-benchmark-check
+      COMMAND fc3d_benchmark ${FC3D_BENCHMARK_ARGS}
+      --reference ${FC3D_BENCHMARK_REFERENCE} --threshold ${FC3D_BENCHMARK_THRESHOLD}
+      DEPENDS fc3d_benchmark
+      WORKING_DIRECTORY ${FC3D_BENCHMARK_DIR}
+      COMMENT "Run the friction contact benchmark and compare with ${FC3D_BENCHMARK_REFERENCE}")
+  endif()
+  add_test(NAME FC3D_benchmark
+    COMMAND fc3d_benchmark --solvers FC3D_NSGS,FC3D_NSN_AC,GFC3D_NSGS_WR
+    --csv fc3d_benchmark_test.csv ./data/Confeti-ex13-4contact-Fc3D-SBM.dat
+    --global ./data/Example_GlobalFrictionContact.dat
+    WORKING_DIRECTORY ${FC3D_BENCHMARK_DIR})
+  set_tests_properties(FC3D_benchmark PROPERTIES TIMEOUT ${tests_timeout})
 endif()
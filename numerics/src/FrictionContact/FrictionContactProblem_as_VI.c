@@ -63,12 +63,9 @@ void Projection_VI_FC3D(void *viIn, double *x, double *PX)
   FrictionContactProblem * fc3d = pb->fc3d;
   //frictionContact_display(fc3d);
 
-  int contact =0;
   int nLocal =  fc3d->dimension;
   int n = fc3d->numberOfContacts* nLocal;
+  assert(nLocal == 3);
   cblas_dcopy(n , x , 1 , PX, 1);
-  for (contact = 0 ; contact < fc3d->numberOfContacts  ; ++contact)
-  {
-    projectionOnCone(&PX[ contact * nLocal ], fc3d->mu[contact]);
-  }
+  projectionOnConeBatch(fc3d->numberOfContacts, fc3d->mu, PX);
 }
@@ -0,0 +1,373 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "fc3d_AlartCurnier_batch.h"
+#include <stdlib.h>
+#include <float.h>
+#include <math.h>
+#include <assert.h>
+
+#if FC3D_AC_BATCH_WIDTH > 1
+#include <immintrin.h>
+#endif
+
+/* #define DEBUG_MESSAGES */
+/* #define DEBUG_STDOUT */
+#include "debug.h"
+
+/* Operations on FC3D_AC_BATCH_WIDTH lanes. A mask holds the result of
+   a comparison for each lane, and SEL(m, a, b) takes a where m is set
+   and b elsewhere. */
+#if FC3D_AC_BATCH_WIDTH == 8
+typedef __m512d vd;
+typedef __mmask8 vmask;
+#define LOAD(p) _mm512_loadu_pd(p)
+#define STORE(p, a) _mm512_storeu_pd(p, a)
+#define SET1(x) _mm512_set1_pd(x)
+#define ADD(a, b) _mm512_add_pd(a, b)
+#define SUB(a, b) _mm512_sub_pd(a, b)
+#define MUL(a, b) _mm512_mul_pd(a, b)
+#define DIV(a, b) _mm512_div_pd(a, b)
+#define FMA(a, b, c) _mm512_fmadd_pd(a, b, c)
+#define SQRT(a) _mm512_sqrt_pd(a)
+#define GT(a, b) _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ)
+#define LT(a, b) _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ)
+#define LE(a, b) _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ)
+#define SEL(m, a, b) _mm512_mask_blend_pd(m, b, a)
+#define AND(m, n) ((vmask)((m) & (n)))
+#define OR(m, n) ((vmask)((m) | (n)))
+#define ANDNOT(m, n) ((vmask)(~(m) & (n)))
+#define TRUE_MASK ((vmask)0xFF)
+#define ANY(m) ((m) != 0)
+#define LANE(m, i) (((m) >> (i)) & 1)
+#elif FC3D_AC_BATCH_WIDTH == 4
+typedef __m256d vd;
+typedef __m256d vmask;
+#define LOAD(p) _mm256_loadu_pd(p)
+#define STORE(p, a) _mm256_storeu_pd(p, a)
+#define SET1(x) _mm256_set1_pd(x)
+#define ADD(a, b) _mm256_add_pd(a, b)
+#define SUB(a, b) _mm256_sub_pd(a, b)
+#define MUL(a, b) _mm256_mul_pd(a, b)
+#define DIV(a, b) _mm256_div_pd(a, b)
+#define FMA(a, b, c) _mm256_fmadd_pd(a, b, c)
+#define SQRT(a) _mm256_sqrt_pd(a)
+#define GT(a, b) _mm256_cmp_pd(a, b, _CMP_GT_OQ)
+#define LT(a, b) _mm256_cmp_pd(a, b, _CMP_LT_OQ)
+#define LE(a, b) _mm256_cmp_pd(a, b, _CMP_LE_OQ)
+#define SEL(m, a, b) _mm256_blendv_pd(b, a, m)
+#define AND(m, n) _mm256_and_pd(m, n)
+#define OR(m, n) _mm256_or_pd(m, n)
+#define ANDNOT(m, n) _mm256_andnot_pd(m, n)
+#define TRUE_MASK _mm256_castsi256_pd(_mm256_set1_epi64x(-1))
+#define ANY(m) (_mm256_movemask_pd(m) != 0)
+#define LANE(m, i) ((_mm256_movemask_pd(m) >> (i)) & 1)
+#else
+typedef double vd;
+typedef int vmask;
+#define LOAD(p) (*(p))
+#define STORE(p, a) (*(p) = (a))
+#define SET1(x) (x)
+#define ADD(a, b) ((a) + (b))
+#define SUB(a, b) ((a) - (b))
+#define MUL(a, b) ((a) * (b))
+#define DIV(a, b) ((a) / (b))
+#define FMA(a, b, c) ((a) * (b) + (c))
+#define SQRT(a) sqrt(a)
+#define GT(a, b) ((a) > (b))
+#define LT(a, b) ((a) < (b))
+#define LE(a, b) ((a) <= (b))
+#define SEL(m, a, b) ((m) ? (a) : (b))
+#define AND(m, n) ((m) && (n))
+#define OR(m, n) ((m) || (n))
+#define ANDNOT(m, n) (!(m) && (n))
+#define TRUE_MASK 1
+#define ANY(m) (m)
+#define LANE(m, i) (m)
+#endif
+
+/* number of doubles stored in batch->data for each contact */
+#define AC_BATCH_DOUBLES 20
+
+/* A contact that does not change the batch results: W = I, q = 0,
+   mu = 0, R = 0 is a solution and the Newton iterations stop at the
+   first one. Unused lanes are filled with it. */
+static void AC_batch_reset(FC3D_AC_Batch * batch, unsigned int begin, unsigned int end)
+{
+  for (unsigned int c = begin; c < end; ++c)
+  {
+    for (unsigned int k = 0; k < 9; ++k)
+      batch->W[k][c] = (k % 4 == 0) ? 1.0 : 0.0;
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+      batch->q[k][c] = 0.0;
+      batch->rho[k][c] = 1.0;
+      batch->R[k][c] = 0.0;
+    }
+    batch->mu[c] = 0.0;
+    batch->error[c] = 0.0;
+    batch->info[c] = 0;
+  }
+}
+
+FC3D_AC_Batch * fc3d_AC_batch_new(unsigned int capacity)
+{
+  FC3D_AC_Batch * batch = (FC3D_AC_Batch *)malloc(sizeof(FC3D_AC_Batch));
+  unsigned int padded = (capacity + FC3D_AC_BATCH_WIDTH - 1) / FC3D_AC_BATCH_WIDTH * FC3D_AC_BATCH_WIDTH;
+  if (padded == 0) padded = FC3D_AC_BATCH_WIDTH;
+
+  batch->size = 0;
+  batch->capacity = padded;
+  batch->data = (double *)malloc(AC_BATCH_DOUBLES * padded * sizeof(double));
+  batch->info = (int *)malloc(padded * sizeof(int));
+
+  double * p = batch->data;
+  for (unsigned int k = 0; k < 9; ++k, p += padded) batch->W[k] = p;
+  for (unsigned int k = 0; k < 3; ++k, p += padded) batch->q[k] = p;
+  batch->mu = p;
+  p += padded;
+  for (unsigned int k = 0; k < 3; ++k, p += padded) batch->rho[k] = p;
+  for (unsigned int k = 0; k < 3; ++k, p += padded) batch->R[k] = p;
+  batch->error = p;
+
+  AC_batch_reset(batch, 0, padded);
+  return batch;
+}
+
+void fc3d_AC_batch_free(FC3D_AC_Batch * batch)
+{
+  if (!batch) return;
+  free(batch->data);
+  free(batch->info);
+  free(batch);
+}
+
+void fc3d_AC_batch_clear(FC3D_AC_Batch * batch)
+{
+  AC_batch_reset(batch, 0, batch->size);
+  batch->size = 0;
+}
+
+void fc3d_AC_batch_set(FC3D_AC_Batch * batch, unsigned int contact,
+                       const double * W, const double * q, double mu,
+                       const double * R)
+{
+  assert(contact < batch->capacity);
+  assert(W[0] > 0);
+
+  for (unsigned int k = 0; k < 9; ++k)
+    batch->W[k][contact] = W[k];
+  for (unsigned int k = 0; k < 3; ++k)
+  {
+    batch->q[k][contact] = q[k];
+    batch->R[k][contact] = R[k];
+  }
+  batch->mu[contact] = mu;
+
+  /* same values as computerho */
+  double sw = W[1 + 1 * 3] + W[2 + 2 * 3];
+  double dw = sw * sw - 4.0 * (W[1 + 1 * 3] + W[2 + 2 * 3] -  W[2 + 1 * 3] + W[1 + 2 * 3]);
+  if (dw > 0.0) dw = sqrt(dw);
+  else dw = 0.0;
+  batch->rho[0][contact] = 1.0 / W[0 + 0 * 3];
+  batch->rho[1][contact] = 2.0 * (sw - dw) / ((sw + dw) * (sw + dw));
+  batch->rho[2][contact] = batch->rho[1][contact];
+
+  if (contact >= batch->size)
+    batch->size = contact + 1;
+}
+
+void fc3d_AC_batch_get(const FC3D_AC_Batch * batch, unsigned int contact,
+                       double * R)
+{
+  assert(contact < batch->size);
+  R[0] = batch->R[0][contact];
+  R[1] = batch->R[1][contact];
+  R[2] = batch->R[2][contact];
+}
+
+/* Alart-Curnier function of computeAlartCurnierSTD on a group of
+   lanes, and if J is not NULL, J = -(A W + B) as in
+   fc3d_onecontact_nonsmooth_Newton_solvers_solve_direct. The branches
+   of the scalar version are replaced by selections. */
+static inline void AC_batch_function(const vd * W, const vd * q, vd mu, const vd * rho,
+                                     const vd * R, vd * F, vd * J)
+{
+  const vd zero = SET1(0.0);
+  const vd one = SET1(1.0);
+
+  vd u0 = FMA(W[6], R[2], FMA(W[3], R[1], FMA(W[0], R[0], q[0])));
+  vd u1 = FMA(W[7], R[2], FMA(W[4], R[1], FMA(W[1], R[0], q[1])));
+  vd u2 = FMA(W[8], R[2], FMA(W[5], R[1], FMA(W[2], R[0], q[2])));
+
+  vd RhoN = rho[0];
+  vd RhoT = rho[1];
+  vd RVN = SUB(R[0], MUL(RhoN, u0));
+  vd RVT = SUB(R[1], MUL(RhoT, u1));
+  vd RVS = SUB(R[2], MUL(RhoT, u2));
+  vd RV = SQRT(FMA(RVT, RVT, MUL(RVS, RVS)));
+
+  /* normal part */
+  vmask normal = GT(RVN, zero);
+  vd Radius = SEL(normal, MUL(mu, RVN), zero);
+  F[0] = SEL(normal, MUL(RhoN, u0), R[0]);
+
+  /* tangential part: in the disk, out of the disk with a positive
+     radius, out of the disk with a null radius */
+  vmask disk = LE(RV, Radius);
+  vmask outside = ANDNOT(disk, GT(Radius, zero));
+
+  vd RV1 = DIV(one, SEL(outside, RV, one));
+  vd RVT1 = MUL(RVT, RV1);
+  vd RVS1 = MUL(RVS, RV1);
+
+  F[1] = SEL(disk, MUL(RhoT, u1), SEL(outside, SUB(R[1], MUL(Radius, RVT1)), R[1]));
+  F[2] = SEL(disk, MUL(RhoT, u2), SEL(outside, SUB(R[2], MUL(Radius, RVS1)), R[2]));
+
+  if (!J) return;
+
+  vd A[9], B[9];
+  A[0] = SEL(normal, RhoN, zero);
+  B[0] = SEL(normal, zero, one);
+  A[3] = A[6] = B[3] = B[6] = zero;
+
+  /* Gamma = (I - t t^T) / RV, t = (RVT, RVS) / RV */
+  vd GammaTT = MUL(SUB(one, MUL(RVT1, RVT1)), RV1);
+  vd GammaTS = MUL(MUL(RVT1, RVS1), SUB(zero, RV1));
+  vd GammaSS = MUL(SUB(one, MUL(RVS1, RVS1)), RV1);
+
+  vd RhoTRadius = MUL(RhoT, Radius);
+  vd muRhoN = MUL(mu, RhoN);
+
+  A[1] = SEL(outside, MUL(muRhoN, RVT1), zero);
+  A[2] = SEL(outside, MUL(muRhoN, RVS1), zero);
+  A[4] = SEL(disk, RhoT, SEL(outside, MUL(GammaTT, RhoTRadius), zero));
+  A[7] = SEL(outside, MUL(GammaTS, RhoTRadius), zero);
+  A[5] = A[7];
+  A[8] = SEL(disk, RhoT, SEL(outside, MUL(GammaSS, RhoTRadius), zero));
+
+  vd notDiskOne = SEL(disk, zero, one);
+  B[1] = SEL(outside, MUL(SUB(zero, mu), RVT1), zero);
+  B[2] = SEL(outside, MUL(SUB(zero, mu), RVS1), zero);
+  B[4] = SEL(outside, SUB(one, MUL(GammaTT, Radius)), notDiskOne);
+  B[7] = SEL(outside, SUB(zero, MUL(GammaTS, Radius)), zero);
+  B[5] = B[7];
+  B[8] = SEL(outside, SUB(one, MUL(GammaSS, Radius)), notDiskOne);
+
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int j = 0; j < 3; ++j)
+    {
+      vd AW = FMA(A[i + 6], W[2 + 3 * j], FMA(A[i + 3], W[1 + 3 * j], MUL(A[i], W[3 * j])));
+      J[i + 3 * j] = SUB(SUB(zero, AW), B[i + 3 * j]);
+    }
+  }
+}
+
+/* x = a^{-1} b with the formula of solv3x3, NAN if a is singular */
+static inline void AC_batch_solve3x3(const vd * a, vd * x, const vd * b)
+{
+  vd det = SUB(ADD(ADD(MUL(MUL(a[0], a[4]), a[8]), MUL(MUL(a[3], a[7]), a[2])), MUL(MUL(a[6], a[1]), a[5])),
+               ADD(ADD(MUL(MUL(a[0], a[7]), a[5]), MUL(MUL(a[3], a[1]), a[8])), MUL(MUL(a[6], a[4]), a[2])));
+  vmask regular = OR(GT(det, SET1(DBL_EPSILON)), LT(det, SET1(-DBL_EPSILON)));
+  vd idet = DIV(SET1(1.0), SEL(regular, det, SET1(1.0)));
+  vd nan = SET1(NAN);
+
+  x[0] = MUL(idet, SUB(ADD(ADD(MUL(MUL(a[3], a[7]), b[2]), MUL(MUL(a[6], a[5]), b[1])), MUL(MUL(a[4], a[8]), b[0])),
+                       ADD(ADD(MUL(MUL(a[3], a[8]), b[1]), MUL(MUL(a[6], a[4]), b[2])), MUL(MUL(a[7], a[5]), b[0]))));
+  x[1] = MUL(idet, SUB(ADD(ADD(MUL(MUL(a[0], a[8]), b[1]), MUL(MUL(a[6], a[1]), b[2])), MUL(MUL(a[7], a[2]), b[0])),
+                       ADD(ADD(MUL(MUL(a[0], a[7]), b[2]), MUL(MUL(a[6], a[2]), b[1])), MUL(MUL(a[1], a[8]), b[0]))));
+  x[2] = MUL(idet, SUB(ADD(ADD(MUL(MUL(a[0], a[4]), b[2]), MUL(MUL(a[3], a[2]), b[1])), MUL(MUL(a[1], a[5]), b[0])),
+                       ADD(ADD(MUL(MUL(a[0], a[5]), b[1]), MUL(MUL(a[3], a[1]), b[2])), MUL(MUL(a[4], a[2]), b[0]))));
+  x[0] = SEL(regular, x[0], nan);
+  x[1] = SEL(regular, x[1], nan);
+  x[2] = SEL(regular, x[2], nan);
+}
+
+static inline vd AC_batch_residual(const vd * F, const vd * R)
+{
+  vd nF = FMA(F[2], F[2], FMA(F[1], F[1], MUL(F[0], F[0])));
+  vd nR = FMA(R[2], R[2], FMA(R[1], R[1], MUL(R[0], R[0])));
+  return DIV(MUL(SET1(0.5), nF), ADD(SET1(1.0), SQRT(nR)));
+}
+
+void fc3d_AC_batch_computeFunction(const FC3D_AC_Batch * batch,
+                                   double * F, double * AWplusB)
+{
+  const unsigned int n = batch->capacity;
+  for (unsigned int c = 0; c < batch->size; c += FC3D_AC_BATCH_WIDTH)
+  {
+    vd W[9], q[3], rho[3], R[3], Fv[3], J[9];
+    for (int k = 0; k < 9; ++k) W[k] = LOAD(&batch->W[k][c]);
+    for (int k = 0; k < 3; ++k)
+    {
+      q[k] = LOAD(&batch->q[k][c]);
+      rho[k] = LOAD(&batch->rho[k][c]);
+      R[k] = LOAD(&batch->R[k][c]);
+    }
+    AC_batch_function(W, q, LOAD(&batch->mu[c]), rho, R, Fv, AWplusB ? J : NULL);
+    for (int k = 0; k < 3; ++k) STORE(&F[k * n + c], Fv[k]);
+    if (AWplusB)
+      for (int k = 0; k < 9; ++k) STORE(&AWplusB[k * n + c], J[k]);
+  }
+}
+
+int fc3d_AC_batch_solve(FC3D_AC_Batch * batch, int itermax, double tolerance)
+{
+  int failures = 0;
+  const vd tol = SET1(tolerance);
+
+  for (unsigned int c = 0; c < batch->size; c += FC3D_AC_BATCH_WIDTH)
+  {
+    vd W[9], q[3], rho[3], R[3], F[3], J[9], dR[3];
+    for (int k = 0; k < 9; ++k) W[k] = LOAD(&batch->W[k][c]);
+    for (int k = 0; k < 3; ++k)
+    {
+      q[k] = LOAD(&batch->q[k][c]);
+      rho[k] = LOAD(&batch->rho[k][c]);
+      R[k] = LOAD(&batch->R[k][c]);
+    }
+    vd mu = LOAD(&batch->mu[c]);
+    vd error = SET1(INFINITY);
+
+    /* lanes whose iterations go on */
+    vmask active = TRUE_MASK;
+    for (int iter = 0; iter < itermax && ANY(active); ++iter)
+    {
+      AC_batch_function(W, q, mu, rho, R, F, J);
+      AC_batch_solve3x3(J, dR, F);
+      for (int k = 0; k < 3; ++k)
+        R[k] = SEL(active, ADD(R[k], dR[k]), R[k]);
+
+      AC_batch_function(W, q, mu, rho, R, F, NULL);
+      error = SEL(active, AC_batch_residual(F, R), error);
+      active = ANDNOT(LT(error, tol), active);
+    }
+
+    for (int k = 0; k < 3; ++k) STORE(&batch->R[k][c], R[k]);
+    STORE(&batch->error[c], error);
+
+    vmask failed = ANDNOT(LT(error, tol), TRUE_MASK);
+    for (unsigned int i = 0; i < FC3D_AC_BATCH_WIDTH; ++i)
+    {
+      batch->info[c + i] = LANE(failed, i) ? 1 : 0;
+      if (c + i < batch->size) failures += batch->info[c + i];
+    }
+  }
+  DEBUG_PRINTF("fc3d_AC_batch_solve: %i contacts, %i failures\n", batch->size, failures);
+  return failures;
+}
@@ -0,0 +1,132 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef FC3D_ALARTCURNIER_BATCH_H
+#define FC3D_ALARTCURNIER_BATCH_H
+
+/*!\file fc3d_AlartCurnier_batch.h
+  \brief Alart-Curnier local Newton solver for a batch of independent
+  contacts.
+
+  The local problems are stored as a structure of arrays: each
+  coefficient of the 3x3 local matrices, of the local vectors q and of
+  the reactions is stored in its own array, indexed by contact. The
+  function of computeAlartCurnierSTD, its generalized Jacobian and the
+  Newton update of fc3d_onecontact_nonsmooth_Newton_solvers_solve_direct
+  are then evaluated on FC3D_AC_BATCH_WIDTH contacts at once, with AVX-512
+  or AVX2 intrinsics when the library is compiled for these
+  instruction sets, and with scalar code otherwise.
+
+  The contacts of a batch must be independent, as in a Jacobi sweep or
+  in one color of the colored NSGS.
+*/
+
+#include <stddef.h>
+
+#if defined(__AVX512F__)
+#define FC3D_AC_BATCH_WIDTH 8
+#elif defined(__AVX2__) && defined(__FMA__)
+#define FC3D_AC_BATCH_WIDTH 4
+#else
+#define FC3D_AC_BATCH_WIDTH 1
+#endif
+
+/** Local problems of a batch of contacts, as a structure of arrays */
+typedef struct
+{
+  unsigned int size;     /**< number of contacts in the batch */
+  unsigned int capacity; /**< allocated number of contacts, multiple of FC3D_AC_BATCH_WIDTH */
+  double * W[9];         /**< W[k][c] is the coefficient k (column-major) of the local matrix of contact c */
+  double * q[3];         /**< q[k][c] is the component k of the local vector q of contact c */
+  double * mu;           /**< friction coefficients */
+  double * rho[3];       /**< rho of the Alart-Curnier function (see computerho) */
+  double * R[3];         /**< R[k][c] is the component k of the reaction of contact c */
+  double * error;        /**< residual of the last Newton iteration of each contact */
+  int * info;            /**< 0 if the Newton iterations of a contact have converged, 1 otherwise */
+  double * data;         /**< storage of all the arrays above except info */
+} FC3D_AC_Batch;
+
+#if defined(__cplusplus) && !defined(BUILD_AS_CPP)
+extern "C"
+{
+#endif
+
+  /** Allocate a batch
+      \param capacity maximum number of contacts
+      \return the batch, with size 0
+  */
+  FC3D_AC_Batch * fc3d_AC_batch_new(unsigned int capacity);
+
+  /** Free a batch
+      \param batch the batch to free
+  */
+  void fc3d_AC_batch_free(FC3D_AC_Batch * batch);
+
+  /** Set the local problem of a contact of the batch. The size of the
+      batch is increased if needed, and rho is computed as in
+      computerho.
+      \param batch the batch
+      \param contact index of the contact in the batch (< capacity)
+      \param W the 3x3 local matrix, column-major
+      \param q the local vector
+      \param mu the friction coefficient
+      \param R the initial reaction
+  */
+  void fc3d_AC_batch_set(FC3D_AC_Batch * batch, unsigned int contact,
+                         const double * W, const double * q, double mu,
+                         const double * R);
+
+  /** Get the reaction of a contact of the batch
+      \param batch the batch
+      \param contact index of the contact in the batch
+      \param[out] R the reaction
+  */
+  void fc3d_AC_batch_get(const FC3D_AC_Batch * batch, unsigned int contact,
+                         double * R);
+
+  /** Empty the batch, the capacity is kept
+      \param batch the batch
+  */
+  void fc3d_AC_batch_clear(FC3D_AC_Batch * batch);
+
+  /** Alart-Curnier function of computeAlartCurnierSTD and -(A W + B),
+      the matrix of the Newton system, at the current reactions of the
+      batch
+      \param batch the batch
+      \param[out] F F[k * capacity + c] is the component k of the function of contact c
+      \param[out] AWplusB if not NULL, AWplusB[k * capacity + c] is the
+      coefficient k (column-major) of -(A W + B) for contact c
+  */
+  void fc3d_AC_batch_computeFunction(const FC3D_AC_Batch * batch,
+                                     double * F, double * AWplusB);
+
+  /** Newton iterations of
+      fc3d_onecontact_nonsmooth_Newton_solvers_solve_direct on all the
+      contacts of the batch. The iterations of a contact stop as soon
+      as its residual is below the tolerance.
+      \param batch the batch, the reactions are updated
+      \param itermax maximum number of Newton iterations
+      \param tolerance tolerance on the residual
+      \return the number of contacts whose iterations have not converged
+  */
+  int fc3d_AC_batch_solve(FC3D_AC_Batch * batch, int itermax, double tolerance);
+
+#if defined(__cplusplus) && !defined(BUILD_AS_CPP)
+}
+#endif
+
+#endif
@@ -92,8 +92,8 @@ void fc3d_DeSaxceFixedPoint(FrictionContactProblem* problem, double *reaction, d
         reaction[pos] -= rho * (velocitytmp[pos] + mu[contact] * normUT);
         reaction[pos + 1] -= rho * velocitytmp[pos + 1];
         reaction[pos + 2] -= rho * velocitytmp[pos + 2];
-        projectionOnCone(&reaction[pos], mu[contact]);
       }
+      projectionOnConeBatch(nc, mu, reaction);
 
       /* **** Criterium convergence **** */
       fc3d_compute_error(problem, reaction , velocity, tolerance, options, &error);
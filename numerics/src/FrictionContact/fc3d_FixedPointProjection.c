@@ -140,9 +140,8 @@ void fc3d_fixedPointProjection(FrictionContactProblem* problem, double *reaction
           reaction[pos] -= rho_k * (velocity_k[pos] + mu[contact] * normUT);
           reaction[pos + 1] -= rho_k * velocity_k[pos + 1];
           reaction[pos + 2] -= rho_k * velocity_k[pos + 2];
-
-          projectionOnCone(&reaction[pos], mu[contact]);
         }
+        projectionOnConeBatch(nc, mu, reaction);
 
 
         /* velocity <- q + M * reaction  */
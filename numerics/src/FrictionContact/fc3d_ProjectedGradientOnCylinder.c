@@ -50,8 +50,9 @@ void fc3d_ProjectedGradientOnCylinder(FrictionContactProblem* problem, double *r
   int j, iter = 0; /* Current iteration number */
   double error = 1.; /* Current error */
   int hasNotConverged = 1;
+#ifdef VERBOSE_DEBUG
   int contact; /* Number of the current row of blocks in M */
-  int nLocal = 3;
+#endif
   dparam[0] = dparam[2]; // set the tolerance for the local solver
   double * velocitytmp = (double *)malloc(n * sizeof(double));
 
@@ -92,9 +93,7 @@ void fc3d_ProjectedGradientOnCylinder(FrictionContactProblem* problem, double *r
       prodNumericsMatrix(n, n, alpha, M, reaction, beta, velocitytmp);
       // projection for each contact
       cblas_daxpy(n, -1.0, velocitytmp, 1, reaction , 1);
-      for (contact = 0 ; contact < nc ; ++contact)
-        projectionOnCylinder(&reaction[ contact * nLocal],
-                             options->dWork[contact]);
+      projectionOnCylinderBatch(nc, options->dWork, reaction);
 
 #ifdef VERBOSE_DEBUG
 
@@ -140,9 +139,7 @@ void fc3d_ProjectedGradientOnCylinder(FrictionContactProblem* problem, double *r
 
     cblas_daxpy(n, rho, velocitytmp, 1, reaction, 1);
 
-    for (contact = 0 ; contact < nc ; ++contact)
-      projectionOnCylinder(&reaction[contact * nLocal],
-                           options->dWork[contact]);
+    projectionOnCylinderBatch(nc, options->dWork, reaction);
     cblas_dcopy(n , q , 1 , velocitytmp, 1);
     prodNumericsMatrix(n, n, 1.0, M, reaction, 1.0, velocitytmp);
 
@@ -188,9 +185,7 @@ void fc3d_ProjectedGradientOnCylinder(FrictionContactProblem* problem, double *r
           printf("\n");
         }
 #endif
-        for (contact = 0 ; contact < nc ; ++contact)
-          projectionOnCylinder(&reaction[contact * nLocal],
-                               options->dWork[contact]);
+        projectionOnCylinderBatch(nc, options->dWork, reaction);
         /*          printf("options->dWork[%i] = %le\n",contact, options->dWork[contact]  );} */
 #ifdef VERBOSE_DEBUG
         printf("LS iteration %i step 1 after projection\n", j);
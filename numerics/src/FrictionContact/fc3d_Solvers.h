@@ -97,6 +97,17 @@ extern "C"
            2: in each iteration
       [in] iparam[6] : seed for the random genrator in shuffling  contacts
       [out]iparam[7] = iter number of performed iterations
+      [in] iparam[8] : sweep mode
+           0 : sequential sweep (default)
+           1 : graph-colored parallel sweep (NM_SPARSE_BLOCK storage only,
+               see fc3d_nsgs_parallel_iterations). iparam[5] is ignored.
+           2 : graph-colored parallel sweep, with the contacts of a color
+               solved by the batched Alart-Curnier solver
+               (fc3d_AC_batch_solve) when the local solver is
+               SICONOS_FRICTION_3D_ONECONTACT_NSN_AC with the STD
+               function, as 1 otherwise.
+      [in] iparam[9] : number of threads for the parallel sweep
+           (0: OpenMP default)
 
 
 
@@ -113,12 +124,69 @@ extern "C"
 
   void fc3d_nsgs_computeqLocal(FrictionContactProblem * problem, FrictionContactProblem * localproblem, double * reaction, int contact);
 
+  /** Update function of the local problem (see UpdatePtr) of fc3d_nsgs
+      \param contact the contact number
+      \param problem the global problem
+      \param localproblem the local problem to fill
+      \param reaction the global reaction vector
+      \param options the local solver options (unused)
+  */
+  void fc3d_nsgs_update(int contact, FrictionContactProblem* problem, FrictionContactProblem* localproblem, double * reaction, SolverOptions* options);
+
 
   /** set the default solver parameters and perform memory allocation for NSGS
       \param options the pointer to the array of options to set
   */
   int fc3d_nsgs_setDefaultSolverOptions(SolverOptions* options);
 
+  /** Greedy coloring of the contacts such that two contacts coupled
+      by a non null off-diagonal block of M never share a color.
+      \param M the sparse block matrix of the problem
+      \param[out] color the color of each contact (size M->blocknumber0)
+      \return the number of colors
+  */
+  unsigned int fc3d_nsgs_compute_coloring(SparseBlockStructuredMatrix* M, unsigned int* color);
+
+  /** Check whether the graph-colored parallel sweep can be used
+      \param problem the friction-contact 3D problem
+      \param localsolver_options the options of the local solver
+      \return 1 if M is stored as NM_SPARSE_BLOCK and the local solver
+      is reentrant, 0 otherwise
+  */
+  int fc3d_nsgs_parallel_is_supported(FrictionContactProblem* problem, SolverOptions* localsolver_options);
+
+  /** Check whether the graph-colored parallel sweep solves the
+      contacts of a color with the batched Alart-Curnier solver
+      \param options the NSGS solver options
+      \return 1 if iparam[8] is 2 and the local solver is
+      SICONOS_FRICTION_3D_ONECONTACT_NSN_AC with the STD function
+      (local iparam[10] = 0), 0 otherwise
+  */
+  int fc3d_nsgs_parallel_is_batched(SolverOptions* options);
+
+  /** NSGS iterations with a graph-colored sweep: the contacts of a
+      given color are not coupled and are solved concurrently (OpenMP),
+      each thread with its own local problem and local solver
+      parameters, or with its own batch of local problems (see
+      fc3d_nsgs_parallel_is_batched). The result is independent of the
+      number of threads.
+      \param problem the friction-contact 3D problem to solve
+      \param reaction global vector (n), in-out parameter
+      \param velocity global vector (n), in-out parameter
+      \param info return 0 if the solution is found
+      \param options the NSGS solver options
+      \param local_solver the (initialized) local solver
+      \param update_localproblem the local problem update function
+      \param computeError the error function
+      \param[out] iter number of performed iterations
+      \param[out] error reached error
+  */
+  void fc3d_nsgs_parallel_iterations(FrictionContactProblem* problem, double *reaction, double *velocity,
+                                     int* info, SolverOptions* options,
+                                     SolverPtr local_solver, UpdatePtr update_localproblem,
+                                     ComputeErrorPtr computeError,
+                                     int * iter, double * error);
+
 
 
 
@@ -595,6 +595,21 @@ void fc3d_nonsmooth_Newton_solvers_solve(fc3d_nonsmooth_Newton_solvers* equation
           return;
         }
     }
+
+    /* the linear solver data of the previous calls holds the symbolic
+     * analysis of AWpB, valid as long as the contact set is the same */
+    NumericsSparseLinearSolverParams* kept =
+      (NumericsSparseLinearSolverParams*) options->solverParameters;
+    options->solverParameters = NULL;
+    if (kept && kept->solver == NM_linearSolverParams(AWpB)->solver)
+    {
+      freeNumericsSparseLinearSolverParams(AWpB->matrix2->linearSolverParams);
+      AWpB->matrix2->linearSolverParams = kept;
+    }
+    else if (kept)
+    {
+      freeNumericsSparseLinearSolverParams(kept);
+    }
   }
 
   // compute rho here
@@ -753,6 +768,22 @@ void fc3d_nonsmooth_Newton_solvers_solve(fc3d_nonsmooth_Newton_solvers* equation
 
   options->iparam[1] = iter;
 
+  if (problem->M->storageType != NM_DENSE)
+  {
+    NumericsSparseLinearSolverParams* p = NM_linearSolverParams(AWpB);
+    if (verbose > 0)
+    {
+      printf("------------------------ FC3D - NSN - %u symbolic analyses, %u reused, %g s saved\n",
+             p->nbAnalysis, p->nbAnalysisReused, NM_sparse_analysis_time_saved(p));
+    }
+    if (!options->dWork)
+    {
+      /* kept for the next call, freed with the solver options */
+      options->solverParameters = p;
+      AWpB->matrix2->linearSolverParams = NULL;
+    }
+  }
+
   if (!options->dWork)
   {
     assert(buffer);
@@ -21,6 +21,7 @@
 #include "fc3d_projection.h"
 #include "fc3d_unitary_enumerative.h"
 #include "fc3d_compute_error.h"
+#include "fc3d_nsgs_plan.h"
 #include "NCP_Solvers.h"
 #include "SiconosBlas.h"
 #include <stdio.h>
@@ -366,6 +367,22 @@ void fc3d_nsgs(FrictionContactProblem* problem, double *reaction, double *veloci
                              problem , localproblem,
                              options, localsolver_options);
 
+  /* For the standard local problem update, the off-diagonal blocks of
+     M are rearranged once for all the iterations */
+  FC3D_NSGS_Plan * plan = NULL;
+  void * localsolver_data = localsolver_options->solverData;
+  if (update_localproblem == &fc3d_nsgs_update ||
+      update_localproblem == &fc3d_projection_update ||
+      update_localproblem == &fc3d_onecontact_nonsmooth_Newton_AC_update)
+  {
+    plan = fc3d_nsgs_plan_new(problem);
+    if (plan)
+    {
+      localsolver_options->solverData = plan;
+      update_localproblem = &fc3d_nsgs_plan_update;
+    }
+  }
+
   /*****  NSGS Iterations *****/
   int iter = 0; /* Current iteration number */
   double error = 1.; /* Current error */
@@ -392,8 +409,23 @@ void fc3d_nsgs(FrictionContactProblem* problem, double *reaction, double *veloci
     /* printf("\n"); */
   }
 
+  int parallel = 0;
+  if (iparam[8] == 1 || iparam[8] == 2) /* graph-colored parallel sweep */
+  {
+    parallel = fc3d_nsgs_parallel_is_supported(problem, localsolver_options);
+    if (!parallel && verbose > 0)
+      printf("----------------------------------- FC3D - NSGS - parallel sweep not available for this storage or local solver (%s), sequential sweep is used\n",
+             idToName(localsolver_options->solverId));
+  }
+
   /*  dparam[0]= dparam[2]; // set the tolerance for the local solver */
-  if (iparam[1] == 1 || iparam[1] == 2)
+  if (parallel)
+  {
+    fc3d_nsgs_parallel_iterations(problem, reaction, velocity, info, options,
+                                  local_solver, update_localproblem, computeError,
+                                  &iter, &error);
+  }
+  else if (iparam[1] == 1 || iparam[1] == 2)
   {
     double reactionold[3];
     while ((iter < itermax) && (hasNotConverged > 0))
@@ -776,6 +808,11 @@ void fc3d_nsgs(FrictionContactProblem* problem, double *reaction, double *veloci
   iparam[7] = iter;
 
   /***** Free memory *****/
+  if (plan)
+  {
+    localsolver_options->solverData = localsolver_data;
+    fc3d_nsgs_plan_free(plan);
+  }
   (*freeSolver)(problem,localproblem,localsolver_options);
   if (problem->M->storageType == NM_DENSE && localproblem->M->matrix0)
   {
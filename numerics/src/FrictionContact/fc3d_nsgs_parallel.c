@@ -0,0 +1,394 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "fc3d_Solvers.h"
+#include "fc3d_compute_error.h"
+#include "fc3d_AlartCurnier_batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* #define DEBUG_MESSAGES */
+/* #define DEBUG_STDOUT */
+#include "debug.h"
+
+/* Graph-colored NSGS.
+
+   Two contacts i and j are coupled if the block (i,j) or (j,i) of M is
+   non null. A greedy coloring of this coupling graph gives classes of
+   contacts that do not see each other: within one color, each local
+   problem only reads reactions of contacts of other colors, that are
+   not modified during the sweep of the current color. The contacts of
+   a color may then be solved concurrently, and the result does not
+   depend on the scheduling nor on the number of threads.
+
+   With iparam[8] == 2 and the Alart-Curnier local solver, each thread
+   gathers its contacts of the current color in a FC3D_AC_Batch and
+   solves them at once with fc3d_AC_batch_solve. The lanes of a batch
+   are independent, and the result does not depend on the number of
+   threads either.
+*/
+
+unsigned int fc3d_nsgs_compute_coloring(SparseBlockStructuredMatrix* M, unsigned int* color)
+{
+  assert(M);
+  assert(color);
+
+  unsigned int nc = M->blocknumber0;
+  if (nc == 0) return 0;
+
+  /* Symmetric adjacency of the coupling graph in compressed row form */
+  size_t * degree = (size_t *)calloc(nc + 1, sizeof(size_t));
+  size_t nbrows = M->filled1 > 0 ? M->filled1 - 1 : 0;
+
+  for (size_t row = 0; row < nbrows; ++row)
+  {
+    for (size_t blockNum = M->index1_data[row];
+         blockNum < M->index1_data[row + 1]; ++blockNum)
+    {
+      size_t col = M->index2_data[blockNum];
+      if (col != row)
+      {
+        degree[row + 1]++;
+        degree[col + 1]++;
+      }
+    }
+  }
+  for (unsigned int i = 0; i < nc; ++i)
+  {
+    degree[i + 1] += degree[i];
+  }
+
+  size_t * adjacency = (size_t *)malloc((degree[nc] + 1) * sizeof(size_t));
+  size_t * fill = (size_t *)malloc(nc * sizeof(size_t));
+  memcpy(fill, degree, nc * sizeof(size_t));
+
+  for (size_t row = 0; row < nbrows; ++row)
+  {
+    for (size_t blockNum = M->index1_data[row];
+         blockNum < M->index1_data[row + 1]; ++blockNum)
+    {
+      size_t col = M->index2_data[blockNum];
+      if (col != row)
+      {
+        adjacency[fill[row]++] = col;
+        adjacency[fill[col]++] = row;
+      }
+    }
+  }
+
+  /* Greedy coloring in the natural contact order: each contact takes
+     the smallest color not already used by one of its neighbours */
+  unsigned int * forbidden = (unsigned int *)malloc((nc + 1) * sizeof(unsigned int));
+  for (unsigned int i = 0; i <= nc; ++i) forbidden[i] = nc;
+
+  unsigned int numberOfColors = 0;
+  for (unsigned int i = 0; i < nc; ++i) color[i] = nc;
+
+  for (unsigned int i = 0; i < nc; ++i)
+  {
+    for (size_t k = degree[i]; k < degree[i + 1]; ++k)
+    {
+      unsigned int c = color[adjacency[k]];
+      if (c < nc) forbidden[c] = i;
+    }
+    unsigned int c = 0;
+    while (forbidden[c] == i) ++c;
+    color[i] = c;
+    if (c + 1 > numberOfColors) numberOfColors = c + 1;
+  }
+
+  free(forbidden);
+  free(fill);
+  free(adjacency);
+  free(degree);
+
+  DEBUG_PRINTF("fc3d_nsgs_compute_coloring: %i contacts, %i colors\n", nc, numberOfColors);
+  return numberOfColors;
+}
+
+int fc3d_nsgs_parallel_is_supported(FrictionContactProblem* problem, SolverOptions* localsolver_options)
+{
+  if (problem->M->storageType != NM_SPARSE_BLOCK)
+    return 0;
+
+  switch (localsolver_options->solverId)
+  {
+  case SICONOS_FRICTION_3D_ONECONTACT_NSN_AC:
+  case SICONOS_FRICTION_3D_ONECONTACT_NSN_AC_GP:
+  case SICONOS_FRICTION_3D_ONECONTACT_ProjectionOnCone:
+  case SICONOS_FRICTION_3D_ONECONTACT_ProjectionOnConeWithLocalIteration:
+  case SICONOS_FRICTION_3D_ONECONTACT_ProjectionOnConeWithDiagonalization:
+  case SICONOS_FRICTION_3D_ONECONTACT_QUARTIC:
+  case SICONOS_FRICTION_3D_ONECONTACT_QUARTIC_NU:
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+int fc3d_nsgs_parallel_is_batched(SolverOptions* options)
+{
+  SolverOptions * localsolver_options = options->internalSolvers;
+  return options->iparam[8] == 2
+    && localsolver_options->solverId == SICONOS_FRICTION_3D_ONECONTACT_NSN_AC
+    && localsolver_options->iparam[10] == 0;
+}
+
+/* over-relaxation of the new reaction r of a contact, and squared
+   increment from its former value */
+static double relax(double * r, const double * reactionold, int withRelaxation, double omega)
+{
+  if (withRelaxation)
+  {
+    r[0] = omega * r[0] + (1.0 - omega) * reactionold[0];
+    r[1] = omega * r[1] + (1.0 - omega) * reactionold[1];
+    r[2] = omega * r[2] + (1.0 - omega) * reactionold[2];
+  }
+  return (r[0] - reactionold[0]) * (r[0] - reactionold[0]) +
+         (r[1] - reactionold[1]) * (r[1] - reactionold[1]) +
+         (r[2] - reactionold[2]) * (r[2] - reactionold[2]);
+}
+
+void fc3d_nsgs_parallel_iterations(FrictionContactProblem* problem, double *reaction, double *velocity,
+                                   int* info, SolverOptions* options,
+                                   SolverPtr local_solver, UpdatePtr update_localproblem,
+                                   ComputeErrorPtr computeError,
+                                   int * iter_out, double * error_out)
+{
+  int* iparam = options->iparam;
+  double* dparam = options->dparam;
+  unsigned int nc = problem->numberOfContacts;
+  int itermax = iparam[0];
+  double tolerance = dparam[0];
+  int withRelaxation = iparam[4];
+  double omega = dparam[8];
+  SolverOptions * localsolver_options = options->internalSolvers;
+
+  assert(problem->M->storageType == NM_SPARSE_BLOCK);
+
+  /* Contacts sorted by color */
+  unsigned int * color = (unsigned int *)malloc(nc * sizeof(unsigned int));
+  unsigned int numberOfColors = fc3d_nsgs_compute_coloring(problem->M->matrix1, color);
+
+  unsigned int * colorStart = (unsigned int *)calloc(numberOfColors + 1, sizeof(unsigned int));
+  unsigned int * contactsByColor = (unsigned int *)malloc(nc * sizeof(unsigned int));
+  for (unsigned int i = 0; i < nc; ++i) colorStart[color[i] + 1]++;
+  for (unsigned int c = 0; c < numberOfColors; ++c) colorStart[c + 1] += colorStart[c];
+  {
+    unsigned int * pos = (unsigned int *)malloc((numberOfColors + 1) * sizeof(unsigned int));
+    memcpy(pos, colorStart, (numberOfColors + 1) * sizeof(unsigned int));
+    for (unsigned int i = 0; i < nc; ++i) contactsByColor[pos[color[i]]++] = i;
+    free(pos);
+  }
+
+  int nthreads = 1;
+#ifdef _OPENMP
+  nthreads = (iparam[9] > 0) ? iparam[9] : omp_get_max_threads();
+#endif
+
+  if (verbose > 0)
+    printf("----------------------------------- FC3D - NSGS - parallel sweep on %i colors with %i thread(s)%s\n",
+           numberOfColors, nthreads,
+           fc3d_nsgs_parallel_is_batched(options) ? ", batched Alart-Curnier local solver" : "");
+
+  /* Per-thread local problems and local solver options. The work
+     arrays of the local solver (dWork, iWork) are indexed by contact
+     and may be shared. */
+  FrictionContactProblem * localproblems =
+    (FrictionContactProblem *)malloc(nthreads * sizeof(FrictionContactProblem));
+  SolverOptions * localoptions = (SolverOptions *)malloc(nthreads * sizeof(SolverOptions));
+  for (int t = 0; t < nthreads; ++t)
+  {
+    localproblems[t].numberOfContacts = 1;
+    localproblems[t].dimension = 3;
+    localproblems[t].q = (double*)malloc(3 * sizeof(double));
+    localproblems[t].mu = (double*)malloc(sizeof(double));
+    localproblems[t].M = createNumericsMatrixFromData(NM_DENSE, 3, 3, NULL);
+
+    localoptions[t] = *localsolver_options;
+    localoptions[t].iparam = (int *)malloc(localsolver_options->iSize * sizeof(int));
+    localoptions[t].dparam = (double *)malloc(localsolver_options->dSize * sizeof(double));
+    memcpy(localoptions[t].iparam, localsolver_options->iparam, localsolver_options->iSize * sizeof(int));
+    memcpy(localoptions[t].dparam, localsolver_options->dparam, localsolver_options->dSize * sizeof(double));
+  }
+
+  /* batches of the Alart-Curnier local problems, large enough for
+     the largest color */
+  FC3D_AC_Batch ** batches = NULL;
+  if (fc3d_nsgs_parallel_is_batched(options))
+  {
+    unsigned int colorSize = 0;
+    for (unsigned int c = 0; c < numberOfColors; ++c)
+      if (colorStart[c + 1] - colorStart[c] > colorSize)
+        colorSize = colorStart[c + 1] - colorStart[c];
+    batches = (FC3D_AC_Batch **)malloc(nthreads * sizeof(FC3D_AC_Batch *));
+    for (int t = 0; t < nthreads; ++t)
+      batches[t] = fc3d_AC_batch_new(colorSize);
+  }
+
+  /* squared increment of each contact, summed in the contact order to
+     get a reproducible incremental error */
+  double * increment = (double *)malloc(nc * sizeof(double));
+
+  int iter = 0;
+  double error = 1.;
+  int hasNotConverged = 1;
+
+  while ((iter < itermax) && (hasNotConverged > 0))
+  {
+    ++iter;
+    for (unsigned int c = 0; c < numberOfColors; ++c)
+    {
+      int start = (int)colorStart[c];
+      int end = (int)colorStart[c + 1];
+      if (batches)
+      {
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads)
+#endif
+        {
+          int t = 0, nt = 1;
+#ifdef _OPENMP
+          t = omp_get_thread_num();
+          nt = omp_get_num_threads();
+#endif
+          /* a contiguous part of the color for each thread */
+          int first = start + (end - start) * t / nt;
+          int last = start + (end - start) * (t + 1) / nt;
+          FC3D_AC_Batch * batch = batches[t];
+          fc3d_AC_batch_clear(batch);
+          for (int k = first; k < last; ++k)
+          {
+            unsigned int contact = contactsByColor[k];
+            (*update_localproblem)(contact, problem, &localproblems[t], reaction, &localoptions[t]);
+            fc3d_AC_batch_set(batch, k - first, localproblems[t].M->matrix0,
+                              localproblems[t].q, localproblems[t].mu[0], &reaction[3 * contact]);
+          }
+          fc3d_AC_batch_solve(batch, localsolver_options->iparam[0], localsolver_options->dparam[0]);
+          for (int k = first; k < last; ++k)
+          {
+            unsigned int contact = contactsByColor[k];
+            double * r = &reaction[3 * contact];
+            double reactionold[3] = {r[0], r[1], r[2]};
+            fc3d_AC_batch_get(batch, k - first, r);
+            increment[contact] = relax(r, reactionold, withRelaxation, omega);
+          }
+        }
+      }
+      else
+      {
+        int i;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+#endif
+        for (i = start; i < end; ++i)
+        {
+          int t = 0;
+#ifdef _OPENMP
+          t = omp_get_thread_num();
+#endif
+          unsigned int contact = contactsByColor[i];
+          double * r = &reaction[3 * contact];
+          double reactionold[3] = {r[0], r[1], r[2]};
+
+          (*update_localproblem)(contact, problem, &localproblems[t], reaction, &localoptions[t]);
+          localoptions[t].iparam[4] = contact;
+          (*local_solver)(&localproblems[t], r, &localoptions[t]);
+
+          increment[contact] = relax(r, reactionold, withRelaxation, omega);
+        }
+      }
+    }
+
+    /* **** Criterium convergence **** */
+    if (iparam[1] == 1 || iparam[1] == 2)
+    {
+      error = 0.0;
+      for (unsigned int contact = 0; contact < nc; ++contact)
+        error += increment[contact];
+      error = sqrt(error);
+    }
+    else
+    {
+      (*computeError)(problem, reaction, velocity, tolerance, options, &error);
+    }
+
+    if (error < tolerance)
+    {
+      hasNotConverged = 0;
+      if (verbose > 0)
+        printf("----------------------------------- FC3D - NSGS - Iteration %i Residual = %14.7e < %7.3e\n", iter, error, options->dparam[0]);
+    }
+    else
+    {
+      if (verbose > 0)
+        printf("----------------------------------- FC3D - NSGS - Iteration %i Residual = %14.7e > %7.3e\n", iter, error, options->dparam[0]);
+    }
+    *info = hasNotConverged;
+
+    if (options->callback)
+    {
+      options->callback->collectStatsIteration(options->callback->env, 3 * nc,
+                                               reaction, velocity,
+                                               error, NULL);
+    }
+  }
+
+  if (iparam[1] == 1) /* Full criterium */
+  {
+    double absolute_error;
+    (*computeError)(problem, reaction, velocity, tolerance, options, &absolute_error);
+    if (verbose > 0 && absolute_error > error)
+    {
+      printf("----------------------------------- FC3D - NSGS - Warning absolute Residual = %14.7e is larger than incremental error = %14.7e\n", absolute_error, error);
+    }
+  }
+
+  *iter_out = iter;
+  *error_out = error;
+
+  /***** Free memory *****/
+  for (int t = 0; t < nthreads; ++t)
+  {
+    free(localoptions[t].iparam);
+    free(localoptions[t].dparam);
+    localproblems[t].M->matrix0 = NULL;
+    freeNumericsMatrix(localproblems[t].M);
+    free(localproblems[t].M);
+    free(localproblems[t].q);
+    free(localproblems[t].mu);
+  }
+  if (batches)
+  {
+    for (int t = 0; t < nthreads; ++t)
+      fc3d_AC_batch_free(batches[t]);
+    free(batches);
+  }
+  free(localoptions);
+  free(localproblems);
+  free(increment);
+  free(contactsByColor);
+  free(colorStart);
+  free(color);
+}
@@ -0,0 +1,159 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "fc3d_nsgs_plan.h"
+#include "NumericsMatrix.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+/* #define DEBUG_MESSAGES */
+/* #define DEBUG_STDOUT */
+#include "debug.h"
+
+FC3D_NSGS_Plan * fc3d_nsgs_plan_new(FrictionContactProblem * problem)
+{
+  assert(problem);
+  NumericsMatrix * M = problem->M;
+  if (!M || M->storageType != NM_SPARSE_BLOCK || !M->matrix1)
+    return NULL;
+
+  SparseBlockStructuredMatrix * A = M->matrix1;
+  unsigned int nc = (unsigned int)problem->numberOfContacts;
+  if (A->blocknumber0 != nc || A->blocknumber1 != nc)
+    return NULL;
+  for (unsigned int i = 0; i < nc; ++i)
+  {
+    if (A->blocksize0[i] != 3 * (i + 1) || A->blocksize1[i] != 3 * (i + 1))
+      return NULL;
+  }
+
+  size_t nbrows = A->filled1 > 0 ? A->filled1 - 1 : 0;
+
+  FC3D_NSGS_Plan * plan = (FC3D_NSGS_Plan *)malloc(sizeof(FC3D_NSGS_Plan));
+  plan->nc = nc;
+  plan->rowStart = (size_t *)calloc(nc + 1, sizeof(size_t));
+  plan->diagonal = (double **)calloc(nc, sizeof(double *));
+
+  for (size_t row = 0; row < nbrows; ++row)
+  {
+    for (size_t blockNum = A->index1_data[row];
+         blockNum < A->index1_data[row + 1]; ++blockNum)
+    {
+      if (A->index2_data[blockNum] == row)
+        plan->diagonal[row] = A->block[blockNum];
+      else
+        plan->rowStart[row + 1]++;
+    }
+  }
+  for (unsigned int i = 0; i < nc; ++i)
+    plan->rowStart[i + 1] += plan->rowStart[i];
+
+  size_t nbOffDiagonal = plan->rowStart[nc];
+  plan->column = (unsigned int *)malloc((nbOffDiagonal + 1) * sizeof(unsigned int));
+  /* one extra double so that the 4-wide loads of the last column of
+     the last block stay in bounds */
+  plan->blocks = (double *)malloc((9 * nbOffDiagonal + 1) * sizeof(double));
+  plan->blocks[9 * nbOffDiagonal] = 0.0;
+
+  for (size_t row = 0; row < nbrows; ++row)
+  {
+    size_t k = plan->rowStart[row];
+    for (size_t blockNum = A->index1_data[row];
+         blockNum < A->index1_data[row + 1]; ++blockNum)
+    {
+      size_t col = A->index2_data[blockNum];
+      if (col != row)
+      {
+        plan->column[k] = (unsigned int)col;
+        memcpy(&plan->blocks[9 * k], A->block[blockNum], 9 * sizeof(double));
+        ++k;
+      }
+    }
+  }
+
+  DEBUG_PRINTF("fc3d_nsgs_plan_new: %i contacts, %zu off-diagonal blocks\n", nc, nbOffDiagonal);
+  return plan;
+}
+
+void fc3d_nsgs_plan_free(FC3D_NSGS_Plan * plan)
+{
+  if (!plan) return;
+  free(plan->rowStart);
+  free(plan->column);
+  free(plan->blocks);
+  free(plan->diagonal);
+  free(plan);
+}
+
+void fc3d_nsgs_plan_computeqLocal(const FC3D_NSGS_Plan * plan, const double * q,
+                                  const double * reaction, unsigned int contact,
+                                  double * qLocal)
+{
+  const size_t start = plan->rowStart[contact];
+  const size_t end = plan->rowStart[contact + 1];
+  const double * b = &plan->blocks[9 * start];
+  const unsigned int * column = &plan->column[start];
+
+#if defined(__AVX2__) && defined(__FMA__)
+  /* Each column of a block is loaded with its 4th neighbour, the last
+     lane of the accumulator is meaningless. */
+  __m256d acc = _mm256_setr_pd(q[3 * contact], q[3 * contact + 1], q[3 * contact + 2], 0.0);
+  for (size_t k = start; k < end; ++k, b += 9, ++column)
+  {
+    const double * x = &reaction[3 * *column];
+    acc = _mm256_fmadd_pd(_mm256_loadu_pd(b), _mm256_broadcast_sd(x), acc);
+    acc = _mm256_fmadd_pd(_mm256_loadu_pd(b + 3), _mm256_broadcast_sd(x + 1), acc);
+    acc = _mm256_fmadd_pd(_mm256_loadu_pd(b + 6), _mm256_broadcast_sd(x + 2), acc);
+  }
+  double result[4];
+  _mm256_storeu_pd(result, acc);
+  qLocal[0] = result[0];
+  qLocal[1] = result[1];
+  qLocal[2] = result[2];
+#else
+  double q0 = q[3 * contact];
+  double q1 = q[3 * contact + 1];
+  double q2 = q[3 * contact + 2];
+  for (size_t k = start; k < end; ++k, b += 9, ++column)
+  {
+    const double * x = &reaction[3 * *column];
+    q0 += b[0] * x[0] + b[3] * x[1] + b[6] * x[2];
+    q1 += b[1] * x[0] + b[4] * x[1] + b[7] * x[2];
+    q2 += b[2] * x[0] + b[5] * x[1] + b[8] * x[2];
+  }
+  qLocal[0] = q0;
+  qLocal[1] = q1;
+  qLocal[2] = q2;
+#endif
+}
+
+void fc3d_nsgs_plan_update(int contact, FrictionContactProblem* problem,
+                           FrictionContactProblem* localproblem,
+                           double * reaction, SolverOptions* options)
+{
+  const FC3D_NSGS_Plan * plan = (const FC3D_NSGS_Plan *)options->solverData;
+  assert(plan);
+
+  localproblem->M->matrix0 = plan->diagonal[contact];
+  fc3d_nsgs_plan_computeqLocal(plan, problem->q, reaction, (unsigned int)contact, localproblem->q);
+  localproblem->mu[0] = problem->mu[contact];
+}
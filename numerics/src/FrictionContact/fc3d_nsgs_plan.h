@@ -0,0 +1,91 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef FC3D_NSGS_PLAN_H
+#define FC3D_NSGS_PLAN_H
+
+/*!\file fc3d_nsgs_plan.h
+  \brief Precomputed access pattern of the off-diagonal blocks used to
+  build the local problems of the NSGS solver.
+
+  For each contact, the off-diagonal 3x3 blocks of its row of M are
+  copied in a contiguous array together with their column (contact)
+  indices, so that qLocal = q_i + sum_{j != i} M_ij r_j is evaluated
+  without going through the generic SparseBlockStructuredMatrix
+  accessors. The plan is built once at the beginning of a call to
+  fc3d_nsgs and reused for all iterations.
+*/
+
+#include "FrictionContactProblem.h"
+#include "SolverOptions.h"
+
+/** Off-diagonal blocks of M rearranged by contact */
+typedef struct
+{
+  unsigned int nc;        /**< number of contacts */
+  size_t * rowStart;      /**< first block of each contact (size nc + 1) */
+  unsigned int * column;  /**< column (contact) index of each block */
+  double * blocks;        /**< 3x3 blocks, column-major, contiguous (9 doubles per block) */
+  double ** diagonal;     /**< diagonal block of each contact (pointers into M) */
+} FC3D_NSGS_Plan;
+
+#if defined(__cplusplus) && !defined(BUILD_AS_CPP)
+extern "C"
+{
+#endif
+
+  /** Build the plan for a problem whose matrix is stored as
+      NM_SPARSE_BLOCK with 3x3 blocks
+      \param problem the friction-contact 3D problem
+      \return the plan, or NULL if the storage of M is not supported
+  */
+  FC3D_NSGS_Plan * fc3d_nsgs_plan_new(FrictionContactProblem * problem);
+
+  /** Free a plan
+      \param plan the plan to free
+  */
+  void fc3d_nsgs_plan_free(FC3D_NSGS_Plan * plan);
+
+  /** qLocal = q_contact + sum_{j != contact} M_{contact,j} reaction_j
+      \param plan the plan
+      \param q the global q vector
+      \param reaction the global reaction vector
+      \param contact the contact number
+      \param[out] qLocal the local q vector (size 3)
+  */
+  void fc3d_nsgs_plan_computeqLocal(const FC3D_NSGS_Plan * plan, const double * q,
+                                    const double * reaction, unsigned int contact,
+                                    double * qLocal);
+
+  /** Update function of the local problem (see UpdatePtr) using the
+      plan stored in options->solverData. It is equivalent to
+      fc3d_nsgs_update for NM_SPARSE_BLOCK storage.
+      \param contact the contact number
+      \param problem the global problem
+      \param localproblem the local problem to fill
+      \param reaction the global reaction vector
+      \param options the local solver options, options->solverData is the plan
+  */
+  void fc3d_nsgs_plan_update(int contact, FrictionContactProblem* problem,
+                             FrictionContactProblem* localproblem,
+                             double * reaction, SolverOptions* options);
+
+#if defined(__cplusplus) && !defined(BUILD_AS_CPP)
+}
+#endif
+
+#endif
@@ -271,10 +271,7 @@ static void AC_fillMLocal(FrictionContactProblem * problem, FrictionContactProbl
     /* ok, we maintain the sparseblock storage from the sparse one */
     if (!problem->M->matrix1)
     {
-      problem->M->matrix1 = (SparseBlockStructuredMatrix*) malloc(sizeof(SparseBlockStructuredMatrix));
-      problem->M->matrix1->block = NULL;
-      problem->M->matrix1->index1_data = NULL;
-      problem->M->matrix1->index2_data = NULL;
+      problem->M->matrix1 = newSBM();
     }
     sparseToSBM(problem->dimension, NM_triplet(problem->M), problem->M->matrix1);
     int diagPos = getDiagonalBlockPos(problem->M->matrix1, contact);
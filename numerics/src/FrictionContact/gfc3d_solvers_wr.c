@@ -151,7 +151,7 @@ int reformulationIntoLocalProblem(GlobalFrictionContactProblem* problem, Frictio
 
     // compute W = H^T M^-1 H
     //Copy Htmp <- H
-    SparseBlockStructuredMatrix *HtmpSBM = (SparseBlockStructuredMatrix*)malloc(sizeof(SparseBlockStructuredMatrix));
+    SparseBlockStructuredMatrix *HtmpSBM = newSBM();
     /* copySBM(H->matrix1 , HtmpSBM); */
 
 #ifdef OUTPUT_DEBUG
@@ -195,7 +195,7 @@ int reformulationIntoLocalProblem(GlobalFrictionContactProblem* problem, Frictio
 
 
 
-    SparseBlockStructuredMatrix *Htrans = (SparseBlockStructuredMatrix*)malloc(sizeof(SparseBlockStructuredMatrix));
+    SparseBlockStructuredMatrix *Htrans = newSBM();
     transposeSBM(H->matrix1, Htrans);
 #ifdef OUTPUT_DEBUG
     fileout = fopen("dataHtrans.sci", "w");
@@ -209,7 +209,7 @@ int reformulationIntoLocalProblem(GlobalFrictionContactProblem* problem, Frictio
     Wnum->storageType = 1;
     Wnum-> size0 = m;
     Wnum-> size1 = m;
-    Wnum->matrix1 = (SparseBlockStructuredMatrix*)malloc(sizeof(SparseBlockStructuredMatrix));
+    Wnum->matrix1 = newSBM();
     Wnum->matrix0 = NULL;
     SparseBlockStructuredMatrix *W =  Wnum->matrix1;
 
@@ -0,0 +1,163 @@
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SiconosConfig.h"
+#ifdef WITH_TIMERS
+#define TIMER_FFTW_CYCLE
+#endif
+#include "timers_interf.h"
+#include "NumericsMatrix.h"
+#include "SolverOptions.h"
+#include "fc3d_Solvers.h"
+#include "fc3d_AlartCurnier_batch.h"
+
+/* Compare the batched Alart-Curnier Newton solver with the one-contact
+   solver on random independent contacts, and time both. */
+
+#define NC 1000
+#define REPEAT 100
+
+static double random_between(double a, double b)
+{
+  return a + (b - a) * ((double) rand() / RAND_MAX);
+}
+
+int main()
+{
+  DECL_TIMER(T0);
+  DECL_TIMER(T1);
+
+  int itermax = 20;
+  double tolerance = 1e-16;
+
+  double * W = (double *) malloc(9 * NC * sizeof(double));
+  double * q = (double *) malloc(3 * NC * sizeof(double));
+  double * mu = (double *) malloc(NC * sizeof(double));
+  double * R0 = (double *) malloc(3 * NC * sizeof(double));
+  double * R1 = (double *) malloc(3 * NC * sizeof(double));
+
+  srand(1);
+  for (unsigned int c = 0; c < NC; ++c)
+  {
+    /* W = L L^T + 0.1 I */
+    double L[9];
+    for (unsigned int k = 0; k < 9; ++k) L[k] = random_between(-1.0, 1.0);
+    for (unsigned int i = 0; i < 3; ++i)
+      for (unsigned int j = 0; j < 3; ++j)
+      {
+        double s = (i == j) ? 0.1 : 0.0;
+        for (unsigned int k = 0; k < 3; ++k) s += L[i + 3 * k] * L[j + 3 * k];
+        W[9 * c + i + 3 * j] = s;
+      }
+    for (unsigned int k = 0; k < 3; ++k) q[3 * c + k] = random_between(-1.0, 1.0);
+    mu[c] = random_between(0.1, 1.0);
+  }
+
+  /* one-contact solver */
+  SolverOptions options;
+  fc3d_onecontact_nonsmooth_Newtow_setDefaultSolverOptions(&options);
+  options.solverId = SICONOS_FRICTION_3D_ONECONTACT_NSN_AC;
+  options.iparam[0] = itermax;
+  options.dparam[0] = tolerance;
+
+  double Wlocal[9], qlocal[3], mulocal[1];
+  NumericsMatrix * M = createNumericsMatrixFromData(NM_DENSE, 3, 3, Wlocal);
+  FrictionContactProblem localproblem = { 3, 1, M, qlocal, mulocal };
+  fc3d_onecontact_nonsmooth_Newton_solvers_initialize(&localproblem, &localproblem, &options);
+
+  int failures0 = 0;
+  START_TIMER(T0);
+  for (unsigned int r = 0; r < REPEAT; ++r)
+  {
+    failures0 = 0;
+    for (unsigned int c = 0; c < NC; ++c)
+    {
+      for (unsigned int k = 0; k < 9; ++k) Wlocal[k] = W[9 * c + k];
+      for (unsigned int k = 0; k < 3; ++k) qlocal[k] = q[3 * c + k];
+      mulocal[0] = mu[c];
+      for (unsigned int k = 0; k < 3; ++k) R0[3 * c + k] = 0.0;
+      failures0 += fc3d_onecontact_nonsmooth_Newton_solvers_solve(&localproblem, &R0[3 * c], &options);
+    }
+  }
+  STOP_TIMER(T0);
+
+  /* batch solver */
+  FC3D_AC_Batch * batch = fc3d_AC_batch_new(NC);
+  double zero[3] = { 0.0, 0.0, 0.0 };
+  int failures1 = 0;
+  START_TIMER(T1);
+  for (unsigned int r = 0; r < REPEAT; ++r)
+  {
+    fc3d_AC_batch_clear(batch);
+    for (unsigned int c = 0; c < NC; ++c)
+      fc3d_AC_batch_set(batch, c, &W[9 * c], &q[3 * c], mu[c], zero);
+    failures1 = fc3d_AC_batch_solve(batch, itermax, tolerance);
+  }
+  STOP_TIMER(T1);
+  for (unsigned int c = 0; c < NC; ++c)
+    fc3d_AC_batch_get(batch, c, &R1[3 * c]);
+
+  printf("batch width: %i\n", FC3D_AC_BATCH_WIDTH);
+  printf("failures: one contact %i, batch %i\n", failures0, failures1);
+  PRINT_ELAPSED(T0);
+  PRINT_ELAPSED(T1);
+#ifdef WITH_TIMERS
+  printf("T1/T0 = %g\n", ELAPSED(T1) / ELAPSED(T0));
+#endif
+
+  int info = 0;
+  for (unsigned int c = 0; c < NC; ++c)
+  {
+    if (batch->info[c]) continue;
+    double d = 0.0, n = 0.0;
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+      d += (R1[3 * c + k] - R0[3 * c + k]) * (R1[3 * c + k] - R0[3 * c + k]);
+      n += R0[3 * c + k] * R0[3 * c + k];
+    }
+    if (sqrt(d) > 1e-6 * (1.0 + sqrt(n)))
+    {
+      printf("contact %i: batch reaction differs from the one-contact reaction\n", c);
+      info = 1;
+    }
+  }
+
+  /* the residual of a converged contact is below the tolerance */
+  double * F = (double *) malloc(3 * batch->capacity * sizeof(double));
+  fc3d_AC_batch_computeFunction(batch, F, NULL);
+  for (unsigned int c = 0; c < NC; ++c)
+  {
+    if (batch->info[c]) continue;
+    double nF = 0.0, nR = 0.0;
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+      nF += F[k * batch->capacity + c] * F[k * batch->capacity + c];
+      nR += R1[3 * c + k] * R1[3 * c + k];
+    }
+    if (0.5 * nF / (1.0 + sqrt(nR)) >= tolerance)
+    {
+      printf("contact %i: residual above the tolerance\n", c);
+      info = 1;
+    }
+  }
+
+  /* most of the contacts must converge */
+  if (failures1 > NC / 10) info = 1;
+
+  free(F);
+  fc3d_AC_batch_free(batch);
+  M->matrix0 = NULL;
+  freeNumericsMatrix(M);
+  free(M);
+  deleteSolverOptions(&options);
+  free(W);
+  free(q);
+  free(mu);
+  free(R0);
+  free(R1);
+
+  return info;
+}
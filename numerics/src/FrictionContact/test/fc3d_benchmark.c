@@ -0,0 +1,819 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/*
+  Benchmark of the FC3D and GFC3D solvers over the problems of ./data
+
+  Each solver is run on each problem and the wall time, the number of
+  iterations, the error (fc3d_compute_error or gfc3d_compute_error at
+  the solver tolerance) and the peak memory (resident set size) are
+  recorded. The results are written as csv and json, and summarized
+  as performance profiles (fraction of the problems solved within tau
+  times the best time).
+
+  On POSIX systems each run is done in a child process: a crash or a
+  time out of one solver does not stop the benchmark and the peak
+  memory is the one of the run.
+
+  With --reference, the results are compared to a previous csv output
+  and the program exits with an error if a problem is not solved
+  anymore or is solved more than --threshold times slower.
+
+  Usage: fc3d_benchmark [options] [problem files]
+  see fc3d_benchmark --help.
+*/
+
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define FC3D_BENCHMARK_FORK
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#endif
+
+#include "NonSmoothDrivers.h"
+#include "fc3d_compute_error.h"
+#include "gfc3d_compute_error.h"
+
+#if defined(WITH_FCLIB)
+#include "fclib_interface.h"
+#endif
+
+#define BENCHMARK_NAME_SIZE 128
+#define BENCHMARK_PATH_SIZE 1024
+#define BENCHMARK_MAX_SOLVERS 64
+
+enum BENCHMARK_STATUS
+{
+  BENCHMARK_CONVERGED = 0,
+  BENCHMARK_FAILED = 1,
+  BENCHMARK_CRASHED = 2,
+  BENCHMARK_TIMEOUT = 3,
+  BENCHMARK_UNREADABLE = 4
+};
+
+static const char * benchmark_status_names[] =
+{
+  "converged", "failed", "crashed", "timeout", "unreadable"
+};
+
+typedef struct
+{
+  char path[BENCHMARK_PATH_SIZE];
+  int global;
+} benchmark_problem;
+
+typedef struct
+{
+  char problem[BENCHMARK_NAME_SIZE];
+  char solver[BENCHMARK_NAME_SIZE];
+  int solverId;
+  int global;
+  int contacts;
+  int status;
+  int info;
+  int iterations;
+  double time;
+  double error;
+  long peak_rss;
+} benchmark_record;
+
+typedef struct
+{
+  double tolerance;
+  int max_iter;
+  int repeat;
+  int time_limit;
+  int fork;
+} benchmark_params;
+
+/* the corpus used when no file is given */
+static const benchmark_problem benchmark_default_problems[] =
+{
+  { "./data/BoxesStack1-i100000-32.hdf5.dat", 0 },
+  { "./data/KaplasTower-i1061-4.hdf5.dat", 0 },
+  { "./data/Capsules-i100-1090.dat", 0 },
+  { "./data/Capsules-i100-889.dat", 0 },
+  { "./data/Capsules-i101-404.dat", 0 },
+  { "./data/Capsules-i103-990.dat", 0 },
+  { "./data/Capsules-i122-1617.dat", 0 },
+  { "./data/NESpheres_10_1.dat", 0 },
+  { "./data/NESpheres_30_1.dat", 0 },
+  { "./data/Confeti-ex03-Fc3D-SBM.dat", 0 },
+  { "./data/Confeti-ex13-4contact-Fc3D-SBM.dat", 0 },
+  { "./data/Confeti-ex13-Fc3D-SBM.dat", 0 },
+  { "./data/Example_GlobalFrictionContact.dat", 1 },
+  { "./data/Example_GlobalFrictionContact_SBM.dat", 1 },
+#if defined(WITH_FCLIB)
+  { "./data/Capsules-i125-1213.hdf5", 0 },
+  { "./data/LMGC_GlobalFrictionContactProblem00046.hdf5", 1 },
+  { "./data/CubeH8.hdf5", 1 },
+#endif
+};
+
+/* the solvers used when --solvers is not given. The GAMS solvers and
+ * the one contact solvers are left out */
+static const int benchmark_default_solvers[] =
+{
+  SICONOS_FRICTION_3D_NSGS,
+  SICONOS_FRICTION_3D_NSGSV,
+  SICONOS_FRICTION_3D_PROX,
+  SICONOS_FRICTION_3D_TFP,
+  SICONOS_FRICTION_3D_NSN_AC,
+  SICONOS_FRICTION_3D_NSN_FB,
+  SICONOS_FRICTION_3D_NSN_NM,
+  SICONOS_FRICTION_3D_DSFP,
+  SICONOS_FRICTION_3D_FPP,
+  SICONOS_FRICTION_3D_EG,
+  SICONOS_FRICTION_3D_VI_FPP,
+  SICONOS_FRICTION_3D_VI_EG,
+  SICONOS_FRICTION_3D_HP,
+  SICONOS_FRICTION_3D_ACLMFP,
+  SICONOS_FRICTION_3D_SOCLCP,
+  SICONOS_GLOBAL_FRICTION_3D_NSGS_WR,
+  SICONOS_GLOBAL_FRICTION_3D_NSGSV_WR,
+  SICONOS_GLOBAL_FRICTION_3D_PROX_WR,
+  SICONOS_GLOBAL_FRICTION_3D_DSFP_WR,
+  SICONOS_GLOBAL_FRICTION_3D_TFP_WR,
+  SICONOS_GLOBAL_FRICTION_3D_NSGS,
+  SICONOS_GLOBAL_FRICTION_3D_NSN_AC_WR,
+  SICONOS_GLOBAL_FRICTION_3D_NSN_AC
+};
+
+static const double benchmark_profile_tau[] =
+{
+  1., 1.25, 1.5, 2., 4., 8., 16., 32., 64., 128., 256., 512., 1024.
+};
+
+static int is_global_solver(int solverId)
+{
+  return solverId >= SICONOS_GLOBAL_FRICTION_3D_NSGS_WR;
+}
+
+static double benchmark_now(void)
+{
+#if defined(FC3D_BENCHMARK_FORK)
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec + 1e-9 * (double)t.tv_nsec;
+#else
+  return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/* peak resident set size of the current process in kB, -1 if unknown */
+static long benchmark_peak_rss(void)
+{
+#if defined(FC3D_BENCHMARK_FORK)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage))
+    return -1;
+#if defined(__APPLE__)
+  return (long)(usage.ru_maxrss / 1024);
+#else
+  return (long)usage.ru_maxrss;
+#endif
+#else
+  return -1;
+#endif
+}
+
+/* the solvers do not store the number of iterations at the same
+ * place */
+static int benchmark_iterations(int solverId, SolverOptions* options)
+{
+  switch (solverId)
+  {
+  case SICONOS_FRICTION_3D_NSN_AC:
+  case SICONOS_FRICTION_3D_NSN_FB:
+  case SICONOS_FRICTION_3D_NSN_NM:
+  case SICONOS_GLOBAL_FRICTION_3D_NSN_AC:
+    return options->iparam[SICONOS_IPARAM_ITER_DONE];
+  default:
+    return options->iparam[7];
+  }
+}
+
+static const char * benchmark_basename(const char * path)
+{
+  const char * name = strrchr(path, '/');
+  return name ? name + 1 : path;
+}
+
+static int benchmark_is_hdf5(const char * path)
+{
+  size_t n = strlen(path);
+  return n > 5 && strcmp(path + n - 5, ".hdf5") == 0;
+}
+
+static FrictionContactProblem* benchmark_read_fc3d(const char * path)
+{
+  if (benchmark_is_hdf5(path))
+  {
+#if defined(WITH_FCLIB)
+    return frictionContact_fclib_read(path);
+#else
+    return NULL;
+#endif
+  }
+  FILE * file = fopen(path, "r");
+  if (!file)
+    return NULL;
+  FrictionContactProblem* problem = (FrictionContactProblem*)malloc(sizeof(FrictionContactProblem));
+  int info = frictionContact_newFromFile(problem, file);
+  fclose(file);
+  if (info || problem->dimension != 3)
+  {
+    free(problem);
+    return NULL;
+  }
+  return problem;
+}
+
+static GlobalFrictionContactProblem* benchmark_read_gfc3d(const char * path)
+{
+  if (benchmark_is_hdf5(path))
+  {
+#if defined(WITH_FCLIB)
+    return globalFrictionContact_fclib_read(path);
+#else
+    return NULL;
+#endif
+  }
+  FILE * file = fopen(path, "r");
+  if (!file)
+    return NULL;
+  GlobalFrictionContactProblem* problem = (GlobalFrictionContactProblem*)malloc(sizeof(GlobalFrictionContactProblem));
+  int info = globalFrictionContact_newFromFile(problem, file);
+  fclose(file);
+  if (info || problem->dimension != 3)
+  {
+    free(problem);
+    return NULL;
+  }
+  return problem;
+}
+
+static void benchmark_set_options(SolverOptions* options, int solverId,
+                                  const benchmark_params* params)
+{
+  if (is_global_solver(solverId))
+    gfc3d_setDefaultSolverOptions(options, solverId);
+  else
+    fc3d_setDefaultSolverOptions(options, solverId);
+  if (params->tolerance > 0.)
+    options->dparam[SICONOS_DPARAM_TOL] = params->tolerance;
+  if (params->max_iter > 0)
+    options->iparam[SICONOS_IPARAM_MAX_ITER] = params->max_iter;
+}
+
+/* solve the problem params->repeat times with the solver and keep the
+ * best time */
+static void benchmark_solve(const benchmark_problem* p, int solverId,
+                            const benchmark_params* params,
+                            benchmark_record* r)
+{
+  int k, n = 0, m = 0;
+  double * reaction = NULL;
+  double * velocity = NULL;
+  double * globalVelocity = NULL;
+  FrictionContactProblem* fc3d = NULL;
+  GlobalFrictionContactProblem* gfc3d = NULL;
+
+  if (p->global)
+  {
+    gfc3d = benchmark_read_gfc3d(p->path);
+    if (gfc3d)
+    {
+      r->contacts = gfc3d->numberOfContacts;
+      m = gfc3d->M->size0;
+    }
+  }
+  else
+  {
+    fc3d = benchmark_read_fc3d(p->path);
+    if (fc3d)
+      r->contacts = fc3d->numberOfContacts;
+  }
+  if (!fc3d && !gfc3d)
+  {
+    r->status = BENCHMARK_UNREADABLE;
+    return;
+  }
+
+  n = 3 * r->contacts;
+  reaction = (double*)calloc(n, sizeof(double));
+  velocity = (double*)calloc(n, sizeof(double));
+  if (gfc3d)
+    globalVelocity = (double*)calloc(m, sizeof(double));
+
+  NumericsOptions numerics_options;
+  setDefaultNumericsOptions(&numerics_options);
+  numerics_options.verboseMode = 0;
+
+  SolverOptions options;
+  benchmark_set_options(&options, solverId, params);
+
+  r->time = -1.;
+  for (k = 0; k < params->repeat; ++k)
+  {
+    memset(reaction, 0, n * sizeof(double));
+    memset(velocity, 0, n * sizeof(double));
+    if (gfc3d)
+      memset(globalVelocity, 0, m * sizeof(double));
+
+    double start = benchmark_now();
+    if (gfc3d)
+      r->info = gfc3d_driver(gfc3d, reaction, velocity, globalVelocity,
+                             &options, &numerics_options);
+    else
+      r->info = fc3d_driver(fc3d, reaction, velocity,
+                            &options, &numerics_options);
+    double elapsed = benchmark_now() - start;
+    if (r->time < 0. || elapsed < r->time)
+      r->time = elapsed;
+  }
+
+  r->iterations = benchmark_iterations(solverId, &options);
+  if (gfc3d)
+    gfc3d_compute_error(gfc3d, reaction, velocity, globalVelocity,
+                        options.dparam[SICONOS_DPARAM_TOL], &r->error);
+  else
+    fc3d_compute_error(fc3d, reaction, velocity,
+                       options.dparam[SICONOS_DPARAM_TOL], &options, &r->error);
+  r->status = (r->info == 0) ? BENCHMARK_CONVERGED : BENCHMARK_FAILED;
+
+  deleteSolverOptions(&options);
+  free(reaction);
+  free(velocity);
+  free(globalVelocity);
+  if (gfc3d)
+    freeGlobalFrictionContactProblem(gfc3d);
+  if (fc3d)
+    freeFrictionContactProblem(fc3d);
+}
+
+static void benchmark_run(const benchmark_problem* p, int solverId,
+                          const benchmark_params* params,
+                          benchmark_record* r)
+{
+  memset(r, 0, sizeof(benchmark_record));
+  strncpy(r->problem, benchmark_basename(p->path), BENCHMARK_NAME_SIZE - 1);
+  strncpy(r->solver, idToName(solverId), BENCHMARK_NAME_SIZE - 1);
+  r->solverId = solverId;
+  r->global = p->global;
+  r->info = -1;
+  r->iterations = -1;
+  r->time = -1.;
+  r->error = -1.;
+  r->peak_rss = -1;
+
+#if defined(FC3D_BENCHMARK_FORK)
+  int fd[2];
+  if (params->fork && pipe(fd) == 0)
+  {
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+      close(fd[0]);
+      if (params->time_limit > 0)
+        alarm(params->time_limit);
+      benchmark_solve(p, solverId, params, r);
+      r->peak_rss = benchmark_peak_rss();
+      if (write(fd[1], r, sizeof(benchmark_record)) != (ssize_t)sizeof(benchmark_record))
+        _exit(1);
+      _exit(0);
+    }
+    close(fd[1]);
+    if (pid > 0)
+    {
+      benchmark_record result;
+      size_t size = 0;
+      ssize_t count;
+      while (size < sizeof(benchmark_record) &&
+             (count = read(fd[0], (char*)&result + size, sizeof(benchmark_record) - size)) > 0)
+        size += (size_t)count;
+      int wstatus = 0;
+      waitpid(pid, &wstatus, 0);
+      if (size == sizeof(benchmark_record))
+        *r = result;
+      else if (WIFSIGNALED(wstatus) && WTERMSIG(wstatus) == SIGALRM)
+        r->status = BENCHMARK_TIMEOUT;
+      else
+        r->status = BENCHMARK_CRASHED;
+    }
+    else
+    {
+      perror("fc3d_benchmark: fork");
+      r->status = BENCHMARK_CRASHED;
+    }
+    close(fd[0]);
+    return;
+  }
+#endif
+  benchmark_solve(p, solverId, params, r);
+  r->peak_rss = benchmark_peak_rss();
+}
+
+static void benchmark_write_csv(FILE* file, benchmark_record* records, int n)
+{
+  int i;
+  fprintf(file, "problem,kind,solver,solver_id,contacts,status,info,iterations,time,error,peak_rss_kb\n");
+  for (i = 0; i < n; ++i)
+  {
+    benchmark_record* r = &records[i];
+    fprintf(file, "%s,%s,%s,%d,%d,%s,%d,%d,%.9g,%.9g,%ld\n",
+            r->problem, r->global ? "gfc3d" : "fc3d", r->solver, r->solverId,
+            r->contacts, benchmark_status_names[r->status], r->info,
+            r->iterations, r->time, r->error, r->peak_rss);
+  }
+}
+
+static void benchmark_write_json(FILE* file, benchmark_record* records, int n,
+                                 const benchmark_params* params)
+{
+  int i;
+  fprintf(file, "{\n  \"tolerance\": %.9g,\n  \"max_iter\": %d,\n  \"repeat\": %d,\n  \"runs\": [\n",
+          params->tolerance, params->max_iter, params->repeat);
+  for (i = 0; i < n; ++i)
+  {
+    benchmark_record* r = &records[i];
+    fprintf(file, "    {\"problem\": \"%s\", \"kind\": \"%s\", \"solver\": \"%s\", \"solver_id\": %d, "
+            "\"contacts\": %d, \"status\": \"%s\", \"info\": %d, \"iterations\": %d, "
+            "\"time\": %.9g, \"error\": %.9g, \"peak_rss_kb\": %ld}%s\n",
+            r->problem, r->global ? "gfc3d" : "fc3d", r->solver, r->solverId,
+            r->contacts, benchmark_status_names[r->status], r->info,
+            r->iterations, r->time, r->error, r->peak_rss,
+            (i + 1 < n) ? "," : "");
+  }
+  fprintf(file, "  ]\n}\n");
+}
+
+/* Performance profile of the solvers on the problems of one kind
+ * (fc3d or gfc3d): for each tau, the fraction of the problems solved
+ * by a solver in less than tau times the best time over all the
+ * solvers. Written as a table on out and as csv on csv (if not
+ * NULL). */
+static void benchmark_profile(FILE* out, FILE* csv, benchmark_record* records,
+                              int n, int global)
+{
+  int solvers[BENCHMARK_MAX_SOLVERS];
+  int nsolvers = 0, nproblems = 0;
+  int i, j, s, t;
+  int ntau = sizeof(benchmark_profile_tau) / sizeof(double);
+
+  for (i = 0; i < n; ++i)
+  {
+    if (records[i].global != global)
+      continue;
+    for (s = 0; s < nsolvers; ++s)
+      if (solvers[s] == records[i].solverId)
+        break;
+    if (s == nsolvers && nsolvers < BENCHMARK_MAX_SOLVERS)
+      solvers[nsolvers++] = records[i].solverId;
+  }
+  if (!nsolvers)
+    return;
+
+  /* the records of a problem are contiguous */
+  int * solved = (int*)calloc(nsolvers * ntau, sizeof(int));
+  for (i = 0; i < n; i = j)
+  {
+    for (j = i; j < n && strcmp(records[j].problem, records[i].problem) == 0; ++j);
+    if (records[i].global != global)
+      continue;
+    nproblems++;
+    double best = -1.;
+    for (s = i; s < j; ++s)
+      if (records[s].status == BENCHMARK_CONVERGED && (best < 0. || records[s].time < best))
+        best = records[s].time;
+    if (best < 0.)
+      continue;
+    for (s = i; s < j; ++s)
+    {
+      if (records[s].status != BENCHMARK_CONVERGED)
+        continue;
+      int k;
+      for (k = 0; k < nsolvers && solvers[k] != records[s].solverId; ++k);
+      for (t = 0; t < ntau; ++t)
+        if (records[s].time <= benchmark_profile_tau[t] * best)
+          solved[k * ntau + t]++;
+    }
+  }
+
+  fprintf(out, "\nPerformance profile (%s), fraction of the %d problems solved within tau times the best time\n",
+          global ? "gfc3d" : "fc3d", nproblems);
+  fprintf(out, "%8s", "tau");
+  for (s = 0; s < nsolvers; ++s)
+    fprintf(out, " %14s", idToName(solvers[s]));
+  fprintf(out, "\n");
+  if (csv)
+  {
+    fprintf(csv, "kind,tau");
+    for (s = 0; s < nsolvers; ++s)
+      fprintf(csv, ",%s", idToName(solvers[s]));
+    fprintf(csv, "\n");
+  }
+  for (t = 0; t < ntau; ++t)
+  {
+    fprintf(out, "%8g", benchmark_profile_tau[t]);
+    if (csv)
+      fprintf(csv, "%s,%g", global ? "gfc3d" : "fc3d", benchmark_profile_tau[t]);
+    for (s = 0; s < nsolvers; ++s)
+    {
+      double rho = nproblems ? (double)solved[s * ntau + t] / nproblems : 0.;
+      fprintf(out, " %14.3f", rho);
+      if (csv)
+        fprintf(csv, ",%.6f", rho);
+    }
+    fprintf(out, "\n");
+    if (csv)
+      fprintf(csv, "\n");
+  }
+  free(solved);
+}
+
+/* Compare the records with a csv file written by a previous run.
+ * \return the number of regressions */
+static int benchmark_compare(const char * path, benchmark_record* records, int n,
+                             double threshold, double min_time)
+{
+  char line[1024];
+  int regressions = 0, compared = 0, i;
+  FILE * file = fopen(path, "r");
+  if (!file)
+  {
+    fprintf(stderr, "fc3d_benchmark: cannot open the reference %s\n", path);
+    return 1;
+  }
+
+  printf("\nComparison with %s (threshold %g)\n", path, threshold);
+  /* skip the header */
+  if (!fgets(line, sizeof(line), file))
+  {
+    fclose(file);
+    return 0;
+  }
+  while (fgets(line, sizeof(line), file))
+  {
+    char * fields[11];
+    int nfields = 0;
+    char * c = line;
+    fields[nfields++] = c;
+    for (; *c && nfields < 11; ++c)
+    {
+      if (*c == ',')
+      {
+        *c = '\0';
+        fields[nfields++] = c + 1;
+      }
+    }
+    if (nfields < 11)
+      continue;
+
+    const char * problem = fields[0];
+    const char * solver = fields[2];
+    int ref_converged = strcmp(fields[5], benchmark_status_names[BENCHMARK_CONVERGED]) == 0;
+    double ref_time = atof(fields[8]);
+
+    for (i = 0; i < n; ++i)
+      if (strcmp(records[i].problem, problem) == 0 && strcmp(records[i].solver, solver) == 0)
+        break;
+    if (i == n)
+      continue;
+    compared++;
+
+    benchmark_record* r = &records[i];
+    if (ref_converged && r->status != BENCHMARK_CONVERGED)
+    {
+      printf("REGRESSION %s on %s: %s, converged in the reference\n",
+             solver, problem, benchmark_status_names[r->status]);
+      regressions++;
+    }
+    else if (ref_converged && ref_time >= min_time && r->time > threshold * ref_time)
+    {
+      printf("REGRESSION %s on %s: %g s, %g s in the reference (x%.2f)\n",
+             solver, problem, r->time, ref_time, r->time / ref_time);
+      regressions++;
+    }
+  }
+  fclose(file);
+  printf("%d runs compared, %d regressions\n", compared, regressions);
+  return regressions;
+}
+
+static int benchmark_parse_solvers(char * list, int * solvers)
+{
+  int n = 0;
+  char * name = strtok(list, ",");
+  while (name && n < BENCHMARK_MAX_SOLVERS)
+  {
+    int id = atoi(name);
+    if (!id)
+      id = nameToId(name);
+    if (!id)
+    {
+      fprintf(stderr, "fc3d_benchmark: unknown solver %s\n", name);
+      return -1;
+    }
+    solvers[n++] = id;
+    name = strtok(NULL, ",");
+  }
+  return n;
+}
+
+static void benchmark_usage(const char * exe)
+{
+  printf("Usage: %s [options] [problem files]\n"
+         "Run the FC3D and GFC3D solvers on the problems (default: the corpus of ./data).\n"
+         "  --solvers LIST     comma separated solver names (FC3D_NSGS, GFC3D_NSGS_WR, ...) or ids\n"
+         "  --global           the problem files are global (GFC3D) problems\n"
+         "  --tolerance TOL    tolerance of the solvers (default: solver default)\n"
+         "  --max-iter N       maximum number of iterations (default: solver default)\n"
+         "  --repeat N         run each solve N times and keep the best time (default: 1)\n"
+         "  --time-limit S     stop a run after S seconds (default: none)\n"
+         "  --no-fork          run the solvers in the benchmark process\n"
+         "  --csv FILE         write the results as csv\n"
+         "  --json FILE        write the results as json\n"
+         "  --profile FILE     write the performance profiles as csv\n"
+         "  --reference FILE   compare with the csv of a previous run, exit with 1 on regressions\n"
+         "  --threshold R      time ratio above which a run is a regression (default: 1.5)\n"
+         "  --min-time S       ignore the time of the reference runs shorter than S (default: 1e-3)\n",
+         exe);
+}
+
+int main(int argc, char* argv[])
+{
+  benchmark_params params = { 0., 0, 1, 0, 1 };
+  const char * csv_path = NULL;
+  const char * json_path = NULL;
+  const char * profile_path = NULL;
+  const char * reference_path = NULL;
+  double threshold = 1.5;
+  double min_time = 1e-3;
+  int global = 0;
+  int solvers[BENCHMARK_MAX_SOLVERS];
+  int nsolvers = 0;
+  int i, s;
+
+  benchmark_problem* problems = (benchmark_problem*)malloc(argc * sizeof(benchmark_problem));
+  int nproblems = 0;
+
+  for (i = 1; i < argc; ++i)
+  {
+    const char * arg = argv[i];
+    int has_value = i + 1 < argc;
+    if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0)
+    {
+      benchmark_usage(argv[0]);
+      free(problems);
+      return 0;
+    }
+    else if (strcmp(arg, "--global") == 0)
+      global = 1;
+    else if (strcmp(arg, "--no-fork") == 0)
+      params.fork = 0;
+    else if (strcmp(arg, "--solvers") == 0 && has_value)
+    {
+      nsolvers = benchmark_parse_solvers(argv[++i], solvers);
+      if (nsolvers < 0)
+      {
+        free(problems);
+        return 1;
+      }
+    }
+    else if (strcmp(arg, "--tolerance") == 0 && has_value)
+      params.tolerance = atof(argv[++i]);
+    else if (strcmp(arg, "--max-iter") == 0 && has_value)
+      params.max_iter = atoi(argv[++i]);
+    else if (strcmp(arg, "--repeat") == 0 && has_value)
+      params.repeat = atoi(argv[++i]);
+    else if (strcmp(arg, "--time-limit") == 0 && has_value)
+      params.time_limit = atoi(argv[++i]);
+    else if (strcmp(arg, "--csv") == 0 && has_value)
+      csv_path = argv[++i];
+    else if (strcmp(arg, "--json") == 0 && has_value)
+      json_path = argv[++i];
+    else if (strcmp(arg, "--profile") == 0 && has_value)
+      profile_path = argv[++i];
+    else if (strcmp(arg, "--reference") == 0 && has_value)
+      reference_path = argv[++i];
+    else if (strcmp(arg, "--threshold") == 0 && has_value)
+      threshold = atof(argv[++i]);
+    else if (strcmp(arg, "--min-time") == 0 && has_value)
+      min_time = atof(argv[++i]);
+    else if (arg[0] == '-')
+    {
+      fprintf(stderr, "fc3d_benchmark: unknown option %s\n", arg);
+      benchmark_usage(argv[0]);
+      free(problems);
+      return 1;
+    }
+    else
+    {
+      memset(&problems[nproblems], 0, sizeof(benchmark_problem));
+      strncpy(problems[nproblems].path, arg, BENCHMARK_PATH_SIZE - 1);
+      problems[nproblems].global = global;
+      nproblems++;
+    }
+  }
+  if (params.repeat < 1)
+    params.repeat = 1;
+
+  const benchmark_problem* corpus = problems;
+  if (!nproblems)
+  {
+    corpus = benchmark_default_problems;
+    nproblems = sizeof(benchmark_default_problems) / sizeof(benchmark_problem);
+  }
+  if (!nsolvers)
+  {
+    nsolvers = sizeof(benchmark_default_solvers) / sizeof(int);
+    memcpy(solvers, benchmark_default_solvers, sizeof(benchmark_default_solvers));
+  }
+
+  benchmark_record* records = (benchmark_record*)malloc(nproblems * nsolvers * sizeof(benchmark_record));
+  int nrecords = 0;
+
+  printf("%-40s %-22s %8s %-10s %8s %12s %12s %10s\n", "problem", "solver", "contacts",
+         "status", "iter", "time (s)", "error", "rss (kB)");
+  for (i = 0; i < nproblems; ++i)
+  {
+    for (s = 0; s < nsolvers; ++s)
+    {
+      if (is_global_solver(solvers[s]) != corpus[i].global)
+        continue;
+      benchmark_record* r = &records[nrecords++];
+      benchmark_run(&corpus[i], solvers[s], &params, r);
+      printf("%-40s %-22s %8d %-10s %8d %12.6g %12.6g %10ld\n", r->problem, r->solver,
+             r->contacts, benchmark_status_names[r->status], r->iterations,
+             r->time, r->error, r->peak_rss);
+      fflush(stdout);
+    }
+  }
+
+  if (csv_path)
+  {
+    FILE * file = fopen(csv_path, "w");
+    if (file)
+    {
+      benchmark_write_csv(file, records, nrecords);
+      fclose(file);
+    }
+    else
+      fprintf(stderr, "fc3d_benchmark: cannot write %s\n", csv_path);
+  }
+  if (json_path)
+  {
+    FILE * file = fopen(json_path, "w");
+    if (file)
+    {
+      benchmark_write_json(file, records, nrecords, &params);
+      fclose(file);
+    }
+    else
+      fprintf(stderr, "fc3d_benchmark: cannot write %s\n", json_path);
+  }
+
+  FILE * profile = profile_path ? fopen(profile_path, "w") : NULL;
+  benchmark_profile(stdout, profile, records, nrecords, 0);
+  benchmark_profile(stdout, profile, records, nrecords, 1);
+  if (profile)
+    fclose(profile);
+
+  int info = 0;
+  if (reference_path)
+    info = benchmark_compare(reference_path, records, nrecords, threshold, min_time) ? 1 : 0;
+
+  free(records);
+  free(problems);
+  return info;
+}
@@ -0,0 +1,179 @@
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SiconosConfig.h"
+#ifdef WITH_TIMERS
+#define TIMER_FFTW_CYCLE
+#endif
+#include "timers_interf.h"
+#include "NumericsMatrix.h"
+#include "SparseBlockMatrix.h"
+#include "SolverOptions.h"
+#include "FrictionContactProblem.h"
+#include "fc3d_Solvers.h"
+#include "fc3d_nsgs_plan.h"
+
+/* Compare the local problems built with the plan of fc3d_nsgs with the
+   ones of fc3d_nsgs_update, time both updates over full sweeps, and
+   check that fc3d_nsgs gives the same reactions on the
+   NM_SPARSE_BLOCK storage (with the plan) and on a dense copy of the
+   problem (with the former loop). The rounding differences grow with
+   the iterations on KaplasTower, which is only compared after one
+   sweep. */
+
+#define REPEAT 20
+
+static int compare_updates(FrictionContactProblem * problem, FC3D_NSGS_Plan * plan)
+{
+  int nc = problem->numberOfContacts;
+  int n = 3 * nc;
+  double * reaction = (double *) malloc(n * sizeof(double));
+  for (int i = 0; i < n; ++i)
+    reaction[i] = 2.0 * rand() / RAND_MAX - 1.0;
+
+  double q0[3], q1[3], mu0[1], mu1[1];
+  FrictionContactProblem local0 = { 3, 1, createNumericsMatrixFromData(NM_DENSE, 3, 3, NULL), q0, mu0 };
+  FrictionContactProblem local1 = { 3, 1, createNumericsMatrixFromData(NM_DENSE, 3, 3, NULL), q1, mu1 };
+  SolverOptions options;
+  memset(&options, 0, sizeof(SolverOptions));
+  options.solverData = plan;
+
+  int info = 0;
+  for (int contact = 0; contact < nc; ++contact)
+  {
+    fc3d_nsgs_update(contact, problem, &local0, reaction, NULL);
+    fc3d_nsgs_plan_update(contact, problem, &local1, reaction, &options);
+    if (memcmp(local0.M->matrix0, local1.M->matrix0, 9 * sizeof(double)) || mu0[0] != mu1[0])
+    {
+      printf("contact %i: the plan gives another local matrix or friction coefficient\n", contact);
+      info = 1;
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+      if (fabs(q0[k] - q1[k]) > 1e-12 * (1.0 + fabs(q0[k])))
+      {
+        printf("contact %i: qLocal[%i] = %g with the plan, %g expected\n", contact, k, q1[k], q0[k]);
+        info = 1;
+      }
+    }
+  }
+
+  /* the reactions are left unchanged by both updates */
+  DECL_TIMER(T0);
+  DECL_TIMER(T1);
+  START_TIMER(T0);
+  for (int r = 0; r < REPEAT; ++r)
+    for (int contact = 0; contact < nc; ++contact)
+      fc3d_nsgs_update(contact, problem, &local0, reaction, NULL);
+  STOP_TIMER(T0);
+  START_TIMER(T1);
+  for (int r = 0; r < REPEAT; ++r)
+    for (int contact = 0; contact < nc; ++contact)
+      fc3d_nsgs_plan_update(contact, problem, &local1, reaction, &options);
+  STOP_TIMER(T1);
+  PRINT_ELAPSED(T0);
+  PRINT_ELAPSED(T1);
+#ifdef WITH_TIMERS
+  printf("T1/T0 = %g\n", ELAPSED(T1) / ELAPSED(T0));
+#endif
+
+  local0.M->matrix0 = NULL;
+  local1.M->matrix0 = NULL;
+  freeNumericsMatrix(local0.M);
+  freeNumericsMatrix(local1.M);
+  free(local0.M);
+  free(local1.M);
+  free(reaction);
+  return info;
+}
+
+static int compare_solve(FrictionContactProblem * problem, int itermax)
+{
+  int nc = problem->numberOfContacts;
+  int n = 3 * nc;
+
+  /* the same problem with a dense matrix */
+  double * dense = (double *) malloc(n * n * sizeof(double));
+  SBMtoDense(problem->M->matrix1, dense);
+  FrictionContactProblem denseProblem = { 3, nc, createNumericsMatrixFromData(NM_DENSE, n, n, dense),
+                                          problem->q, problem->mu };
+
+  double * reaction0 = (double *) calloc(n, sizeof(double));
+  double * velocity0 = (double *) calloc(n, sizeof(double));
+  double * reaction1 = (double *) calloc(n, sizeof(double));
+  double * velocity1 = (double *) calloc(n, sizeof(double));
+
+  SolverOptions options0, options1;
+  fc3d_nsgs_setDefaultSolverOptions(&options0);
+  fc3d_nsgs_setDefaultSolverOptions(&options1);
+  options0.iparam[0] = options1.iparam[0] = itermax;
+  options0.dparam[0] = options1.dparam[0] = 1e-8;
+
+  int info0 = 1, info1 = 1; /* not a trivial problem */
+  fc3d_nsgs(&denseProblem, reaction0, velocity0, &info0, &options0);
+  fc3d_nsgs(problem, reaction1, velocity1, &info1, &options1);
+  printf("iterations: dense %i, sparse block %i\n", options0.iparam[7], options1.iparam[7]);
+
+  int info = 0;
+  if (info0 != info1 || options0.iparam[7] != options1.iparam[7])
+  {
+    printf("fc3d_nsgs: another number of iterations with the plan\n");
+    info = 1;
+  }
+  double d = 0.0, nr = 0.0;
+  for (int i = 0; i < n; ++i)
+  {
+    d += (reaction1[i] - reaction0[i]) * (reaction1[i] - reaction0[i]);
+    nr += reaction0[i] * reaction0[i];
+  }
+  if (sqrt(d) > 1e-10 * (1.0 + sqrt(nr)))
+  {
+    printf("fc3d_nsgs: the reaction with the plan differs by %g\n", sqrt(d));
+    info = 1;
+  }
+
+  deleteSolverOptions(&options0);
+  deleteSolverOptions(&options1);
+  freeNumericsMatrix(denseProblem.M);
+  free(denseProblem.M);
+  free(reaction0);
+  free(velocity0);
+  free(reaction1);
+  free(velocity1);
+  return info;
+}
+
+int main(void)
+{
+  const char * files[] = { "./data/BoxesStack1-i100000-32.hdf5.dat",
+                           "./data/KaplasTower-i1061-4.hdf5.dat" };
+  int itermax[] = { 100, 1 };
+  int info = 0;
+  srand(1);
+  for (unsigned int f = 0; f < sizeof(files) / sizeof(files[0]); ++f)
+  {
+    printf("%s\n", files[f]);
+    FrictionContactProblem * problem = (FrictionContactProblem *) malloc(sizeof(FrictionContactProblem));
+    FILE * file = fopen(files[f], "r");
+    assert(file);
+    frictionContact_newFromFile(problem, file);
+    fclose(file);
+
+    FC3D_NSGS_Plan * plan = fc3d_nsgs_plan_new(problem);
+    assert(plan);
+    info += compare_updates(problem, plan);
+    fc3d_nsgs_plan_free(plan);
+
+    info += compare_solve(problem, itermax[f]);
+    freeFrictionContactProblem(problem);
+  }
+  if (info)
+    printf("End of test of the fc3d_nsgs plan: failure\n");
+  else
+    printf("End of test of the fc3d_nsgs plan: success\n");
+  return info;
+}
@@ -0,0 +1,97 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "NonSmoothDrivers.h"
+#include "FrictionContactProblem.h"
+#include "fc3d_Solvers.h"
+
+/* NSGS with the graph-colored parallel sweep: the reactions and the
+   number of iterations must not depend on the number of threads. */
+
+static int solve(FrictionContactProblem * problem, int nthreads,
+                 double * reaction, double * velocity, int * iter)
+{
+  NumericsOptions global_options;
+  setDefaultNumericsOptions(&global_options);
+  SolverOptions options;
+  int info = fc3d_setDefaultSolverOptions(&options, SICONOS_FRICTION_3D_NSGS);
+  options.iparam[0] = 20000;
+  options.dparam[0] = 1e-08;
+  options.iparam[8] = 1; /* graph-colored parallel sweep */
+  options.iparam[9] = nthreads;
+
+  options.internalSolvers->iparam[0] = 100;
+  options.internalSolvers->dparam[0] = 1e-16;
+
+  int n = problem->dimension * problem->numberOfContacts;
+  memset(reaction, 0, n * sizeof(double));
+  memset(velocity, 0, n * sizeof(double));
+  info = fc3d_driver(problem, reaction, velocity, &options, &global_options);
+  *iter = options.iparam[7];
+  printf("%i thread(s): info = %i, %i iterations, error = %e\n",
+         nthreads, info, *iter, options.dparam[1]);
+
+  deleteSolverOptions(&options);
+  return info;
+}
+
+int main(void)
+{
+  int info = 0 ;
+
+  char filename[50] = "./data/Confeti-ex03-Fc3D-SBM.dat";
+  printf("Test on %s\n", filename);
+
+  FILE * finput  =  fopen(filename, "r");
+  FrictionContactProblem * problem = (FrictionContactProblem *) malloc(sizeof(FrictionContactProblem));
+  info = frictionContact_newFromFile(problem, finput);
+  fclose(finput);
+
+  int n = problem->dimension * problem->numberOfContacts;
+  double * reaction[3], * velocity[3];
+  int iter[3];
+  int nthreads[3] = { 1, 2, 4 };
+  for (int k = 0; k < 3; ++k)
+  {
+    reaction[k] = (double *) malloc(n * sizeof(double));
+    velocity[k] = (double *) malloc(n * sizeof(double));
+    info += solve(problem, nthreads[k], reaction[k], velocity[k], &iter[k]);
+  }
+
+  for (int k = 1; k < 3; ++k)
+  {
+    if (iter[k] != iter[0]
+        || memcmp(reaction[k], reaction[0], n * sizeof(double))
+        || memcmp(velocity[k], velocity[0], n * sizeof(double)))
+    {
+      printf("the solution with %i threads differs from the one with 1 thread\n", nthreads[k]);
+      info = 1;
+    }
+  }
+
+  for (int k = 0; k < 3; ++k)
+  {
+    free(reaction[k]);
+    free(velocity[k]);
+  }
+  freeFrictionContactProblem(problem);
+  printf("\nEnd of test on %s\n", filename);
+  return info;
+}
@@ -0,0 +1,124 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "SiconosConfig.h"
+#ifdef WITH_TIMERS
+#define TIMER_FFTW_CYCLE
+#endif
+#include "timers_interf.h"
+#include "NonSmoothDrivers.h"
+#include "FrictionContactProblem.h"
+#include "fc3d_Solvers.h"
+
+/* NSGS with the graph-colored parallel sweep, with the one-contact
+   Alart-Curnier solver SICONOS_FRICTION_3D_ONECONTACT_NSN_AC
+   (iparam[8] = 1) and with the batched one (iparam[8] = 2). Both must converge, the batched sweep must give the
+   same solution with 1 and 4 threads, and the same solution as the
+   one-contact sweep up to the tolerance. */
+
+static int solve(FrictionContactProblem * problem, int sweep, int nthreads,
+                 double * reaction, double * velocity, int * iter)
+{
+  NumericsOptions global_options;
+  setDefaultNumericsOptions(&global_options);
+  SolverOptions options;
+  fc3d_setDefaultSolverOptions(&options, SICONOS_FRICTION_3D_NSGS);
+  options.iparam[0] = 20000;
+  options.dparam[0] = 1e-08;
+  options.iparam[8] = sweep;
+  options.iparam[9] = nthreads;
+
+  /* the undamped Newton of fc3d_AC_batch_solve */
+  options.internalSolvers->solverId = SICONOS_FRICTION_3D_ONECONTACT_NSN_AC;
+  options.internalSolvers->iparam[0] = 100;
+  options.internalSolvers->dparam[0] = 1e-16;
+
+  int n = problem->dimension * problem->numberOfContacts;
+  memset(reaction, 0, n * sizeof(double));
+  memset(velocity, 0, n * sizeof(double));
+
+  DECL_TIMER(T);
+  START_TIMER(T);
+  int info = fc3d_driver(problem, reaction, velocity, &options, &global_options);
+  STOP_TIMER(T);
+  *iter = options.iparam[7];
+  printf("sweep %i, %i thread(s): info = %i, %i iterations, error = %e\n",
+         sweep, nthreads, info, *iter, options.dparam[1]);
+  PRINT_ELAPSED(T);
+
+  deleteSolverOptions(&options);
+  return info;
+}
+
+int main(void)
+{
+  int info = 0 ;
+
+  char filename[50] = "./data/Confeti-ex03-Fc3D-SBM.dat";
+  printf("Test on %s\n", filename);
+
+  FILE * finput  =  fopen(filename, "r");
+  FrictionContactProblem * problem = (FrictionContactProblem *) malloc(sizeof(FrictionContactProblem));
+  info = frictionContact_newFromFile(problem, finput);
+  fclose(finput);
+
+  int n = problem->dimension * problem->numberOfContacts;
+  double * reaction[3], * velocity[3];
+  int iter[3];
+  int sweep[3] = { 1, 2, 2 };
+  int nthreads[3] = { 1, 1, 4 };
+  for (int k = 0; k < 3; ++k)
+  {
+    reaction[k] = (double *) malloc(n * sizeof(double));
+    velocity[k] = (double *) malloc(n * sizeof(double));
+    info += solve(problem, sweep[k], nthreads[k], reaction[k], velocity[k], &iter[k]);
+  }
+
+  if (iter[2] != iter[1]
+      || memcmp(reaction[2], reaction[1], n * sizeof(double))
+      || memcmp(velocity[2], velocity[1], n * sizeof(double)))
+  {
+    printf("the batched sweep with 4 threads differs from the one with 1 thread\n");
+    info = 1;
+  }
+
+  double d = 0.0, nr = 0.0;
+  for (int i = 0; i < n; ++i)
+  {
+    d += (reaction[1][i] - reaction[0][i]) * (reaction[1][i] - reaction[0][i]);
+    nr += reaction[0][i] * reaction[0][i];
+  }
+  printf("difference of the reactions: %e\n", sqrt(d));
+  if (sqrt(d) > 1e-6 * (1.0 + sqrt(nr)))
+  {
+    printf("the batched sweep gives another reaction\n");
+    info = 1;
+  }
+
+  for (int k = 0; k < 3; ++k)
+  {
+    free(reaction[k]);
+    free(velocity[k]);
+  }
+  freeFrictionContactProblem(problem);
+  printf("\nEnd of test on %s\n", filename);
+  return info;
+}
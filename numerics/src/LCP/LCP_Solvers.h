@@ -354,7 +354,13 @@ extern "C"
   */
   void lcp_path(LinearComplementarityProblem* problem, double *z, double *w, int *info, SolverOptions* options);
 
-  /** enumerative solver
+  /** enumerative solver. The complementarity patterns are visited
+  * starting from the one of iparam[3], which is set to the pattern
+  * found (iparam[1]) so that the next call starts from it. Bit i of
+  * the code of a pattern is 1 if w[i] is the unknown (z[i] = 0), 0 if
+  * z[i] is the unknown (w[i] = 0). iparam[1] is not a number of
+  * iterations, as for the iterative solvers. iparam[5] is the number
+  * of threads (0 for the OpenMP default).
   * \param[in] problem structure that represents the LCP (M, q...)
   * \param[in,out] z a n-vector of doubles which contains the initial solution and returns the solution of the problem.
   * \param[in,out] w a n-vector of doubles which returns the solution of the problem.
@@ -25,42 +25,17 @@
 #include "LCP_Solvers.h"
 #include "SiconosLapack.h"
 #include "lcp_enum.h"
-static unsigned long  int sCurrentEnum = 0;
-static unsigned long  int sCmpEnum = 0;
-static unsigned long  int sNbCase = 0;
-static double sProgress = 0;
-static int* sWZ = 0;
-static double * sM = 0;
-static double * sMref = 0;
-static double * sQ = 0;
-static double * sQref = 0;
-static double * sColNul = 0;
-static int sSize = 0;
-static int LWORK = 0;
+#include "mlcp_enum_tool.h"
 
-
-static void affectWZ();
 static void lcp_buildM(int * zw, double * M, double * Mref, int size);
 static void lcp_fillSolution(double*  z, double * w, int size, int* zw, double * Q);
-static void lcp_initEnum();
-static int lcp_nextEnum();
-static void lcp_buildQ();
 
-/*case defined with sCurrentEnum
- *if sWZ[i]==0
+/*case defined with the enumeration (see mlcp_enum_tool.h)
+ *if zw[i]==0
  *  w[i] null
  *else
  *  z[i] null
  */
-void affectWZ()
-{
-  unsigned long  int aux = sCurrentEnum;
-  for (int i = 0; i < sSize; i++)
-  {
-    sWZ[i] = aux & 1;
-    aux = aux >> 1;
-  }
-}
 void lcp_buildM(int * zw, double * M, double * Mref, int size)
 {
   int col;
@@ -76,8 +51,7 @@ void lcp_buildM(int * zw, double * M, double * Mref, int size)
     }
     else
     {
-      /*for(i=0;i<size;i++) Aux[i]=0;*/
-      memcpy(Aux, sColNul, sSize * sizeof(double));
+      memset(Aux, 0, size * sizeof(double));
       Aux[col] = -1;
       /*M[(n+col)*npm+col+n]=-1;*/
     }
@@ -103,41 +77,7 @@ void   lcp_fillSolution(double*  z, double * w, int size, int* zw, double * Q)
     }
   }
 }
-void lcp_initEnum()
-{
-  int cmp;
-  sCmpEnum = 0;
-  sNbCase = 1;
-  for (cmp = 0; cmp < sSize; cmp++)
-    sNbCase = sNbCase << 1;
-  sProgress = 0;
-}
-int lcp_nextEnum()
-{
-  if (sCmpEnum == sNbCase)
-    return 0;
-  if (sCurrentEnum >= sNbCase)
-  {
-    sCurrentEnum = 0;
-  }
-  if (verbose)
-    printf("try enum :%d\n", (int)sCurrentEnum);
-  affectWZ();
-  sCurrentEnum++;
-  sCmpEnum++;
-  if (verbose && sCmpEnum > (unsigned long int)sProgress * sNbCase)
-  {
-    sProgress += 0.001;
-    printf("lcp_enum progress %f %d \n", sProgress, (int) sCurrentEnum);
-  }
-
-  return 1;
-}
 
-void lcp_buildQ()
-{
-  memcpy(sQ, sQref, (sSize)*sizeof(double));
-}
 int lcp_enum_getNbIWork(LinearComplementarityProblem* problem, SolverOptions* options)
 {
   return 2 * (problem->size);
@@ -147,12 +87,10 @@ int lcp_enum_getNbDWork(LinearComplementarityProblem* problem, SolverOptions* op
   int aux = 3 * (problem->size) + (problem->size) * (problem->size);
   if (options->iparam[4])
   {
-    LWORK = -1;
     //int info = 0;
     double dgelsSize = 0;
     //DGELS(problem->M->size0, problem->size , 1, 0, problem->M->size0, 0, problem->M->size0, &dgelsSize, LWORK, &info);
     aux += (int) dgelsSize;
-    LWORK = (int) dgelsSize;
   }
   return aux;
 }
@@ -175,7 +113,16 @@ void lcp_enum_reset(LinearComplementarityProblem* problem, SolverOptions* option
   null_SolverOptions(options);
 }
 
-
+/*
+ *options:
+ * dparam[0] : (in) a positive value, tolerane about the sign.
+ * iparam[0] : (in) look for all the solutions (1) or stop at the first one (0).
+ * iparam[1] : (out) the code of the pattern found (see mlcp_enum_tool.h).
+ * iparam[2] : (out) the number of solutions found.
+ * iparam[3] : (in/out) the code of the pattern tried first, set to the pattern found.
+ * iparam[4] : (in) use DGELS (1) or DGESV (0).
+ * iparam[5] : (in) number of threads, 0 for the default (OpenMP only).
+ */
 void lcp_enum(LinearComplementarityProblem* problem, double *z, double *w, int *info , SolverOptions* options)
 {
   *info = 1;
@@ -187,15 +134,20 @@ void lcp_enum(LinearComplementarityProblem* problem, double *z, double *w, int *
   double * workingFloat = options->dWork;
   int * workingInt = options->iWork;
   int lin;
-  sSize = (problem->size);
+  int size = (problem->size);
   int NRHS = 1;
   int * ipiv;
   int check;
   int LAinfo = 0;
   int useDGELS = options->iparam[4];
+  double * M;
+  double * Q;
+  double * Qref;
+  double * Mref;
+  int * WZ;
 
   /*OUTPUT param*/
-  sCurrentEnum = options->iparam[3];
+  unsigned long long int first = (unsigned int) options->iparam[3];
   tol = options->dparam[0];
   int multipleSolutions = options->iparam[0];
   int numberofSolutions = 0;
@@ -203,33 +155,62 @@ void lcp_enum(LinearComplementarityProblem* problem, double *z, double *w, int *
 
 
 
-  sMref = problem->M->matrix0;
-  if (!sMref)
+  Mref = problem->M->matrix0;
+  if (!Mref)
   {
     printf("lcp_enum failed, problem->M->matrix0 is null");
 
   }
 
   if (verbose)
-    printf("lcp_enum begin, size %d tol %e\n", sSize, tol);
+    printf("lcp_enum begin, size %d tol %e\n", size, tol);
+
+  M = workingFloat;
+  Q = M + size * size;
+  Qref = Q + 2 * size;
+  for (lin = 0; lin < size; lin++)
+    Qref[lin] =  - problem->q[lin];
+  WZ = workingInt;
+  ipiv = WZ + size;
+  *info = 0;
 
-  sM = workingFloat;
-  sQ = sM + sSize * sSize;
-  sColNul = sQ + sSize;
-  sQref = sColNul + sSize;
-  for (lin = 0; lin < sSize; lin++)
+  if (!useDGELS && !multipleSolutions)
   {
-    sQref[lin] =  - problem->q[lin];
-    sColNul[lin] = 0;
+    /* LU updates from one pattern to the next one */
+    EnumSystem sys;
+    unsigned long long int code = 0;
+    sys.size = size;
+    sys.m = size;
+    sys.M = Mref;
+    sys.Q = Qref;
+    sys.indexInBlock = NULL;
+    sys.tol = tol;
+    sys.accept = NULL;
+    sys.data = NULL;
+    sys.nbThreads = options->iSize > 5 ? options->iparam[5] : 0;
+    sys.maxmod = 0;
+    if (enumSystem_solve(&sys, first, WZ, Q, &code))
+    {
+      if (verbose)
+        printf("lcp_enum find a solution with the pattern %llu!\n", code);
+      lcp_fillSolution(z, w, size, WZ, Q);
+      options->iparam[1] = (int) code;
+      options->iparam[2] = 1;
+      options->iparam[3] = (int) code;
+      return;
+    }
+    *info = 1;
+    if (verbose)
+      printf("lcp_enum has not found a solution!\n");
+    return;
   }
-  sWZ = workingInt;
-  ipiv = sWZ + sSize;
-  *info = 0;
-  lcp_initEnum();
-  while (lcp_nextEnum())
+
+  EnumerationStruct e;
+  initEnum(&e, size, first);
+  while (nextEnum(&e, WZ))
   {
-    lcp_buildM(sWZ, sM, sMref, sSize);
-    lcp_buildQ();
+    lcp_buildM(WZ, M, Mref, size);
+    memcpy(Q, Qref, size * sizeof(double));
     /*     if (verbose) */
     /*       printCurrentSystem(); */
     if (useDGELS)
@@ -238,21 +219,21 @@ void lcp_enum(LinearComplementarityProblem* problem, double *z, double *w, int *
       /*   { */
       /*     printf("call dgels on ||AX-B||\n"); */
       /*     printf("A\n"); */
-      /*     displayMat(sM,sSize,sSize,0); */
+      /*     displayMat(M,size,size,0); */
       /*     printf("B\n"); */
-      /*     displayMat(sQ,sSize,1,0); */
+      /*     displayMat(Q,size,1,0); */
       /*   } */
 
-      DGELS(LA_NOTRANS,sSize, sSize, NRHS, sM, sSize, sQ, sSize,&LAinfo);
+      DGELS(LA_NOTRANS,size, size, NRHS, M, size, Q, size,&LAinfo);
       if (verbose)
       {
         printf("Solution of dgels (info=%i)\n", LAinfo);
-        displayMat(sQ, sSize, 1, 0);
+        displayMat(Q, size, 1, 0);
       }
     }
     else
     {
-      DGESV(sSize, NRHS, sM, sSize, ipiv, sQ, sSize, &LAinfo);
+      DGESV(size, NRHS, M, size, ipiv, Q, size, &LAinfo);
     }
     if (!LAinfo)
     {
@@ -261,9 +242,9 @@ void lcp_enum(LinearComplementarityProblem* problem, double *z, double *w, int *
         int cc = 0;
         int ii;
         printf("DGELS LAInfo=%i\n", LAinfo);
-        for (ii = 0; ii < sSize; ii++)
+        for (ii = 0; ii < size; ii++)
         {
-          if (isnan(sQ[ii]) || isinf(sQ[ii]))
+          if (isnan(Q[ii]) || isinf(Q[ii]))
           {
             printf("DGELS FAILED\n");
             cc = 1;
@@ -280,9 +261,9 @@ void lcp_enum(LinearComplementarityProblem* problem, double *z, double *w, int *
       }
 
       check = 1;
-      for (lin = 0 ; lin < sSize; lin++)
+      for (lin = 0 ; lin < size; lin++)
       {
-        if (sQ[lin] < - tol)
+        if (Q[lin] < - tol)
         {
           check = 0;
           break;/*out of the cone!*/
@@ -295,13 +276,14 @@ void lcp_enum(LinearComplementarityProblem* problem, double *z, double *w, int *
         numberofSolutions++;
         if (verbose || multipleSolutions)
         {
-          printf("lcp_enum find %i solution with sCurrentEnum = %ld!\n", numberofSolutions, sCurrentEnum - 1);
+          printf("lcp_enum find %i solution with the pattern %llu!\n", numberofSolutions, e.pattern);
         }
 
 
-        lcp_fillSolution(z, w, sSize, sWZ, sQ);
-        options->iparam[1] = (int) sCurrentEnum - 1;
+        lcp_fillSolution(z, w, size, WZ, Q);
+        options->iparam[1] = (int) e.pattern;
         options->iparam[2] = numberofSolutions;
+        options->iparam[3] = (int) e.pattern;
         if (!multipleSolutions)  return;
       }
     }
@@ -325,15 +307,14 @@ int linearComplementarity_enum_setDefaultSolverOptions(LinearComplementarityProb
   options->numberOfInternalSolvers = 0;
   options->isSet = 1;
   options->filterOn = 1;
-  options->iSize = 5;
+  options->iSize = 6;
   options->dSize = 5;
   options->iparam = (int *)malloc(options->iSize * sizeof(int));
   options->dparam = (double *)malloc(options->dSize * sizeof(double));
-  for (i = 0; i < 5; i++)
-  {
+  for (i = 0; i < options->iSize; i++)
     options->iparam[i] = 0;
+  for (i = 0; i < options->dSize; i++)
     options->dparam[i] = 0.0;
-  }
   if (problem)
   {
     options->dWork = (double*) malloc(lcp_enum_getNbDWork(problem, options) * sizeof(double));
@@ -109,7 +109,10 @@ The enumeratif solver must be initialize: \n
 3) Reset the solver with  mlcp_driver_reset() .\n
  parameters:
 - dparam[0] (in): a positive value, tolerane about the sign.
+- iparam[1] (out): the code of the complementarity pattern found (see mlcp_enum_tool.h): its bit i is 1 if w[i] is the unknown (v[i] = 0), 0 if v[i] is the unknown (w[i] = 0). Unlike the iterative solvers above, this is not a number of iterations; it was left unset by the previous versions of mlcp_enum.
+- iparam[3] (in/out): the code of the pattern tried first. It is set to the pattern found, so that the next call starts from it.
 - iparam[4] (in) :  use DGELS (1) or DGESV (0).
+- iparam[6] (in): number of threads used by the enumeration, 0 for the OpenMP default.
 - dWork : working float zone size : The number of doubles is retruned by the function  mlcp_driver_get_dwork() . MUST BE ALLOCATED BY THE USER.
 - iWork : working int zone size : . The number of double is retruned by the function  mlcp_driver_get_iwork() . MUST BE ALLOCATED BY THE USER.
 
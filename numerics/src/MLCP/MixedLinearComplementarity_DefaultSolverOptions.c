@@ -40,6 +40,11 @@ void  mixedLinearComplementarity_default_setDefaultSolverOptions(MixedLinearComp
   pOptions->dparam = (double*)malloc(10 * sizeof(double));
   pOptions->numberOfInternalSolvers = 0;
   null_SolverOptions(pOptions);
+  for (int i = 0; i < 10; i++)
+  {
+    pOptions->iparam[i] = 0;
+    pOptions->dparam[i] = 0.0;
+  }
 
 
   pOptions->dparam[0] = 10 - 7;
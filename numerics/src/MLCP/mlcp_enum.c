@@ -39,80 +39,28 @@ dim(v)=nn
 //#define ENUM_USE_DGELS
 //#endif
 
-#ifdef MLCP_DEBUG
-static int *sLastIWork;
-static double *sLastDWork;
-#endif
-
-static double * sQ = 0;
-static double * sColNul = 0;
-static double * sM = 0;
-static double * sMref = 0;
-static double * sQref = 0;
-/* double working memory for dgels*/
-static double * sDgelsWork = 0;
-static int LWORK = 0;
-
-static int sNn = 0;
-static int sMm = 0;
-static int sMl = 0;
-static int* sW2V = 0;
-
-/*OUTPUT */
-/*sW2 is a pointer on the output w*/
-static double* sW2;
-/*sW1 is a pointer on the output w*/
-static double* sW1;
-/*sV is a pointer on the output v*/
-static double* sV;
-/*sU is a pointer on the output u*/
-static double* sU;
-
-static void buildQ(void);
-static void printCurrentSystem(void);
-static void printRefSystem(void);
-
-/*case defined with sCurrentEnum
- *if sW2V[i]==0
+/*case defined with the enumeration (see mlcp_enum_tool.h)
+ *if W2V[i]==0
  *  v[i] not null w2[i] null
  *else
  *  v[i] null and w2[i] not null
  */
-/* void affectW2V(){ */
-/*   unsigned long  int aux = sCurrentEnum; */
-/*   for (unsigned int i =0; i <sMm; i++){ */
-/*     sW2V[i]=aux & 1; */
-/*     aux = aux >> 1; */
-/*   } */
-
-/* } */
-/* void initEnum(){ */
-/*   int cmp; */
-/*   sCmpEnum=0;   */
-/*   sNbCase = 1; */
-/*   for (cmp=0;cmp<sMm;cmp++) */
-/*     sNbCase = sNbCase << 1; */
-/*   sProgress=0; */
-/* } */
-/* int nextEnum(){ */
-/*   if (sCmpEnum == sNbCase) */
-/*     return 0; */
-/*   if (sCurrentEnum >= sNbCase){ */
-/*     sCurrentEnum=0; */
-/*   } */
-/*   if (verbose) */
-/*     printf("try enum :%d\n",(int)sCurrentEnum); */
-/*   affectW2V(); */
-/*   sCurrentEnum++; */
-/*   sCmpEnum++; */
-/*   if (verbose && sCmpEnum > sProgress*sNbCase){ */
-/*     sProgress+=0.001; */
-/*     printf(" progress %f %d \n",sProgress,(int) sCurrentEnum); */
-/*   } */
-
-/*   return 1; */
-/* } */
 
+/* data of the final check of a solution found by enumSystem_solve */
+typedef struct
+{
+  MixedLinearComplementarityProblem* problem;
+  int* indexInBlock;
+  double tol;
+} MLCPEnumData;
+
+static void printCurrentSystem(double* M, double* Q, int n, int m, int NbLines);
+static void printRefSystem(double* Mref, double* Qref, int n, int m, int NbLines);
+static void mlcp_enum_fill(MixedLinearComplementarityProblem* problem, double* z, double* w,
+                           int* W2V, double* Q, int* indexInBlock);
+static int mlcp_enum_accept(void* data, int* W2V, double* sol, double* z, double* w);
+static void mlcp_enum_run(MixedLinearComplementarityProblem* problem, double *z, double *w,
+                          int *info, SolverOptions* options, int* indexInBlock);
 
 int mixedLinearComplementarity_enum_setDefaultSolverOptions(MixedLinearComplementarityProblem* problem, SolverOptions* pOPtionSolver)
 {
@@ -121,26 +69,19 @@ int mixedLinearComplementarity_enum_setDefaultSolverOptions(MixedLinearComplemen
   return 0;
 }
 
-
-void buildQ()
-{
-  memcpy(sQ, sQref, sMl * sizeof(double));
-}
-void printCurrentSystem()
+void printCurrentSystem(double* M, double* Q, int n, int m, int NbLines)
 {
-  int npm = sNn + sMm;
   printf("printCurrentSystemM:\n");
-  displayMat(sM, sMl, npm, 0);
+  displayMat(M, NbLines, n + m, 0);
   printf("printCurrentSystemQ (ie -Q from mlcp beause of linear system MZ=Q):\n");
-  displayMat(sQ, sMl, 1, 0);
+  displayMat(Q, NbLines, 1, 0);
 }
-void printRefSystem()
+void printRefSystem(double* Mref, double* Qref, int n, int m, int NbLines)
 {
-  int npm = sNn + sMm;
-  printf("ref M NbLines %d n %d  m %d :\n", sMl, sNn, sMm);
-  displayMat(sMref, sMl, npm, 0);
+  printf("ref M NbLines %d n %d  m %d :\n", NbLines, n, m);
+  displayMat(Mref, NbLines, n + m, 0);
   printf("ref Q (ie -Q from mlcp beause of linear system MZ=Q):\n");
-  displayMat(sQref, sMl, 1, 0);
+  displayMat(Qref, NbLines, 1, 0);
 }
 int mlcp_enum_getNbIWork(MixedLinearComplementarityProblem* problem, SolverOptions* options)
 {
@@ -150,10 +91,10 @@ int mlcp_enum_getNbIWork(MixedLinearComplementarityProblem* problem, SolverOptio
 }
 int mlcp_enum_getNbDWork(MixedLinearComplementarityProblem* problem, SolverOptions* options)
 {
+  int LWORK = 0;
   if (!problem)
     return 0;
   assert(problem->M);
-  LWORK = 0;
   if (options->iparam[4])
   {
     LWORK = -1;
@@ -165,11 +106,44 @@ int mlcp_enum_getNbDWork(MixedLinearComplementarityProblem* problem, SolverOptio
   return LWORK + 3 * (problem->M->size0) + (problem->n + problem->m) * (problem->M->size0); 
 }
 
+void mlcp_enum_fill(MixedLinearComplementarityProblem* problem, double* z, double* w,
+                    int* W2V, double* Q, int* indexInBlock)
+{
+  int NbLines = problem->M->size0;
+  if (indexInBlock || problem->blocksRows)
+    mlcp_fillSolution_Block(z, w, problem->n, problem->m, NbLines, W2V, Q, indexInBlock);
+  else
+    mlcp_fillSolution(z, z + problem->n, w, w + (NbLines - problem->m),
+                      problem->n, problem->m, NbLines, W2V, Q);
+}
+
+int mlcp_enum_accept(void* data, int* W2V, double* sol, double* z, double* w)
+{
+  MLCPEnumData* d = (MLCPEnumData*) data;
+  double err;
+  mlcp_enum_fill(d->problem, z, w, W2V, sol, d->indexInBlock);
+  mlcp_compute_error(d->problem, z, w, d->tol, &err);
+  /*because it happens the LU leads to an wrong solution witout raise any error.*/
+  if (err > 10 * d->tol)
+  {
+    if (verbose)
+      printf("LU no-error, but mlcp_compute_error out of tol: %e!\n", err);
+    return 0;
+  }
+  return 1;
+}
+
 /*
  * The are no memory allocation in mlcp_enum, all necessary memory must be allocated by the user.
+ * Without DGELS, the search allocates the memory of the updates of the
+ * LU factors (one per thread).
  *
  *options:
  * dparam[0] : (in) a positive value, tolerane about the sign.
+ * iparam[1] : (out) the code of the pattern found (see mlcp_enum_tool.h), if m < 32.
+ * iparam[3] : (in/out) the code of the pattern tried first, set to the pattern found.
+ * iparam[4] : (in) use DGELS (1) or DGESV (0).
+ * iparam[6] : (in) number of threads, 0 for the default (OpenMP only).
  * dWork : working float zone size : (nn+mm)*(nn+mm) + 3*(nn+mm). MUST BE ALLOCATED BY THE USER.
  * iWork : working int zone size : 2(nn+mm). MUST BE ALLOCATED BY THE USER.
  * double *z : size n+m
@@ -178,95 +152,130 @@ int mlcp_enum_getNbDWork(MixedLinearComplementarityProblem* problem, SolverOptio
 void mlcp_enum_Block(MixedLinearComplementarityProblem* problem, double *z, double *w, int *info, SolverOptions* options);
 void mlcp_enum(MixedLinearComplementarityProblem* problem, double *z, double *w, int *info, SolverOptions* options)
 {
-  int nbSol = 0;
   if (problem->blocksRows)
   {
     mlcp_enum_Block(problem, z, w, info, options);
     return;
   }
-  double tol ;
-  double * workingFloat = options->dWork;
-  int * workingInt = options->iWork;
-  int lin;
-  int npm = (problem->n) + (problem->m);
+  mlcp_enum_run(problem, z, w, info, options, NULL);
+}
+/*
+An adaptation of the previuos algorithm, to manage the case of MLCP-block formalization
+ */
+void mlcp_enum_Block(MixedLinearComplementarityProblem* problem, double *z, double *w, int *info, SolverOptions* options)
+{
+  int * indexInBlock = options->iWork + 2 * problem->m + problem->n;
+  assert(problem->M);
+  assert(problem->M->matrix0);
+  assert(problem->q);
+  if (problem->m == 0)
+    indexInBlock = 0;
+  else
+    mlcp_buildIndexInBlock(problem, indexInBlock);
+  mlcp_enum_run(problem, z, w, info, options, indexInBlock);
+}
+
+void mlcp_enum_run(MixedLinearComplementarityProblem* problem, double *z, double *w,
+                   int *info, SolverOptions* options, int* indexInBlock)
+{
+  int isBlock = (problem->blocksRows != NULL);
+  int Ml = problem->M->size0;
+  int Nn = problem->n;
+  int Mm = problem->m;
+  int npm = Nn + Mm;
   int NRHS = 1;
-  int * ipiv;
-  int check;
   int LAinfo = 0;
-  *info = 0;
-  sMl = problem->M->size0;
-  sNn = problem->n;
-  sMm = problem->m;
   int useDGELS = options->iparam[4];
-  /*OUTPUT param*/
-  sW1 = w;
-  sW2 = w + (sMl - problem->m); /*sW2 size :m */
-  sU = z;
-  sV = z + problem->n;
-  tol = options->dparam[0];
-
-  sMref = problem->M->matrix0;
-  /*  LWORK = 2*npm; LWORK >= max( 1, MN + max( MN, NRHS ) ) where MN = min(M,N)*/
-  //  verbose=1;
-  if (verbose)
-    printf("mlcp_enum begin, n %d m %d tol %lf\n", sNn, sMm, tol);
+  double tol = options->dparam[0];
+  double * Mref = problem->M->matrix0;
+  int lin;
+  int nbSol = 0;
 
-  sM = workingFloat;
-  /*  sQ = sM + npm*npm;*/
-  sQ = sM + (sNn + sMm) * sMl;
-  /*  sColNul = sQ + sMm +sNn;*/
-  sColNul = sQ + sMl;
-  /*  sQref = sColNul + sMm +sNn;*/
-  sQref = sColNul + sMl;
+  /* working memory */
+  double * M = options->dWork;
+  double * Q = M + npm * Ml;
+  double * Qref = Q + 2 * Ml;
+  int * W2V = options->iWork;
 
-  sDgelsWork = sQref + sMl;
+  *info = 0;
+  if (verbose)
+    printf("mlcp_enum begin, n %d m %d tol %lf\n", Nn, Mm, tol);
 
-  for (lin = 0; lin < sMl; lin++)
-    sQref[lin] =  - problem->q[lin];
-  for (lin = 0; lin < sMl; lin++)
-    sColNul[lin] = 0;
-  /*  printf("sColNul\n");
-      displayMat(sColNul,npm,1);*/
+  for (lin = 0; lin < Ml; lin++)
+    Qref[lin] =  - problem->q[lin];
   if (verbose)
-    printRefSystem();
-  sW2V = workingInt;
-  ipiv = sW2V + sMm;
+    printRefSystem(Mref, Qref, Nn, Mm, Ml);
 
-  initEnum(problem->m);
-  while (nextEnum(sW2V))
+  if (!useDGELS)
   {
-    mlcp_buildM(sW2V, sM, sMref, sNn, sMm, sMl);
-    buildQ();
-    if (verbose)
-      printCurrentSystem();
-    if (useDGELS)
+    /* square system: LU updates from one pattern to the next one */
+    EnumSystem sys;
+    MLCPEnumData data;
+    unsigned long long int code = 0;
+    assert(Ml == npm);
+    data.problem = problem;
+    data.indexInBlock = indexInBlock;
+    data.tol = tol;
+    sys.size = npm;
+    sys.m = Mm;
+    sys.M = Mref;
+    sys.Q = Qref;
+    sys.indexInBlock = indexInBlock;
+    sys.tol = tol;
+    sys.accept = &mlcp_enum_accept;
+    sys.data = &data;
+    sys.nbThreads = options->iSize > 6 ? options->iparam[6] : 0;
+    sys.maxmod = 0;
+    if (enumSystem_solve(&sys, (unsigned int) options->iparam[3], W2V, Q, &code))
     {
-      DGELS(LA_NOTRANS,sMl, npm, NRHS, sM, sMl, sQ, sMl, &LAinfo);
+      mlcp_enum_fill(problem, z, w, W2V, Q, indexInBlock);
+      if (Mm < 32)
+      {
+        options->iparam[1] = (int) code;
+        options->iparam[3] = (int) code;
+      }
       if (verbose)
       {
-        printf("Solution of dgels\n");
-        displayMat(sQ, sMl, 1, 0);
+        printf("mlcp_enum find a solution with the pattern %llu!\n", code);
+        if (isBlock)
+          mlcp_DisplaySolution_Block(z, w, Nn, Mm, Ml, indexInBlock);
+        else
+          mlcp_DisplaySolution(z, z + Nn, w, w + (Ml - Mm), Nn, Mm, Ml);
       }
+      return;
     }
-    else
+    *info = 1;
+    if (verbose)
+      printf("mlcp_enum failed!\n");
+    return;
+  }
+
+  {
+    EnumerationStruct e;
+    initEnum(&e, Mm, (unsigned int) options->iparam[3]);
+    while (nextEnum(&e, W2V))
     {
-      DGESV(npm, NRHS, sM, npm, ipiv, sQ, npm, &LAinfo);
+      if (isBlock)
+        mlcp_buildM_Block(W2V, M, Mref, Nn, Mm, Ml, indexInBlock);
+      else
+        mlcp_buildM(W2V, M, Mref, Nn, Mm, Ml);
+      memcpy(Q, Qref, Ml * sizeof(double));
+      if (verbose)
+        printCurrentSystem(M, Q, Nn, Mm, Ml);
+      DGELS(LA_NOTRANS,Ml, npm, NRHS, M, Ml, Q, Ml, &LAinfo);
       if (verbose)
       {
-        printf("Solution of dgesv\n");
-        displayMat(sQ, sMl, 1, 0);
+        printf("Solution of dgels\n");
+        displayMat(Q, Ml, 1, 0);
       }
-    }
-    if (!LAinfo)
-    {
-      if (useDGELS)
+      if (!LAinfo)
       {
         int cc = 0;
         int ii;
         double rest = 0;
         for (ii = 0; ii < npm; ii++)
         {
-          if (isnan(sQ[ii]) || isinf(sQ[ii]))
+          if (isnan(Q[ii]) || isinf(Q[ii]))
           {
             printf("DGELS FAILED\n");
             cc = 1;
@@ -276,9 +285,9 @@ void mlcp_enum(MixedLinearComplementarityProblem* problem, double *z, double *w,
         if (cc)
           continue;
 
-        if (sMl > npm)
+        if (Ml > npm)
         {
-          rest = cblas_dnrm2(sMl - npm, sQ + npm, 1);
+          rest = cblas_dnrm2(Ml - npm, Q + npm, 1);
 
           if (rest > tol || isnan(rest) || isinf(rest))
           {
@@ -289,232 +298,65 @@ void mlcp_enum(MixedLinearComplementarityProblem* problem, double *z, double *w,
           if (verbose)
             printf("DGELS, optimal point rest = %e\n", rest);
         }
-      }
-
-      if (verbose)
-      {
-        printf("Solving linear system success, solution in cone?\n");
-        displayMat(sQ, sMl, 1, 0);
-      }
 
-      check = 1;
-      for (lin = 0 ; lin < sMm; lin++)
-      {
-        if (sQ[sNn + lin] < - tol)
-        {
-          check = 0;
-          break;/*out of the cone!*/
-        }
-      }
-      if (!check)
-        continue;
-      else
-      {
-        double err;
-        mlcp_fillSolution(sU, sV, sW1, sW2, sNn, sMm, sMl, sW2V, sQ);
-        mlcp_compute_error(problem, z, w, tol, &err);
-        /*because it happens the LU leads to an wrong solution witout raise any error.*/
-        if (err > 10 * tol)
-        {
-          if (verbose)
-            printf("LU no-error, but mlcp_compute_error out of tol: %e!\n", err);
-          continue;
-        }
-        nbSol++;
         if (verbose)
         {
-          printf("mlcp_enum find a solution, err=%e !\n", err);
-          mlcp_DisplaySolution(sU, sV, sW1, sW2, sNn, sMm, sMl);
+          printf("Solving linear system success, solution in cone?\n");
+          displayMat(Q, Ml, 1, 0);
         }
-        // options->iparam[1]=sCurrentEnum-1;
-        return;
-      }
-    }
-    else
-    {
-      if (verbose)
-      {
-        printf("LU factorization failed:\n");
-      }
-    }
-  }
-  *info = 1;
-  if (verbose)
-    printf("mlcp_enum failed nbSol=%i!\n", nbSol);
-}
-/*
-An adaptation of the previuos algorithm, to manage the case of MLCP-block formalization
- */
-void mlcp_enum_Block(MixedLinearComplementarityProblem* problem, double *z, double *w, int *info, SolverOptions* options)
-{
-  double tol ;
-  double * workingFloat = options->dWork;
-  int * workingInt = options->iWork;
-  int lin;
-  int npm = (problem->n) + (problem->m);
-  int NRHS = 1;
-  int * ipiv;
-  int * indexInBlock;
-  int check;
-  int LAinfo = 0;
-  int useDGELS = options->iparam[4];
-  *info = 0;
-  assert(problem->M);
-  assert(problem->M->matrix0);
-  assert(problem->q);
-
-
-
-  sMl = problem->M->size0;
-  sNn = problem->n;
-  sMm = problem->m;
 
-  /*OUTPUT param*/
-  sW1 = w;
-  /*sW2=w+(sMl-problem->m); sW2 size :m */
-  sU = z;
-  tol = options->dparam[0];
-
-  sMref = problem->M->matrix0;
-  /*  LWORK = 2*npm; LWORK >= max( 1, MN + max( MN, NRHS ) ) where MN = min(M,N)*/
-  //  verbose=1;
-  if (verbose)
-    printf("mlcp_enum begin, n %d m %d tol %lf\n", sNn, sMm, tol);
-
-  sM = workingFloat;
-  /*  sQ = sM + npm*npm;*/
-  sQ = sM + (sNn + sMm) * sMl;
-  /*  sColNul = sQ + sMm +sNn;*/
-  sColNul = sQ + sMl;
-  /*  sQref = sColNul + sMm +sNn;*/
-  sQref = sColNul + sMl;
-
-  sDgelsWork = sQref + sMl;
-
-  for (lin = 0; lin < sMl; lin++)
-    sQref[lin] =  - problem->q[lin];
-  for (lin = 0; lin < sMl; lin++)
-    sColNul[lin] = 0;
-
-  /*  printf("sColNul\n");
-      displayMat(sColNul,npm,1);*/
-  if (verbose)
-    printRefSystem();
-  sW2V = workingInt;
-  ipiv = sW2V + sMm;
-  indexInBlock = ipiv + sMm + sNn;
-  if (sMm == 0)
-    indexInBlock = 0;
-  *info = 0;
-  mlcp_buildIndexInBlock(problem, indexInBlock);
-  initEnum(problem->m);
-  while (nextEnum(sW2V))
-  {
-    mlcp_buildM_Block(sW2V, sM, sMref, sNn, sMm, sMl, indexInBlock);
-    buildQ();
-    if (verbose)
-      printCurrentSystem();
-    if (useDGELS)
-    {
-      DGELS(LA_NOTRANS,sMl, npm, NRHS, sM, sMl, sQ, sMl,&LAinfo);
-      if (verbose)
-      {
-        printf("Solution of dgels\n");
-        displayMat(sQ, sMl, 1, 0);
-      }
-    }
-    else
-    {
-      DGESV(npm, NRHS, sM, npm, ipiv, sQ, npm, &LAinfo);
-      if (verbose)
-      {
-        printf("Solution of dgesv\n");
-        displayMat(sQ, sMl, 1, 0);
-      }
-    }
-    if (!LAinfo)
-    {
-      if (useDGELS)
-      {
-        int cc = 0;
-        int ii;
-        double rest = 0;
-        for (ii = 0; ii < npm; ii++)
+        int check = 1;
+        for (lin = 0 ; lin < Mm; lin++)
         {
-          if (isnan(sQ[ii]) || isinf(sQ[ii]))
+          if (Q[isBlock ? indexInBlock[lin] : Nn + lin] < - tol)
           {
-            printf("DGELS FAILED\n");
-            cc = 1;
-            break;
+            check = 0;
+            break;/*out of the cone!*/
           }
         }
-        if (cc)
+        if (!check)
           continue;
-
-        if (sMl > npm)
+        else
         {
-          rest = cblas_dnrm2(sMl - npm, sQ + npm, 1);
-
-          if (rest > tol || isnan(rest) || isinf(rest))
+          double err;
+          mlcp_enum_fill(problem, z, w, W2V, Q, indexInBlock);
+          mlcp_compute_error(problem, z, w, tol, &err);
+          /*because it happens the LU leads to an wrong solution witout raise any error.*/
+          if (err > 10 * tol)
           {
             if (verbose)
-              printf("DGELS, optimal point doesn't satisfy AX=b, rest = %e\n", rest);
+              printf("LU no-error, but mlcp_compute_error out of tol: %e!\n", err);
             continue;
           }
+          nbSol++;
+          if (Mm < 32)
+          {
+            options->iparam[1] = (int) e.pattern;
+            options->iparam[3] = (int) e.pattern;
+          }
           if (verbose)
-            printf("DGELS, optimal point rest = %e\n", rest);
-        }
-      }
-
-      if (verbose)
-      {
-        printf("Solving linear system success, solution in cone?\n");
-        displayMat(sQ, sMl, 1, 0);
-      }
-
-      check = 1;
-      for (lin = 0 ; lin < sMm; lin++)
-      {
-        if (sQ[indexInBlock[lin]] < - tol)
-        {
-          check = 0;
-          break;/*out of the cone!*/
+          {
+            printf("mlcp_enum find a solution, err=%e !\n", err);
+            if (isBlock)
+              mlcp_DisplaySolution_Block(z, w, Nn, Mm, Ml, indexInBlock);
+            else
+              mlcp_DisplaySolution(z, z + Nn, w, w + (Ml - Mm), Nn, Mm, Ml);
+          }
+          return;
         }
       }
-      if (!check)
-        continue;
       else
       {
-        double err;
-        mlcp_fillSolution_Block(sU, sW1, sNn, sMm, sMl, sW2V, sQ, indexInBlock);
-        mlcp_compute_error(problem, z, w, tol, &err);
-        /*because it happens the LU leads to an wrong solution witout raise any error.*/
-        if (err > 10 * tol)
-        {
-          if (verbose)
-            printf("LU no-error, but mlcp_compute_error out of tol: %e!\n", err);
-          continue;
-        }
         if (verbose)
         {
-          printf("mlcp_enum find a solution err = %e!\n", err);
-          mlcp_DisplaySolution_Block(sU, sW1, sNn, sMm, sMl, indexInBlock);
+          printf("LU factorization failed:\n");
         }
-        // options->iparam[1]=sCurrentEnum-1;
-        return;
-      }
-    }
-    else
-    {
-      if (verbose)
-      {
-        printf("LU factorization failed:\n");
       }
     }
   }
   *info = 1;
   if (verbose)
-    printf("mlcp_enum failed!\n");
+    printf("mlcp_enum failed nbSol=%i!\n", nbSol);
 }
 int mlcp_enum_alloc_working_memory(MixedLinearComplementarityProblem* problem, SolverOptions* options)
 {
@@ -1,64 +1,436 @@
 #include "mlcp_enum_tool.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
 #include "NumericsOptions.h"
+#include "SiconosLapack.h"
+#include "lumod_wrapper.h"
 
-static unsigned long long int sCurrentEnum = 0;
-static unsigned long long int sCmpEnum = 0;
-static unsigned long long int sNbCase = 0;
-static double sProgress = 0;
-static int sMm = 0;
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
-static void affectW2V(int * W2V);
+/* below this number of patterns, the enumeration is not split among threads */
+#define ENUM_PARALLEL_MIN_CASES 1024
+/* default maximum number of updated columns before a refactorization */
+#define ENUM_DEFAULT_MAXMOD 16
+/* relative residual above which a solution of the updated factors is
+ * computed again from a new factorization */
+#define ENUM_TOL_RESIDUAL 1e-12
 
-void initEnum(int M)
+unsigned long long int nbCasesEnum(int m)
 {
-  int cmp;
-  /*  sCurrentEnum = 0;*/
+  unsigned long long int nbCases = 1;
+  for (int cmp = 0; cmp < m; cmp++)
+    nbCases = nbCases << 1;
+  return nbCases;
+}
 
-  sCmpEnum = 0;
-  sNbCase = 1;
-  sMm = M;
+void initEnumRange(EnumerationStruct* e, int m, unsigned long long int first,
+                   unsigned long long int begin, unsigned long long int end)
+{
+  e->size = m;
+  e->first = first;
+  e->begin = begin;
+  e->current = begin;
+  e->end = end;
+  e->pattern = first;
+  e->flipped = -1;
+  e->progress = 0;
+}
 
-  for (cmp = 0; cmp < sMm; cmp++)
-    sNbCase = sNbCase << 1;
-  sProgress = 0;
+void initEnum(EnumerationStruct* e, int m, unsigned long long int first)
+{
+  initEnumRange(e, m, first, 0, nbCasesEnum(m));
 }
 
-void affectW2V(int * W2V)
+int nextEnum(EnumerationStruct* e, int* W2V)
 {
-  unsigned long  int aux = sCurrentEnum;
-  for (int i = 0; i < sMm; i++)
+  unsigned long long int rank = e->current;
+  if (rank >= e->end)
+    return 0;
+
+  e->pattern = e->first ^ rank ^ (rank >> 1);
+  if (rank == e->begin)
   {
-    W2V[i] = aux & 1;
-    aux = aux >> 1;
+    for (int i = 0; i < e->size; i++)
+      W2V[i] = (e->pattern >> i) & 1;
+    e->flipped = -1;
   }
+  else
+  {
+    /* gray(rank) ^ gray(rank - 1) is the lowest set bit of rank */
+    int i = 0;
+    unsigned long long int aux = rank;
+    while (!(aux & 1))
+    {
+      aux = aux >> 1;
+      i++;
+    }
+    W2V[i] = (e->pattern >> i) & 1;
+    e->flipped = i;
+  }
+
   if (verbose)
   {
-    for (int i = 0; i < sMm; i++)
-      printf("wv[%d]=%d \t", i, W2V[i]);
-    printf("\n");
+    printf("try enum :%llu\n", e->pattern);
+    if (e->current - e->begin > (unsigned long long int)(e->progress * (double)(e->end - e->begin)))
+    {
+      e->progress += 0.001;
+      printf(" progress %f %llu \n", e->progress, e->pattern);
+    }
   }
+  e->current++;
+  return 1;
+}
 
+/* Work memory of a search, one per thread */
+typedef struct
+{
+  SN_lumod_dense_data* lumod; /* LU factors of a pattern and the column updates */
+  int factorized; /* 1 if lumod holds valid factors */
+  int* slot; /* for each complementarity unknown, its index in the updates, -1 if its column is factorized */
+  int* owner; /* for each update, its complementarity unknown */
+  int* W2V;
+  int* ipiv;
+  double* H; /* the matrix of a pattern, for the final check */
+  double* col;
+  double* x;
+  double* sol;
+  double* z;
+  double* w;
+} EnumWork;
+
+/* The best solution found by the threads */
+typedef struct
+{
+  unsigned long long int rank;
+  int* W2V;
+  double* sol;
+} EnumResult;
+
+static EnumWork* enumWork_new(int n, int m, int maxmod)
+{
+  EnumWork* work = (EnumWork*) malloc(sizeof(EnumWork));
+  work->lumod = SN_lumod_dense_allocate(n, maxmod);
+  work->factorized = 0;
+  work->slot = (int*) malloc((2 * m + maxmod + n) * sizeof(int));
+  work->owner = work->slot + m;
+  work->W2V = work->owner + maxmod;
+  work->ipiv = work->W2V + m;
+  work->H = (double*) malloc((n * n + 5 * n) * sizeof(double));
+  work->col = work->H + n * n;
+  work->x = work->col + n;
+  work->sol = work->x + n;
+  work->z = work->sol + n;
+  work->w = work->z + n;
+  return work;
+}
+
+static void enumWork_free(EnumWork* work)
+{
+  SM_lumod_dense_free(work->lumod);
+  free(work->slot);
+  free(work->H);
+  free(work);
+}
+
+static int enum_position(EnumSystem* sys, int i)
+{
+  return sys->indexInBlock ? sys->indexInBlock[i] : sys->size - sys->m + i;
 }
 
-int nextEnum(int * W2V)
+/* matrix of the linear system of the pattern W2V */
+static void enum_buildH(EnumSystem* sys, int* W2V, double* H)
 {
-  if (sCmpEnum == sNbCase)
+  int n = sys->size;
+  memcpy(H, sys->M, n * n * sizeof(double));
+  for (int i = 0; i < sys->m; i++)
+  {
+    if (W2V[i])
+    {
+      int pos = enum_position(sys, i);
+      memset(H + pos * n, 0, n * sizeof(double));
+      H[pos * n + pos] = -1.;
+    }
+  }
+}
+
+/* column of the i-th complementarity unknown */
+static void enum_buildColumn(EnumSystem* sys, int i, int isW, double* col)
+{
+  int n = sys->size;
+  int pos = enum_position(sys, i);
+  if (isW)
+  {
+    memset(col, 0, n * sizeof(double));
+    col[pos] = -1.;
+  }
+  else
+    memcpy(col, sys->M + pos * n, n * sizeof(double));
+}
+
+/* Factorize the matrix of the pattern W2V. Return 0 on success. */
+static int enum_factorize(EnumSystem* sys, int* W2V, EnumWork* work)
+{
+  SN_lumod_dense_data* lumod = work->lumod;
+  int n = sys->size;
+  int info = 0;
+  enum_buildH(sys, W2V, lumod->LU_H);
+  DGETRF(n, n, lumod->LU_H, n, lumod->ipiv_LU_H, &info);
+  lumod->k = 0;
+  memset(lumod->Uk, 0, lumod->maxmod * n * sizeof(double));
+  for (int i = 0; i < sys->m; i++)
+    work->slot[i] = -1;
+  work->factorized = (info == 0);
+  if (info && verbose)
+    printf("enum: the matrix of the pattern is singular.\n");
+  return info;
+}
+
+/* The i-th complementarity unknown has changed: update the factors.
+ * Return 0 on success. */
+static int enum_update(EnumSystem* sys, int* W2V, int i, EnumWork* work)
+{
+  SN_lumod_dense_data* lumod = work->lumod;
+  int n = sys->size;
+  int info = 0;
+  int j = work->slot[i];
+  if (j < 0)
+  {
+    /* the column differs from the factorized one: one more update */
+    if (lumod->k >= lumod->maxmod)
+      return enum_factorize(sys, W2V, work);
+    enum_buildColumn(sys, i, W2V[i], work->col);
+    DGETRS(LA_NOTRANS, n, 1, lumod->LU_H, n, lumod->ipiv_LU_H, work->col, n, &info);
+    if (info)
+      return enum_factorize(sys, W2V, work);
+    work->slot[i] = lumod->k;
+    work->owner[lumod->k] = i;
+    SN_lumod_add_row_col(lumod, enum_position(sys, i), work->col);
+  }
+  else
+  {
+    /* back to the factorized column: remove the update, the last
+     * update takes its place */
+    int last = lumod->k - 1;
+    SN_lumod_delete_row_col(lumod, j, j);
+    if (j != last)
+    {
+      work->slot[work->owner[last]] = j;
+      work->owner[j] = work->owner[last];
+    }
+    work->slot[i] = -1;
+  }
+  return 0;
+}
+
+static int enum_inCone(EnumSystem* sys, double* x)
+{
+  for (int i = 0; i < sys->m; i++)
+  {
+    if (x[enum_position(sys, i)] < - sys->tol)
+      return 0;/*out of the cone!*/
+  }
+  return 1;
+}
+
+/* Relative residual of the solution x of the pattern W2V */
+static double enum_residual(EnumSystem* sys, int* W2V, double* x, double* r)
+{
+  int n = sys->size;
+  double normQ = 0., normHx = 0., normR = 0.;
+  memcpy(r, sys->Q, n * sizeof(double));
+  for (int j = 0; j < n; j++)
+  {
+    const double* Mj = sys->M + j * n;
+    for (int i = 0; i < n; i++)
+      r[i] -= Mj[i] * x[j];
+  }
+  for (int i = 0; i < sys->m; i++)
+  {
+    if (W2V[i])
+    {
+      /* the column of this unknown is -e_pos instead of M[:, pos] */
+      int pos = enum_position(sys, i);
+      const double* Mj = sys->M + pos * n;
+      for (int k = 0; k < n; k++)
+        r[k] += Mj[k] * x[pos];
+      r[pos] -= x[pos];
+    }
+  }
+  for (int i = 0; i < n; i++)
+  {
+    normQ += sys->Q[i] * sys->Q[i];
+    normHx += (sys->Q[i] - r[i]) * (sys->Q[i] - r[i]);
+    normR += r[i] * r[i];
+  }
+  return sqrt(normR) / (1. + sqrt(normQ) + sqrt(normHx));
+}
+
+/* Solve the system of the current pattern with the updated factors.
+ * The updates may be inaccurate when the matrix of the small system is
+ * ill-conditioned: the factors are then computed again, so that the
+ * filter on the sign of the solution agrees with enum_confirm. */
+static int enum_solveCurrent(EnumSystem* sys, EnumWork* work)
+{
+  int n = sys->size;
+  memcpy(work->x, sys->Q, n * sizeof(double));
+  int info = SN_lumod_dense_solve(work->lumod, work->x, NULL);
+  if (SN_lumod_need_refactorization(info)
+      || (!info && work->lumod->k > 0
+          && !(enum_residual(sys, work->W2V, work->x, work->col) <= ENUM_TOL_RESIDUAL)))
+  {
+    if (enum_factorize(sys, work->W2V, work))
+      return 1;
+    memcpy(work->x, sys->Q, n * sizeof(double));
+    info = SN_lumod_dense_solve(work->lumod, work->x, NULL);
+  }
+  return info;
+}
+
+/* A candidate is solved again from scratch, so that the solution does
+ * not suffer from the accumulated updates. */
+static int enum_confirm(EnumSystem* sys, EnumWork* work)
+{
+  int n = sys->size;
+  int info = 0;
+  enum_buildH(sys, work->W2V, work->H);
+  memcpy(work->sol, sys->Q, n * sizeof(double));
+  DGESV(n, 1, work->H, n, work->ipiv, work->sol, n, &info);
+  if (info)
     return 0;
-  if (sCurrentEnum >= sNbCase)
+  for (int i = 0; i < n; i++)
   {
-    sCurrentEnum = 0;
+    if (isnan(work->sol[i]) || isinf(work->sol[i]))
+      return 0;
   }
-  if (verbose)
-    printf("try enum :%d\n", (int)sCurrentEnum);
-  affectW2V(W2V);
-  sCurrentEnum++;
-  sCmpEnum++;
-  if (verbose && sCmpEnum > (unsigned long int)sProgress * sNbCase)
+  if (!enum_inCone(sys, work->sol))
+    return 0;
+  if (sys->accept && !sys->accept(sys->data, work->W2V, work->sol, work->z, work->w))
+    return 0;
+  return 1;
+}
+
+/* Visit the patterns of rank begin to end - 1, stop at the first
+ * solution or when a solution of lower rank has been found. */
+static void enum_search(EnumSystem* sys, unsigned long long int first,
+                        unsigned long long int begin, unsigned long long int end,
+                        EnumWork* work, EnumResult* result)
+{
+  EnumerationStruct e;
+  unsigned long long int best;
+  initEnumRange(&e, sys->m, first, begin, end);
+  work->factorized = 0;
+  while (nextEnum(&e, work->W2V))
   {
-    sProgress += 0.001;
-    printf(" progress %f %d \n", sProgress, (int) sCurrentEnum);
+    unsigned long long int rank = e.current - 1;
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+    best = result->rank;
+    if (rank > best)
+      return;
+
+    if (work->factorized && e.flipped >= 0)
+    {
+      if (enum_update(sys, work->W2V, e.flipped, work))
+        continue;
+    }
+    else if (enum_factorize(sys, work->W2V, work))
+      continue;
+
+    if (enum_solveCurrent(sys, work))
+      continue;
+    if (!enum_inCone(sys, work->x))
+      continue;
+    if (!enum_confirm(sys, work))
+      continue;
+
+#ifdef _OPENMP
+#pragma omp critical(enum_result)
+#endif
+    {
+      if (rank < result->rank)
+      {
+        memcpy(result->W2V, work->W2V, sys->m * sizeof(int));
+        memcpy(result->sol, work->sol, sys->size * sizeof(double));
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+        result->rank = rank;
+      }
+    }
+    return;
   }
+}
+
+int enumSystem_solve(EnumSystem* sys, unsigned long long int first,
+                     int* W2V, double* sol, unsigned long long int* code)
+{
+  int n = sys->size;
+  int m = sys->m;
+  unsigned long long int nbCases = nbCasesEnum(m);
+  int maxmod = sys->maxmod > 0 ? sys->maxmod : ENUM_DEFAULT_MAXMOD;
+  int nbThreads = 1;
+  EnumResult result;
+  EnumWork* work;
 
+  if (n == 0)
+  {
+    *code = 0;
+    return 1;
+  }
+  if (maxmod > m)
+    maxmod = m;
+  if (maxmod < 1)
+    maxmod = 1;
+  first = first & (nbCases - 1);
+
+#ifdef _OPENMP
+  nbThreads = (sys->nbThreads > 0) ? sys->nbThreads : omp_get_max_threads();
+  if (nbCases < ENUM_PARALLEL_MIN_CASES)
+    nbThreads = 1;
+#endif
+
+  result.rank = nbCases;
+  result.W2V = W2V;
+  result.sol = sol;
+
+  /* The first pattern, in general the one of the previous call, is
+   * tried alone. */
+  work = enumWork_new(n, m, maxmod);
+  enum_search(sys, first, 0, 1, work, &result);
+
+  if (result.rank == nbCases && nbCases > 1)
+  {
+    if (nbThreads > 1)
+    {
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nbThreads)
+      {
+        int t = omp_get_thread_num();
+        int nt = omp_get_num_threads();
+        unsigned long long int chunk = (nbCases - 1 + nt - 1) / nt;
+        unsigned long long int begin = 1 + t * chunk;
+        unsigned long long int end = begin + chunk < nbCases ? begin + chunk : nbCases;
+        EnumWork* threadWork = t ? enumWork_new(n, m, maxmod) : work;
+        if (begin < end)
+          enum_search(sys, first, begin, end, threadWork, &result);
+        if (t)
+          enumWork_free(threadWork);
+      }
+#endif
+    }
+    else
+      enum_search(sys, first, 1, nbCases, work, &result);
+  }
+  enumWork_free(work);
+
+  if (result.rank == nbCases)
+    return 0;
+  *code = first ^ result.rank ^ (result.rank >> 1);
   return 1;
 }
@@ -1,9 +1,111 @@
-
 #ifndef MLCP_ENUM_TOOL_H
 #define MLCP_ENUM_TOOL_H
 
+/* Enumeration of the complementarity patterns, shared by mlcp_enum and
+ * lcp_enum.
+ *
+ * A pattern W2V of size m tells for each complementarity index i if
+ * v[i] (or z[i] for a LCP) is the unknown (W2V[i] == 0) or w2[i] is the
+ * unknown (W2V[i] == 1). Its code is the integer whose bit i is W2V[i].
+ *
+ * The 2^m patterns are visited in a Gray code order starting from a
+ * given pattern: the rank r gives the pattern first ^ r ^ (r >> 1), so
+ * that two consecutive patterns differ by exactly one component and
+ * the pattern of rank 0 is the first one. There is no global state:
+ * several enumerations may run at the same time.
+ */
+
+#include "SiconosConfig.h"
+
+#if defined(__cplusplus) && !defined(BUILD_AS_CPP)
+extern "C"
+{
+#endif
+
+  /** State of an enumeration */
+  typedef struct
+  {
+    unsigned long long int first; /**< code of the pattern of rank 0 */
+    unsigned long long int begin; /**< rank of the first visited pattern */
+    unsigned long long int current; /**< rank of the next pattern */
+    unsigned long long int end; /**< rank after the last pattern */
+    unsigned long long int pattern; /**< code of the last returned pattern */
+    int flipped; /**< component changed by the last nextEnum(), -1 if the pattern was set entirely */
+    int size; /**< number of components */
+    double progress;
+  } EnumerationStruct;
+
+  /** A square linear system built from a pattern: the column (and row)
+   * of the i-th complementarity unknown is indexInBlock[i] (or n + i if
+   * indexInBlock is null). It is the column of M if W2V[i] == 0, else
+   * it is -e_{indexInBlock[i]}. The other columns are those of M.
+   */
+  typedef struct
+  {
+    int size; /**< number of unknowns and of equations */
+    int m; /**< number of complementarity unknowns */
+    double* M; /**< the matrix, size x size column major */
+    double* Q; /**< the right hand side (-q) */
+    int* indexInBlock; /**< index of the complementarity unknowns, may be null */
+    double tol; /**< tolerance about the sign of the complementarity unknowns */
+    /** final check of a solution, may be null. z and w are work
+     *  vectors of size size. Return 1 if the solution is accepted */
+    int (*accept)(void* data, int* W2V, double* sol, double* z, double* w);
+    void* data; /**< first argument of accept */
+    int nbThreads; /**< number of threads, 0 for the default */
+    int maxmod; /**< maximum number of columns updated before a refactorization, 0 for the default */
+  } EnumSystem;
+
+  /** \return the number of patterns of size m */
+  unsigned long long int nbCasesEnum(int m);
+
+  /** start the enumeration of all the patterns of size m
+   * \param e the enumeration
+   * \param m the number of components
+   * \param first the code of the first pattern
+   */
+  void initEnum(EnumerationStruct* e, int m, unsigned long long int first);
+
+  /** start the enumeration of the patterns of rank begin to end - 1
+   * \param e the enumeration
+   * \param m the number of components
+   * \param first the code of the pattern of rank 0
+   * \param begin the first rank
+   * \param end the rank after the last one
+   */
+  void initEnumRange(EnumerationStruct* e, int m, unsigned long long int first,
+                     unsigned long long int begin, unsigned long long int end);
+
+  /** go to the next pattern
+   * \param e the enumeration
+   * \param[in,out] W2V the pattern. Only the flipped component is
+   * written, except for the first pattern of the enumeration
+   * \return 0 if all the patterns have been visited, else 1
+   */
+  int nextEnum(EnumerationStruct* e, int* W2V);
+
+  /** Look for a pattern such that the solution of the linear system
+   * of EnumSystem has non negative complementarity unknowns.
+   *
+   * The pattern first is tried first, then the others in the Gray code
+   * order. From one pattern to the next, one column of the matrix
+   * changes: the LU factors are updated (see lumod_wrapper.h) rather
+   * than recomputed. With OpenMP, the ranks are split among the
+   * threads, and the solution of lowest rank is returned, so that the
+   * result does not depend on the number of threads.
+   *
+   * \param sys the linear system
+   * \param first the code of the first pattern tried
+   * \param[out] W2V the pattern found (size m)
+   * \param[out] sol the solution of the system with this pattern (size size)
+   * \param[out] code the code of the pattern found
+   * \return 1 if a pattern has been found, else 0
+   */
+  int enumSystem_solve(EnumSystem* sys, unsigned long long int first,
+                       int* W2V, double* sol, unsigned long long int* code);
 
-void initEnum(int M);
-int nextEnum(int * W2V);
+#if defined(__cplusplus) && !defined(BUILD_AS_CPP)
+}
+#endif
 
-#endif //MLCP_ENUM_H
+#endif //MLCP_ENUM_TOOL_H
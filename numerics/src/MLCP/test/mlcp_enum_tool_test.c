@@ -0,0 +1,281 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/*
+  Tests of enumSystem_solve: the pattern found is the first one in the
+  Gray code order that a direct solve per pattern accepts, whatever the
+  number of column updates before a refactorization and the number of
+  threads, and several systems may be solved at the same time. The warm
+  start of lcp_enum through iparam[3] is checked on a LCP with three
+  solutions.
+*/
+
+#undef NDEBUG
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "SiconosLapack.h"
+#include "mlcp_enum_tool.h"
+#include "LCP_Solvers.h"
+#include "NumericsMatrix.h"
+
+#define NB_SYSTEMS 60
+#define TOL 1e-12
+
+typedef struct
+{
+  int n;
+  double* M;
+  double* Q;
+  unsigned long long int first;
+} TestSystem;
+
+/* the first pattern of the Gray code order from first whose system,
+   solved with DGESV, has non negative complementarity unknowns */
+static int reference_pattern(TestSystem* s)
+{
+  int n = s->n;
+  double* H = (double*) malloc(n * n * sizeof(double));
+  double* x = (double*) malloc(n * sizeof(double));
+  int* ipiv = (int*) malloc(n * sizeof(int));
+  int found = -1;
+  unsigned long long int nbCases = nbCasesEnum(n);
+  for (unsigned long long int rank = 0; rank < nbCases && found < 0; rank++)
+  {
+    unsigned long long int pattern = s->first ^ rank ^ (rank >> 1);
+    int info = 0;
+    memcpy(H, s->M, n * n * sizeof(double));
+    memcpy(x, s->Q, n * sizeof(double));
+    for (int i = 0; i < n; i++)
+    {
+      if ((pattern >> i) & 1)
+      {
+        memset(H + i * n, 0, n * sizeof(double));
+        H[i * n + i] = -1.0;
+      }
+    }
+    DGESV(n, 1, H, n, ipiv, x, n, &info);
+    if (info)
+      continue;
+    found = (int) pattern;
+    for (int i = 0; i < n; i++)
+    {
+      if (x[i] < -TOL || isnan(x[i]))
+        found = -1;
+    }
+  }
+  free(H);
+  free(x);
+  free(ipiv);
+  return found;
+}
+
+/* random systems, with a dominant diagonal, with a null diagonal and
+   with many null entries, so that singular patterns are met */
+static void build_system(TestSystem* s, int k)
+{
+  int n = 1 + rand() % 13;
+  int kind = k % 3;
+  s->n = n;
+  s->M = (double*) malloc(n * n * sizeof(double));
+  s->Q = (double*) malloc(n * sizeof(double));
+  for (int i = 0; i < n * n; i++)
+    s->M[i] = rand() / (double) RAND_MAX - 0.5;
+  for (int i = 0; i < n; i++)
+  {
+    if (kind == 0)
+      s->M[i * n + i] += n;
+    else if (kind == 2)
+      s->M[i * n + i] = 0.0;
+    s->Q[i] = rand() / (double) RAND_MAX - 0.5;
+  }
+  if (kind == 2)
+  {
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < n; j++)
+        if ((i + j) % 3 == 0)
+          s->M[i + j * n] = 0.0;
+  }
+  s->first = rand() % nbCasesEnum(n);
+}
+
+static int solve(TestSystem* s, int nbThreads, int maxmod, double* sol)
+{
+  EnumSystem sys;
+  sys.size = s->n;
+  sys.m = s->n;
+  sys.M = s->M;
+  sys.Q = s->Q;
+  sys.indexInBlock = NULL;
+  sys.tol = TOL;
+  sys.accept = NULL;
+  sys.data = NULL;
+  sys.nbThreads = nbThreads;
+  sys.maxmod = maxmod;
+  int* W2V = (int*) malloc(s->n * sizeof(int));
+  unsigned long long int code = 0;
+  int found = enumSystem_solve(&sys, s->first, W2V, sol, &code);
+  for (int i = 0; found && i < s->n; i++)
+    assert(W2V[i] == (int)((code >> i) & 1));
+  free(W2V);
+  return found ? (int) code : -1;
+}
+
+/* the result does not depend on maxmod, that is on the number of
+   column updates between two factorizations, nor on the number of
+   threads */
+static int test_patterns(TestSystem* systems)
+{
+  int info = 0;
+  double* sol = (double*) malloc(13 * sizeof(double));
+  double* sol1 = (double*) malloc(13 * sizeof(double));
+  for (int k = 0; k < NB_SYSTEMS; k++)
+  {
+    TestSystem* s = &systems[k];
+    int ref = reference_pattern(s);
+    for (int maxmod = 1; maxmod <= 5; maxmod++)
+    {
+      int code = solve(s, 1, maxmod, sol1);
+      if (code != ref)
+      {
+        printf("system %i, maxmod %i: pattern %i, expected %i\n", k, maxmod, code, ref);
+        info = 1;
+      }
+    }
+    for (int nbThreads = 2; nbThreads <= 4; nbThreads++)
+    {
+      int code = solve(s, nbThreads, 0, sol);
+      if (code != ref)
+      {
+        printf("system %i, %i threads: pattern %i, expected %i\n", k, nbThreads, code, ref);
+        info = 1;
+      }
+      else if (code >= 0 && memcmp(sol, sol1, s->n * sizeof(double)))
+      {
+        printf("system %i, %i threads: the solution differs\n", k, nbThreads);
+        info = 1;
+      }
+    }
+  }
+  free(sol);
+  free(sol1);
+  return info;
+}
+
+/* systems solved at the same time give the results of a sequential
+   loop */
+static int test_reentrancy(TestSystem* systems)
+{
+  int codes[NB_SYSTEMS];
+  int info = 0;
+  int k;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(4) schedule(dynamic, 1)
+#endif
+  for (k = 0; k < NB_SYSTEMS; k++)
+  {
+    double sol[13];
+    codes[k] = solve(&systems[k], 1, 0, sol);
+  }
+  for (k = 0; k < NB_SYSTEMS; k++)
+  {
+    double sol[13];
+    if (codes[k] != solve(&systems[k], 1, 0, sol))
+    {
+      printf("system %i: the concurrent solve differs\n", k);
+      info = 1;
+    }
+  }
+  return info;
+}
+
+/* w = M z + q with the solutions z = (1, 0), (0, 1) and (1/3, 1/3):
+   the one returned is the first pattern met from iparam[3] */
+static int test_warm_start(void)
+{
+  double M[4] = {1.0, 2.0, 2.0, 1.0};
+  double q[2] = {-1.0, -1.0};
+  double z[2], w[2];
+  int info = 0, lcpinfo = 0;
+
+  LinearComplementarityProblem problem;
+  problem.size = 2;
+  problem.M = createNumericsMatrixFromData(NM_DENSE, 2, 2, M);
+  problem.q = q;
+
+  SolverOptions options;
+  linearComplementarity_enum_setDefaultSolverOptions(&problem, &options);
+  options.dparam[0] = TOL;
+  options.iparam[5] = 1;
+
+  /* code 1: w_0 and z_1 are the unknowns */
+  options.iparam[3] = 1;
+  lcp_enum(&problem, z, w, &lcpinfo, &options);
+  if (lcpinfo || fabs(z[0]) > TOL || fabs(z[1] - 1.0) > TOL || options.iparam[1] != 1)
+  {
+    printf("warm start from pattern 1: z = (%g, %g), pattern %i\n", z[0], z[1], options.iparam[1]);
+    info = 1;
+  }
+  /* iparam[3] is the pattern found: the same solution is found again */
+  lcp_enum(&problem, z, w, &lcpinfo, &options);
+  if (lcpinfo || options.iparam[3] != 1 || fabs(z[1] - 1.0) > TOL)
+    info = 1;
+
+  options.iparam[3] = 2;
+  lcp_enum(&problem, z, w, &lcpinfo, &options);
+  if (lcpinfo || fabs(z[0] - 1.0) > TOL || fabs(z[1]) > TOL || options.iparam[1] != 2)
+  {
+    printf("warm start from pattern 2: z = (%g, %g), pattern %i\n", z[0], z[1], options.iparam[1]);
+    info = 1;
+  }
+
+  options.iparam[3] = 0;
+  lcp_enum(&problem, z, w, &lcpinfo, &options);
+  if (lcpinfo || fabs(z[0] - 1.0 / 3.0) > TOL || fabs(z[1] - 1.0 / 3.0) > TOL || options.iparam[1] != 0)
+  {
+    printf("warm start from pattern 0: z = (%g, %g), pattern %i\n", z[0], z[1], options.iparam[1]);
+    info = 1;
+  }
+
+  lcp_enum_reset(&problem, &options, 1);
+  free(problem.M);
+  return info;
+}
+
+int main(void)
+{
+  TestSystem systems[NB_SYSTEMS];
+  int info = 0;
+  srand(3);
+  for (int k = 0; k < NB_SYSTEMS; k++)
+    build_system(&systems[k], k);
+
+  info += test_patterns(systems);
+  info += test_reentrancy(systems);
+  info += test_warm_start();
+
+  for (int k = 0; k < NB_SYSTEMS; k++)
+  {
+    free(systems[k].M);
+    free(systems[k].Q);
+  }
+  printf("End of test of enumSystem_solve: %s\n", info ? "failed" : "success");
+  return info;
+}
@@ -258,33 +258,24 @@ DMUMPS_STRUC_C* NM_MUMPS_id(NumericsMatrix* A)
     //mumps_id->CNTL(3) = ...;
     //mumps_id->CNTL(5) = ...;
 
-    mumps_id = (DMUMPS_STRUC_C*) params->solver_data;
-    mumps_id->n = (int) NM_triplet(A)->n;
-    mumps_id->irn = NM_MUMPS_irn(A);
-    mumps_id->jcn = NM_MUMPS_jcn(A);
+  }
 
-    int nz;
-    if (NM_sparse(A)->triplet)
-    {
-      nz = (int) NM_sparse(A)->triplet->nz;
-      mumps_id->nz = nz;
-      mumps_id->a = NM_sparse(A)->triplet->x;
-    }
-    else
-    {
-      nz = NM_linearSolverParams(A)->iWork[2 * NM_csc(A)->nzmax];
-      mumps_id->nz = nz;
-      mumps_id->a = NM_sparse(A)->csc->x;
-    }
+  /* the matrix storage may have been rebuilt since the previous call,
+   * for instance with the same pattern and new values */
+  mumps_id = (DMUMPS_STRUC_C*) params->solver_data;
+  mumps_id->n = (int) NM_triplet(A)->n;
+  mumps_id->irn = NM_MUMPS_irn(A);
+  mumps_id->jcn = NM_MUMPS_jcn(A);
+
+  if (NM_sparse(A)->triplet)
+  {
+    mumps_id->nz = (int) NM_sparse(A)->triplet->nz;
+    mumps_id->a = NM_sparse(A)->triplet->x;
   }
   else
   {
-    mumps_id = (DMUMPS_STRUC_C*) params->solver_data;
-    DEBUG_EXPR_WE(double data_ptr = NULL;
-        if (NM_sparse(A)->triplet) { data_ptr = NM_sparse(A)->triplet->x; }
-        else { data_ptr = NM_sparse(A)->csc->x; }
-        if (data_ptr != mumps_id->a) { fprintf(stderr, "the data array and mumps_id->a don't match: %p != %p\n", data_ptr, mumps_id-a); } )
-
+    mumps_id->nz = NM_linearSolverParams(A)->iWork[2 * NM_csc(A)->nzmax];
+    mumps_id->a = NM_sparse(A)->csc->x;
   }
 
   return mumps_id;
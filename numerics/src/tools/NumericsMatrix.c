@@ -22,6 +22,7 @@
 #include <math.h>
 #include <stdint.h>
 #include <string.h>
+#include <time.h>
 
 #include "NumericsMatrix.h"
 #include "NumericsMatrix_private.h"
@@ -33,6 +34,10 @@
 //#define DEBUG_MESSAGES
 #include "debug.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 void prodNumericsMatrix(int sizeX, int sizeY, double alpha, NumericsMatrix* A, const double* const x, double beta, double* y)
 {
 
@@ -629,7 +634,7 @@ NumericsMatrix* duplicateNumericsMatrix(NumericsMatrix* mat)
       data = malloc(size0*size1*sizeof(double));
       break;
     case NM_SPARSE_BLOCK:
-      data = malloc(sizeof(SparseBlockStructuredMatrix));
+      data = newSBM();
       break;
     case NM_SPARSE:
       data = malloc(sizeof(CSparseMatrix));
@@ -921,6 +926,22 @@ void NM_copy_to_sparse(const NumericsMatrix* const A, NumericsMatrix* B)
   }
 }
 
+/* 1 if A and B have the same blocks, of the same sizes, at the same places */
+static int NM_SBM_same_pattern(const SparseBlockStructuredMatrix* const A,
+                               const SparseBlockStructuredMatrix* const B)
+{
+  return A->nbblocks == B->nbblocks &&
+    A->blocknumber0 == B->blocknumber0 &&
+    A->blocknumber1 == B->blocknumber1 &&
+    A->filled1 == B->filled1 &&
+    A->filled2 == B->filled2 &&
+    B->block &&
+    !memcmp(A->blocksize0, B->blocksize0, A->blocknumber0 * sizeof(unsigned int)) &&
+    !memcmp(A->blocksize1, B->blocksize1, A->blocknumber1 * sizeof(unsigned int)) &&
+    !memcmp(A->index1_data, B->index1_data, A->filled1 * sizeof(size_t)) &&
+    !memcmp(A->index2_data, B->index2_data, A->filled2 * sizeof(size_t));
+}
+
 void NM_copy(const NumericsMatrix* const A, NumericsMatrix* B)
 {
   assert(A);
@@ -955,105 +976,44 @@ void NM_copy(const NumericsMatrix* const A, NumericsMatrix* B)
   }
   case NM_SPARSE_BLOCK:
   {
-    int need_blocks = 0;
-
     SparseBlockStructuredMatrix* A_ = A->matrix1;
     SparseBlockStructuredMatrix* B_ = B->matrix1;
 
-    if (B_)
+    if (B_ && NM_SBM_same_pattern(A_, B_))
     {
-      if (B_->nbblocks < A_->nbblocks)
+      /* same blocks: only the values are copied, B keeps its storage
+       * (one slab or one allocation per block) */
+      unsigned int currentRowNumber ;
+      size_t colNumber;
+      unsigned int nbRows, nbColumns;
+      for (currentRowNumber = 0 ; currentRowNumber < A_->filled1 - 1; ++currentRowNumber)
       {
-        need_blocks = 1;
-        for (unsigned i=0; i<B_->nbblocks; ++i)
+        nbRows = A_->blocksize0[currentRowNumber];
+        if (currentRowNumber != 0)
+          nbRows -= A_->blocksize0[currentRowNumber - 1];
+        for (size_t blockNum = A_->index1_data[currentRowNumber];
+             blockNum < A_->index1_data[currentRowNumber + 1]; ++blockNum)
         {
-          free(B_->block [i]);
-          B_->block [i] = NULL;
+          colNumber = A_->index2_data[blockNum];
+          nbColumns = A_->blocksize1[colNumber];
+          if (colNumber != 0)
+            nbColumns -= A_->blocksize1[colNumber - 1];
+          memcpy(B_->block[blockNum], A_->block[blockNum], nbRows * nbColumns * sizeof(double));
         }
-        B_->block = (double **) realloc(B_->block, A_->nbblocks * sizeof(double *));
-      }
-      B_->nbblocks = A_->nbblocks;
-
-      if (B_->blocknumber0 < A_->blocknumber0)
-      {
-        B_->blocksize0 = (unsigned int*) realloc(B_->blocksize0, A_->blocknumber0 * sizeof(unsigned int));
-      }
-      B_->blocknumber0 = A_->blocknumber0;
-
-      if (B_->blocknumber1 < A_->blocknumber1)
-      {
-        B_->blocksize1 = (unsigned int*) realloc(B_->blocksize1, A_->blocknumber1 * sizeof(unsigned int));
       }
-      B_->blocknumber1 = A_->blocknumber1;
-
-      if (B_->filled1 < A_->filled1)
-      {
-        B_->index1_data = (size_t*) realloc(B_->index1_data, A_->filled1 * sizeof(size_t));
-      }
-      B_->filled1 = A_->filled1;
-
-      if (B_->filled2 < A_->filled2)
-      {
-        B_->index2_data = (size_t*) realloc(B_->index2_data, A_->filled2 * sizeof(size_t));
-      }
-      B_->filled2 = A_->filled2;
+      B_->fixedblocksize = A_->fixedblocksize;
     }
     else
     {
-      B->matrix1 = newSBM();
-      B_ = B->matrix1;
-
-      B_->block = (double **) malloc(A_->nbblocks * sizeof(double *));
-      B_->nbblocks = A_->nbblocks;
-
-      B_->blocksize0 = (unsigned int*) malloc(A_->blocknumber0 * sizeof(unsigned int));
-      B_->blocknumber0 = A_->blocknumber0;
-
-      B_->blocksize1 = (unsigned int*) malloc(A_->blocknumber1 * sizeof(unsigned int));
-      B_->blocknumber1 = A_->blocknumber1;
-
-      B_->index1_data = (size_t*) malloc(A_->filled1 * sizeof(size_t));
-      B_->filled1 = A_->filled1;
-
-      B_->index2_data = (size_t*) malloc(A_->filled2 * sizeof(size_t));
-      B_->filled2 = A_->filled2;
-    }
-
-    memcpy(B_->blocksize0, A_->blocksize0, A_->blocknumber0 * sizeof(unsigned int));
-    memcpy(B_->blocksize1, A_->blocksize1, A_->blocknumber1 * sizeof(unsigned int));
-    memcpy(B_->index1_data, A_->index1_data, A_->filled1 * sizeof(size_t));
-    memcpy(B_->index2_data, A_->index2_data, A_->filled2 * sizeof(size_t));
-
-    /* cf copySBM */
-    unsigned int currentRowNumber ;
-    size_t colNumber;
-    unsigned int nbRows, nbColumns;
-    for (currentRowNumber = 0 ; currentRowNumber < A_->filled1 - 1; ++currentRowNumber)
-    {
-      for (size_t blockNum = A_->index1_data[currentRowNumber];
-           blockNum < A_->index1_data[currentRowNumber + 1]; ++blockNum)
+      /* freeSBM releases the slab or the blocks, whichever B has */
+      if (B_)
+        freeSBM(B_);
+      else
       {
-        assert(blockNum < A_->filled2);
-        colNumber = A_->index2_data[blockNum];
-        /* Get dim. of the current block */
-        nbRows = A_->blocksize0[currentRowNumber];
-        if (currentRowNumber != 0)
-          nbRows -= A_->blocksize0[currentRowNumber - 1];
-        nbColumns = A_->blocksize1[colNumber];
-
-        if (colNumber != 0)
-          nbColumns -= A_->blocksize1[colNumber - 1];
-
-        if (need_blocks)
-        {
-          B_->block[blockNum] = (double*)malloc(nbRows * nbColumns * sizeof(double));
-        }
-
-        for (unsigned int i = 0; i < nbRows * nbColumns; i++)
-        {
-          B_->block[blockNum] [i] = A_->block[blockNum] [i] ;
-        }
+        B->matrix1 = newSBM();
+        B_ = B->matrix1;
       }
+      copySBM(A_, B_, 1);
     }
 
     /* invalidations */
@@ -1350,10 +1310,47 @@ CSparseMatrix* NM_csr(NumericsMatrix *A)
   return A->matrix2->csr;
 }
 
+/* Number of threads of the parallel products, 1 without OpenMP */
+static int NM_threads_number(void)
+{
+#ifdef _OPENMP
+  return (numericsThreadsNumber > 0) ? numericsThreadsNumber : omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+/* y <- alpha trans(B) x + beta y, with B in compressed column
+ * format. Each component of y is the dot product of one column of B
+ * with x and is computed by a single thread, in the storage order: the
+ * result does not depend on the number of threads. */
+static void NM_csc_tgemv_parallel(int nthreads, const double alpha, const CSparseMatrix* const B,
+                                  const double *x, const double beta, double *y)
+{
+  const csi * Bp = B->p;
+  const csi * Bi = B->i;
+  const double * Bx = B->x;
+  csi j;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+#endif
+  for (j = 0; j < B->n; ++j)
+  {
+    double s = 0.0;
+    for (csi p = Bp[j]; p < Bp[j + 1]; ++p)
+    {
+      s += Bx[p] * x[Bi[p]];
+    }
+    y[j] = (beta == 0.0) ? alpha * s : alpha * s + beta * y[j];
+  }
+}
+
 /* Numerics Matrix wrapper  for y <- alpha A x + beta y */
 void NM_gemv(const double alpha, NumericsMatrix* A, const double *x,
              const double beta, double *y)
 {
+  int nthreads = NM_threads_number();
+
   switch (A->storageType)
   {
   case NM_DENSE:
@@ -1375,9 +1372,14 @@ void NM_gemv(const double alpha, NumericsMatrix* A, const double *x,
   default:
   {
     assert(A->storageType == NM_SPARSE);
+    if (nthreads > 1)
+    {
+      /* the rows of A are the columns of its transpose */
+      NM_csc_tgemv_parallel(nthreads, alpha, NM_csc_trans(A), x, beta, y);
+    }
     // if possible use the much simpler version provided by CSparse
     // Also at the time of writing, cs_aaxpy is bugged --xhub
-    if (fabs(alpha - 1.) < 100*DBL_EPSILON && fabs(beta - 1.) < 100*DBL_EPSILON)
+    else if (fabs(alpha - 1.) < 100*DBL_EPSILON && fabs(beta - 1.) < 100*DBL_EPSILON)
     {
       CHECK_RETURN(cs_gaxpy(NM_csc(A), x, y));
     }
@@ -1393,6 +1395,8 @@ void NM_gemv(const double alpha, NumericsMatrix* A, const double *x,
 void NM_tgemv(const double alpha, NumericsMatrix* A, const double *x,
               const double beta, double *y)
 {
+  int nthreads = NM_threads_number();
+
   switch (A->storageType)
   {
     case NM_DENSE:
@@ -1404,9 +1408,13 @@ void NM_tgemv(const double alpha, NumericsMatrix* A, const double *x,
     case NM_SPARSE_BLOCK:
     case NM_SPARSE:
       {
+        if (nthreads > 1)
+        {
+          NM_csc_tgemv_parallel(nthreads, alpha, NM_csc(A), x, beta, y);
+        }
         /* if possible use the much simpler version provided by CSparse
          Also at the time of writing, cs_aaxpy is bugged --xhub */
-        if (fabs(alpha - 1.) < 100*DBL_EPSILON && fabs(beta - 1.) < 100*DBL_EPSILON)
+        else if (fabs(alpha - 1.) < 100*DBL_EPSILON && fabs(beta - 1.) < 100*DBL_EPSILON)
         {
           CHECK_RETURN(cs_gaxpy(NM_csc_trans(A), x, y));
         }
@@ -1552,6 +1560,55 @@ double* NM_dWork(NumericsMatrix* A, int size)
   return A->internalData->dWork;
 }
 
+/* Symbolic analysis of A for CSparse, kept in p and reused as long as
+ * the sparsity pattern of A does not change. With a sparse block
+ * storage, the pattern is the block structure, so that the entries
+ * dropped by cs_zentry do not trigger a new analysis: the column
+ * ordering of an analysis is valid for any matrix of the same size. */
+static css* NM_csparse_symbolic(NumericsMatrix* A, CSparseMatrix* csc,
+                                NumericsSparseLinearSolverParams* p)
+{
+  const void* blocks[4];
+  size_t sizes[4];
+  unsigned int n;
+  if (A->storageType == NM_SPARSE_BLOCK && A->matrix1)
+  {
+    SparseBlockStructuredMatrix* B = A->matrix1;
+    blocks[0] = B->index1_data;
+    sizes[0] = B->filled1 * sizeof(size_t);
+    blocks[1] = B->index2_data;
+    sizes[1] = B->filled2 * sizeof(size_t);
+    blocks[2] = B->blocksize0;
+    sizes[2] = B->blocknumber0 * sizeof(unsigned int);
+    blocks[3] = B->blocksize1;
+    sizes[3] = B->blocknumber1 * sizeof(unsigned int);
+    n = 4;
+  }
+  else
+  {
+    blocks[0] = csc->p;
+    sizes[0] = (csc->n + 1) * sizeof(csi);
+    blocks[1] = csc->i;
+    sizes[1] = csc->p[csc->n] * sizeof(csi);
+    n = 2;
+  }
+
+  int same = NM_sparse_same_pattern(p, n, blocks, sizes);
+  if (same && p->symbolic)
+  {
+    p->nbAnalysisReused++;
+  }
+  else
+  {
+    if (p->symbolic) cs_sfree((css*) p->symbolic);
+    clock_t start = clock();
+    p->symbolic = cs_sqr(1, csc, 0);
+    p->analysisTime += (double) (clock() - start) / CLOCKS_PER_SEC;
+    p->nbAnalysis++;
+  }
+  return (css*) p->symbolic;
+}
+
 int NM_gesv_expert(NumericsMatrix* A, double *b, bool keep)
 {
   assert(A->size0 == A->size1);
@@ -1637,7 +1694,17 @@ int NM_gesv_expert(NumericsMatrix* A, double *b, bool keep)
       }
       else
       {
-        info = !cs_lusol(1, NM_csc(A), b, DBL_EPSILON);
+        /* numeric factorization only, as long as the pattern is the
+         * same as in the previous calls */
+        CSparseMatrix* csc = NM_csc(A);
+        cs_lu_factors cs_lu_A;
+        cs_lu_A.n = csc->n;
+        cs_lu_A.S = NM_csparse_symbolic(A, csc, p);
+        cs_lu_A.N = cs_lu(csc, cs_lu_A.S, DBL_EPSILON);
+        double* x = (double*) cs_malloc(csc->n, sizeof(double));
+        info = !cs_solve(&cs_lu_A, x, b);
+        cs_free(x);
+        cs_nfree(cs_lu_A.N);
       }
       break;
 
@@ -1653,13 +1720,33 @@ int NM_gesv_expert(NumericsMatrix* A, double *b, bool keep)
 
       mumps_id->rhs = b;
 
-      if (!keep || mumps_id->job == -1)
+      if (keep && mumps_id->job != -1 && NM_internalData(A)->isLUfactorized)
       {
-        mumps_id->job = 6;
+        /* the factors of the previous call are kept */
+        mumps_id->job = 3;
       }
       else
       {
-        mumps_id->job = 3;
+        /* the analysis is done again only if the row and column
+         * indices have changed */
+        const void* blocks[2] = { mumps_id->irn, mumps_id->jcn };
+        size_t sizes[2] = { mumps_id->nz * sizeof(int),
+                            mumps_id->nz * sizeof(int) };
+        if (NM_sparse_same_pattern(p, 2, blocks, sizes)
+            && mumps_id->job != -1)
+        {
+          p->nbAnalysisReused++;
+        }
+        else
+        {
+          clock_t start = clock();
+          mumps_id->job = 1;
+          dmumps_c(mumps_id);
+          p->analysisTime += (double) (clock() - start) / CLOCKS_PER_SEC;
+          p->nbAnalysis++;
+        }
+        /* factorization and solve */
+        mumps_id->job = 5;
       }
 
 
@@ -1668,7 +1755,17 @@ int NM_gesv_expert(NumericsMatrix* A, double *b, bool keep)
 
       info = mumps_id->info[0];
 
+      /* the factors may be reused by the next call only if asked */
+      NM_internalData(A)->isLUfactorized = keep && !info;
+
       /* MUMPS can return info codes with negative value */
+      if (info < 0)
+      {
+        /* the next call starts with a new analysis */
+        free(p->pattern);
+        p->pattern = NULL;
+        p->patternSize = 0;
+      }
       if (info)
       {
         if (verbose > 0)
@@ -1676,11 +1773,8 @@ int NM_gesv_expert(NumericsMatrix* A, double *b, bool keep)
           printf("NM_gesv: MUMPS fails : info(1)=%d, info(2)=%d\n", info, mumps_id->info[1]);
         }
       }
-      if (!keep)
-      {
-        NM_MUMPS_free(p);
-      }
-      else if (!p->solver_free_hook)
+      /* the instance keeps the analysis for the next calls */
+      if (!p->solver_free_hook)
       {
         p->solver_free_hook = &NM_MUMPS_free;
       }
@@ -26,9 +26,19 @@ void setNumericsVerbose(int newVerboseMode)
   verbose = newVerboseMode;
 }
 
+/* Default number of threads: sequential products
+Warning: global variable
+*/
+int numericsThreadsNumber = 1;
+void setNumericsThreadsNumber(int newThreadsNumber)
+{
+  numericsThreadsNumber = newThreadsNumber;
+}
+
 void setNumericsOptions(NumericsOptions* opt)
 {
   verbose = opt->verboseMode;
+  numericsThreadsNumber = opt->threadsNumber;
 }
 
 void numericsError(char * functionName, char* message)
@@ -54,4 +64,5 @@ void numericsWarning(char * functionName, char* message)
 void setDefaultNumericsOptions(NumericsOptions* opts)
 {
   opts->verboseMode = 0;
+  opts->threadsNumber = 1;
 }
@@ -41,6 +41,9 @@
 typedef struct
 {
   int verboseMode; /**< 0: off, 1: on */
+  int threadsNumber; /**< number of threads of the parallel matrix-vector
+                        products (prodSBM, NM_gemv, NM_tgemv). 1:
+                        sequential, 0: OpenMP default */
 } NumericsOptions;
 
 
@@ -49,6 +52,9 @@ typedef struct
 /* Verbose mode */
 extern int verbose;
 
+/* Number of threads of the parallel matrix-vector products */
+extern int numericsThreadsNumber;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -59,6 +65,12 @@ extern "C"
    */
   void setNumericsVerbose(int newVerboseMode);
 
+  /* Set the number of threads of the parallel matrix-vector products.
+     Without OpenMP, the products are always sequential.
+     \param newThreadsNumber 1 sequential, 0 OpenMP default, n > 1 n threads.
+   */
+  void setNumericsThreadsNumber(int newThreadsNumber);
+
   /* Set global option for numerics
      \param opt a NumericsOptions structure
    */
@@ -4,6 +4,7 @@
 #include "SparseMatrix.h"
 #include <math.h>
 #include <float.h>
+#include <string.h>
 
 #include "SiconosCompat.h"
 #include "NumericsSparseMatrix.h"
@@ -88,6 +89,13 @@ NumericsSparseLinearSolverParams* newNumericsSparseLinearSolverParams(void)
   p->iWorkSize = 0;
   p->dWorkSize = 0;
 
+  p->pattern = NULL;
+  p->patternSize = 0;
+  p->symbolic = NULL;
+  p->nbAnalysis = 0;
+  p->nbAnalysisReused = 0;
+  p->analysisTime = 0.;
+
   return p;
 }
 
@@ -127,6 +135,16 @@ NumericsSparseLinearSolverParams* freeNumericsSparseLinearSolverParams(NumericsS
     free(p->solver_data);
     p->solver_data = NULL;
   }
+  if (p->symbolic)
+  {
+    cs_sfree((css*) p->symbolic);
+    p->symbolic = NULL;
+  }
+  if (p->pattern)
+  {
+    free(p->pattern);
+    p->pattern = NULL;
+  }
 
   free(p);
   return NULL;
@@ -142,3 +160,47 @@ void NM_sparse_free(void *p)
 
   ptr->solver_data = NULL;
   }
+
+int NM_sparse_same_pattern(NumericsSparseLinearSolverParams* p,
+                           unsigned int n, const void** blocks,
+                           const size_t* sizes)
+{
+  size_t size = 0;
+  for (unsigned int k = 0; k < n; ++k)
+  {
+    size += sizes[k];
+  }
+
+  if (p->pattern && size == p->patternSize)
+  {
+    int same = 1;
+    char* pattern = (char*) p->pattern;
+    for (unsigned int k = 0; same && k < n; ++k)
+    {
+      same = !memcmp(pattern, blocks[k], sizes[k]);
+      pattern += sizes[k];
+    }
+    if (same) return 1;
+  }
+
+  /* record the new pattern */
+  if (size != p->patternSize)
+  {
+    free(p->pattern);
+    p->pattern = size ? malloc(size) : NULL;
+    p->patternSize = size;
+  }
+  char* pattern = (char*) p->pattern;
+  for (unsigned int k = 0; k < n; ++k)
+  {
+    memcpy(pattern, blocks[k], sizes[k]);
+    pattern += sizes[k];
+  }
+  return 0;
+}
+
+double NM_sparse_analysis_time_saved(const NumericsSparseLinearSolverParams* p)
+{
+  if (!p->nbAnalysis) return 0.;
+  return p->analysisTime / p->nbAnalysis * p->nbAnalysisReused;
+}
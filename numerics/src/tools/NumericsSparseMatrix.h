@@ -7,6 +7,7 @@
  */
 
 #include "SiconosConfig.h"
+#include <stddef.h>
 
 #if defined(__cplusplus) && !defined(BUILD_AS_CPP)
 extern "C"
@@ -34,6 +35,12 @@ extern "C"
     int iWorkSize; /**< size of integer work vector array */
     double* dWork;
     int dWorkSize;
+    void* pattern; /**< sparsity pattern of the last symbolic analysis */
+    size_t patternSize; /**< size in bytes of pattern */
+    void* symbolic; /**< symbolic analysis kept between the factorizations (CSparse) */
+    unsigned int nbAnalysis; /**< number of symbolic analyses */
+    unsigned int nbAnalysisReused; /**< number of factorizations that reused the last symbolic analysis */
+    double analysisTime; /**< cumulated time of the symbolic analyses, in seconds */
   } NumericsSparseLinearSolverParams;
 
   typedef enum { NS_UNKNOWN, NS_TRIPLET, NS_CSC, NS_CSR } NumericsSparseOrigin;
@@ -100,6 +107,25 @@ extern "C"
   }
 
 
+  /** Compare a sparsity pattern with the one of the last symbolic
+   * analysis, and record it if it is different.
+   * \param p the structure holding the data for the solver
+   * \param n number of memory blocks describing the pattern
+   * \param blocks the memory blocks
+   * \param sizes the sizes in bytes of the memory blocks
+   * \return 1 if the pattern is the recorded one, 0 otherwise
+   */
+  int NM_sparse_same_pattern(NumericsSparseLinearSolverParams* p,
+                             unsigned int n, const void** blocks,
+                             const size_t* sizes);
+
+  /** Estimate of the time saved by the reuse of symbolic analyses,
+   * i.e. the mean time of an analysis times the number of reuses.
+   * \param p the structure holding the data for the solver
+   * \return the time in seconds
+   */
+  double NM_sparse_analysis_time_saved(const NumericsSparseLinearSolverParams* p);
+
   /** Free allocated space for NumericsSparseLinearSolverParams.
    * \param p a NumericsSparseLinearSolverParams
    * \return NULL on success
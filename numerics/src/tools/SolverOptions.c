@@ -28,6 +28,8 @@
 #include "relay_cst.h"
 #include "Friction_cst.h"
 #include "AVI_cst.h"
+#include "SparseMatrix.h"
+#include "NumericsSparseMatrix.h"
 #include "VI_cst.h"
 #include "misc.h"
 
@@ -289,6 +291,18 @@ void free_solver_specific_data(SolverOptions* options)
      vi_box_AVI_free_solverData(options);
      break;
     }
+    /* linear solver data kept between the calls */
+    case SICONOS_FRICTION_3D_NSN_AC:
+    case SICONOS_FRICTION_3D_NSN_FB:
+    case SICONOS_FRICTION_3D_NSN_NM:
+    {
+      if (options->solverParameters)
+      {
+        freeNumericsSparseLinearSolverParams((NumericsSparseLinearSolverParams*)options->solverParameters);
+        options->solverParameters = NULL;
+      }
+      break;
+    }
     default:
       {
        if (options->solverParameters)
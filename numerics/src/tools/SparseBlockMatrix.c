@@ -1,15 +1,21 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <string.h>
 #include "SparseBlockMatrix.h"
 #include "SiconosLapack.h"
 #include <math.h>
 #include "misc.h"
+#include "NumericsOptions.h"
 //#define DEBUG_MESSAGES 1
 //#define DEBUG_STDOUT 1
 //#define DEBUG_NOCOLOR 1
 #include "debug.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 //#define VERBOSE_DEBUG
 
 /* Clang 3.6 seems to be at odd with the C99 and C11 std on the conversion from
@@ -36,10 +42,98 @@ SparseBlockStructuredMatrix* newSBM(void)
   sbm->filled2 = 0;
   sbm->index1_data = NULL;
   sbm->index2_data = NULL;
+  sbm->blockstorage = NULL;
+  sbm->fixedblocksize = 0;
 
   return sbm;
 }
 
+int allocateContiguousBlocksSBM(SparseBlockStructuredMatrix* M)
+{
+  assert(M);
+  assert(M->blocksize0);
+  assert(M->blocksize1);
+  assert(M->index1_data);
+  assert(M->index2_data);
+
+  /* Offset of each block in the slab and common size of the blocks */
+  size_t storageSize = 0;
+  unsigned int commonSize = 0;
+  int sameSize = 1;
+  size_t * offset = (size_t *)malloc((M->nbblocks + 1) * sizeof(size_t));
+
+  for (unsigned int currentRowNumber = 0 ; currentRowNumber < M->filled1 - 1; ++currentRowNumber)
+  {
+    unsigned int nbRows = M->blocksize0[currentRowNumber];
+    if (currentRowNumber != 0)
+      nbRows -= M->blocksize0[currentRowNumber - 1];
+
+    for (size_t blockNum = M->index1_data[currentRowNumber];
+         blockNum < M->index1_data[currentRowNumber + 1]; ++blockNum)
+    {
+      assert(blockNum < M->nbblocks);
+      size_t colNumber = M->index2_data[blockNum];
+      unsigned int nbColumns = M->blocksize1[colNumber];
+      if (colNumber != 0)
+        nbColumns -= M->blocksize1[colNumber - 1];
+
+      if (nbRows != nbColumns || (commonSize && nbRows != commonSize))
+        sameSize = 0;
+      commonSize = nbRows;
+
+      offset[blockNum] = nbRows * nbColumns;
+    }
+  }
+  for (unsigned int i = 0; i < M->nbblocks; ++i)
+  {
+    size_t blockSize = offset[i];
+    offset[i] = storageSize;
+    storageSize += blockSize;
+  }
+
+  if (M->blockstorage)
+    free(M->blockstorage);
+  /* one extra double allows 4-wide loads on the last column of the last block */
+  M->blockstorage = (double *)malloc((storageSize + 1) * sizeof(double));
+  if (!M->blockstorage)
+  {
+    free(offset);
+    return 1;
+  }
+  M->blockstorage[storageSize] = 0.0;
+
+  if (!M->block)
+    M->block = (double **)malloc(M->nbblocks * sizeof(double *));
+  for (unsigned int i = 0; i < M->nbblocks; ++i)
+    M->block[i] = &M->blockstorage[offset[i]];
+
+  /* the fixed size fast paths index x and y by block number: all the
+     block rows and columns, even empty ones, must have the same size */
+  for (unsigned int i = 0; sameSize && i < M->blocknumber0; ++i)
+    sameSize = (M->blocksize0[i] == (i + 1) * commonSize);
+  for (unsigned int i = 0; sameSize && i < M->blocknumber1; ++i)
+    sameSize = (M->blocksize1[i] == (i + 1) * commonSize);
+  M->fixedblocksize = (sameSize) ? commonSize : 0;
+
+  free(offset);
+  return 0;
+}
+
+/* y += alpha * A * x for a 3x3 block A in column-major order */
+static inline void SBM_gemv3x3(double alpha, const double * A, const double * x, double * y)
+{
+  y[0] += alpha * (A[0] * x[0] + A[3] * x[1] + A[6] * x[2]);
+  y[1] += alpha * (A[1] * x[0] + A[4] * x[1] + A[7] * x[2]);
+  y[2] += alpha * (A[2] * x[0] + A[5] * x[1] + A[8] * x[2]);
+}
+
+/* y += alpha * A * x for a 2x2 block A in column-major order */
+static inline void SBM_gemv2x2(double alpha, const double * A, const double * x, double * y)
+{
+  y[0] += alpha * (A[0] * x[0] + A[2] * x[1]);
+  y[1] += alpha * (A[1] * x[0] + A[3] * x[1]);
+}
+
 
 /* a basic iterator scheme for different kind of sparse
  * matrices (csc, csr, triplet) */
@@ -73,54 +167,87 @@ void prodSBM(unsigned int sizeX, unsigned int sizeY, double alpha, const SparseB
   assert(sizeX == A->blocksize1[A->blocknumber1 - 1]);
   assert(sizeY == A->blocksize0[A->blocknumber0 - 1]);
 
-  /* Column (block) position of the current block*/
-  size_t colNumber;
-  /* Number of rows/columns of the current block */
-  unsigned int nbRows, nbColumns;
-  /* Position of the sub-block of x multiplied by the sub-block of A */
-  unsigned int posInX = 0;
-  /* Position of the sub-block of y, result of the product */
-  unsigned int posInY = 0;
-
-  /* Loop over all non-null blocks
-     Works whatever the ordering order of the block is, in A->block
+  /* Loop over all non-null blocks, row by row. Each row of blocks
+     writes its own part of y in the same order whatever the number of
+     threads is: the result does not depend on the scheduling.
   */
   cblas_dscal(sizeY, beta, y, 1);
 
-  for (unsigned int currentRowNumber = 0 ; currentRowNumber < A->filled1 - 1; ++currentRowNumber)
+  int nbRowsOfBlocks = (int)A->filled1 - 1;
+  int currentRowNumber;
+#ifdef _OPENMP
+  int nthreads = (numericsThreadsNumber > 0) ? numericsThreadsNumber : omp_get_max_threads();
+#endif
+
+  if (A->fixedblocksize == 3)
+  {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) if(nthreads > 1) schedule(static)
+#endif
+    for (currentRowNumber = 0 ; currentRowNumber < nbRowsOfBlocks; ++currentRowNumber)
+    {
+      for (size_t blockNum = A->index1_data[currentRowNumber];
+           blockNum < A->index1_data[currentRowNumber + 1]; ++blockNum)
+      {
+        SBM_gemv3x3(alpha, A->block[blockNum], &x[3 * A->index2_data[blockNum]], &y[3 * currentRowNumber]);
+      }
+    }
+    return;
+  }
+  else if (A->fixedblocksize == 2)
   {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) if(nthreads > 1) schedule(static)
+#endif
+    for (currentRowNumber = 0 ; currentRowNumber < nbRowsOfBlocks; ++currentRowNumber)
+    {
+      for (size_t blockNum = A->index1_data[currentRowNumber];
+           blockNum < A->index1_data[currentRowNumber + 1]; ++blockNum)
+      {
+        SBM_gemv2x2(alpha, A->block[blockNum], &x[2 * A->index2_data[blockNum]], &y[2 * currentRowNumber]);
+      }
+    }
+    return;
+  }
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) if(nthreads > 1) schedule(static)
+#endif
+  for (currentRowNumber = 0 ; currentRowNumber < nbRowsOfBlocks; ++currentRowNumber)
+  {
+    /* Number of rows of the current row of blocks */
+    unsigned int nbRows = A->blocksize0[currentRowNumber];
+    /* Position of the sub-block of y, result of the product */
+    unsigned int posInY = 0;
+    if (currentRowNumber != 0)
+    {
+      nbRows -= A->blocksize0[currentRowNumber - 1];
+      posInY += A->blocksize0[currentRowNumber - 1];
+    }
+    assert((nbRows <= sizeY));
+
     for (size_t blockNum = A->index1_data[currentRowNumber];
          blockNum < A->index1_data[currentRowNumber + 1]; ++blockNum)
     {
       assert(blockNum < A->filled2);
 
-      colNumber = A->index2_data[blockNum];
+      /* Column (block) position of the current block*/
+      size_t colNumber = A->index2_data[blockNum];
 
       assert(colNumber < sizeX);
 
       /* Get dim. of the current block */
-      nbRows = A->blocksize0[currentRowNumber];
-
-
-      if (currentRowNumber != 0)
-        nbRows -= A->blocksize0[currentRowNumber - 1];
-
-      assert((nbRows <= sizeY));
-
-      nbColumns = A->blocksize1[colNumber];
+      unsigned int nbColumns = A->blocksize1[colNumber];
+      /* Get position in x of the sub-block multiplied by A sub-block */
+      unsigned int posInX = 0;
       if (colNumber != 0)
+      {
         nbColumns -= A->blocksize1[colNumber - 1];
+        posInX += A->blocksize1[colNumber - 1];
+      }
 
       assert((nbColumns <= sizeX));
 
-      /* Get position in x of the sub-block multiplied by A sub-block */
-      posInX = 0;
-      if (colNumber != 0)
-        posInX += A->blocksize1[colNumber - 1];
-      /* Get position in y for the ouput sub-block, result of the product */
-      posInY = 0;
-      if (currentRowNumber != 0)
-        posInY += A->blocksize0[currentRowNumber - 1];
       /* Computes y[] += currentBlock*x[] */
       cblas_dgemv(CblasColMajor, CblasNoTrans, nbRows, nbColumns, alpha, A->block[blockNum],
                   nbRows, &x[posInX], 1, 1.0, &y[posInY], 1);
@@ -159,6 +286,8 @@ void allocateMemoryForProdSBMSBM(const SparseBlockStructuredMatrix* const A, con
   else
   {
     /*      compute blocknumber and block sizes of C */
+    C->blockstorage = NULL;
+    C->fixedblocksize = (A->fixedblocksize == B->fixedblocksize) ? A->fixedblocksize : 0;
     C->blocknumber0 = A->blocknumber0;
     C->blocknumber1 = B->blocknumber1;
     C->blocksize0  = (unsigned int *)malloc(C->blocknumber0 * sizeof(unsigned int));
@@ -541,6 +670,27 @@ void subRowProdSBM(unsigned int sizeX, unsigned int sizeY, unsigned int currentR
   if (init == 1)
     cblas_dscal(sizeY, 0.0, y, 1);
 
+  if (A->fixedblocksize == 3)
+  {
+    for (size_t blockNum = A->index1_data[currentRowNumber];
+         blockNum < A->index1_data[currentRowNumber + 1];
+         ++blockNum)
+    {
+      SBM_gemv3x3(1.0, A->block[blockNum], &x[3 * A->index2_data[blockNum]], y);
+    }
+    return;
+  }
+  else if (A->fixedblocksize == 2)
+  {
+    for (size_t blockNum = A->index1_data[currentRowNumber];
+         blockNum < A->index1_data[currentRowNumber + 1];
+         ++blockNum)
+    {
+      SBM_gemv2x2(1.0, A->block[blockNum], &x[2 * A->index2_data[blockNum]], y);
+    }
+    return;
+  }
+
   /* Loop over all non-null blocks
      Works whatever the ordering order of the block is, in A->block
      But it requires a set to 0 of all y components
@@ -619,6 +769,31 @@ void rowProdNoDiagSBM(unsigned int sizeX, unsigned int sizeY, unsigned int curre
   if (init == 1)
     cblas_dscal(sizeY, 0.0, y, 1);
 
+  if (A->fixedblocksize == 3)
+  {
+    for (size_t blockNum = A->index1_data[currentRowNumber];
+         blockNum < A->index1_data[currentRowNumber + 1];
+         ++blockNum)
+    {
+      colNumber = A->index2_data[blockNum];
+      if (colNumber != currentRowNumber)
+        SBM_gemv3x3(1.0, A->block[blockNum], &x[3 * colNumber], y);
+    }
+    return;
+  }
+  else if (A->fixedblocksize == 2)
+  {
+    for (size_t blockNum = A->index1_data[currentRowNumber];
+         blockNum < A->index1_data[currentRowNumber + 1];
+         ++blockNum)
+    {
+      colNumber = A->index2_data[blockNum];
+      if (colNumber != currentRowNumber)
+        SBM_gemv2x2(1.0, A->block[blockNum], &x[2 * colNumber], y);
+    }
+    return;
+  }
+
   /* Loop over all non-null blocks. Works whatever the ordering order
      of the block is, in A->block, but it requires a set to 0 of all y
      components
@@ -676,12 +851,22 @@ void freeSBM(SparseBlockStructuredMatrix *blmat)
     blmat->blocksize1 = NULL;
   }
 
-  for (unsigned int i = 0 ; i < blmat->nbblocks ; i++)
+  if (blmat->blockstorage)
   {
-    if (blmat->block[i])
-    {
-      free(blmat->block[i]);
+    free(blmat->blockstorage);
+    blmat->blockstorage = NULL;
+    for (unsigned int i = 0 ; i < blmat->nbblocks ; i++)
       blmat->block[i] = NULL;
+  }
+  else
+  {
+    for (unsigned int i = 0 ; i < blmat->nbblocks ; i++)
+    {
+      if (blmat->block[i])
+      {
+        free(blmat->block[i]);
+        blmat->block[i] = NULL;
+      }
     }
   }
 
@@ -709,6 +894,7 @@ void freeSBM(SparseBlockStructuredMatrix *blmat)
   blmat->blocknumber0 = 0;
   blmat->blocknumber1 = 0;
   blmat->nbblocks = 0;
+  blmat->fixedblocksize = 0;
 }
 
 void printSBM(const SparseBlockStructuredMatrix* const m)
@@ -1046,7 +1232,9 @@ void newFromFileSBM(SparseBlockStructuredMatrix* const m, FILE *file)
     CHECK_IO(fscanf(file, "%d", &(index2_dataCurrent)));
     m->index2_data[i] = index2_dataCurrent;
   }
-  m->block = (double**)malloc(m->nbblocks * sizeof(double*));
+  m->block = NULL;
+  m->blockstorage = NULL;
+  allocateContiguousBlocksSBM(m);
   unsigned int currentRowNumber ;
   size_t colNumber;
   unsigned int nbRows, nbColumns;
@@ -1074,7 +1262,6 @@ void newFromFileSBM(SparseBlockStructuredMatrix* const m, FILE *file)
       {
         printf("Numerics, SparseBlockStructuredMatrix readInFileSBM failed, problem in block numbering. \n");
       }
-      m->block[blockNum] = (double*)malloc(nbRows * nbColumns * sizeof(double));
       for (unsigned int i = 0; i < nbRows * nbColumns; i++)
       {
         CHECK_IO(fscanf(file, "%32le\n", &(m->block[blockNum][i])));
@@ -1295,8 +1482,11 @@ int copySBM(const SparseBlockStructuredMatrix* const A, SparseBlockStructuredMat
   B->index2_data = (size_t*)malloc(B->filled2 * sizeof(size_t));
   for (unsigned int i = 0; i < B->filled2; i++) B->index2_data[i] = A->index2_data[i];
   B->block = (double **)malloc(B->nbblocks * sizeof(double*));
+  B->blockstorage = NULL;
+  B->fixedblocksize = A->fixedblocksize;
   if (copyBlock)
   {
+    allocateContiguousBlocksSBM(B);
     unsigned int currentRowNumber ;
     size_t colNumber;
     unsigned int nbRows, nbColumns;
@@ -1314,11 +1504,7 @@ int copySBM(const SparseBlockStructuredMatrix* const A, SparseBlockStructuredMat
         nbColumns = B->blocksize1[colNumber];
         if (colNumber != 0)
           nbColumns -= B->blocksize1[colNumber - 1];
-        B->block[blockNum] = (double*)malloc(nbRows * nbColumns * sizeof(double));
-        for (unsigned int i = 0; i < nbRows * nbColumns; i++)
-        {
-          B->block[blockNum] [i] = A->block[blockNum] [i] ;
-        }
+        memcpy(B->block[blockNum], A->block[blockNum], nbRows * nbColumns * sizeof(double));
       }
     }
   }
@@ -1395,6 +1581,8 @@ int transposeSBM(const SparseBlockStructuredMatrix* const A, SparseBlockStructur
 
 
   B->block = (double **)malloc(B->nbblocks * sizeof(double*));
+  B->blockstorage = NULL;
+  allocateContiguousBlocksSBM(B);
   unsigned int currentRowNumber ;
   size_t colNumber;
   unsigned int nbRows, nbColumns;
@@ -1412,8 +1600,6 @@ int transposeSBM(const SparseBlockStructuredMatrix* const A, SparseBlockStructur
       nbColumns = B->blocksize1[colNumber];
       if (colNumber != 0)
         nbColumns -= B->blocksize1[colNumber - 1];
-      int lengthblock = nbRows * nbColumns;
-      B->block[blockNum] = (double*)malloc(lengthblock * sizeof(double));
 
 
 
@@ -1765,8 +1951,7 @@ void freeSparseBlockCoordinateMatrix3x3fortran(SparseBlockCoordinateMatrix *MC)
 /* i.e coo.h file under scipy sparsetools */
 SparseBlockStructuredMatrix* SBCMToSBM(SparseBlockCoordinateMatrix* MC)
 {
-  SparseBlockStructuredMatrix* M = (SparseBlockStructuredMatrix *) 
-    malloc(sizeof(SparseBlockStructuredMatrix));
+  SparseBlockStructuredMatrix* M = newSBM();
 
   M->nbblocks = MC->nbblocks;
   M->filled2 = MC->nbblocks;
@@ -1951,9 +2136,14 @@ int sparseToSBM(int blocksize, const CSparseMatrix* const sparseMat, SparseBlock
 
   if (!A->block)
     A->block = (double **) malloc(A->nbblocks * sizeof(double *));
+  if (A->blockstorage)
+    free(A->blockstorage);
+  A->blockstorage = (double *) malloc((A->nbblocks * blocksize * blocksize + 1) * sizeof(double));
+  A->blockstorage[A->nbblocks * blocksize * blocksize] = 0.;
+  A->fixedblocksize = blocksize;
   for (unsigned int i = 0; i < A->nbblocks; i++)
   {
-    A->block[i] = (double *) malloc(blocksize * blocksize * sizeof(double));
+    A->block[i] = &A->blockstorage[i * blocksize * blocksize];
 
     /* fill block with 0 */
     for (int birow = 0; birow < blocksize; ++birow)
@@ -2191,8 +2381,16 @@ void SBMfree(SparseBlockStructuredMatrix* A, unsigned int level)
 
   if (level & NUMERICS_SBM_FREE_BLOCK)
   {
-    for (unsigned int i = 0; i < A->nbblocks; i++)
-      free(A->block[i]);
+    if (A->blockstorage)
+    {
+      free(A->blockstorage);
+      A->blockstorage = NULL;
+    }
+    else
+    {
+      for (unsigned int i = 0; i < A->nbblocks; i++)
+        free(A->block[i]);
+    }
   }
   free(A->block);
   free(A->blocksize0);
@@ -2274,6 +2472,8 @@ void RowPermutationSBM(unsigned int *rowIndex, SparseBlockStructuredMatrix* A, S
   int nbCol = A->blocknumber1;
   C->nbblocks = A->nbblocks;
   C->block = (double**)malloc(A->nbblocks * sizeof(double*));
+  C->blockstorage = NULL;
+  C->fixedblocksize = A->fixedblocksize;
   C->blocknumber0 = A->blocknumber0;
   C->blocknumber1 = A->blocknumber1;
   C->blocksize0 = (unsigned int*)malloc(nbRow * sizeof(unsigned int));
@@ -67,6 +67,12 @@
 
     \param index2_data index2_data is of size filled2
     index2_data[blockNumber] -> columnNumber.
+    \param blockstorage if not NULL, all the blocks are stored in
+    this single contiguous slab, in the order of their block number,
+    and block[i] points into it (see allocateContiguousBlocksSBM()).
+    NULL if each block has been allocated separately.
+    \param fixedblocksize if not 0, all the blocks are square of this
+    size. Unrolled products are used for sizes 2 and 3.
 
 
     Related functions: prodSBM(), subRowProdSBM(), freeSBM(),
@@ -119,6 +125,8 @@ typedef struct
   size_t filled2;
   size_t *index1_data;
   size_t *index2_data;
+  double *blockstorage;
+  unsigned int fixedblocksize;
 
 } SparseBlockStructuredMatrix;
 
@@ -179,6 +187,18 @@ extern "C"
    */
   SparseBlockStructuredMatrix* newSBM(void);
 
+  /** Allocation of all the blocks of a SparseBlockStructuredMatrix in
+   * a single contiguous slab. The pattern of the matrix (blocknumber0,
+   * blocknumber1, blocksize0, blocksize1, filled1, filled2,
+   * index1_data, index2_data, nbblocks) must already be set. M->block
+   * is allocated if needed and M->block[i] points into the slab. If
+   * all the blocks are square of the same size, M->fixedblocksize is
+   * set.
+   * \param M the matrix
+   * \return 0 if successful
+   */
+  int allocateContiguousBlocksSBM(SparseBlockStructuredMatrix* M);
+
   /** SparseMatrix - vector product y = alpha*A*x + beta*y
       \param[in] sizeX dim of the vectors x
       \param[in] sizeY dim of the vectors y
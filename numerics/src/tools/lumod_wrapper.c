@@ -8,6 +8,7 @@
 #include "SiconosBlas.h"
 #include "SiconosLapack.h"
 #include "lumod_dense.h"
+#include "NumericsOptions.h"
 
 
 //#define DEBUG_STDOUT
@@ -200,7 +201,8 @@ int SN_lumod_dense_solve(SN_lumod_dense_data* restrict lumod_data, double* restr
 
     if (fetestexcept(FE_ALL_EXCEPT & ~FE_INEXACT & ~FE_UNDERFLOW))
     {
-      printf("solution of the small system is spurious!\n");
+      if (verbose)
+        printf("solution of the small system is spurious!\n");
       return SN_LUMOD_NEED_REFACTORIZATION;
     }
     /* Step 3. Compute x3 = x1 - Yk x2 */
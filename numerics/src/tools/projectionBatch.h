@@ -0,0 +1,132 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/* Internal helpers of the batched projections of projectionOnCone.c
+   and projectionOnCylinder.c. When the library is compiled for
+   AVX-512 or AVX2 (with FMA), PROJECTION_BATCH_WIDTH is the number of
+   contacts of a vector register, the macros below are the vector
+   operations, and projectionBatchLoad / projectionBatchStore convert
+   PROJECTION_BATCH_WIDTH contiguous vectors of R^3 to and from three
+   registers of their components. */
+
+#ifndef ProjectionBatch_H
+#define ProjectionBatch_H
+
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+#include <immintrin.h>
+#endif
+
+#if defined(__AVX512F__)
+
+#define PROJECTION_BATCH_WIDTH 8
+#define VD __m512d
+#define VMASK __mmask8
+#define ZERO _mm512_setzero_pd()
+#define ONE _mm512_set1_pd(1.0)
+#define LOAD(p) _mm512_loadu_pd(p)
+#define SQRT(a) _mm512_sqrt_pd(a)
+#define FMA(a, b, c) _mm512_fmadd_pd(a, b, c)
+#define MUL(a, b) _mm512_mul_pd(a, b)
+#define SUB(a, b) _mm512_sub_pd(a, b)
+#define DIV(a, b) _mm512_div_pd(a, b)
+#define LE(a, b) _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ)
+#define LT(a, b) _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ)
+#define GT(a, b) _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ)
+#define AND(m, n) ((__mmask8)((m) & (n)))
+#define OR(m, n) ((__mmask8)((m) | (n)))
+#define SEL(m, a, b) _mm512_mask_blend_pd(m, b, a)
+
+/* indices of _mm512_permutex2var_pd: 8 + i is the lane i of the
+   second operand */
+static inline void projectionBatchLoad(const double * p, VD * r0, VD * r1, VD * r2)
+{
+  const __m512i xab = _mm512_setr_epi64(0, 3, 6, 9, 12, 15, 0, 0);
+  const __m512i xc  = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 10, 13);
+  const __m512i yab = _mm512_setr_epi64(1, 4, 7, 10, 13, 0, 0, 0);
+  const __m512i yc  = _mm512_setr_epi64(0, 1, 2, 3, 4, 8, 11, 14);
+  const __m512i zab = _mm512_setr_epi64(2, 5, 8, 11, 14, 0, 0, 0);
+  const __m512i zc  = _mm512_setr_epi64(0, 1, 2, 3, 4, 9, 12, 15);
+  __m512d a = _mm512_loadu_pd(p);
+  __m512d b = _mm512_loadu_pd(p + 8);
+  __m512d c = _mm512_loadu_pd(p + 16);
+  *r0 = _mm512_permutex2var_pd(_mm512_permutex2var_pd(a, xab, b), xc, c);
+  *r1 = _mm512_permutex2var_pd(_mm512_permutex2var_pd(a, yab, b), yc, c);
+  *r2 = _mm512_permutex2var_pd(_mm512_permutex2var_pd(a, zab, b), zc, c);
+}
+
+static inline void projectionBatchStore(double * p, VD r0, VD r1, VD r2)
+{
+  const __m512i axy = _mm512_setr_epi64(0, 8, 0, 1, 9, 0, 2, 10);
+  const __m512i az  = _mm512_setr_epi64(0, 1, 8, 3, 4, 9, 6, 7);
+  const __m512i bxy = _mm512_setr_epi64(0, 3, 11, 0, 4, 12, 0, 5);
+  const __m512i bz  = _mm512_setr_epi64(10, 1, 2, 11, 4, 5, 12, 7);
+  const __m512i cxy = _mm512_setr_epi64(13, 0, 6, 14, 0, 7, 15, 0);
+  const __m512i cz  = _mm512_setr_epi64(0, 13, 2, 3, 14, 5, 6, 15);
+  _mm512_storeu_pd(p, _mm512_permutex2var_pd(_mm512_permutex2var_pd(r0, axy, r1), az, r2));
+  _mm512_storeu_pd(p + 8, _mm512_permutex2var_pd(_mm512_permutex2var_pd(r0, bxy, r1), bz, r2));
+  _mm512_storeu_pd(p + 16, _mm512_permutex2var_pd(_mm512_permutex2var_pd(r0, cxy, r1), cz, r2));
+}
+
+#elif defined(__AVX2__) && defined(__FMA__)
+
+#define PROJECTION_BATCH_WIDTH 4
+#define VD __m256d
+#define VMASK __m256d
+#define ZERO _mm256_setzero_pd()
+#define ONE _mm256_set1_pd(1.0)
+#define LOAD(p) _mm256_loadu_pd(p)
+#define SQRT(a) _mm256_sqrt_pd(a)
+#define FMA(a, b, c) _mm256_fmadd_pd(a, b, c)
+#define MUL(a, b) _mm256_mul_pd(a, b)
+#define SUB(a, b) _mm256_sub_pd(a, b)
+#define DIV(a, b) _mm256_div_pd(a, b)
+#define LE(a, b) _mm256_cmp_pd(a, b, _CMP_LE_OQ)
+#define LT(a, b) _mm256_cmp_pd(a, b, _CMP_LT_OQ)
+#define GT(a, b) _mm256_cmp_pd(a, b, _CMP_GT_OQ)
+#define AND(m, n) _mm256_and_pd(m, n)
+#define OR(m, n) _mm256_or_pd(m, n)
+#define SEL(m, a, b) _mm256_blendv_pd(b, a, m)
+
+/* a = [x0 y0 z0 x1], b = [y1 z1 x2 y2], c = [z2 x3 y3 z3] */
+static inline void projectionBatchLoad(const double * p, VD * r0, VD * r1, VD * r2)
+{
+  __m256d a = _mm256_loadu_pd(p);
+  __m256d b = _mm256_loadu_pd(p + 4);
+  __m256d c = _mm256_loadu_pd(p + 8);
+  *r0 = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(a, b, 0x4), c, 0x2),
+                              _MM_SHUFFLE(1, 2, 3, 0));
+  *r1 = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(a, b, 0x9), c, 0x4),
+                              _MM_SHUFFLE(2, 3, 0, 1));
+  *r2 = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(a, b, 0x2), c, 0x9),
+                              _MM_SHUFFLE(3, 0, 1, 2));
+}
+
+/* the permutations of projectionBatchLoad are their own inverse */
+static inline void projectionBatchStore(double * p, VD r0, VD r1, VD r2)
+{
+  r0 = _mm256_permute4x64_pd(r0, _MM_SHUFFLE(1, 2, 3, 0));
+  r1 = _mm256_permute4x64_pd(r1, _MM_SHUFFLE(2, 3, 0, 1));
+  r2 = _mm256_permute4x64_pd(r2, _MM_SHUFFLE(3, 0, 1, 2));
+  _mm256_storeu_pd(p, _mm256_blend_pd(_mm256_blend_pd(r0, r1, 0x2), r2, 0x4));
+  _mm256_storeu_pd(p + 4, _mm256_blend_pd(_mm256_blend_pd(r1, r2, 0x2), r0, 0x4));
+  _mm256_storeu_pd(p + 8, _mm256_blend_pd(_mm256_blend_pd(r2, r0, 0x2), r1, 0x4));
+}
+
+#endif
+
+#endif
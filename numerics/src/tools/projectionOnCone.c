@@ -17,6 +17,7 @@
 */
 #include <math.h>
 #include "projectionOnCone.h"
+#include "projectionBatch.h"
 
 unsigned projectionOnCone(double* r, double  mu)
 {
@@ -42,6 +43,46 @@ unsigned projectionOnCone(double* r, double  mu)
   }
 }
 
+#ifdef PROJECTION_BATCH_WIDTH
+/* The three cases of projectionOnCone are computed for all the lanes,
+   the result is selected with the comparison masks. */
+#define PROJCONE_BATCH_KERNEL(R0, R1, R2, MU)                            \
+  do {                                                                  \
+    VD normT = SQRT(FMA(R1, R1, MUL(R2, R2)));                          \
+    VMASK dual = LE(MUL(MU, normT), SUB(ZERO, R0));                     \
+    VMASK inside = LE(normT, MUL(MU, R0));                              \
+    VD rn = DIV(FMA(MU, normT, R0), FMA(MU, MU, ONE));                  \
+    VD scale = DIV(MUL(MU, rn), SEL(inside, ONE, normT));               \
+    R0 = SEL(dual, ZERO, SEL(inside, R0, rn));                          \
+    R1 = SEL(dual, ZERO, SEL(inside, R1, MUL(R1, scale)));              \
+    R2 = SEL(dual, ZERO, SEL(inside, R2, MUL(R2, scale)));              \
+  } while(0)
+#endif
+
+void projectionOnConeBatch(unsigned int n, const double* mu, double* r)
+{
+  unsigned int contact = 0;
+
+#ifdef PROJECTION_BATCH_WIDTH
+  for (; contact + PROJECTION_BATCH_WIDTH <= n; contact += PROJECTION_BATCH_WIDTH)
+  {
+    double * p = &r[3 * contact];
+    VD r0, r1, r2;
+    projectionBatchLoad(p, &r0, &r1, &r2);
+    VD m = LOAD(&mu[contact]);
+
+    PROJCONE_BATCH_KERNEL(r0, r1, r2, m);
+
+    projectionBatchStore(p, r0, r1, r2);
+  }
+#endif
+
+  for (; contact < n; ++contact)
+  {
+    projectionOnCone(&r[3 * contact], mu[contact]);
+  }
+}
+
 void projectionOnSecondOrderCone(double* r, double  mu, int size)
 {
   if (size ==3)
@@ -35,6 +35,16 @@ extern "C"
   */
   unsigned projectionOnCone(double* r, double  mu);
 
+  /** projectionOnConeBatch Projection of n vectors of \f$R^3\f$ on
+      their cones, as projectionOnCone. The projection is computed
+      without branches, on several contacts at once with AVX-512 or
+      AVX2 when the library is compiled for these instruction sets.
+  \param[in] n the number of vectors
+  \param[in] mu the angles of the cones (size n)
+  \param[in,out] r the vectors to be projected, stored contiguously (size 3n)
+  */
+  void projectionOnConeBatch(unsigned int n, const double* mu, double* r);
+
   /** projectionOnCone Projection on the second Order Cone in \f$R^n\f$, \f$K \{ r, r_1 \geq 0, 0 \|[r_2,r_n]\| \geq mu r_1  \} \f$
   \param[in,out] r the vector to be projected
   \param[in] mu the angle of the cone
@@ -17,6 +17,7 @@
 */
 #include <math.h>
 #include "projectionOnCylinder.h"
+#include "projectionBatch.h"
 
 void projectionOnCylinder(double* r, double  R)
 {
@@ -59,6 +60,48 @@ void projectionOnCylinder(double* r, double  R)
 
   }
 }
+
+#ifdef PROJECTION_BATCH_WIDTH
+/* The tangential part is scaled to the radius when it is outside of
+   the cylinder, or for a negative normal part if it is not null. It is
+   set to zero for a negative normal part otherwise. */
+#define PROJCYLINDER_BATCH_KERNEL(R0, R1, R2, RADIUS)                    \
+  do {                                                                  \
+    VD normTsquare = FMA(R1, R1, MUL(R2, R2));                          \
+    VMASK negative = LT(R0, ZERO);                                      \
+    VMASK scaled = OR(GT(normTsquare, MUL(RADIUS, RADIUS)),             \
+                      AND(negative, GT(normTsquare, ZERO)));            \
+    VD normT = SEL(scaled, SQRT(normTsquare), ONE);                     \
+    R0 = SEL(negative, ZERO, R0);                                       \
+    R1 = SEL(scaled, DIV(MUL(RADIUS, R1), normT), SEL(negative, ZERO, R1)); \
+    R2 = SEL(scaled, DIV(MUL(RADIUS, R2), normT), SEL(negative, ZERO, R2)); \
+  } while(0)
+#endif
+
+void projectionOnCylinderBatch(unsigned int n, const double* R, double* r)
+{
+  unsigned int contact = 0;
+
+#ifdef PROJECTION_BATCH_WIDTH
+  for (; contact + PROJECTION_BATCH_WIDTH <= n; contact += PROJECTION_BATCH_WIDTH)
+  {
+    double * p = &r[3 * contact];
+    VD r0, r1, r2;
+    projectionBatchLoad(p, &r0, &r1, &r2);
+    VD radius = LOAD(&R[contact]);
+
+    PROJCYLINDER_BATCH_KERNEL(r0, r1, r2, radius);
+
+    projectionBatchStore(p, r0, r1, r2);
+  }
+#endif
+
+  for (; contact < n; ++contact)
+  {
+    projectionOnCylinder(&r[3 * contact], R[contact]);
+  }
+}
+
 void projectionOnGeneralCylinder(double* r, double  R, int dim)
 {
 
@@ -30,6 +30,17 @@ extern "C"
   \param[in] R the radius of the cone
   */
   void projectionOnCylinder(double* r, double  R);
+
+  /** projectionOnCylinderBatch Projection of n vectors of \f$R^3\f$ on
+      their cylinders, as projectionOnCylinder. The projection is
+      computed without branches, on several contacts at once with
+      AVX-512 or AVX2 when the library is compiled for these
+      instruction sets.
+  \param[in] n the number of vectors
+  \param[in] R the radii of the cylinders (size n)
+  \param[in,out] r the vectors to be projected, stored contiguously (size 3n)
+  */
+  void projectionOnCylinderBatch(unsigned int n, const double* R, double* r);
   
   /** projectionOnGeneralCylinder Projection onto the positive Cylinder of radius R  \f$  \{ r, r_1 \geq 0, 0 \sqrt(r_2^2+r_3^2) \geq R \} \f$
   \param[in,out] r the vector to be projected
@@ -82,7 +82,7 @@ int test_BuildNumericsMatrix(NumericsMatrix** MM)
   M2->size0 = n;
   M2->size1 = n;
 
-  SparseBlockStructuredMatrix * SBM = (SparseBlockStructuredMatrix *)malloc(sizeof(SparseBlockStructuredMatrix));
+  SparseBlockStructuredMatrix * SBM = newSBM();
   M2->matrix1 = SBM;
   SBM->nbblocks = 6;
   SBM->blocknumber0 = 3;
@@ -164,7 +164,7 @@ int test_BuildNumericsMatrix(NumericsMatrix** MM)
   M4->size0 = n;
   M4->size1 = 4;
 
-  M4->matrix1 = (SparseBlockStructuredMatrix *)malloc(sizeof(SparseBlockStructuredMatrix));
+  M4->matrix1 = newSBM();
   SparseBlockStructuredMatrix * SBM2 = M4->matrix1;
 
   SBM2->nbblocks = 2;
@@ -464,7 +464,7 @@ int test_prodNumericsMatrixNumericsMatrix(NumericsMatrix** MM)
   C3.storageType = 1;
   C3.size0 = M2->size0;
   C3.size1 = M2->size1;
-  SparseBlockStructuredMatrix * SBM3 = (SparseBlockStructuredMatrix *)malloc(sizeof(SparseBlockStructuredMatrix));
+  SparseBlockStructuredMatrix * SBM3 = newSBM();
   C3.matrix1 = SBM3;
   beta = 1.0;
   i = 1;
@@ -514,7 +514,7 @@ int test_prodNumericsMatrixNumericsMatrix(NumericsMatrix** MM)
   C4.storageType = 1;
   C4.size0 = M2->size0;
   C4.size1 = M4->size1;
-  SparseBlockStructuredMatrix * SBM4 = (SparseBlockStructuredMatrix *)malloc(sizeof(SparseBlockStructuredMatrix));
+  SparseBlockStructuredMatrix * SBM4 = newSBM();
   C4.matrix1 = SBM4;
 
   allocateMemoryForProdSBMSBM(M2->matrix1, M4->matrix1, SBM4);
@@ -0,0 +1,124 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/*
+  Tests the parallel matrix-vector products: the results must not
+  depend on the number of threads.
+
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "NumericsMatrix.h"
+#include "SparseBlockMatrix.h"
+#include "NumericsOptions.h"
+
+static int compare(int n, double* y, double* yref, double tol)
+{
+  for (int i = 0; i < n; i++)
+  {
+    if (fabs(y[i] - yref[i]) > tol * (1.0 + fabs(yref[i])))
+    {
+      printf("y[%i] = %e, expected %e\n", i, y[i], yref[i]);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* y = 2 A x + y and y = 2 A^T x + y with threads = 1, 2, 3 */
+static int test_products(NumericsMatrix* A, int exactSequential)
+{
+  int info = 0;
+  int n = A->size0;
+  int m = A->size1;
+  int size = (n > m) ? n : m;
+  double* x = (double*)malloc(size * sizeof(double));
+  double* y[3];
+  for (int i = 0; i < size; i++)
+    x[i] = 1.0 + 0.1 * i;
+
+  for (int trans = 0; trans < 2; trans++)
+  {
+    int sizeY = trans ? m : n;
+    for (int t = 0; t < 3; t++)
+    {
+      y[t] = (double*)malloc(sizeY * sizeof(double));
+      for (int i = 0; i < sizeY; i++)
+        y[t][i] = 1.0 - 0.2 * i;
+
+      setNumericsThreadsNumber(t + 1);
+      if (trans)
+        NM_tgemv(2.0, A, x, 1.0, y[t]);
+      else
+        NM_gemv(2.0, A, x, 1.0, y[t]);
+    }
+    setNumericsThreadsNumber(1);
+
+    /* bitwise reproducible from one thread count to another */
+    info += compare(sizeY, y[2], y[1], 0.0);
+    /* the sequential product may sum in another order */
+    info += compare(sizeY, y[2], y[0], (exactSequential && !trans) ? 0.0 : 1e-12);
+
+    for (int t = 0; t < 3; t++)
+      free(y[t]);
+  }
+  free(x);
+  return info;
+}
+
+int main(void)
+{
+  printf("========= Starts Numerics tests 7 for NumericsMatrix ========= \n");
+
+  int info = 0;
+  const char* files[2] = {"data/SBM1.dat", "data/SBM2.dat"};
+
+  for (int f = 0; f < 2; f++)
+  {
+    SparseBlockStructuredMatrix* sbm = newSBM();
+    FILE* file = fopen(files[f], "r");
+    newFromFileSBM(sbm, file);
+    fclose(file);
+
+    NumericsMatrix* A = newNumericsMatrix();
+    fillNumericsMatrix(A, NM_SPARSE_BLOCK, sbm->blocksize0[sbm->blocknumber0 - 1],
+                       sbm->blocksize1[sbm->blocknumber1 - 1], sbm);
+
+    NumericsMatrix* B = createNumericsMatrix(NM_SPARSE, A->size0, A->size1);
+    NM_copy_to_sparse(A, B);
+
+    info += test_products(A, 1);
+    info += test_products(B, 0);
+
+    freeNumericsMatrix(A);
+    freeNumericsMatrix(B);
+    free(A);
+    free(B);
+  }
+
+  if (info)
+  {
+    printf("========= Failed Numerics tests 7 for NumericsMatrix ========= \n");
+    return 1;
+  }
+  printf("========= End Numerics tests 7 for NumericsMatrix ========= \n");
+  return 0;
+}
@@ -0,0 +1,241 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/*
+  Tests the reuse of the symbolic analysis by NM_gesv_expert: the
+  analysis is done again only when the sparsity pattern changes (for a
+  sparse block matrix, its block structure), and the solutions are the
+  ones of a dense solver.
+
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "NumericsMatrix.h"
+#include "SparseBlockMatrix.h"
+#include "NumericsSparseMatrix.h"
+#include "SiconosLapack.h"
+
+#define N 20
+
+static int check(int cond, const char* msg)
+{
+  if (!cond)
+    printf("%s\n", msg);
+  return !cond;
+}
+
+static int test_same_pattern(void)
+{
+  int info = 0;
+  NumericsSparseLinearSolverParams* p = newNumericsSparseLinearSolverParams();
+  int i1[3] = {0, 1, 2};
+  int i2[3] = {0, 1, 3};
+  double d[2] = {1., 2.};
+  const void* blocks[2] = {i1, d};
+  size_t sizes[2] = {sizeof(i1), sizeof(d)};
+
+  info += check(!NM_sparse_same_pattern(p, 2, blocks, sizes), "the first pattern is new");
+  info += check(NM_sparse_same_pattern(p, 2, blocks, sizes), "the same pattern is recognized");
+  blocks[0] = i2;
+  info += check(!NM_sparse_same_pattern(p, 2, blocks, sizes), "a changed pattern is new");
+  info += check(NM_sparse_same_pattern(p, 2, blocks, sizes), "the changed pattern is recorded");
+  info += check(!NM_sparse_same_pattern(p, 1, blocks, sizes), "a shorter pattern is new");
+
+  freeNumericsSparseLinearSolverParams(p);
+  return info;
+}
+
+/* tridiagonal matrix, with the entries (0, N-1) and (N-1, 0) if corners */
+static NumericsMatrix* sparse_matrix(double shift, int corners)
+{
+  NumericsMatrix* A = createNumericsMatrix(NM_SPARSE, N, N);
+  NM_triplet_alloc(A, 3 * N + 2);
+  A->matrix2->origin = NS_TRIPLET;
+  CSparseMatrix* T = A->matrix2->triplet;
+  for (int i = 0; i < N; i++)
+  {
+    cs_zentry(T, i, i, 4. + shift + 0.1 * i);
+    if (i > 0)
+      cs_zentry(T, i, i - 1, -1. - shift);
+    if (i < N - 1)
+      cs_zentry(T, i, i + 1, -1. + 0.5 * shift);
+  }
+  if (corners)
+  {
+    cs_zentry(T, 0, N - 1, 0.5);
+    cs_zentry(T, N - 1, 0, 0.5);
+  }
+  return A;
+}
+
+/* solve A x = b with NM_gesv_expert and with DGESV on the dense matrix
+ * Adense, and compare both solutions */
+static int solve_and_compare(NumericsMatrix* A, double* Adense)
+{
+  int n = A->size0;
+  double* b = (double*)malloc(n * sizeof(double));
+  double* x = (double*)malloc(n * sizeof(double));
+  int* ipiv = (int*)malloc(n * sizeof(int));
+  for (int i = 0; i < n; i++)
+    b[i] = x[i] = 1. - 0.3 * i;
+
+  int info = NM_gesv_expert(A, b, false);
+  int infoDense = 0;
+  DGESV(n, 1, Adense, n, ipiv, x, n, &infoDense);
+  info += check(!infoDense, "the dense solver fails");
+  for (int i = 0; i < n; i++)
+  {
+    if (fabs(b[i] - x[i]) > 1e-12 * (1. + fabs(x[i])))
+    {
+      printf("x[%i] = %e, expected %e\n", i, b[i], x[i]);
+      info = 1;
+    }
+  }
+  free(b);
+  free(x);
+  free(ipiv);
+  return info;
+}
+
+static void dense_of_sparse(NumericsMatrix* A, double* Adense)
+{
+  memset(Adense, 0, A->size0 * A->size1 * sizeof(double));
+  CSparseMatrix* T = NM_triplet(A);
+  for (csi k = 0; k < T->nz; k++)
+    Adense[T->i[k] + T->p[k] * A->size0] += T->x[k];
+}
+
+/* the linear solver parameters of A are moved to B */
+static void move_params(NumericsMatrix* A, NumericsMatrix* B)
+{
+  NM_linearSolverParams(B);
+  freeNumericsSparseLinearSolverParams(B->matrix2->linearSolverParams);
+  B->matrix2->linearSolverParams = A->matrix2->linearSolverParams;
+  A->matrix2->linearSolverParams = NULL;
+}
+
+static int test_sparse(NumericsSparseLinearSolver solver)
+{
+  int info = 0;
+  double* Adense = (double*)malloc(N * N * sizeof(double));
+
+  NumericsMatrix* A = sparse_matrix(0., 0);
+  NumericsSparseLinearSolverParams* p = NM_linearSolverParams(A);
+  p->solver = solver;
+  dense_of_sparse(A, Adense);
+  info += solve_and_compare(A, Adense);
+  info += check(p->nbAnalysis == 1 && p->nbAnalysisReused == 0, "one analysis expected");
+
+  /* same pattern, other values */
+  NumericsMatrix* B = sparse_matrix(1., 0);
+  move_params(A, B);
+  dense_of_sparse(B, Adense);
+  info += solve_and_compare(B, Adense);
+  info += check(p->nbAnalysis == 1 && p->nbAnalysisReused == 1, "the analysis should be reused");
+
+  /* other pattern */
+  NumericsMatrix* C = sparse_matrix(2., 1);
+  move_params(B, C);
+  dense_of_sparse(C, Adense);
+  info += solve_and_compare(C, Adense);
+  info += check(p->nbAnalysis == 2 && p->nbAnalysisReused == 1, "a new analysis expected");
+
+  freeNumericsMatrix(A);
+  freeNumericsMatrix(B);
+  freeNumericsMatrix(C);
+  free(A);
+  free(B);
+  free(C);
+  free(Adense);
+  return info;
+}
+
+/* A zero entry in a block is dropped from the csc matrix, but the block
+ * structure, hence the analysis, is the same. */
+static int test_sparse_block(NumericsSparseLinearSolver solver)
+{
+  int info = 0;
+  NumericsMatrix* A[2];
+  for (int k = 0; k < 2; k++)
+  {
+    SparseBlockStructuredMatrix* sbm = newSBM();
+    FILE* file = fopen("data/SBM1.dat", "r");
+    newFromFileSBM(sbm, file);
+    fclose(file);
+    A[k] = newNumericsMatrix();
+    fillNumericsMatrix(A[k], NM_SPARSE_BLOCK, sbm->blocksize0[sbm->blocknumber0 - 1],
+                       sbm->blocksize1[sbm->blocknumber1 - 1], sbm);
+    /* a diagonally dominant matrix: 2 x 2 blocks of size 3, blocks 0
+     * and 3 are diagonal */
+    for (int i = 0; i < 3; i++)
+    {
+      sbm->block[0][4 * i] += 10.;
+      sbm->block[3][4 * i] += 10.;
+    }
+  }
+  int n = A[0]->size0;
+  double* Adense = (double*)malloc(n * n * sizeof(double));
+
+  NM_linearSolverParams(A[0])->solver = solver;
+  NumericsSparseLinearSolverParams* p = NM_linearSolverParams(A[0]);
+  SBMtoDense(A[0]->matrix1, Adense);
+  info += solve_and_compare(A[0], Adense);
+
+  A[1]->matrix1->block[1][0] = 0.;
+  A[1]->matrix1->block[3][7] = 3.;
+  NM_linearSolverParams(A[1]);
+  freeNumericsSparseLinearSolverParams(A[1]->matrix2->linearSolverParams);
+  A[1]->matrix2->linearSolverParams = p;
+  A[0]->matrix2->linearSolverParams = NULL;
+  SBMtoDense(A[1]->matrix1, Adense);
+  info += solve_and_compare(A[1], Adense);
+  if (solver == NS_CS_LUSOL)
+    info += check(p->nbAnalysis == 1 && p->nbAnalysisReused == 1, "the analysis of the block structure should be reused");
+
+  for (int k = 0; k < 2; k++)
+  {
+    freeNumericsMatrix(A[k]);
+    free(A[k]);
+  }
+  free(Adense);
+  return info;
+}
+
+int main(void)
+{
+  printf("========= Starts Numerics tests 8 for NumericsMatrix ========= \n");
+
+  int info = test_same_pattern();
+  info += test_sparse(NS_CS_LUSOL);
+  info += test_sparse_block(NS_CS_LUSOL);
+#ifdef WITH_MUMPS
+  info += test_sparse(NS_MUMPS);
+  info += test_sparse_block(NS_MUMPS);
+#endif
+
+  if (info)
+  {
+    printf("========= Failed Numerics tests 8 for NumericsMatrix ========= \n");
+    return 1;
+  }
+  printf("========= End Numerics tests 8 for NumericsMatrix ========= \n");
+  return 0;
+}
@@ -0,0 +1,245 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/*
+  Tests the contiguous block storage of SparseBlockStructuredMatrix,
+  the fixed block size products and NM_copy of such matrices
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "SparseBlockMatrix.h"
+#include "NumericsMatrix.h"
+
+/* 4 x 4 blocks of size bs, with 8 non null blocks */
+static SparseBlockStructuredMatrix* buildSBM(unsigned int bs)
+{
+  static const size_t index1[5] = {0, 2, 4, 6, 8};
+  static const size_t index2[8] = {0, 2, 1, 3, 0, 2, 1, 3};
+
+  SparseBlockStructuredMatrix* M = newSBM();
+  M->nbblocks = 8;
+  M->blocknumber0 = 4;
+  M->blocknumber1 = 4;
+  M->blocksize0 = (unsigned int*)malloc(4 * sizeof(unsigned int));
+  M->blocksize1 = (unsigned int*)malloc(4 * sizeof(unsigned int));
+  for (unsigned int i = 0; i < 4; i++)
+  {
+    M->blocksize0[i] = (i + 1) * bs;
+    M->blocksize1[i] = (i + 1) * bs;
+  }
+  M->filled1 = 5;
+  M->filled2 = 8;
+  M->index1_data = (size_t*)malloc(5 * sizeof(size_t));
+  M->index2_data = (size_t*)malloc(8 * sizeof(size_t));
+  memcpy(M->index1_data, index1, 5 * sizeof(size_t));
+  memcpy(M->index2_data, index2, 8 * sizeof(size_t));
+
+  if (allocateContiguousBlocksSBM(M))
+    return NULL;
+
+  for (unsigned int b = 0; b < M->nbblocks; b++)
+    for (unsigned int k = 0; k < bs * bs; k++)
+      M->block[b][k] = 1.0 + b + 0.1 * k;
+  return M;
+}
+
+static int compare(int n, double* y, double* yref)
+{
+  for (int i = 0; i < n; i++)
+  {
+    if (fabs(y[i] - yref[i]) > 1e-12)
+    {
+      printf("y[%i] = %e, expected %e\n", i, y[i], yref[i]);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static int test_fixedBlockSize(unsigned int bs)
+{
+  int info = 0;
+  SparseBlockStructuredMatrix* M = buildSBM(bs);
+  if (!M || M->fixedblocksize != bs || !M->blockstorage)
+  {
+    printf("allocateContiguousBlocksSBM failed for block size %i\n", bs);
+    return 1;
+  }
+  /* blocks are stored one after the other */
+  for (unsigned int b = 0; b < M->nbblocks; b++)
+    info += (M->block[b] != M->blockstorage + b * bs * bs);
+
+  int n = 4 * bs;
+  double* dense = (double*)malloc(n * n * sizeof(double));
+  double* x = (double*)malloc(n * sizeof(double));
+  double* y = (double*)malloc(n * sizeof(double));
+  double* yref = (double*)malloc(n * sizeof(double));
+  SBMtoDense(M, dense);
+  for (int i = 0; i < n; i++)
+  {
+    x[i] = 1.0 - 0.5 * i;
+    y[i] = yref[i] = 0.3 * i;
+  }
+
+  /* y = 2 A x + 0.5 y */
+  for (int i = 0; i < n; i++)
+  {
+    double s = 0.0;
+    for (int j = 0; j < n; j++)
+      s += dense[i + j * n] * x[j];
+    yref[i] = 2.0 * s + 0.5 * yref[i];
+  }
+  prodSBM(n, n, 2.0, M, x, 0.5, y);
+  info += compare(n, y, yref);
+
+  /* rows products, with and without the diagonal block */
+  for (unsigned int row = 0; row < 4; row++)
+  {
+    for (unsigned int i = 0; i < bs; i++)
+    {
+      double s = 0.0, sNoDiag = 0.0;
+      for (int j = 0; j < n; j++)
+      {
+        s += dense[row * bs + i + j * n] * x[j];
+        if (j / bs != row)
+          sNoDiag += dense[row * bs + i + j * n] * x[j];
+      }
+      yref[i] = s;
+      yref[bs + i] = sNoDiag;
+    }
+    subRowProdSBM(n, bs, row, M, x, y, 1);
+    rowProdNoDiagSBM(n, bs, row, M, x, &y[bs], 1);
+    info += compare(2 * bs, y, yref);
+  }
+
+  /* copy keeps the contiguous layout */
+  SparseBlockStructuredMatrix* C = newSBM();
+  copySBM(M, C, 1);
+  info += (C->fixedblocksize != bs || !C->blockstorage);
+  info += (memcmp(C->blockstorage, M->blockstorage, M->nbblocks * bs * bs * sizeof(double)) != 0);
+
+  /* transpose */
+  SparseBlockStructuredMatrix* T = newSBM();
+  transposeSBM(M, T);
+  info += (T->fixedblocksize != bs || !T->blockstorage);
+  double* denseT = (double*)malloc(n * n * sizeof(double));
+  SBMtoDense(T, denseT);
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < n; j++)
+      info += (denseT[i + j * n] != dense[j + i * n]);
+
+  freeSBM(M);
+  freeSBM(C);
+  freeSBM(T);
+  free(M);
+  free(C);
+  free(T);
+  free(dense);
+  free(denseT);
+  free(x);
+  free(y);
+  free(yref);
+  return info;
+}
+
+static NumericsMatrix* buildNM(unsigned int bs)
+{
+  NumericsMatrix* M = newNumericsMatrix();
+  fillNumericsMatrix(M, NM_SPARSE_BLOCK, 4 * bs, 4 * bs, buildSBM(bs));
+  return M;
+}
+
+static int compareNM(NumericsMatrix* A, NumericsMatrix* B)
+{
+  int n = A->size0;
+  int info = (B->size0 != A->size0 || B->size1 != A->size1);
+  info += (B->matrix1->fixedblocksize != A->matrix1->fixedblocksize);
+  double* denseA = (double*)malloc(n * n * sizeof(double));
+  double* denseB = (double*)malloc(n * n * sizeof(double));
+  SBMtoDense(A->matrix1, denseA);
+  SBMtoDense(B->matrix1, denseB);
+  info += compare(n * n, denseB, denseA);
+  free(denseA);
+  free(denseB);
+  return info;
+}
+
+/* NM_copy into a matrix with contiguous blocks, of another pattern
+ * and then of the same pattern */
+static int test_NM_copy(unsigned int bs, unsigned int bsB)
+{
+  int info = 0;
+  NumericsMatrix* A = buildNM(bs);
+  NumericsMatrix* B = buildNM(bsB);
+
+  NM_copy(A, B);
+  info += compareNM(A, B);
+  info += (B->matrix1->blockstorage == NULL);
+
+  double* storage = B->matrix1->blockstorage;
+  for (unsigned int k = 0; k < bs * bs; k++)
+    A->matrix1->block[0][k] = -1.0 - k;
+  NM_copy(A, B);
+  info += compareNM(A, B);
+  /* same pattern: the storage of B is kept */
+  info += (B->matrix1->blockstorage != storage);
+
+  /* the fixed size products of the copy */
+  int n = 4 * bs;
+  double* x = (double*)malloc(n * sizeof(double));
+  double* y = (double*)calloc(n, sizeof(double));
+  double* yref = (double*)calloc(n, sizeof(double));
+  for (int i = 0; i < n; i++)
+    x[i] = 1.0 + 0.25 * i;
+  prodSBM(n, n, 1.0, A->matrix1, x, 0.0, yref);
+  prodSBM(n, n, 1.0, B->matrix1, x, 0.0, y);
+  info += compare(n, y, yref);
+
+  freeNumericsMatrix(A);
+  freeNumericsMatrix(B);
+  free(A);
+  free(B);
+  free(x);
+  free(y);
+  free(yref);
+  if (info)
+    printf("NM_copy failed, block sizes %i and %i\n", bs, bsB);
+  return info;
+}
+
+int main(void)
+{
+  printf("========= Starts SBM tests 6 for SBM ========= \n");
+  int info = test_fixedBlockSize(3);
+  info += test_fixedBlockSize(2);
+  info += test_fixedBlockSize(4);
+  info += test_NM_copy(3, 3);
+  info += test_NM_copy(3, 2);
+  info += test_NM_copy(2, 3);
+  info += test_NM_copy(4, 1);
+  if (info)
+  {
+    printf("========= Failed SBM tests 6 for SBM  ========= \n");
+    return 1;
+  }
+  printf("\n========= Succed SBM tests 6 for SBM  ========= \n");
+  return 0;
+}
@@ -0,0 +1,65 @@
+/* Siconos is a program dedicated to modeling, simulation and control
+ * of non smooth dynamical systems.
+ *
+ * Copyright 2016 INRIA.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/*
+  projectionOnCylinderBatch gives the same result as projectionOnCylinder
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "projectionOnCylinder.h"
+
+#define N 1003
+
+int main(void)
+{
+  double * r = (double *)malloc(3 * N * sizeof(double));
+  double * s = (double *)malloc(3 * N * sizeof(double));
+  double * R = (double *)malloc(N * sizeof(double));
+
+  srand(1);
+  for (int i = 0; i < 3 * N; ++i)
+    r[i] = s[i] = 2.0 * rand() / RAND_MAX - 1.0;
+  for (int i = 0; i < N; ++i)
+    R[i] = 1.5 * rand() / RAND_MAX;
+
+  /* negative and positive normal parts on the axis, and a null radius */
+  r[0] = s[0] = -1.0; r[1] = s[1] = 0.0; r[2] = s[2] = 0.0;
+  r[3] = s[3] = 1.0; r[4] = s[4] = 0.0; r[5] = s[5] = 0.0;
+  R[2] = 0.0;
+
+  for (int i = 0; i < N; ++i)
+    projectionOnCylinder(&s[3 * i], R[i]);
+  projectionOnCylinderBatch(N, R, r);
+
+  int info = 0;
+  for (int i = 0; i < 3 * N; ++i)
+  {
+    if (fabs(r[i] - s[i]) > 1e-14)
+    {
+      printf("projectionOnCylinderBatch: r[%i] = %g, expected %g\n", i, r[i], s[i]);
+      info = 1;
+    }
+  }
+
+  free(r);
+  free(s);
+  free(R);
+  return info;
+}
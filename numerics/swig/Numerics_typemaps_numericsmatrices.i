@@ -934,13 +934,9 @@ static PyObject* cs_sparse_to_coo_matrix(CSparseMatrix *M, bool copy)
 
 %typemap(in, numinputs=0) (SparseBlockStructuredMatrix* outSBM) 
 {
-  $1 = (SparseBlockStructuredMatrix*) malloc(sizeof(SparseBlockStructuredMatrix));
+  $1 = newSBM();
   if(!$1) SWIG_fail;
 
-  $1->block = NULL;
-  $1->index1_data = NULL;
-  $1->index2_data = NULL;
-
 }
 
 %typemap(argout) (SparseBlockStructuredMatrix* outSBM)